@@ -0,0 +1,41 @@
+#ifndef ELS_BENCH
+#define ELS_BENCH
+
+#include <chrono>
+#include <cstdio>
+
+// shared by the drivers that produce the timing tables in the readme
+// every driver is a single file that builds from this folder with the line at its top
+namespace els
+{
+	namespace bench
+	{
+		// best of runs calls of fn in milliseconds, the best run hides the noise of other processes
+		template <typename Fn>
+		inline double best_ms(int runs, Fn&& fn)
+		{
+			double best = 1e300;
+			for (int r = 0; r < runs; ++r)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				fn();
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				best = ms < best ? ms : best;
+			}
+			return best;
+		}
+
+		// keeps the compiler from dropping the work that produced the memory behind p
+		inline void keep(const void* p)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__asm__ volatile("" : : "r"(p) : "memory");
+#else
+			static const void* volatile sink;
+			sink = p;
+#endif
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,100 @@
+// g++ -std=c++17 -O2 -DELS_NO_THREADS -I../include bvh.cpp -o bvh
+// ./bvh [triangles], without an argument it runs 100k and 1M
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "elsVector2.h"
+#include "elsBvh.h"
+#include "elsRandom.h"
+#include "bench.h"
+
+using namespace els;
+
+static void run(size_t n)
+{
+	// triangle soup, every triangle within a unit ball around a center in a 200 unit cube
+	random::reseed(39);
+	const vec3f lo{ -100.f }, hi{ 100.f };
+	std::vector<vec3f> a(n), b(n), c(n);
+	std::vector<aabbf> boxes(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		const vec3f center = random::uniform_rand(lo, hi);
+		a[i] = center + random::ball_rand(1.f);
+		b[i] = center + random::ball_rand(1.f);
+		c[i] = center + random::ball_rand(1.f);
+		boxes[i] = aabbf{};
+		boxes[i].merge(a[i]).merge(b[i]).merge(c[i]);
+	}
+
+	bvhf tree;
+	const double build = bench::best_ms(3, [&] { tree.build(boxes); });
+	const double refit = bench::best_ms(3, [&] { tree.refit(boxes); });
+
+	const size_t queries = 100000;
+	std::vector<rayf> rays(queries), cast(queries);
+	std::vector<vec3f> points(queries);
+	std::vector<aabbf> regions(queries);
+	for (size_t i = 0; i < queries; ++i)
+	{
+		rays[i] = rayf{ random::uniform_rand(lo, hi), random::spherical_rand(1.f) };
+		points[i] = random::uniform_rand(lo * 1.1f, hi * 1.1f);
+		regions[i] = aabbf::from_center(points[i], vec3f{ 2.f });
+	}
+
+	std::vector<uint32_t> hits(queries);
+	const auto triangle = [&](uint32_t prim, rayf& ray)
+	{
+		float t, u, v;
+		if (!intersect(ray, a[prim], b[prim], c[prim], t, u, v))
+			return false;
+		ray.t_max = t;
+		return true;
+	};
+	const double raycast = bench::best_ms(3, [&]
+		{
+			cast = rays;
+			tree.raycast(span<rayf>(cast), span<uint32_t>(hits), triangle);
+		});
+
+	std::vector<bvhf::Hit> nearest(queries);
+	const double closest = bench::best_ms(3, [&]
+		{
+			tree.nearest(span<const vec3f>(points), span<bvhf::Hit>(nearest), [&](uint32_t prim, const vec3f& p)
+				{
+					return closest_point(p, a[prim], b[prim], c[prim]).distance2(p);
+				});
+		});
+
+	std::vector<uint32_t> counts(queries);
+	const double overlap = bench::best_ms(3, [&]
+		{
+			std::fill(counts.begin(), counts.end(), 0u);
+			tree.query(span<const aabbf>(regions), [&](size_t q, uint32_t) { ++counts[q]; });
+		});
+
+	// the first corner of every triangle as a point set
+	std::vector<aabbf> corners(n);
+	for (size_t i = 0; i < n; ++i)
+		corners[i] = aabbf{ a[i], a[i] };
+	bvhf point_tree;
+	point_tree.build(corners);
+	const double neighbour = bench::best_ms(3, [&] { point_tree.nearest(span<const vec3f>(points), span<bvhf::Hit>(nearest)); });
+
+	std::printf("| %zu%s | %.0f ms | %.1f ms | %.2f Mrays/s | %.2f Mq/s | %.2f Mq/s | %.2f Mq/s |\n",
+		n % 1000000 ? n / 1000 : n / 1000000, n % 1000000 ? "k" : "M", build, refit,
+		queries / raycast / 1000.0, queries / closest / 1000.0, queries / overlap / 1000.0, queries / neighbour / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+	std::printf("| Triangles | Build | Refit | Raycast | Closest point | Box overlap | Point nearest neighbour |\n");
+	if (argc > 1)
+		run(static_cast<size_t>(std::atoll(argv[1])));
+	else
+	{
+		run(100000);
+		run(1000000);
+	}
+	return 0;
+}
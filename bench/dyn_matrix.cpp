@@ -0,0 +1,87 @@
+// g++ -std=c++17 -O2 -DELS_NO_THREADS -I../include dyn_matrix.cpp -o dyn_matrix
+// add -DELS_NO_AVX2 for the SSE2 columns
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "elsDynMatrix.h"
+#include "bench.h"
+
+using namespace els;
+
+int main()
+{
+	std::mt19937 rng{ 48 };
+	std::uniform_real_distribution<float> u(-1.f, 1.f);
+	std::printf("%s\n", simd::has_avx2() ? "AVX2" : "SSE2 or scalar");
+	std::printf("| n | gemm | naive | gemv | LU + solve |\n");
+	for (size_t n : { 64, 256, 1024, 2048 })
+	{
+		dyn_matf a(n, n), b(n, n), c(n, n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = 0; j < n; ++j)
+			{
+				a(i, j) = u(rng);
+				b(i, j) = u(rng);
+			}
+		}
+		std::vector<float> x(n), y(n);
+		for (float& v : x)
+			v = u(rng);
+
+		// small sizes repeat inside a run so the timer resolution does not show
+		const int repeat = n <= 64 ? 100 : 1;
+		const int runs = n <= 256 ? 10 : 3;
+		const double flops = 2.0 * n * n * n;
+		const double gemm_ms = bench::best_ms(runs, [&]
+			{
+				for (int r = 0; r < repeat; ++r)
+					gemm(1.f, a, b, 0.f, c);
+				bench::keep(c.data());
+			}) / repeat;
+
+		// the textbook triple loop, too slow to be worth it past 1024
+		double naive_ms = 0.0;
+		if (n <= 1024)
+		{
+			naive_ms = bench::best_ms(n <= 256 ? runs : 1, [&]
+				{
+					for (int r = 0; r < repeat; ++r)
+					{
+						for (size_t i = 0; i < n; ++i)
+						{
+							for (size_t j = 0; j < n; ++j)
+							{
+								float s = 0.f;
+								for (size_t k = 0; k < n; ++k)
+									s += a(i, k) * b(k, j);
+								c(i, j) = s;
+							}
+						}
+					}
+					bench::keep(c.data());
+				}) / repeat;
+		}
+
+		const double gemv_ms = bench::best_ms(5, [&]
+			{
+				for (int r = 0; r < 100; ++r)
+					gemv(1.f, a, span<const float>(x), 0.f, span<float>(y));
+				bench::keep(y.data());
+			}) / 100;
+		const double lu_ms = bench::best_ms(runs, [&]
+			{
+				LU<dyn_matf> lu(a);
+				lu.solve(span<const float>(x), span<float>(y));
+				bench::keep(y.data());
+			});
+
+		std::printf("| %zu | %.1f GFLOP/s | ", n, flops / gemm_ms * 1e-6);
+		if (naive_ms > 0.0)
+			std::printf("%.2f GFLOP/s | ", flops / naive_ms * 1e-6);
+		else
+			std::printf("| ");
+		std::printf("%.1f GFLOP/s | %.2f ms |\n", 2.0 * n * n / gemv_ms * 1e-6, lu_ms);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+// g++ -std=c++17 -O2 -I../include fixed.cpp -o fixed
+#include <cstdio>
+#include "elsFixed.h"
+#include "elsVector3.h"
+#include "elsMatrix4.h"
+#include "elsQuaternion.h"
+#include "bench.h"
+
+using namespace els;
+
+// every step feeds the next, so the time per step is the latency of one operation
+template <typename T, typename Step>
+static double chain_ns(T& x, Step&& step)
+{
+	const int steps = 1 << 20;
+	const double ms = bench::best_ms(5, [&]
+		{
+			for (int i = 0; i < steps; ++i)
+				x = step(x);
+			bench::keep(&x);
+		});
+	return ms * 1e6 / steps;
+}
+
+template <typename T>
+struct Times
+{
+	double dot, cross, normalized, multiply, sin, sqrt;
+
+	Times()
+	{
+		// the chains stay bounded, a fixed point value that grows would wrap
+		const Vector3<T> w{ T(0.5), T(0.1), T(0.2) };
+		T s = T(1);
+		dot = chain_ns(s, [&](T v) { return Vector3<T>{ v, T(1), T(2) }.dot(w); });
+		// a unit axis and a start orthogonal to it keep the length
+		const Vector3<T> axis{ T(0.6), T(0), T(0.8) };
+		Vector3<T> c{ T(0), T(1), T(0) };
+		cross = chain_ns(c, [&](const Vector3<T>& v) { return v.cross(axis); });
+		Vector3<T> n{ T(1), T(2), T(2) };
+		normalized = chain_ns(n, [&](const Vector3<T>& v) { return (v + w).normalized(); });
+		Quaternion<T> q;
+		q.set_euler(T(0.3), T(0.5), T(0.1));
+		const Matrix4<T> r = q.to_mtx4();
+		Matrix4<T> m = r;
+		multiply = chain_ns(m, [&](const Matrix4<T>& a) { return a * r; });
+		T x = T(0.5);
+		sin = chain_ns(x, [](T v) { return els::sin(v) + T(0.5); });
+		T y = T(2);
+		sqrt = chain_ns(y, [](T v) { return els::sqrt(v) + T(1); });
+	}
+};
+
+int main()
+{
+	const Times<float> f;
+	const Times<Fixed32> x;
+	std::printf("| Operation | float | Fixed32 |\n");
+	std::printf("| dot | %.1f | %.1f |\n", f.dot, x.dot);
+	std::printf("| cross | %.1f | %.1f |\n", f.cross, x.cross);
+	std::printf("| normalized | %.1f | %.1f |\n", f.normalized, x.normalized);
+	std::printf("| Matrix4 multiply | %.1f | %.1f |\n", f.multiply, x.multiply);
+	std::printf("| sin | %.1f | %.1f |\n", f.sin, x.sin);
+	std::printf("| sqrt | %.1f | %.1f |\n", f.sqrt, x.sqrt);
+	return 0;
+}
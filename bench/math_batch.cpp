@@ -0,0 +1,139 @@
+// g++ -std=c++17 -O2 -DELS_NO_THREADS -I../include math_batch.cpp -o math_batch
+// add -DELS_NO_AVX2 for the SSE2 column, the AVX2 column needs a cpu with AVX2 and FMA
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "elsMathBatch.h"
+#include "bench.h"
+
+using namespace els;
+
+// distance to the double result in units of the float spacing there, subnormal results count in the smallest spacing
+static double ulp_error(float got, double want)
+{
+	if (std::isnan(want))
+		return std::isnan(got) ? 0.0 : 1e9;
+	if (std::isinf(static_cast<float>(want)))
+		return got == static_cast<float>(want) ? 0.0 : 1e9;
+	int e;
+	std::frexp(std::fabs(want), &e);
+	return std::fabs(static_cast<double>(got) - want) / std::ldexp(1.0, e - 24 < -149 ? -149 : e - 24);
+}
+
+struct Row
+{
+	const char* name;
+	double error, batch, libm;
+};
+
+static void print(const Row& r)
+{
+	std::printf("| %-8s | %.1f | %.1f ms | %.1f ms |\n", r.name, r.error, r.batch, r.libm);
+}
+
+int main()
+{
+	const size_t n = 1 << 20;
+	const int runs = 10;
+	std::mt19937 rng{ 35 };
+	std::uniform_real_distribution<float> angle(-8192.f, 8192.f), exponent(-87.f, 88.f), base(0.01f, 100.f), power(-8.f, 8.f), side(-100.f, 100.f);
+	std::vector<float> x(n), y(n), out(n), out2(n);
+	const span<const float> xs(x.data(), n), ys(y.data(), n);
+	const span<float> os(out.data(), n), os2(out2.data(), n);
+
+	const auto error = [&](double (*f)(double))
+	{
+		double worst = 0.0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double e = ulp_error(out[i], f(x[i]));
+			worst = e > worst ? e : worst;
+		}
+		return worst;
+	};
+
+	std::printf("%s\n", simd::has_avx2() ? "AVX2" : "SSE2 or scalar");
+	std::printf("| Function | Max error | batch | libm |\n");
+
+	for (float& v : x)
+		v = angle(rng);
+	{
+		Row r{ "sin", 0.0, 0.0, 0.0 };
+		r.batch = bench::best_ms(runs, [&] { sin(xs, os); bench::keep(out.data()); });
+		r.error = error([](double v) { return std::sin(v); });
+		cos(xs, os);
+		const double c = error([](double v) { return std::cos(v); });
+		r.error = c > r.error ? c : r.error;
+		r.libm = bench::best_ms(runs, [&] { for (size_t i = 0; i < n; ++i) out[i] = std::sin(x[i]); bench::keep(out.data()); });
+		print(r);
+
+		Row s{ "sincos", r.error, 0.0, 0.0 };
+		s.batch = bench::best_ms(runs, [&] { sincos(xs, os, os2); bench::keep(out.data()); bench::keep(out2.data()); });
+		s.libm = bench::best_ms(runs, [&]
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					out[i] = std::sin(x[i]);
+					out2[i] = std::cos(x[i]);
+				}
+				bench::keep(out.data());
+				bench::keep(out2.data());
+			});
+		print(s);
+	}
+
+	for (float& v : x)
+		v = exponent(rng);
+	{
+		Row r{ "exp", 0.0, 0.0, 0.0 };
+		r.batch = bench::best_ms(runs, [&] { exp(xs, os); bench::keep(out.data()); });
+		r.error = error([](double v) { return std::exp(v); });
+		r.libm = bench::best_ms(runs, [&] { for (size_t i = 0; i < n; ++i) out[i] = std::exp(x[i]); bench::keep(out.data()); });
+		print(r);
+	}
+
+	for (float& v : x)
+		v = base(rng);
+	{
+		Row r{ "log", 0.0, 0.0, 0.0 };
+		r.batch = bench::best_ms(runs, [&] { log(xs, os); bench::keep(out.data()); });
+		r.error = error([](double v) { return std::log(v); });
+		r.libm = bench::best_ms(runs, [&] { for (size_t i = 0; i < n; ++i) out[i] = std::log(x[i]); bench::keep(out.data()); });
+		print(r);
+	}
+
+	// results below the normal range are left out of the error, they lose bits to the format itself
+	for (float& v : y)
+		v = power(rng);
+	{
+		Row r{ "pow", 0.0, 0.0, 0.0 };
+		r.batch = bench::best_ms(runs, [&] { pow(xs, ys, os); bench::keep(out.data()); });
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double want = std::pow(static_cast<double>(x[i]), static_cast<double>(y[i]));
+			const double e = std::fabs(want) < 1.2e-38 ? 0.0 : ulp_error(out[i], want);
+			r.error = e > r.error ? e : r.error;
+		}
+		r.libm = bench::best_ms(runs, [&] { for (size_t i = 0; i < n; ++i) out[i] = std::pow(x[i], y[i]); bench::keep(out.data()); });
+		print(r);
+	}
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		x[i] = side(rng);
+		y[i] = side(rng);
+	}
+	{
+		Row r{ "atan2", 0.0, 0.0, 0.0 };
+		r.batch = bench::best_ms(runs, [&] { atan2(ys, xs, os); bench::keep(out.data()); });
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double e = ulp_error(out[i], std::atan2(static_cast<double>(y[i]), static_cast<double>(x[i])));
+			r.error = e > r.error ? e : r.error;
+		}
+		r.libm = bench::best_ms(runs, [&] { for (size_t i = 0; i < n; ++i) out[i] = std::atan2(y[i], x[i]); bench::keep(out.data()); });
+		print(r);
+	}
+	return 0;
+}
@@ -0,0 +1,188 @@
+// g++ -std=c++17 -O2 -I../include ray_packets.cpp -o ray_packets
+// add -DELS_NO_AVX2 for the SSE2 columns, the scalar column is the same in both builds
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "elsVector2.h"
+#include "elsIntersect.h"
+#include "elsRandom.h"
+#include "bench.h"
+
+using namespace els;
+
+int main()
+{
+	// rays from a small cube in every direction through primitives spread over a larger one
+	random::reseed(40);
+	const size_t rays = 256, prims = 4096;
+	std::vector<rayf> single(rays);
+	std::vector<float> ox(rays), oy(rays), oz(rays), dx(rays), dy(rays), dz(rays), t_min(rays, 0.f), t_max(rays);
+	for (size_t i = 0; i < rays; ++i)
+	{
+		const vec3f o = random::uniform_rand(vec3f{ -1.f }, vec3f{ 1.f });
+		const vec3f d = random::spherical_rand(1.f);
+		single[i] = rayf{ o, d };
+		ox[i] = o.x, oy[i] = o.y, oz[i] = o.z;
+		dx[i] = d.x, dy[i] = d.y, dz[i] = d.z;
+	}
+	std::vector<uint32_t> prim(rays);
+	std::vector<float> hit_u(rays), hit_v(rays);
+	const RaySoA packet{ ox, oy, oz, dx, dy, dz, t_min, t_max };
+	const HitSoA hits{ prim, hit_u, hit_v };
+
+	std::vector<vec3f> a(prims), b(prims), c(prims);
+	std::vector<spheref> spheres(prims);
+	std::vector<aabbf> boxes(prims);
+	std::vector<float> ax(prims), ay(prims), az(prims), bx(prims), by(prims), bz(prims), cx(prims), cy(prims), cz(prims);
+	std::vector<float> sx(prims), sy(prims), sz(prims), sr(prims, 0.5f);
+	std::vector<float> lx(prims), ly(prims), lz(prims), hx(prims), hy(prims), hz(prims);
+	for (size_t m = 0; m < prims; ++m)
+	{
+		const vec3f center = random::uniform_rand(vec3f{ -20.f }, vec3f{ 20.f });
+		a[m] = center + random::ball_rand(1.f);
+		b[m] = center + random::ball_rand(1.f);
+		c[m] = center + random::ball_rand(1.f);
+		spheres[m] = spheref{ center, 0.5f };
+		boxes[m] = aabbf{};
+		boxes[m].merge(a[m]).merge(b[m]).merge(c[m]);
+		ax[m] = a[m].x, ay[m] = a[m].y, az[m] = a[m].z;
+		bx[m] = b[m].x, by[m] = b[m].y, bz[m] = b[m].z;
+		cx[m] = c[m].x, cy[m] = c[m].y, cz[m] = c[m].z;
+		sx[m] = center.x, sy[m] = center.y, sz[m] = center.z;
+		lx[m] = boxes[m].min.x, ly[m] = boxes[m].min.y, lz[m] = boxes[m].min.z;
+		hx[m] = boxes[m].max.x, hy[m] = boxes[m].max.y, hz[m] = boxes[m].max.z;
+	}
+	const TriangleSoA triangles{ ax, ay, az, bx, by, bz, cx, cy, cz };
+	const SphereSoA sphere_soa{ sx, sy, sz, sr };
+	const AABBSoA box_soa{ lx, ly, lz, hx, hy, hz };
+	std::vector<uint32_t> bits((prims + 31) / 32);
+	std::vector<float> found(rays);
+
+	// every ray meets every primitive once per run
+	const auto rate = [&](const auto& fn)
+	{
+		const double ms = bench::best_ms(3, [&]
+			{
+				for (int r = 0; r < 10; ++r)
+					fn();
+			});
+		const double per_second = 10.0 * rays / (ms * 1e-3);
+		return std::make_pair(per_second * prims * 1e-6, per_second * 1e-3);
+	};
+	const auto print = [](const char* name, std::pair<double, double> packet_rate, std::pair<double, double> many, std::pair<double, double> scalar)
+	{
+		std::printf("| %s | %.0f (%.0f) | %.0f (%.0f) | %.0f (%.0f) |\n", name, packet_rate.first, packet_rate.second,
+			many.first, many.second, scalar.first, scalar.second);
+	};
+	std::printf("%s, M tests/s (k rays/s)\n", simd::has_avx2() ? "AVX2" : "SSE2 or scalar");
+	std::printf("| Test | packet | one ray vs many | scalar intersect |\n");
+
+	for (bool watertight : { false, true })
+	{
+		const auto p = rate([&]
+			{
+				std::fill(t_max.begin(), t_max.end(), 1e30f);
+				for (size_t m = 0; m < prims; ++m)
+					raycast(packet, a[m], b[m], c[m], static_cast<uint32_t>(m), hits, watertight);
+				bench::keep(prim.data());
+			});
+		const auto o = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					rayf q = single[i];
+					float u, v;
+					found[i] = static_cast<float>(raycast(q, triangles, u, v, watertight));
+				}
+				bench::keep(found.data());
+			});
+		const auto s = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					rayf q = single[i];
+					for (size_t m = 0; m < prims; ++m)
+					{
+						float t, u, v;
+						if (watertight ? intersect_watertight(q, a[m], b[m], c[m], t, u, v) : intersect(q, a[m], b[m], c[m], t, u, v))
+							q.t_max = t;
+					}
+					found[i] = q.t_max;
+				}
+				bench::keep(found.data());
+			});
+		print(watertight ? "Triangle, watertight" : "Triangle", p, o, s);
+	}
+
+	{
+		const auto p = rate([&]
+			{
+				std::fill(t_max.begin(), t_max.end(), 1e30f);
+				for (size_t m = 0; m < prims; ++m)
+					raycast(packet, spheres[m], static_cast<uint32_t>(m), hits);
+				bench::keep(prim.data());
+			});
+		const auto o = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					rayf q = single[i];
+					found[i] = static_cast<float>(raycast(q, sphere_soa));
+				}
+				bench::keep(found.data());
+			});
+		const auto s = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					rayf q = single[i];
+					for (size_t m = 0; m < prims; ++m)
+					{
+						float t;
+						if (intersect(q, spheres[m], t))
+							q.t_max = t;
+					}
+					found[i] = q.t_max;
+				}
+				bench::keep(found.data());
+			});
+		print("Sphere", p, o, s);
+	}
+
+	{
+		std::fill(t_max.begin(), t_max.end(), 1e30f);
+		const auto p = rate([&]
+			{
+				for (size_t m = 0; m < prims; ++m)
+				{
+					intersect(packet, boxes[m], bits);
+					bench::keep(bits.data());
+				}
+			});
+		const auto o = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					intersect(single[i], box_soa, bits);
+					bench::keep(bits.data());
+				}
+			});
+		const auto s = rate([&]
+			{
+				for (size_t i = 0; i < rays; ++i)
+				{
+					const vec3f inv = single[i].inv_direction();
+					uint32_t count = 0;
+					for (size_t m = 0; m < prims; ++m)
+					{
+						float t;
+						count += intersect(single[i], inv, boxes[m], t);
+					}
+					found[i] = static_cast<float>(count);
+				}
+				bench::keep(found.data());
+			});
+		print("Box", p, o, s);
+	}
+	return 0;
+}
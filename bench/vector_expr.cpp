@@ -0,0 +1,54 @@
+// g++ -std=c++17 -O2 -I../include vector_expr.cpp -o vector_expr
+// the readme also lists -O3, the same line with -O3 gives those columns
+#include <cstdio>
+#include <vector>
+#include "elsVector3.h"
+#include "elsVectorExpr.h"
+#include "bench.h"
+
+using namespace els;
+
+int main()
+{
+	const size_t n = 1 << 16;
+	const int runs = 20;
+	std::vector<vec3f> a(n), b(n), c(n), r(n);
+	std::vector<float> length(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		a[i] = vec3f{ static_cast<float>(i), 1.f, 2.f };
+		b[i] = vec3f{ 3.f, static_cast<float>(i & 7), 1.f };
+		c[i] = vec3f{ 1.f, 2.f, static_cast<float>(i & 3) };
+	}
+	const float s = 0.5f, t = 1.5f;
+
+	const double eager_sum = bench::best_ms(runs, [&]
+		{
+			for (size_t i = 0; i < n; ++i)
+				r[i] = a[i] * s + b[i] * t - c[i];
+			bench::keep(r.data());
+		});
+	const double lazy_sum = bench::best_ms(runs, [&]
+		{
+			for (size_t i = 0; i < n; ++i)
+				r[i] = lazy(a[i]) * s + lazy(b[i]) * t - c[i];
+			bench::keep(r.data());
+		});
+	const double eager_length = bench::best_ms(runs, [&]
+		{
+			for (size_t i = 0; i < n; ++i)
+				length[i] = (a[i] - b[i]).length();
+			bench::keep(length.data());
+		});
+	const double lazy_length = bench::best_ms(runs, [&]
+		{
+			for (size_t i = 0; i < n; ++i)
+				length[i] = (lazy(a[i]) - b[i]).length();
+			bench::keep(length.data());
+		});
+
+	std::printf("| Expression | eager | lazy |\n");
+	std::printf("| a * s + b * t - c | %.0f us | %.0f us |\n", eager_sum * 1e3, lazy_sum * 1e3);
+	std::printf("| (a - b).length() | %.0f us | %.0f us |\n", eager_length * 1e3, lazy_length * 1e3);
+	return 0;
+}
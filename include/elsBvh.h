@@ -0,0 +1,783 @@
+#ifndef ELS_BVH
+#define ELS_BVH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsGeometry.h"
+#include "elsRay.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// queries per worker chunk for the batched queries
+	constexpr size_t bvh_query_grain = 1024;
+
+	// depth first layout, the left child follows its parent and the right child sits at index
+	// leaves cover the primitive slots [index, index + count)
+	template <typename T>
+	struct BvhNode
+	{
+		AABB<T> bounds;
+		uint32_t index;
+		uint32_t count; // 0 for interior nodes
+
+		constexpr bool is_leaf() const { return count != 0; }
+	};
+
+	namespace detail
+	{
+		namespace bvh
+		{
+			constexpr size_t bins = 16;
+			// below this many primitives a node is binned on one thread
+			constexpr size_t parallel_bins = 1 << 15;
+			// past this depth nodes split at the object median, which bounds the depth by sah_depth + 32
+			constexpr size_t sah_depth = 40;
+			constexpr size_t max_depth = sah_depth + 40;
+
+			// primitive box moved around by the build so every pass reads memory in order
+			template <typename T>
+			struct PrimRef
+			{
+				AABB<T> bounds;
+				uint32_t prim;
+
+				// twice the centroid, the factor cancels out in the binning
+				T centroid(int axis) const { return bounds.min[axis] + bounds.max[axis]; }
+			};
+
+			// plain min max accumulator, lighter than AABB::merge in the inner loops
+			template <typename T>
+			struct Box
+			{
+				T lo[3] = { std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max() };
+				T hi[3] = { std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest() };
+
+				void grow(T x, T y, T z)
+				{
+					lo[0] = x < lo[0] ? x : lo[0];
+					lo[1] = y < lo[1] ? y : lo[1];
+					lo[2] = z < lo[2] ? z : lo[2];
+					hi[0] = x > hi[0] ? x : hi[0];
+					hi[1] = y > hi[1] ? y : hi[1];
+					hi[2] = z > hi[2] ? z : hi[2];
+				}
+				void grow(const AABB<T>& b)
+				{
+					lo[0] = b.min.x < lo[0] ? b.min.x : lo[0];
+					lo[1] = b.min.y < lo[1] ? b.min.y : lo[1];
+					lo[2] = b.min.z < lo[2] ? b.min.z : lo[2];
+					hi[0] = b.max.x > hi[0] ? b.max.x : hi[0];
+					hi[1] = b.max.y > hi[1] ? b.max.y : hi[1];
+					hi[2] = b.max.z > hi[2] ? b.max.z : hi[2];
+				}
+				void grow(const Box& b)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						lo[k] = b.lo[k] < lo[k] ? b.lo[k] : lo[k];
+						hi[k] = b.hi[k] > hi[k] ? b.hi[k] : hi[k];
+					}
+				}
+				T half_area() const
+				{
+					const T x = hi[0] - lo[0];
+					const T y = hi[1] - lo[1];
+					const T z = hi[2] - lo[2];
+					return x * y + y * z + z * x;
+				}
+				AABB<T> aabb() const { return AABB<T>{ Vector3<T>{ lo[0], lo[1], lo[2] }, Vector3<T>{ hi[0], hi[1], hi[2] } }; }
+			};
+
+			template <typename T>
+			struct Bin
+			{
+				Box<T> bounds;
+				size_t count = 0;
+			};
+
+			template <typename T>
+			struct Builder
+			{
+				PrimRef<T>* refs;
+				size_t leaf_size;
+
+				struct Range
+				{
+					Box<T> bounds;
+					Box<T> centroids;
+				};
+				struct Split
+				{
+					int axis = -1;
+					size_t bin = 0;
+					T cost = std::numeric_limits<T>::max();
+				};
+
+				Range measure(size_t begin, size_t end, bool threaded) const
+				{
+					Range r;
+					const auto fn = [&](size_t first, size_t last, Range& out)
+					{
+						for (size_t i = first; i < last; ++i)
+						{
+							const PrimRef<T>& ref = refs[i];
+							out.bounds.grow(ref.bounds);
+							out.centroids.grow(ref.centroid(0), ref.centroid(1), ref.centroid(2));
+						}
+					};
+					if (!threaded || end - begin < parallel_bins)
+					{
+						fn(begin, end, r);
+						return r;
+					}
+					std::mutex lock;
+					parallel::for_range(begin, end, parallel_bins, [&](size_t first, size_t last)
+						{
+							Range local;
+							fn(first, last, local);
+							std::lock_guard<std::mutex> guard(lock);
+							r.bounds.grow(local.bounds);
+							r.centroids.grow(local.centroids);
+						});
+					return r;
+				}
+
+				static size_t bin_of(T c, T lo, T scale)
+				{
+					const T b = (c - lo) * scale;
+					return b <= 0 ? 0 : min(static_cast<size_t>(b), bins - 1);
+				}
+
+				// cheapest binned sah split over all three axes, axis stays -1 when the centroids coincide
+				Split find_split(size_t begin, size_t end, const Range& range, bool threaded) const
+				{
+					Bin<T> all[3][bins];
+					T scale[3];
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						const T extent = range.centroids.hi[axis] - range.centroids.lo[axis];
+						scale[axis] = extent > 0 ? static_cast<T>(bins) / extent : static_cast<T>(0);
+					}
+
+					const auto fill = [&](size_t first, size_t last, Bin<T>(&out)[3][bins])
+					{
+						for (size_t i = first; i < last; ++i)
+						{
+							const PrimRef<T>& ref = refs[i];
+							for (int axis = 0; axis < 3; ++axis)
+							{
+								Bin<T>& bin = out[axis][bin_of(ref.centroid(axis), range.centroids.lo[axis], scale[axis])];
+								bin.bounds.grow(ref.bounds);
+								++bin.count;
+							}
+						}
+					};
+					if (!threaded || end - begin < parallel_bins)
+						fill(begin, end, all);
+					else
+					{
+						std::mutex lock;
+						parallel::for_range(begin, end, parallel_bins, [&](size_t first, size_t last)
+							{
+								Bin<T> local[3][bins];
+								fill(first, last, local);
+								std::lock_guard<std::mutex> guard(lock);
+								for (int axis = 0; axis < 3; ++axis)
+								{
+									for (size_t b = 0; b < bins; ++b)
+									{
+										all[axis][b].bounds.grow(local[axis][b].bounds);
+										all[axis][b].count += local[axis][b].count;
+									}
+								}
+							});
+					}
+
+					Split best;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						if (scale[axis] == 0)
+							continue;
+
+						// right to left sweep stores the right side cost of every plane
+						T right_cost[bins];
+						Box<T> acc;
+						size_t count = 0;
+						for (size_t b = bins - 1; b > 0; --b)
+						{
+							acc.grow(all[axis][b].bounds);
+							count += all[axis][b].count;
+							right_cost[b] = count ? acc.half_area() * static_cast<T>(count) : static_cast<T>(0);
+						}
+
+						acc = Box<T>{};
+						count = 0;
+						for (size_t b = 0; b + 1 < bins; ++b)
+						{
+							acc.grow(all[axis][b].bounds);
+							count += all[axis][b].count;
+							if (count == 0 || count == end - begin)
+								continue;
+							const T cost = acc.half_area() * static_cast<T>(count) + right_cost[b + 1];
+							if (cost < best.cost)
+							{
+								best.axis = axis;
+								best.bin = b + 1;
+								best.cost = cost;
+							}
+						}
+					}
+					if (best.axis >= 0)
+						best.cost = best.cost / range.bounds.half_area();
+					return best;
+				}
+
+				// partitions the range and returns the first slot of the right side
+				size_t partition(size_t begin, size_t end, const Range& range, const Split& split, size_t depth, bool& leaf) const
+				{
+					const size_t count = end - begin;
+					leaf = false;
+					if (count <= leaf_size)
+					{
+						// leaf unless a split is cheaper than testing every primitive, traversal costs one test
+						if (split.axis < 0 || static_cast<T>(1) + split.cost >= static_cast<T>(count))
+						{
+							leaf = true;
+							return end;
+						}
+					}
+
+					if (split.axis >= 0 && depth < sah_depth)
+					{
+						const int axis = split.axis;
+						const T lo = range.centroids.lo[axis];
+						const T scale = static_cast<T>(bins) / (range.centroids.hi[axis] - lo);
+						PrimRef<T>* mid = std::partition(refs + begin, refs + end, [&](const PrimRef<T>& ref)
+							{
+								return bin_of(ref.centroid(axis), lo, scale) < split.bin;
+							});
+						return static_cast<size_t>(mid - refs);
+					}
+
+					// object median on the widest centroid axis
+					const T ex = range.centroids.hi[0] - range.centroids.lo[0];
+					const T ey = range.centroids.hi[1] - range.centroids.lo[1];
+					const T ez = range.centroids.hi[2] - range.centroids.lo[2];
+					const int axis = ex >= ey && ex >= ez ? 0 : (ey >= ez ? 1 : 2);
+					const size_t mid = begin + count / 2;
+					std::nth_element(refs + begin, refs + mid, refs + end, [&](const PrimRef<T>& a, const PrimRef<T>& b)
+						{
+							return a.centroid(axis) < b.centroid(axis);
+						});
+					return mid;
+				}
+
+				void build(size_t begin, size_t end, size_t depth, std::vector<BvhNode<T>>& out) const
+				{
+					const Range range = measure(begin, end, false);
+					const size_t self = out.size();
+					out.push_back(BvhNode<T>{ range.bounds.aabb(), static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin) });
+					if (end - begin <= 1)
+						return;
+
+					bool leaf;
+					const size_t mid = partition(begin, end, range, find_split(begin, end, range, false), depth, leaf);
+					if (leaf)
+						return;
+
+					out[self].count = 0;
+					build(begin, mid, depth + 1, out);
+					out[self].index = static_cast<uint32_t>(out.size());
+					build(mid, end, depth + 1, out);
+				}
+			};
+		}
+	}
+
+	// bounding volume hierarchy over primitive boxes, built with binned sah
+	// queries call back with the primitive index into the span given to build
+	template <typename T>
+	class Bvh
+	{
+	public:
+		using Scalar = T;
+		using Node = BvhNode<T>;
+		using index_type = uint32_t;
+
+		static constexpr index_type npos = static_cast<index_type>(-1);
+
+		struct Hit
+		{
+			index_type prim = npos;
+			Scalar distance2 = std::numeric_limits<Scalar>::max();
+		};
+
+	private:
+		std::vector<Node> nodes;
+		std::vector<index_type> order;	// slot -> primitive
+		std::vector<AABB<T>> boxes;		// primitive boxes in slot order
+
+		// top of a threaded build, children index top or tasks
+		struct Task
+		{
+			size_t begin, end, depth;
+		};
+		struct TopNode
+		{
+			AABB<T> bounds;
+			size_t left, right;
+			bool left_task, right_task;
+		};
+
+		size_t build_top(const detail::bvh::Builder<T>& builder, size_t begin, size_t end, size_t depth, size_t task_size,
+			std::vector<TopNode>& top, std::vector<Task>& tasks);
+		void flatten(const std::vector<TopNode>& top, size_t index, const std::vector<std::vector<Node>>& built);
+
+		template <typename Fn>
+		index_type raycast_slots(Ray<T>& ray, Fn&& fn) const;
+		template <typename Fn>
+		Hit nearest_slots(const Vector3<T>& p, Scalar max_distance2, Fn&& fn) const;
+
+	public:
+		size_t size() const { return order.size(); }
+		bool empty() const { return order.empty(); }
+		size_t node_count() const { return nodes.size(); }
+		const Node& node(size_t i) const { return nodes[i]; }
+		index_type primitive(size_t slot) const { return order[slot]; }
+		AABB<T> bounds() const { return nodes.empty() ? AABB<T>{} : nodes[0].bounds; }
+		void clear();
+
+		// leaves hold at most leaf_size primitives, large inputs build on all threads
+		void build(span<const AABB<T>> prim_bounds, size_t leaf_size = 4);
+		// keeps the tree and recomputes every box bottom up, for moving primitives
+		void refit(span<const AABB<T>> prim_bounds);
+
+		// fn(prim) for every primitive whose box overlaps box
+		template <typename Fn>
+		void query(const AABB<T>& box, Fn&& fn) const;
+		// fn(prim, ray) tests a primitive and on a hit shortens ray.t_max and returns true
+		// returns the closest primitive hit or npos, ray.t_max is left at its distance
+		template <typename Fn>
+		index_type raycast(Ray<T>& ray, Fn&& fn) const;
+		// stops at the first hit fn reports
+		template <typename Fn>
+		bool occluded(const Ray<T>& ray, Fn&& fn) const;
+		// fn(prim, p) returns the squared distance from p to the primitive
+		template <typename Fn>
+		Hit nearest(const Vector3<T>& p, Fn&& fn, Scalar max_distance2 = std::numeric_limits<Scalar>::max()) const;
+		// distance to the primitive boxes, exact for points stored as zero size boxes
+		Hit nearest(const Vector3<T>& p, Scalar max_distance2 = std::numeric_limits<Scalar>::max()) const;
+
+		// batched versions spread across threads, fn is called concurrently
+		template <typename Fn>
+		void query(span<const AABB<T>> queries, Fn&& fn) const; // fn(query, prim)
+		template <typename Fn>
+		void raycast(span<Ray<T>> rays, span<index_type> hits, Fn&& fn) const;
+		template <typename Fn>
+		void nearest(span<const Vector3<T>> points, span<Hit> hits, Fn&& fn) const;
+		void nearest(span<const Vector3<T>> points, span<Hit> hits) const;
+	};
+
+	// typedefs
+	using bvhf = Bvh<float>;
+	using bvh = Bvh<defaultType>;
+
+	// member functions
+	template <typename T>
+	void Bvh<T>::clear()
+	{
+		nodes.clear();
+		order.clear();
+		boxes.clear();
+	}
+
+	template <typename T>
+	size_t Bvh<T>::build_top(const detail::bvh::Builder<T>& builder, size_t begin, size_t end, size_t depth, size_t task_size,
+		std::vector<TopNode>& top, std::vector<Task>& tasks)
+	{
+		const auto range = builder.measure(begin, end, true);
+		bool leaf;
+		const size_t mid = builder.partition(begin, end, range, builder.find_split(begin, end, range, true), depth, leaf);
+
+		const size_t self = top.size();
+		top.push_back(TopNode{ range.bounds.aabb(), 0, 0, false, false });
+
+		// ranges this large never become leaves, so only the children need checking
+		if (mid - begin <= task_size)
+		{
+			top[self].left = tasks.size();
+			top[self].left_task = true;
+			tasks.push_back(Task{ begin, mid, depth + 1 });
+		}
+		else
+			top[self].left = build_top(builder, begin, mid, depth + 1, task_size, top, tasks);
+
+		if (end - mid <= task_size)
+		{
+			top[self].right = tasks.size();
+			top[self].right_task = true;
+			tasks.push_back(Task{ mid, end, depth + 1 });
+		}
+		else
+			top[self].right = build_top(builder, mid, end, depth + 1, task_size, top, tasks);
+		return self;
+	}
+	template <typename T>
+	void Bvh<T>::flatten(const std::vector<TopNode>& top, size_t index, const std::vector<std::vector<Node>>& built)
+	{
+		const auto emit = [&](size_t child, bool task)
+		{
+			if (!task)
+			{
+				flatten(top, child, built);
+				return;
+			}
+			const uint32_t base = static_cast<uint32_t>(nodes.size());
+			for (Node n : built[child])
+			{
+				if (!n.is_leaf())
+					n.index += base;
+				nodes.push_back(n);
+			}
+		};
+
+		const size_t self = nodes.size();
+		nodes.push_back(Node{ top[index].bounds, 0, 0 });
+		emit(top[index].left, top[index].left_task);
+		nodes[self].index = static_cast<uint32_t>(nodes.size());
+		emit(top[index].right, top[index].right_task);
+	}
+
+	template <typename T>
+	void Bvh<T>::build(span<const AABB<T>> prim_bounds, size_t leaf_size)
+	{
+		clear();
+		const size_t n = prim_bounds.size();
+		if (n == 0)
+			return;
+
+		std::vector<detail::bvh::PrimRef<T>> refs(n);
+		parallel::for_range(0, n, detail::bvh::parallel_bins, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					refs[i] = detail::bvh::PrimRef<T>{ prim_bounds[i], static_cast<uint32_t>(i) };
+			});
+
+		const detail::bvh::Builder<T> builder{ refs.data(), leaf_size ? leaf_size : 1 };
+
+		// the top levels split with threaded binning until the subtrees are small enough to hand out whole
+		// task_size stays at or above leaf_size, build_top relies on its ranges never becoming leaves
+		const size_t threads = parallel::thread_count();
+		const size_t task_size = max(max(n / (threads * 8), detail::bvh::parallel_bins), builder.leaf_size);
+		if (threads == 1 || n <= task_size)
+		{
+			nodes.reserve(2 * n / builder.leaf_size + 1);
+			builder.build(0, n, 0, nodes);
+		}
+		else
+		{
+			std::vector<TopNode> top;
+			std::vector<Task> tasks;
+			build_top(builder, 0, n, 0, task_size, top, tasks);
+
+			std::vector<std::vector<Node>> built(tasks.size());
+			parallel::for_range(0, tasks.size(), 1, [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+						builder.build(tasks[i].begin, tasks[i].end, tasks[i].depth, built[i]);
+				});
+
+			size_t total = top.size();
+			for (const auto& b : built)
+				total += b.size();
+			nodes.reserve(total);
+			flatten(top, 0, built);
+		}
+
+		order.resize(n);
+		boxes.resize(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			order[i] = refs[i].prim;
+			boxes[i] = refs[i].bounds;
+		}
+	}
+
+	template <typename T>
+	void Bvh<T>::refit(span<const AABB<T>> prim_bounds)
+	{
+		for (size_t i = 0; i < order.size(); ++i)
+			boxes[i] = prim_bounds[order[i]];
+
+		// children always come after their parent
+		for (size_t i = nodes.size(); i-- > 0;)
+		{
+			Node& n = nodes[i];
+			if (n.is_leaf())
+			{
+				n.bounds = AABB<T>{};
+				for (size_t s = n.index; s < n.index + n.count; ++s)
+					n.bounds.merge(boxes[s]);
+			}
+			else
+				n.bounds = AABB<T>{ nodes[i + 1].bounds }.merge(nodes[n.index].bounds);
+		}
+	}
+
+	template <typename T>
+	template <typename Fn>
+	void Bvh<T>::query(const AABB<T>& box, Fn&& fn) const
+	{
+		if (nodes.empty())
+			return;
+
+		uint32_t stack[detail::bvh::max_depth];
+		size_t top = 0;
+		uint32_t i = 0;
+		for (;;)
+		{
+			const Node& n = nodes[i];
+			if (n.bounds.intersects(box))
+			{
+				if (n.is_leaf())
+				{
+					for (size_t s = n.index; s < n.index + n.count; ++s)
+					{
+						if (boxes[s].intersects(box))
+							fn(order[s]);
+					}
+				}
+				else
+				{
+					stack[top++] = n.index;
+					i = i + 1;
+					continue;
+				}
+			}
+			if (top == 0)
+				return;
+			i = stack[--top];
+		}
+	}
+
+	template <typename T>
+	template <typename Fn>
+	typename Bvh<T>::index_type Bvh<T>::raycast_slots(Ray<T>& ray, Fn&& fn) const
+	{
+		index_type best = npos;
+		T t;
+		if (nodes.empty() || !intersect(ray, nodes[0].bounds, t))
+			return best;
+
+		const Vector3<T> inv = ray.inv_direction();
+		struct Entry
+		{
+			uint32_t node;
+			T t;
+		};
+		Entry stack[detail::bvh::max_depth];
+		size_t top = 0;
+		uint32_t i = 0;
+		for (;;)
+		{
+			const Node& n = nodes[i];
+			if (n.is_leaf())
+			{
+				for (size_t s = n.index; s < n.index + n.count; ++s)
+				{
+					if (fn(static_cast<index_type>(s), ray))
+						best = static_cast<index_type>(s);
+				}
+			}
+			else
+			{
+				// nearer child first, the other waits with its entry distance
+				T tl, tr;
+				const bool hl = intersect(ray, inv, nodes[i + 1].bounds, tl);
+				const bool hr = intersect(ray, inv, nodes[n.index].bounds, tr);
+				if (hl && hr)
+				{
+					if (tr < tl)
+					{
+						stack[top++] = Entry{ i + 1, tl };
+						i = n.index;
+					}
+					else
+					{
+						stack[top++] = Entry{ n.index, tr };
+						i = i + 1;
+					}
+					continue;
+				}
+				if (hl || hr)
+				{
+					i = hl ? i + 1 : n.index;
+					continue;
+				}
+			}
+
+			// skip entries the closest hit so far already passed
+			for (;;)
+			{
+				if (top == 0)
+					return best;
+				const Entry e = stack[--top];
+				if (e.t <= ray.t_max)
+				{
+					i = e.node;
+					break;
+				}
+			}
+		}
+	}
+	template <typename T>
+	template <typename Fn>
+	typename Bvh<T>::index_type Bvh<T>::raycast(Ray<T>& ray, Fn&& fn) const
+	{
+		const index_type slot = raycast_slots(ray, [&](index_type s, Ray<T>& r) { return fn(order[s], r); });
+		return slot == npos ? npos : order[slot];
+	}
+	template <typename T>
+	template <typename Fn>
+	bool Bvh<T>::occluded(const Ray<T>& ray, Fn&& fn) const
+	{
+		// a hit ends the search by collapsing the ray
+		Ray<T> r = ray;
+		bool hit = false;
+		raycast_slots(r, [&](index_type s, Ray<T>& q)
+			{
+				if (hit || !fn(order[s], q))
+					return false;
+				hit = true;
+				q.t_max = q.t_min - 1;
+				return true;
+			});
+		return hit;
+	}
+
+	template <typename T>
+	template <typename Fn>
+	typename Bvh<T>::Hit Bvh<T>::nearest_slots(const Vector3<T>& p, Scalar max_distance2, Fn&& fn) const
+	{
+		Hit best;
+		best.distance2 = max_distance2;
+		if (nodes.empty())
+			return best;
+
+		struct Entry
+		{
+			uint32_t node;
+			T d2;
+		};
+		Entry stack[detail::bvh::max_depth];
+		size_t top = 0;
+		stack[top++] = Entry{ 0, nodes[0].bounds.distance2(p) };
+		while (top)
+		{
+			const Entry e = stack[--top];
+			if (e.d2 > best.distance2)
+				continue;
+
+			uint32_t i = e.node;
+			for (;;)
+			{
+				const Node& n = nodes[i];
+				if (n.is_leaf())
+				{
+					for (size_t s = n.index; s < n.index + n.count; ++s)
+					{
+						const T d2 = fn(static_cast<index_type>(s), p);
+						if (d2 < best.distance2)
+						{
+							best.distance2 = d2;
+							best.prim = static_cast<index_type>(s);
+						}
+					}
+					break;
+				}
+
+				// descend into the nearer child, the farther one waits
+				const T dl = nodes[i + 1].bounds.distance2(p);
+				const T dr = nodes[n.index].bounds.distance2(p);
+				const uint32_t near_child = dl <= dr ? i + 1 : n.index;
+				const uint32_t far_child = dl <= dr ? n.index : i + 1;
+				const T near_d2 = dl <= dr ? dl : dr;
+				const T far_d2 = dl <= dr ? dr : dl;
+				if (far_d2 <= best.distance2)
+					stack[top++] = Entry{ far_child, far_d2 };
+				if (near_d2 > best.distance2)
+					break;
+				i = near_child;
+			}
+		}
+		return best;
+	}
+	template <typename T>
+	template <typename Fn>
+	typename Bvh<T>::Hit Bvh<T>::nearest(const Vector3<T>& p, Fn&& fn, Scalar max_distance2) const
+	{
+		Hit h = nearest_slots(p, max_distance2, [&](index_type s, const Vector3<T>& q) { return fn(order[s], q); });
+		if (h.prim != npos)
+			h.prim = order[h.prim];
+		return h;
+	}
+	template <typename T>
+	typename Bvh<T>::Hit Bvh<T>::nearest(const Vector3<T>& p, Scalar max_distance2) const
+	{
+		Hit h = nearest_slots(p, max_distance2, [&](index_type s, const Vector3<T>& q) { return boxes[s].distance2(q); });
+		if (h.prim != npos)
+			h.prim = order[h.prim];
+		return h;
+	}
+
+	template <typename T>
+	template <typename Fn>
+	void Bvh<T>::query(span<const AABB<T>> queries, Fn&& fn) const
+	{
+		parallel::for_range(0, queries.size(), bvh_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t q = first; q < last; ++q)
+					query(queries[q], [&](index_type prim) { fn(q, prim); });
+			});
+	}
+	template <typename T>
+	template <typename Fn>
+	void Bvh<T>::raycast(span<Ray<T>> rays, span<index_type> hits, Fn&& fn) const
+	{
+		parallel::for_range(0, rays.size(), bvh_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t r = first; r < last; ++r)
+					hits[r] = raycast(rays[r], fn);
+			});
+	}
+	template <typename T>
+	template <typename Fn>
+	void Bvh<T>::nearest(span<const Vector3<T>> points, span<Hit> hits, Fn&& fn) const
+	{
+		parallel::for_range(0, points.size(), bvh_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					hits[i] = nearest(points[i], fn);
+			});
+	}
+	template <typename T>
+	void Bvh<T>::nearest(span<const Vector3<T>> points, span<Hit> hits) const
+	{
+		parallel::for_range(0, points.size(), bvh_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					hits[i] = nearest(points[i]);
+			});
+	}
+
+} // namespace els
+
+#endif
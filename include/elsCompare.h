@@ -5,7 +5,7 @@
 
 namespace els
 {
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_zero(T val)
 	{
 		if constexpr (std::is_floating_point<T>::value)
@@ -15,16 +15,16 @@ namespace els
 	}
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
-		std::is_arithmetic<Ty>::value &&
-		std::is_arithmetic<Tx>::value >>
+		is_scalar<Ty>::value &&
+		is_scalar<Tx>::value >>
 	inline constexpr bool is_equal(Ty y, Tx x)
 	{
 		return is_zero(y - x);
 	}
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
-		std::is_arithmetic<Ty>::value &&
-		std::is_arithmetic<Tx>::value >>
+		is_scalar<Ty>::value &&
+		is_scalar<Tx>::value >>
 	inline constexpr bool is_not_equal(Ty y, Tx x)
 	{
 		return !is_equal(y, x);
@@ -49,42 +49,54 @@ namespace els
 		return !is_equal(lhs, rhs);
 	}
 
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_nan(T val)
 	{
 		if constexpr (std::is_floating_point<T>::value)
-			return ::isnan(val);
+			return is_constant_evaluated() ? val != val : std::isnan(val);
 		else
 			return false;
 	}
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_inf(T val)
 	{
 		if constexpr (std::is_floating_point<T>::value)
-			return ::isinf(val);
+			return is_constant_evaluated() ? detail::ce::is_inf(val) : std::isinf(val);
 		else
 			return false;
 	}
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_finite(T val)
 	{
 		if constexpr (std::is_floating_point<T>::value)
-			return ::isfinite(val);
+			return is_constant_evaluated() ? !(val != val) && !detail::ce::is_inf(val) : std::isfinite(val);
 		else
 			return true;
 	}
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_normal(T val)
 	{
 		if constexpr (std::is_floating_point<T>::value)
-			return ::isnormal(val);
+		{
+			if (is_constant_evaluated())
+				return !(val != val) && !detail::ce::is_inf(val) && detail::ce::abs(val) >= std::numeric_limits<T>::min();
+			return std::isnormal(val);
+		}
 		else
 			return true;
 	}
-	template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+	template <typename T, typename = std::enable_if_t<is_scalar<T>::value>>
 	inline constexpr bool is_negative(T val)
 	{
-		return ::signbit(val);
+		// -0 is only told apart from 0 at run time
+		if constexpr (std::is_floating_point<T>::value)
+		{
+			if (is_constant_evaluated())
+				return val < 0;
+			return std::signbit(val);
+		}
+		else
+			return val < 0;
 	}
 }
 
@@ -0,0 +1,714 @@
+#ifndef ELS_DYN_MATRIX
+#define ELS_DYN_MATRIX
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+#include "elsSolve.h"
+
+namespace els
+{
+	// elements per worker chunk for transpose and gemv
+	constexpr size_t dyn_matrix_grain = 1 << 14;
+
+	enum class StorageOrder : uint8_t
+	{
+		row_major,
+		col_major,
+	};
+
+	// non-owning window into a matrix, element (r, c) is data[r * row_stride + c * col_stride]
+	// blocks and transposes are views of the same elements, nothing is copied
+	template <typename T>
+	class DynMatrixView
+	{
+	public:
+		using Scalar = std::remove_const_t<T>;
+
+	private:
+		T* ptr = nullptr;
+		size_t r = 0;
+		size_t c = 0;
+		size_t rs = 0;
+		size_t cs = 0;
+
+	public:
+		constexpr DynMatrixView() = default;
+		constexpr DynMatrixView(T* data, size_t rows, size_t cols, size_t row_stride, size_t col_stride = 1)
+			: ptr{ data }, r{ rows }, c{ cols }, rs{ row_stride }, cs{ col_stride } {}
+		template <typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+		constexpr DynMatrixView(const DynMatrixView<U>& rhs)
+			: ptr{ rhs.data() }, r{ rhs.rows() }, c{ rhs.cols() }, rs{ rhs.row_stride() }, cs{ rhs.col_stride() } {}
+
+		constexpr T* data() const { return ptr; }
+		constexpr size_t rows() const { return r; }
+		constexpr size_t cols() const { return c; }
+		constexpr size_t row_stride() const { return rs; }
+		constexpr size_t col_stride() const { return cs; }
+		constexpr bool empty() const { return r == 0 || c == 0; }
+
+		constexpr T& operator()(size_t row, size_t col) const { return ptr[row * rs + col * cs]; }
+
+		constexpr DynMatrixView block(size_t row, size_t col, size_t rows, size_t cols) const
+		{
+			return DynMatrixView{ ptr + row * rs + col * cs, rows, cols, rs, cs };
+		}
+		constexpr DynMatrixView transposed() const { return DynMatrixView{ ptr, c, r, cs, rs }; }
+	};
+
+	namespace detail
+	{
+		namespace dyn
+		{
+			// rows and columns start on a cache line
+			constexpr size_t alignment = 64;
+
+			template <typename T>
+			struct aligned_allocator
+			{
+				using value_type = T;
+
+				aligned_allocator() = default;
+				template <typename U>
+				constexpr aligned_allocator(const aligned_allocator<U>&) {}
+
+				T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ alignment })); }
+				void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t{ alignment }); }
+
+				template <typename U>
+				constexpr bool operator==(const aligned_allocator<U>&) const { return true; }
+				template <typename U>
+				constexpr bool operator!=(const aligned_allocator<U>&) const { return false; }
+			};
+
+			// leading dimension rounded up to whole cache lines
+			template <typename T>
+			constexpr size_t padded(size_t n)
+			{
+				constexpr size_t line = alignment / sizeof(T) ? alignment / sizeof(T) : 1;
+				return (n + line - 1) / line * line;
+			}
+
+			// keeps T from being deduced from a view argument, so matrices convert to views
+			template <typename T>
+			struct identity
+			{
+				using type = T;
+			};
+			template <typename T>
+			using view_t = typename identity<DynMatrixView<T>>::type;
+		}
+	}
+
+	// dense matrix of runtime size, zero initialized, the leading dimension is padded to a cache line
+	template <typename T>
+	class DynMatrix
+	{
+	public:
+		using Scalar = T;
+
+	private:
+		std::vector<T, detail::dyn::aligned_allocator<T>> storage;
+		size_t r = 0;
+		size_t c = 0;
+		size_t ld = 0;
+		StorageOrder layout = StorageOrder::row_major;
+
+	public:
+		DynMatrix() = default;
+		DynMatrix(size_t rows, size_t cols, StorageOrder order = StorageOrder::row_major);
+		// copy of any view, in the given order
+		explicit DynMatrix(DynMatrixView<const T> rhs, StorageOrder order = StorageOrder::row_major);
+
+		size_t rows() const { return r; }
+		size_t cols() const { return c; }
+		// elements between consecutive rows (row-major) or columns (column-major)
+		size_t stride() const { return ld; }
+		StorageOrder order() const { return layout; }
+		bool empty() const { return r == 0 || c == 0; }
+
+		T* data() { return storage.data(); }
+		const T* data() const { return storage.data(); }
+
+		T& operator()(size_t row, size_t col) { return storage[layout == StorageOrder::row_major ? row * ld + col : col * ld + row]; }
+		const T& operator()(size_t row, size_t col) const { return storage[layout == StorageOrder::row_major ? row * ld + col : col * ld + row]; }
+
+		DynMatrixView<T> view();
+		DynMatrixView<const T> view() const;
+		operator DynMatrixView<T>() { return view(); }
+		operator DynMatrixView<const T>() const { return view(); }
+
+		DynMatrixView<T> block(size_t row, size_t col, size_t rows, size_t cols) { return view().block(row, col, rows, cols); }
+		DynMatrixView<const T> block(size_t row, size_t col, size_t rows, size_t cols) const { return view().block(row, col, rows, cols); }
+
+		// copy in the same order, view().transposed() is the free one
+		DynMatrix transposed() const;
+
+		DynMatrix& fill(const Scalar& s);
+		// ones on the diagonal, zero elsewhere
+		DynMatrix& identity();
+	};
+
+	// typedefs
+	using dyn_matf = DynMatrix<float>;
+	using dyn_matd = DynMatrix<double>;
+	using dyn_mat = DynMatrix<defaultType>;
+
+	namespace detail
+	{
+		namespace dyn
+		{
+			// register tiles are gemm_mr rows by table().nr columns, a gemm_kc deep slice of
+			// gemm_mc rows of a stays in l2 and the packed gemm_kc x gemm_nc panel of b in l3,
+			// one nr wide sliver of it in l1
+			constexpr size_t gemm_mr = 6;
+			constexpr size_t gemm_mc = 96;
+			constexpr size_t gemm_kc = 256;
+			constexpr size_t gemm_nc = 512;
+
+			template <typename T>
+			struct dyn_table
+			{
+				size_t nr;
+				void (*tile)(size_t, const T*, const T*, T*);
+				T (*dot)(const T*, const T*, size_t);
+				void (*axpy)(T, const T*, T*, size_t);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsDynMatrixKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsDynMatrixKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// plain loops for the other types, a gemm_mr x 4 tile
+			template <typename T>
+			inline void tile(size_t kc, const T* a, const T* b, T* out)
+			{
+				T c[gemm_mr][4] = {};
+				for (size_t k = 0; k < kc; ++k, a += gemm_mr, b += 4)
+				{
+					for (size_t i = 0; i < gemm_mr; ++i)
+					{
+						for (size_t j = 0; j < 4; ++j)
+							c[i][j] += a[i] * b[j];
+					}
+				}
+				for (size_t i = 0; i < gemm_mr; ++i)
+				{
+					for (size_t j = 0; j < 4; ++j)
+						out[4 * i + j] = c[i][j];
+				}
+			}
+			template <typename T>
+			inline T dot(const T* a, const T* x, size_t n)
+			{
+				T s = 0;
+				for (size_t i = 0; i < n; ++i)
+					s += a[i] * x[i];
+				return s;
+			}
+			template <typename T>
+			inline void axpy(T s, const T* x, T* y, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					y[i] += s * x[i];
+			}
+
+			// picked once on first use
+			template <typename T>
+			inline const dyn_table<T>& table()
+			{
+				if constexpr (std::is_same<T, float>::value)
+				{
+#if defined(ELS_SIMD_AVX2)
+					static const dyn_table<float> kernels = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+					static const dyn_table<float> kernels = x4::make_table();
+#endif
+					return kernels;
+				}
+				else
+				{
+					static const dyn_table<T> kernels{ 4, &tile<T>, &dot<T>, &axpy<T> };
+					return kernels;
+				}
+			}
+
+			// rows i0 + [0, mc) and columns k0 + [0, kc) of a in slivers of gemm_mr rows, k-major, zero padded
+			template <typename T>
+			inline void pack_a(const DynMatrixView<const T>& a, size_t i0, size_t mc, size_t k0, size_t kc, T* out)
+			{
+				for (size_t ir = 0; ir < mc; ir += gemm_mr)
+				{
+					const size_t rows = min(gemm_mr, mc - ir);
+					for (size_t k = 0; k < kc; ++k)
+					{
+						const T* src = &a(i0 + ir, k0 + k);
+						size_t i = 0;
+						for (; i < rows; ++i)
+							*out++ = src[i * a.row_stride()];
+						for (; i < gemm_mr; ++i)
+							*out++ = 0;
+					}
+				}
+			}
+			// rows k0 + [0, kc) and columns j0 + [0, nc) of b in slivers of nr columns, k-major, zero padded
+			template <typename T>
+			inline void pack_b(const DynMatrixView<const T>& b, size_t k0, size_t kc, size_t j0, size_t nc, size_t nr, T* out)
+			{
+				for (size_t jr = 0; jr < nc; jr += nr)
+				{
+					const size_t cols = min(nr, nc - jr);
+					for (size_t k = 0; k < kc; ++k)
+					{
+						const T* src = &b(k0 + k, j0 + jr);
+						size_t j = 0;
+						if (b.col_stride() == 1)
+						{
+							for (; j < cols; ++j)
+								*out++ = src[j];
+						}
+						else
+						{
+							for (; j < cols; ++j)
+								*out++ = src[j * b.col_stride()];
+						}
+						for (; j < nr; ++j)
+							*out++ = 0;
+					}
+				}
+			}
+		}
+	}
+
+	// c = alpha a b + beta c with a m x k, b k x n and c m x n, any strides, c must not overlap a or b
+	// returns false and leaves c untouched when the shapes disagree
+	// c is split in gemm_mc x gemm_nc tiles across threads, each packs its slices of a and b into
+	// contiguous panels that feed a register tile, 4 or 8 wide simd for float
+	// with beta == 0, c is not read
+	template <typename T>
+	bool gemm(T alpha, detail::dyn::view_t<const T> a, detail::dyn::view_t<const T> b, T beta, detail::dyn::view_t<T> c);
+
+	// y = alpha a x + beta y, x holds a.cols() and y a.rows() elements, threaded over rows
+	// with beta == 0, y is not read, returns false and leaves y untouched when the sizes disagree
+	template <typename T>
+	bool gemv(T alpha, detail::dyn::view_t<const T> a, span<const T> x, T beta, span<T> y);
+
+	// out(j, i) = in(i, j), out is in.cols() x in.rows(), in cache sized blocks across threads
+	// returns false and leaves out untouched when it has another shape
+	template <typename T>
+	bool transpose(detail::dyn::view_t<const T> in, detail::dyn::view_t<T> out);
+
+	// textbook product a b, row-major, zero when lhs.cols() != rhs.rows()
+	template <typename T>
+	inline DynMatrix<T> operator*(const DynMatrix<T>& lhs, const DynMatrix<T>& rhs)
+	{
+		DynMatrix<T> out(lhs.rows(), rhs.cols());
+		gemm(static_cast<T>(1), lhs, rhs, static_cast<T>(0), out);
+		return out;
+	}
+
+	// lu factorization with partial pivoting of a square DynMatrix, blocked so that most of the
+	// work is the gemm update of the trailing matrix, see LU<Matrix> for the fixed sizes
+	// a pivot at or below tolerance times the largest entry marks the matrix singular, ok() is false
+	// and solve and inverse return zero, a matrix that is not square is singular too
+	// the tolerance defaults to n epsilon like the fixed sizes
+	template <typename T>
+	class LU<DynMatrix<T>>
+	{
+	public:
+		using Scalar = T;
+
+		// columns per panel, the panel is factored with plain loops
+		static constexpr size_t block = 64;
+
+	private:
+		DynMatrix<T> lu;			// unit lower l below the diagonal, u on and above it, row-major
+		std::vector<size_t> perm;	// row r of lu comes from row perm[r] of the input
+		bool odd = false;
+		bool singular = false;
+
+	public:
+		explicit LU(const DynMatrix<T>& m) : LU(m, detail::solve::solve_tolerance<Scalar>(static_cast<unsigned int>(m.rows()))) {}
+		LU(const DynMatrix<T>& m, Scalar tolerance);
+
+		size_t size() const { return lu.rows(); }
+		bool ok() const { return !singular; }
+		// can overflow for large matrices
+		Scalar det() const;
+
+		// b and x hold size() elements and may alias, false and x untouched when one is shorter
+		bool solve(span<const T> b, span<T> x) const;
+		// one solve per column of b, zero when b.rows() != size()
+		DynMatrix<T> solve(const DynMatrix<T>& b) const;
+		DynMatrix<T> inverse() const;
+	};
+
+	// member functions
+	template <typename T>
+	DynMatrix<T>::DynMatrix(size_t rows, size_t cols, StorageOrder order)
+		: r{ rows }, c{ cols }, ld{ detail::dyn::padded<T>(order == StorageOrder::row_major ? cols : rows) }, layout{ order }
+	{
+		storage.assign(ld * (order == StorageOrder::row_major ? rows : cols), static_cast<T>(0));
+	}
+	template <typename T>
+	DynMatrix<T>::DynMatrix(DynMatrixView<const T> rhs, StorageOrder order)
+		: DynMatrix(rhs.rows(), rhs.cols(), order)
+	{
+		const DynMatrixView<T> v = view();
+		for (size_t i = 0; i < r; ++i)
+		{
+			for (size_t j = 0; j < c; ++j)
+				v(i, j) = rhs(i, j);
+		}
+	}
+	template <typename T>
+	DynMatrixView<T> DynMatrix<T>::view()
+	{
+		return layout == StorageOrder::row_major ? DynMatrixView<T>{ storage.data(), r, c, ld, 1 } : DynMatrixView<T>{ storage.data(), r, c, 1, ld };
+	}
+	template <typename T>
+	DynMatrixView<const T> DynMatrix<T>::view() const
+	{
+		return layout == StorageOrder::row_major ? DynMatrixView<const T>{ storage.data(), r, c, ld, 1 } : DynMatrixView<const T>{ storage.data(), r, c, 1, ld };
+	}
+	template <typename T>
+	DynMatrix<T> DynMatrix<T>::transposed() const
+	{
+		DynMatrix<T> out(c, r, layout);
+		transpose<T>(view(), out);
+		return out;
+	}
+	template <typename T>
+	DynMatrix<T>& DynMatrix<T>::fill(const Scalar& s)
+	{
+		const DynMatrixView<T> v = view();
+		for (size_t i = 0; i < r; ++i)
+		{
+			for (size_t j = 0; j < c; ++j)
+				v(i, j) = s;
+		}
+		return *this;
+	}
+	template <typename T>
+	DynMatrix<T>& DynMatrix<T>::identity()
+	{
+		fill(static_cast<T>(0));
+		for (size_t i = 0; i < min(r, c); ++i)
+			(*this)(i, i) = static_cast<T>(1);
+		return *this;
+	}
+
+	// static functions
+	template <typename T>
+	bool gemm(T alpha, detail::dyn::view_t<const T> a, detail::dyn::view_t<const T> b, T beta, detail::dyn::view_t<T> c)
+	{
+		using namespace detail::dyn;
+
+		const size_t m = c.rows(), n = c.cols(), depth = a.cols();
+		if (a.rows() != m || b.rows() != depth || b.cols() != n)
+			return false;
+		if (m == 0 || n == 0)
+			return true;
+		if (depth == 0 || alpha == 0)
+		{
+			parallel::for_range(0, m, max<size_t>(1, dyn_matrix_grain / n), [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+					{
+						for (size_t j = 0; j < n; ++j)
+							c(i, j) = beta == 0 ? static_cast<T>(0) : beta * c(i, j);
+					}
+				});
+			return true;
+		}
+
+		const dyn_table<T>& kernels = table<T>();
+		const size_t nr = kernels.nr;
+		const size_t mt = (m + gemm_mc - 1) / gemm_mc;
+		const size_t nt = (n + gemm_nc - 1) / gemm_nc;
+
+		// tile t covers rows (t % mt) * gemm_mc and columns (t / mt) * gemm_nc, a run of tiles
+		// with the same columns shares every packed panel of b
+		parallel::for_range(0, mt * nt, 1, [&](size_t first, size_t last)
+			{
+				std::vector<T> pa(gemm_mc * gemm_kc);
+				std::vector<T> pb(gemm_kc * ((gemm_nc + nr - 1) / nr * nr));
+				std::vector<T> out(gemm_mr * nr);
+
+				for (size_t t = first; t < last;)
+				{
+					const size_t jt = t / mt;
+					const size_t run = min(last, (jt + 1) * mt);
+					const size_t j0 = jt * gemm_nc, nc = min(gemm_nc, n - j0);
+					for (size_t k0 = 0; k0 < depth; k0 += gemm_kc)
+					{
+						const size_t kc = min(gemm_kc, depth - k0);
+						const bool fresh = k0 == 0;
+						pack_b(b, k0, kc, j0, nc, nr, pb.data());
+						for (size_t u = t; u < run; ++u)
+						{
+							const size_t i0 = (u % mt) * gemm_mc, mc = min(gemm_mc, m - i0);
+							pack_a(a, i0, mc, k0, kc, pa.data());
+							for (size_t jr = 0; jr < nc; jr += nr)
+							{
+								const size_t cols = min(nr, nc - jr);
+								for (size_t ir = 0; ir < mc; ir += gemm_mr)
+								{
+									const size_t rows = min(gemm_mr, mc - ir);
+									kernels.tile(kc, pa.data() + ir * kc, pb.data() + jr * kc, out.data());
+									for (size_t i = 0; i < rows; ++i)
+									{
+										T* dst = &c(i0 + ir + i, j0 + jr);
+										const T* src = out.data() + i * nr;
+										for (size_t j = 0; j < cols; ++j)
+										{
+											T& e = dst[j * c.col_stride()];
+											if (!fresh)
+												e += alpha * src[j];
+											else
+												e = beta == 0 ? alpha * src[j] : alpha * src[j] + beta * e;
+										}
+									}
+								}
+							}
+						}
+					}
+					t = run;
+				}
+			});
+		return true;
+	}
+
+	template <typename T>
+	bool gemv(T alpha, detail::dyn::view_t<const T> a, span<const T> x, T beta, span<T> y)
+	{
+		const detail::dyn::dyn_table<T>& kernels = detail::dyn::table<T>();
+		const size_t m = a.rows(), n = a.cols();
+		if (x.size() != n || y.size() != m)
+			return false;
+		const size_t grain = max<size_t>(1, dyn_matrix_grain / max<size_t>(n, 1));
+		parallel::for_range(0, m, grain, [&](size_t first, size_t last)
+			{
+				if (a.col_stride() == 1)
+				{
+					// contiguous rows, one dot product each
+					for (size_t i = first; i < last; ++i)
+					{
+						const T s = alpha * kernels.dot(&a(i, 0), x.data(), n);
+						y[i] = beta == 0 ? s : s + beta * y[i];
+					}
+					return;
+				}
+
+				for (size_t i = first; i < last; ++i)
+					y[i] = beta == 0 ? static_cast<T>(0) : beta * y[i];
+				if (a.row_stride() == 1)
+				{
+					// contiguous columns, y gets one axpy per column
+					for (size_t j = 0; j < n; ++j)
+						kernels.axpy(alpha * x[j], &a(first, j), y.data() + first, last - first);
+					return;
+				}
+				for (size_t i = first; i < last; ++i)
+				{
+					T s = 0;
+					for (size_t j = 0; j < n; ++j)
+						s += a(i, j) * x[j];
+					y[i] += alpha * s;
+				}
+			});
+		return true;
+	}
+
+	template <typename T>
+	bool transpose(detail::dyn::view_t<const T> in, detail::dyn::view_t<T> out)
+	{
+		// square blocks so that neither side walks a whole column
+		constexpr size_t tile = 32;
+		const size_t m = in.rows(), n = in.cols();
+		if (out.rows() != n || out.cols() != m)
+			return false;
+		const size_t blocks = (m + tile - 1) / tile;
+		parallel::for_range(0, blocks, max<size_t>(1, dyn_matrix_grain / (tile * max<size_t>(n, 1))), [&](size_t first, size_t last)
+			{
+				for (size_t bi = first; bi < last; ++bi)
+				{
+					const size_t i0 = bi * tile, i1 = min(m, i0 + tile);
+					for (size_t j0 = 0; j0 < n; j0 += tile)
+					{
+						const size_t j1 = min(n, j0 + tile);
+						for (size_t i = i0; i < i1; ++i)
+						{
+							for (size_t j = j0; j < j1; ++j)
+								out(j, i) = in(i, j);
+						}
+					}
+				}
+			});
+		return true;
+	}
+
+	template <typename T>
+	LU<DynMatrix<T>>::LU(const DynMatrix<T>& m, Scalar tolerance)
+		: lu(m.view())
+	{
+		if (m.rows() != m.cols())
+		{
+			singular = true;
+			return;
+		}
+		const detail::dyn::dyn_table<T>& kernels = detail::dyn::table<T>();
+		const size_t n = lu.rows(), ld = lu.stride();
+		T* a = lu.data();
+		perm.resize(n);
+		for (size_t i = 0; i < n; ++i)
+			perm[i] = i;
+
+		Scalar largest = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			for (size_t j = 0; j < n; ++j)
+				largest = max(largest, abs(a[i * ld + j]));
+		}
+		const Scalar limit = tolerance * largest;
+
+		for (size_t k0 = 0; k0 < n; k0 += block)
+		{
+			const size_t k1 = min(n, k0 + block);
+
+			// the panel, whole rows are swapped so l and the trailing columns follow the pivots
+			for (size_t j = k0; j < k1; ++j)
+			{
+				size_t p = j;
+				for (size_t i = j + 1; i < n; ++i)
+				{
+					if (abs(a[i * ld + j]) > abs(a[p * ld + j]))
+						p = i;
+				}
+				if (p != j)
+				{
+					std::swap_ranges(a + j * ld, a + j * ld + n, a + p * ld);
+					std::swap(perm[j], perm[p]);
+					odd = !odd;
+				}
+				if (abs(a[j * ld + j]) <= limit)
+				{
+					singular = true;
+					return;
+				}
+
+				const Scalar inv = 1 / a[j * ld + j];
+				for (size_t i = j + 1; i < n; ++i)
+				{
+					T* row = a + i * ld;
+					const Scalar f = row[j] * inv;
+					row[j] = f;
+					for (size_t c = j + 1; c < k1; ++c)
+						row[c] -= f * a[j * ld + c];
+				}
+			}
+			if (k1 == n)
+				break;
+
+			// u12 = l11^-1 a12, split by columns across threads
+			parallel::for_range(k1, n, max<size_t>(64, dyn_matrix_grain / block), [&](size_t first, size_t last)
+				{
+					for (size_t r = k0 + 1; r < k1; ++r)
+					{
+						for (size_t q = k0; q < r; ++q)
+							kernels.axpy(-a[r * ld + q], a + q * ld + first, a + r * ld + first, last - first);
+					}
+				});
+
+			// a22 -= l21 u12
+			const DynMatrixView<T> v = lu.view();
+			gemm(static_cast<T>(-1), v.block(k1, k0, n - k1, k1 - k0), v.block(k0, k1, k1 - k0, n - k1), static_cast<T>(1), v.block(k1, k1, n - k1, n - k1));
+		}
+	}
+	template <typename T>
+	T LU<DynMatrix<T>>::det() const
+	{
+		if (singular)
+			return 0;
+		Scalar d = odd ? -1 : 1;
+		for (size_t k = 0; k < lu.rows(); ++k)
+			d *= lu(k, k);
+		return d;
+	}
+	template <typename T>
+	bool LU<DynMatrix<T>>::solve(span<const T> b, span<T> x) const
+	{
+		const size_t n = lu.rows();
+		if (b.size() < n || x.size() < n)
+			return false;
+		if (singular)
+		{
+			std::fill(x.begin(), x.begin() + n, static_cast<T>(0));
+			return true;
+		}
+
+		// l y = p b then u x = y
+		const detail::dyn::dyn_table<T>& kernels = detail::dyn::table<T>();
+		std::vector<T> y(n);
+		for (size_t i = 0; i < n; ++i)
+			y[i] = b[perm[i]];
+		for (size_t i = 1; i < n; ++i)
+			y[i] -= kernels.dot(&lu(i, 0), y.data(), i);
+		for (size_t i = n; i-- > 0;)
+			y[i] = (y[i] - kernels.dot(&lu(i, i) + 1, y.data() + i + 1, n - i - 1)) / lu(i, i);
+		std::copy(y.begin(), y.end(), x.begin());
+		return true;
+	}
+	template <typename T>
+	DynMatrix<T> LU<DynMatrix<T>>::solve(const DynMatrix<T>& b) const
+	{
+		const size_t n = lu.rows();
+		DynMatrix<T> x(n, b.cols(), b.order());
+		if (b.rows() != n || singular)
+			return x;
+		std::vector<T> column(n);
+		for (size_t j = 0; j < b.cols(); ++j)
+		{
+			for (size_t i = 0; i < n; ++i)
+				column[i] = b(i, j);
+			solve(column, column);
+			for (size_t i = 0; i < n; ++i)
+				x(i, j) = column[i];
+		}
+		return x;
+	}
+	template <typename T>
+	DynMatrix<T> LU<DynMatrix<T>>::inverse() const
+	{
+		DynMatrix<T> id(lu.rows(), lu.rows());
+		return solve(id.identity());
+	}
+
+} // namespace els
+
+#endif
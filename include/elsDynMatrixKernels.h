@@ -0,0 +1,95 @@
+// no include guard, elsDynMatrix.h includes this once per register width
+// the enclosing namespace provides V, splat(float) and loadv(const float*)
+
+// a register tile of gemm_mr rows and two registers of columns
+constexpr size_t nr = 2 * V::width;
+
+// out = a b for one tile, a holds kc steps of gemm_mr values and b kc steps of nr values,
+// both packed by the driver, out is gemm_mr x nr row-major
+// the twelve accumulators are spelled out, gcc -O2 spills them when they are an array
+inline void tile(size_t kc, const float* a, const float* b, float* out)
+{
+	const V zero = splat(0.f);
+	V c00 = zero, c01 = zero, c10 = zero, c11 = zero, c20 = zero, c21 = zero;
+	V c30 = zero, c31 = zero, c40 = zero, c41 = zero, c50 = zero, c51 = zero;
+	for (size_t k = 0; k < kc; ++k, a += gemm_mr, b += nr)
+	{
+		const V b0 = loadv(b), b1 = loadv(b + V::width);
+		V ai = splat(a[0]);
+		c00 = madd(ai, b0, c00);
+		c01 = madd(ai, b1, c01);
+		ai = splat(a[1]);
+		c10 = madd(ai, b0, c10);
+		c11 = madd(ai, b1, c11);
+		ai = splat(a[2]);
+		c20 = madd(ai, b0, c20);
+		c21 = madd(ai, b1, c21);
+		ai = splat(a[3]);
+		c30 = madd(ai, b0, c30);
+		c31 = madd(ai, b1, c31);
+		ai = splat(a[4]);
+		c40 = madd(ai, b0, c40);
+		c41 = madd(ai, b1, c41);
+		ai = splat(a[5]);
+		c50 = madd(ai, b0, c50);
+		c51 = madd(ai, b1, c51);
+	}
+	store(out, c00);
+	store(out + V::width, c01);
+	store(out + nr, c10);
+	store(out + nr + V::width, c11);
+	store(out + 2 * nr, c20);
+	store(out + 2 * nr + V::width, c21);
+	store(out + 3 * nr, c30);
+	store(out + 3 * nr + V::width, c31);
+	store(out + 4 * nr, c40);
+	store(out + 4 * nr + V::width, c41);
+	store(out + 5 * nr, c50);
+	store(out + 5 * nr + V::width, c51);
+}
+
+// sum of a[i] x[i], four accumulators hide the madd latency
+inline float dot(const float* a, const float* x, size_t n)
+{
+	V s0 = splat(0.f), s1 = s0, s2 = s0, s3 = s0;
+	size_t i = 0;
+	for (; i + 4 * V::width <= n; i += 4 * V::width)
+	{
+		s0 = madd(loadv(a + i), loadv(x + i), s0);
+		s1 = madd(loadv(a + i + V::width), loadv(x + i + V::width), s1);
+		s2 = madd(loadv(a + i + 2 * V::width), loadv(x + i + 2 * V::width), s2);
+		s3 = madd(loadv(a + i + 3 * V::width), loadv(x + i + 3 * V::width), s3);
+	}
+	for (; i + V::width <= n; i += V::width)
+		s0 = madd(loadv(a + i), loadv(x + i), s0);
+
+	float lanes[V::width];
+	store(lanes, (s0 + s1) + (s2 + s3));
+	float s = 0.f;
+	for (size_t k = 0; k < V::width; ++k)
+		s += lanes[k];
+	for (; i < n; ++i)
+		s += a[i] * x[i];
+	return s;
+}
+
+// y += s x
+inline void axpy(float s, const float* x, float* y, size_t n)
+{
+	const V vs = splat(s);
+	size_t i = 0;
+	for (; i + 2 * V::width <= n; i += 2 * V::width)
+	{
+		store(y + i, madd(vs, loadv(x + i), loadv(y + i)));
+		store(y + i + V::width, madd(vs, loadv(x + i + V::width), loadv(y + i + V::width)));
+	}
+	for (; i + V::width <= n; i += V::width)
+		store(y + i, madd(vs, loadv(x + i), loadv(y + i)));
+	for (; i < n; ++i)
+		y[i] += s * x[i];
+}
+
+inline dyn_table<float> make_table()
+{
+	return dyn_table<float>{ nr, &tile, &dot, &axpy };
+}
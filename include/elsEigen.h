@@ -0,0 +1,287 @@
+#ifndef ELS_EIGEN
+#define ELS_EIGEN
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsMatrix3.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// eigenvalues in decreasing order, the eigenvectors are the matching columns of a rotation
+	template <typename T>
+	struct Eigen3
+	{
+		using Scalar = T;
+
+		Vector3<T> values;
+		Matrix3<T> vectors;
+	};
+
+	// m = u diag(sigma) v^T in textbook order, which is v^T * diag * u with operator*
+	// u and v are rotations, sigma is sorted by magnitude and only the last one is negative, when det(m) < 0
+	template <typename T>
+	struct Svd3
+	{
+		using Scalar = T;
+
+		Matrix3<T> u;
+		Vector3<T> sigma;
+		Matrix3<T> v;
+	};
+
+	// m = rotation stretch in textbook order with a symmetric stretch, the stretch has a negative
+	// eigenvalue when det(m) < 0 so that rotation stays a rotation
+	template <typename T>
+	struct Polar3
+	{
+		using Scalar = T;
+
+		Matrix3<T> rotation;
+		Matrix3<T> stretch;
+	};
+
+	// matrices per worker chunk for the span versions
+	constexpr size_t eigen_grain = 1 << 12;
+
+	namespace detail
+	{
+		namespace eigen
+		{
+			// the kernels follow mcadams et al., "computing the singular value decomposition of 3x3 matrices
+			// with minimal branching and elementary floating point operations", jacobi on m^T m, sorted
+			// columns of m v, givens qr, with a fixed number of sweeps
+			constexpr size_t jacobi_sweeps = 4;
+			// below this the qr rotation is skipped, its square stays a normal float
+			constexpr float qr_epsilon = 1e-15f;
+
+			struct eigen_table
+			{
+				void (*eigen)(const float*, size_t, float*);
+				void (*svd)(const float*, size_t, float*);
+				void (*polar)(const float*, size_t, float*);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsEigenKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsEigenKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const eigen_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const eigen_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const eigen_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			static_assert(sizeof(Eigen3<float>) == 12 * sizeof(float), "the kernels write Eigen3<float> as packed floats");
+			static_assert(sizeof(Svd3<float>) == 21 * sizeof(float), "the kernels write Svd3<float> as packed floats");
+			static_assert(sizeof(Polar3<float>) == 18 * sizeof(float), "the kernels write Polar3<float> as packed floats");
+
+			// a b in the textbook sense, operator* composes the other way around
+			template <typename T>
+			inline Matrix3<T> product(const Matrix3<T>& a, const Matrix3<T>& b)
+			{
+				Matrix3<T> result = a;
+				result *= b;
+				return result;
+			}
+
+			template <typename Fn>
+			inline void run(size_t count, Fn&& fn)
+			{
+				parallel::for_range(0, count, eigen_grain, fn);
+			}
+		}
+	}
+
+	// cyclic jacobi with exact rotations until the off diagonal vanishes, only the upper triangle is read
+	template <typename T>
+	inline Eigen3<T> eigen_symmetric(const Matrix3<T>& m)
+	{
+		T a[3][3];
+		for (unsigned int r = 0; r < 3; ++r)
+		{
+			for (unsigned int c = r; c < 3; ++c)
+				a[r][c] = a[c][r] = m[r][c];
+		}
+		Matrix3<T> v = Matrix3<T>::I;
+
+		for (unsigned int sweep = 0; sweep < 32; ++sweep)
+		{
+			const T off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+			const T diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+			if (off <= std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * diag || off < std::numeric_limits<T>::min())
+				break;
+
+			for (unsigned int p = 0; p < 2; ++p)
+			{
+				for (unsigned int q = p + 1; q < 3; ++q)
+				{
+					if (a[p][q] == 0)
+						continue;
+
+					// rotation that clears a[p][q], the smaller of the two angles
+					const T theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+					const T t = (theta < 0 ? -1 : 1) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+					const T c = 1 / std::sqrt(t * t + 1);
+					const T s = t * c;
+					const T apq = a[p][q];
+					a[p][p] -= t * apq;
+					a[q][q] += t * apq;
+					a[p][q] = a[q][p] = 0;
+					const unsigned int k = 3 - p - q;
+					const T akp = a[k][p], akq = a[k][q];
+					a[k][p] = a[p][k] = c * akp - s * akq;
+					a[k][q] = a[q][k] = s * akp + c * akq;
+					for (unsigned int r = 0; r < 3; ++r)
+					{
+						const T vp = v[r][p], vq = v[r][q];
+						v[r][p] = c * vp - s * vq;
+						v[r][q] = s * vp + c * vq;
+					}
+				}
+			}
+		}
+
+		// decreasing order, a swap flips one column so v stays a rotation
+		Eigen3<T> e{ Vector3<T>(a[0][0], a[1][1], a[2][2]), v };
+		for (unsigned int i = 0; i < 2; ++i)
+		{
+			for (unsigned int j = i + 1; j < 3; ++j)
+			{
+				if (e.values[i] >= e.values[j])
+					continue;
+				std::swap(e.values[i], e.values[j]);
+				for (unsigned int r = 0; r < 3; ++r)
+				{
+					const T t = e.vectors[r][i];
+					e.vectors[r][i] = e.vectors[r][j];
+					e.vectors[r][j] = -t;
+				}
+			}
+		}
+		return e;
+	}
+
+	// eigenvectors of m^T m give v, givens qr of m v gives u and sigma
+	template <typename T>
+	inline Svd3<T> svd(const Matrix3<T>& m)
+	{
+		const Eigen3<T> e = eigen_symmetric(detail::eigen::product(m.transposed(), m));
+		Svd3<T> result{ Matrix3<T>::I, Vector3<T>(), e.vectors };
+		Matrix3<T> b = detail::eigen::product(m, e.vectors);
+		for (unsigned int p = 0; p < 2; ++p)
+		{
+			for (unsigned int q = p + 1; q < 3; ++q)
+			{
+				const T a1 = b[p][p], a2 = b[q][p];
+				const T rho = std::sqrt(a1 * a1 + a2 * a2);
+				if (rho == 0)
+					continue;
+				const T c = a1 / rho, s = a2 / rho;
+				for (unsigned int j = 0; j < 3; ++j)
+				{
+					const T bp = b[p][j], bq = b[q][j];
+					b[p][j] = c * bp + s * bq;
+					b[q][j] = c * bq - s * bp;
+				}
+				for (unsigned int r = 0; r < 3; ++r)
+				{
+					const T up = result.u[r][p], uq = result.u[r][q];
+					result.u[r][p] = c * up + s * uq;
+					result.u[r][q] = c * uq - s * up;
+				}
+			}
+		}
+		result.sigma = Vector3<T>(b[0][0], b[1][1], b[2][2]);
+		return result;
+	}
+
+	template <typename T>
+	inline Polar3<T> polar(const Matrix3<T>& m)
+	{
+		const Svd3<T> d = svd(m);
+		const Matrix3<T> vt = d.v.transposed();
+		Matrix3<T> scaled = d.v;
+		for (unsigned int r = 0; r < 3; ++r)
+		{
+			for (unsigned int c = 0; c < 3; ++c)
+				scaled[r][c] *= d.sigma[c];
+		}
+		return Polar3<T>{ detail::eigen::product(d.u, vt), detail::eigen::product(scaled, vt) };
+	}
+
+	// span versions, float spans run 4 or 8 matrices per simd register with the fixed mcadams
+	// sweep count and no branches, within a few 1e-6 of the largest eigen or singular value,
+	// other types loop over the scalar functions above
+	inline void eigen_symmetric(span<const Matrix3<float>> in, span<Eigen3<float>> out)
+	{
+		const auto kernel = detail::eigen::kernels().eigen;
+		detail::eigen::run(in.size(), [&](size_t first, size_t last)
+			{
+				kernel(in[first].data(), last - first, &out[first].values.x);
+			});
+	}
+	inline void svd(span<const Matrix3<float>> in, span<Svd3<float>> out)
+	{
+		const auto kernel = detail::eigen::kernels().svd;
+		detail::eigen::run(in.size(), [&](size_t first, size_t last)
+			{
+				kernel(in[first].data(), last - first, out[first].u.data());
+			});
+	}
+	inline void polar(span<const Matrix3<float>> in, span<Polar3<float>> out)
+	{
+		const auto kernel = detail::eigen::kernels().polar;
+		detail::eigen::run(in.size(), [&](size_t first, size_t last)
+			{
+				kernel(in[first].data(), last - first, out[first].rotation.data());
+			});
+	}
+
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void eigen_symmetric(span<const Matrix3<T>> in, span<Eigen3<T>> out)
+	{
+		detail::eigen::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = eigen_symmetric(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void svd(span<const Matrix3<T>> in, span<Svd3<T>> out)
+	{
+		detail::eigen::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = svd(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void polar(span<const Matrix3<T>> in, span<Polar3<T>> out)
+	{
+		detail::eigen::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = polar(in[i]); });
+	}
+
+} // namespace els
+
+#endif
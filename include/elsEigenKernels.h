@@ -0,0 +1,230 @@
+// no include guard, elsEigen.h includes this once per register width
+// the enclosing namespace provides V, splat(float) and loadv(const float*)
+//
+// every lane holds one matrix, x[3 * r + c] is row r column c, short blocks are padded with identities
+
+inline void gather(const float* in, size_t count, V* x)
+{
+	float lanes[9][V::width];
+	for (size_t k = 0; k < V::width; ++k)
+	{
+		for (size_t e = 0; e < 9; ++e)
+			lanes[e][k] = k < count ? in[9 * k + e] : (e % 4 == 0 ? 1.f : 0.f);
+	}
+	for (size_t e = 0; e < 9; ++e)
+		x[e] = loadv(lanes[e]);
+}
+
+// values registers go to out[stride * k + offset + e] for the first count lanes
+inline void scatter(const V* x, size_t values, float* out, size_t stride, size_t offset, size_t count)
+{
+	float lanes[9][V::width];
+	for (size_t e = 0; e < values; ++e)
+		store(lanes[e], x[e]);
+	for (size_t k = 0; k < count; ++k)
+	{
+		for (size_t e = 0; e < values; ++e)
+			out[stride * k + offset + e] = lanes[e][k];
+	}
+}
+
+inline void identity(V* x)
+{
+	for (size_t e = 0; e < 9; ++e)
+		x[e] = splat(e % 4 == 0 ? 1.f : 0.f);
+}
+
+// one jacobi rotation of the symmetric s that clears s[p][q], v gets it as well
+// the exact angle in the smaller of the two directions, mcadams' approximate angle needs more sweeps
+// for float accuracy than the square roots it saves
+inline void jacobi(V* s, V* v, size_t p, size_t q)
+{
+	const size_t k = 3 - p - q;
+	const V spp = s[4 * p], sqq = s[4 * q], spq = s[3 * p + q];
+	const V tau = (sqq - spp) / (splat(2.f) * spq);
+	const V t_abs = splat(1.f) / (abs(tau) + sqrt(madd(tau, tau, splat(1.f))));
+	// nothing to clear gives 0 / 0 above
+	const V skip = less(abs(spq), splat(std::numeric_limits<float>::min()));
+	const V t = select(skip, splat(0.f), select(less(tau, splat(0.f)), splat(0.f) - t_abs, t_abs));
+	const V c = splat(1.f) / sqrt(madd(t, t, splat(1.f)));
+	const V sn = t * c;
+
+	s[4 * p] = spp - t * spq;
+	s[4 * q] = sqq + t * spq;
+	s[3 * p + q] = s[3 * q + p] = splat(0.f);
+	const V skp = s[3 * k + p], skq = s[3 * k + q];
+	s[3 * k + p] = s[3 * p + k] = c * skp - sn * skq;
+	s[3 * k + q] = s[3 * q + k] = sn * skp + c * skq;
+	for (size_t r = 0; r < 3; ++r)
+	{
+		const V vp = v[3 * r + p], vq = v[3 * r + q];
+		v[3 * r + p] = c * vp - sn * vq;
+		v[3 * r + q] = sn * vp + c * vq;
+	}
+}
+
+inline void sweeps(V* s, V* v)
+{
+	for (size_t i = 0; i < jacobi_sweeps; ++i)
+	{
+		jacobi(s, v, 0, 1);
+		jacobi(s, v, 0, 2);
+		jacobi(s, v, 1, 2);
+	}
+}
+
+// moves column j of x and y in front of column i where key j is larger, one of them
+// changes sign so rotations stay rotations
+inline void order(V* key, V* x, V* y, size_t i, size_t j)
+{
+	const V swap = less(key[i], key[j]);
+	const V t = key[i];
+	key[i] = select(swap, key[j], key[i]);
+	key[j] = select(swap, t, key[j]);
+	for (size_t r = 0; r < 3; ++r)
+	{
+		const V xi = x[3 * r + i], xj = x[3 * r + j];
+		x[3 * r + i] = select(swap, xj, xi);
+		x[3 * r + j] = select(swap, splat(0.f) - xi, xj);
+		if (y)
+		{
+			const V yi = y[3 * r + i], yj = y[3 * r + j];
+			y[3 * r + i] = select(swap, yj, yi);
+			y[3 * r + j] = select(swap, splat(0.f) - yi, yj);
+		}
+	}
+}
+
+// givens rotation of rows p and q of b that clears b[q][p], u gets it as a column rotation
+inline void qr(V* b, V* u, size_t p, size_t q)
+{
+	const V a1 = b[4 * p], a2 = b[3 * q + p];
+	const V rho = sqrt(a1 * a1 + a2 * a2);
+	const V eps = splat(qr_epsilon);
+	V sh = select(less(eps, rho), a2, splat(0.f));
+	V ch = abs(a1) + max(rho, eps);
+	const V negative = less(a1, splat(0.f));
+	const V t = sh;
+	sh = select(negative, ch, sh);
+	ch = select(negative, t, ch);
+	const V w = splat(1.f) / sqrt(ch * ch + sh * sh);
+	ch = ch * w;
+	sh = sh * w;
+
+	const V c = ch * ch - sh * sh;
+	const V sn = splat(2.f) * ch * sh;
+	for (size_t j = 0; j < 3; ++j)
+	{
+		const V bp = b[3 * p + j], bq = b[3 * q + j];
+		b[3 * p + j] = c * bp + sn * bq;
+		b[3 * q + j] = c * bq - sn * bp;
+	}
+	for (size_t r = 0; r < 3; ++r)
+	{
+		const V up = u[3 * r + p], uq = u[3 * r + q];
+		u[3 * r + p] = c * up + sn * uq;
+		u[3 * r + q] = c * uq - sn * up;
+	}
+}
+
+// a = u diag(sigma) v^T with rotations u and v, sigma sorted by magnitude and only the last one negative
+inline void svd_lanes(const V* a, V* u, V* sigma, V* v)
+{
+	V s[9];
+	for (size_t i = 0; i < 3; ++i)
+	{
+		for (size_t j = i; j < 3; ++j)
+			s[3 * i + j] = s[3 * j + i] = madd(a[i], a[j], madd(a[3 + i], a[3 + j], a[6 + i] * a[6 + j]));
+	}
+	identity(v);
+	sweeps(s, v);
+
+	V b[9];
+	for (size_t r = 0; r < 3; ++r)
+	{
+		for (size_t c = 0; c < 3; ++c)
+			b[3 * r + c] = madd(a[3 * r], v[c], madd(a[3 * r + 1], v[3 + c], a[3 * r + 2] * v[6 + c]));
+	}
+	V norm[3];
+	for (size_t c = 0; c < 3; ++c)
+		norm[c] = madd(b[c], b[c], madd(b[3 + c], b[3 + c], b[6 + c] * b[6 + c]));
+	order(norm, b, v, 0, 1);
+	order(norm, b, v, 0, 2);
+	order(norm, b, v, 1, 2);
+
+	identity(u);
+	qr(b, u, 0, 1);
+	qr(b, u, 0, 2);
+	qr(b, u, 1, 2);
+	for (size_t i = 0; i < 3; ++i)
+		sigma[i] = b[4 * i];
+}
+
+// out holds Eigen3<float>, values then vectors
+inline void eigen(const float* in, size_t n, float* out)
+{
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V s[9], v[9];
+		gather(in + 9 * i, count, s);
+		for (size_t r = 0; r < 3; ++r)
+		{
+			for (size_t c = r + 1; c < 3; ++c)
+				s[3 * c + r] = s[3 * r + c];
+		}
+		identity(v);
+		sweeps(s, v);
+
+		V values[3] = { s[0], s[4], s[8] };
+		order(values, v, nullptr, 0, 1);
+		order(values, v, nullptr, 0, 2);
+		order(values, v, nullptr, 1, 2);
+		scatter(values, 3, out + 12 * i, 12, 0, count);
+		scatter(v, 9, out + 12 * i, 12, 3, count);
+	}
+}
+
+// out holds Svd3<float>, u, sigma, v
+inline void svd(const float* in, size_t n, float* out)
+{
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V a[9], u[9], sigma[3], v[9];
+		gather(in + 9 * i, count, a);
+		svd_lanes(a, u, sigma, v);
+		scatter(u, 9, out + 21 * i, 21, 0, count);
+		scatter(sigma, 3, out + 21 * i, 21, 9, count);
+		scatter(v, 9, out + 21 * i, 21, 12, count);
+	}
+}
+
+// out holds Polar3<float>, rotation u v^T then stretch v diag(sigma) v^T
+inline void polar(const float* in, size_t n, float* out)
+{
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V a[9], u[9], sigma[3], v[9];
+		gather(in + 9 * i, count, a);
+		svd_lanes(a, u, sigma, v);
+
+		V r[9], s[9];
+		for (size_t row = 0; row < 3; ++row)
+		{
+			for (size_t c = 0; c < 3; ++c)
+			{
+				r[3 * row + c] = madd(u[3 * row], v[3 * c], madd(u[3 * row + 1], v[3 * c + 1], u[3 * row + 2] * v[3 * c + 2]));
+				s[3 * row + c] = madd(v[3 * row] * sigma[0], v[3 * c], madd(v[3 * row + 1] * sigma[1], v[3 * c + 1], v[3 * row + 2] * sigma[2] * v[3 * c + 2]));
+			}
+		}
+		scatter(r, 9, out + 18 * i, 18, 0, count);
+		scatter(s, 9, out + 18 * i, 18, 9, count);
+	}
+}
+
+inline eigen_table make_table()
+{
+	return eigen_table{ &eigen, &svd, &polar };
+}
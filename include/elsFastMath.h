@@ -0,0 +1,259 @@
+#ifndef ELS_FAST_MATH
+#define ELS_FAST_MATH
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsSimd.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+
+namespace els
+{
+	// approximations for hot loops that can trade accuracy for speed
+	// everything is evaluated in float, max errors are measured against double precision <cmath>
+	//
+	//   function  max error                 range
+	//   rsqrt     2.6e-7 relative           x > 0, 4.8e-6 without sse/neon
+	//   sqrt      2.9e-7 relative           x >= 0, 4.8e-6 without sse/neon
+	//   sin/cos   9.2e-8 absolute           |x| < 8192
+	//   atan2     3.1e-7 absolute
+	//   asin/acos 4.9e-7 absolute           |x| <= 1, clamped outside, 5.4e-6 without sse/neon
+	//   exp2      2.4e-7 relative           [-126, 128), clamped outside
+	//   log2      1.2e-7 absolute + 1 ulp   positive normal x
+	//   exp/log   through exp2/log2, exp loses another |x| * 6e-8 relative to rounding of x * log2(e)
+	//
+	// none of them handle nan, inf or denormals the way <cmath> does
+	namespace fast
+	{
+		namespace detail
+		{
+			inline uint32_t to_bits(float x)
+			{
+				uint32_t u;
+				std::memcpy(&u, &x, sizeof u);
+				return u;
+			}
+			inline float from_bits(uint32_t u)
+			{
+				float x;
+				std::memcpy(&x, &u, sizeof x);
+				return x;
+			}
+		}
+
+		// 1 / sqrt(x) for x > 0
+		inline float rsqrt(float x)
+		{
+#if defined(ELS_SIMD_SSE)
+			const float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+			return r * (1.5f - 0.5f * x * r * r);
+#elif defined(ELS_SIMD_NEON)
+			const float r = vrsqrtes_f32(x);
+			return r * vrsqrtss_f32(x * r, r);
+#else
+			float r = detail::from_bits(0x5f375a86u - (detail::to_bits(x) >> 1));
+			r = r * (1.5f - 0.5f * x * r * r);
+			return r * (1.5f - 0.5f * x * r * r);
+#endif
+		}
+		inline float sqrt(float x)
+		{
+			return x > 0.f ? x * rsqrt(x) : 0.f;
+		}
+
+		// quadrant reduction with pi/2 split in three parts, minimax polynomials on [-pi/4, pi/4]
+		inline void sincos(float x, float& s, float& c)
+		{
+			// adding 1.5 * 2^23 rounds to the nearest integer and leaves it in the low mantissa bits
+			const float shifted = x * 0.636619772f + 12582912.f;
+			const float q = shifted - 12582912.f;
+			const uint32_t quadrant = detail::to_bits(shifted) & 3;
+
+			float r = x - q * 1.5703125f;
+			r -= q * 4.83751297e-4f;
+			r -= q * 7.54978995e-8f;
+			const float r2 = r * r;
+
+			const float sr = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+			const float cr = 1.f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+			// odd quadrants swap the pair, the sign of each follows its own quadrant bit
+			const float sa = (quadrant & 1) ? cr : sr;
+			const float ca = (quadrant & 1) ? sr : cr;
+			s = (quadrant & 2) ? -sa : sa;
+			c = ((quadrant + 1) & 2) ? -ca : ca;
+		}
+		inline float sin(float x)
+		{
+			float s, c;
+			sincos(x, s, c);
+			return s;
+		}
+		inline float cos(float x)
+		{
+			float s, c;
+			sincos(x, s, c);
+			return c;
+		}
+
+		// atan on [0, inf), reduced around tan(pi/8) and tan(3pi/8)
+		inline float atan_positive(float x)
+		{
+			float offset = 0.f;
+			if (x > 2.414213562f)
+			{
+				offset = pi<float> * 0.5f;
+				x = -1.f / x;
+			}
+			else if (x > 0.414213562f)
+			{
+				offset = pi<float> * 0.25f;
+				x = (x - 1.f) / (x + 1.f);
+			}
+			const float z = x * x;
+			return offset + x + x * z * (-3.33329491539e-1f + z * (1.99777106478e-1f + z * (-1.38776856032e-1f + z * 8.05374449538e-2f)));
+		}
+		inline float atan(float x)
+		{
+			return x < 0.f ? -atan_positive(-x) : atan_positive(x);
+		}
+		inline float atan2(float y, float x)
+		{
+			if (x == 0.f)
+				return y > 0.f ? pi<float> * 0.5f : y < 0.f ? -pi<float> * 0.5f : 0.f;
+
+			const float a = atan(y / x);
+			if (x > 0.f)
+				return a;
+			return y < 0.f ? a - pi<float> : a + pi<float>;
+		}
+
+		// asin on [0, 0.5], acos is rebuilt from it through half angle identities
+		inline float asin_small(float x)
+		{
+			const float z = x * x;
+			return x + x * z * (1.6666752422e-1f + z * (7.4953002686e-2f + z * (4.5470025998e-2f + z * (2.4181311049e-2f + z * 4.2163199048e-2f))));
+		}
+		inline float asin(float x)
+		{
+			const float a = x < 0.f ? -x : x;
+			float r;
+			if (a > 0.5f)
+				r = pi<float> * 0.5f - 2.f * asin_small(sqrt(0.5f * (1.f - (a > 1.f ? 1.f : a))));
+			else
+				r = asin_small(a);
+			return x < 0.f ? -r : r;
+		}
+		inline float acos(float x)
+		{
+			if (x > 0.5f)
+				return 2.f * asin_small(sqrt(0.5f * (1.f - (x > 1.f ? 1.f : x))));
+			if (x < -0.5f)
+				return pi<float> - 2.f * asin_small(sqrt(0.5f * (1.f + (x < -1.f ? -1.f : x))));
+			return pi<float> * 0.5f - asin_small(x < 0.f ? -x : x) * (x < 0.f ? -1.f : 1.f);
+		}
+
+		// 2^x, the integer part goes straight into the exponent bits
+		inline float exp2(float x)
+		{
+			x = x < -126.f ? -126.f : x > 127.99999f ? 127.99999f : x;
+			const float shifted = x + 12582912.f;
+			const float f = x - (shifted - 12582912.f);
+			const float p = 1.f + f * (6.931471806e-1f + f * (2.402265070e-1f + f * (5.550410866e-2f + f * (9.618129108e-3f + f * (1.333355815e-3f + f * 1.540353039e-4f)))));
+			// the rounded integer sits in the low mantissa bits of shifted, two's complement for negatives
+			// it reaches 128 from 127.5 up, which has no exponent of its own, so 2^n goes in two halves
+			const int32_t n = static_cast<int32_t>(detail::to_bits(shifted) - detail::to_bits(12582912.f));
+			const int32_t half = n >> 1;
+			return p * detail::from_bits(static_cast<uint32_t>(half + 127) << 23) * detail::from_bits(static_cast<uint32_t>(n - half + 127) << 23);
+		}
+		// log2 for positive normal x, mantissa reduced to [sqrt(1/2), sqrt(2))
+		inline float log2(float x)
+		{
+			const uint32_t bits = detail::to_bits(x);
+			int e = static_cast<int>((bits >> 23) & 0xff) - 127;
+			float m = detail::from_bits((bits & 0x007fffffu) | 0x3f800000u);
+			if (m > 1.414213562f)
+			{
+				m *= 0.5f;
+				++e;
+			}
+			const float t = (m - 1.f) / (m + 1.f);
+			const float t2 = t * t;
+			const float l = t * (2.885390082f + t2 * (0.9617966939f + t2 * (0.5770780164f + t2 * (0.4121985831f + t2 * 0.3205988419f))));
+			return static_cast<float>(e) + l;
+		}
+		inline float exp(float x)
+		{
+			return exp2(x * 1.442695041f);
+		}
+		inline float log(float x)
+		{
+			return log2(x) * ln2<float>;
+		}
+
+		// other floating point types go through float
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T rsqrt(T x) { return static_cast<T>(rsqrt(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T sqrt(T x) { return static_cast<T>(sqrt(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T sin(T x) { return static_cast<T>(sin(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T cos(T x) { return static_cast<T>(cos(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T acos(T x) { return static_cast<T>(acos(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T atan2(T y, T x) { return static_cast<T>(atan2(static_cast<float>(y), static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T exp2(T x) { return static_cast<T>(exp2(static_cast<float>(x))); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value && !std::is_same<T, float>::value>>
+		inline T log2(T x) { return static_cast<T>(log2(static_cast<float>(x))); }
+
+		// vectors, same bounds as rsqrt, sqrt and acos above
+		namespace detail
+		{
+			template <typename V>
+			inline V normalized(const V& v)
+			{
+				V norm = v;
+				norm *= fast::rsqrt(v.length2());
+				return norm;
+			}
+			template <typename V>
+			inline typename V::Scalar angle(const V& a, const V& b)
+			{
+				using T = typename V::Scalar;
+				T denominator2 = a.length2() * b.length2();
+				if (is_zero(denominator2))
+					return 0;
+				const T c = a.dot(b) * fast::rsqrt(denominator2);
+				return fast::acos(clamp(c, static_cast<T>(-1), static_cast<T>(1)));
+			}
+		}
+		template <typename T>
+		inline Vector2<T> normalized(const Vector2<T>& v) { return detail::normalized(v); }
+		template <typename T>
+		inline Vector3<T> normalized(const Vector3<T>& v) { return detail::normalized(v); }
+		template <typename T>
+		inline Vector4<T> normalized(const Vector4<T>& v) { return detail::normalized(v); }
+		template <typename T>
+		inline T length(const Vector2<T>& v) { return fast::sqrt(v.length2()); }
+		template <typename T>
+		inline T length(const Vector3<T>& v) { return fast::sqrt(v.length2()); }
+		template <typename T>
+		inline T length(const Vector4<T>& v) { return fast::sqrt(v.length2()); }
+		template <typename T>
+		inline T angle(const Vector2<T>& a, const Vector2<T>& b) { return detail::angle(a, b); }
+		template <typename T>
+		inline T angle(const Vector3<T>& a, const Vector3<T>& b) { return detail::angle(a, b); }
+		template <typename T>
+		inline T angle(const Vector4<T>& a, const Vector4<T>& b) { return detail::angle(a, b); }
+	}
+
+} // namespace els
+
+#endif
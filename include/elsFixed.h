@@ -0,0 +1,361 @@
+#ifndef ELS_FIXED
+#define ELS_FIXED
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+
+namespace els
+{
+	// signed fixed point scalar stored in 32 bits, IntBits counts the sign bit
+	// every operation is integer only so results are bit exact on every platform and compiler
+	// + - * wrap on overflow like the integer types, * rounds half up, / truncates toward zero
+	// and saturates on division by zero
+	template <int IntBits, int FracBits>
+	class Fixed
+	{
+		static_assert(IntBits >= 1 && FracBits >= 1 && FracBits <= 30 && IntBits + FracBits <= 32,
+			"Fixed needs 1 to 30 fraction bits and fits in 32 bits");
+
+	public:
+		using Raw = int32_t;
+		static constexpr int int_bits = IntBits;
+		static constexpr int frac_bits = FracBits;
+
+	private:
+		static constexpr int64_t one = int64_t(1) << FracBits;
+
+		Raw value;
+
+		static constexpr Raw wrap(int64_t v) { return static_cast<Raw>(static_cast<uint32_t>(static_cast<uint64_t>(v))); }
+
+	public:
+		constexpr Fixed() : value{ 0 } {}
+		template <typename S, std::enable_if_t<std::is_integral<S>::value, int> = 0>
+		constexpr Fixed(S s) : value{ wrap(static_cast<int64_t>(s) * one) } {}
+		// rounds to the nearest step, ties away from zero
+		template <typename S, std::enable_if_t<std::is_floating_point<S>::value, int> = 0>
+		constexpr Fixed(S s) : value{ wrap(static_cast<int64_t>(s * static_cast<S>(one) + (s < 0 ? static_cast<S>(-0.5) : static_cast<S>(0.5)))) } {}
+
+		static constexpr Fixed from_raw(Raw r)
+		{
+			Fixed f;
+			f.value = r;
+			return f;
+		}
+		constexpr Raw raw() const { return value; }
+
+		// integers truncate toward zero like a float to int cast
+		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		constexpr explicit operator S() const
+		{
+			if constexpr (std::is_floating_point<S>::value)
+				return static_cast<S>(value) / static_cast<S>(one);
+			else
+				return static_cast<S>(value / one);
+		}
+		template <int I, int F>
+		constexpr explicit operator Fixed<I, F>() const
+		{
+			if constexpr (F >= FracBits)
+				return Fixed<I, F>::from_raw(wrap(static_cast<int64_t>(value) * (int64_t(1) << (F - FracBits))));
+			else
+				return Fixed<I, F>::from_raw(wrap(static_cast<int64_t>(value) >> (FracBits - F)));
+		}
+
+		constexpr Fixed operator-() const { return from_raw(wrap(-static_cast<int64_t>(value))); }
+		constexpr Fixed operator+() const { return *this; }
+
+		constexpr Fixed& operator+=(const Fixed& rhs)
+		{
+			value = wrap(static_cast<int64_t>(value) + rhs.value);
+			return *this;
+		}
+		constexpr Fixed& operator-=(const Fixed& rhs)
+		{
+			value = wrap(static_cast<int64_t>(value) - rhs.value);
+			return *this;
+		}
+		constexpr Fixed& operator*=(const Fixed& rhs)
+		{
+			// right shifts of negative values are arithmetic on every supported compiler and required since c++20
+			const int64_t p = static_cast<int64_t>(value) * rhs.value;
+			value = wrap((p + (one >> 1)) >> FracBits);
+			return *this;
+		}
+		constexpr Fixed& operator/=(const Fixed& rhs)
+		{
+			if (rhs.value == 0)
+				value = value < 0 ? std::numeric_limits<Raw>::min() : std::numeric_limits<Raw>::max();
+			else
+				value = wrap(static_cast<int64_t>(value) * one / rhs.value);
+			return *this;
+		}
+
+		friend constexpr Fixed operator+(Fixed lhs, const Fixed& rhs) { return lhs += rhs; }
+		friend constexpr Fixed operator-(Fixed lhs, const Fixed& rhs) { return lhs -= rhs; }
+		friend constexpr Fixed operator*(Fixed lhs, const Fixed& rhs) { return lhs *= rhs; }
+		friend constexpr Fixed operator/(Fixed lhs, const Fixed& rhs) { return lhs /= rhs; }
+
+		friend constexpr bool operator==(const Fixed& lhs, const Fixed& rhs) { return lhs.value == rhs.value; }
+		friend constexpr bool operator!=(const Fixed& lhs, const Fixed& rhs) { return lhs.value != rhs.value; }
+		friend constexpr bool operator<(const Fixed& lhs, const Fixed& rhs) { return lhs.value < rhs.value; }
+		friend constexpr bool operator<=(const Fixed& lhs, const Fixed& rhs) { return lhs.value <= rhs.value; }
+		friend constexpr bool operator>(const Fixed& lhs, const Fixed& rhs) { return lhs.value > rhs.value; }
+		friend constexpr bool operator>=(const Fixed& lhs, const Fixed& rhs) { return lhs.value >= rhs.value; }
+	};
+
+	// typedefs
+	using Fixed32 = Fixed<16, 16>;
+
+	template <int I, int F>
+	struct is_scalar<Fixed<I, F>> : std::true_type {};
+
+	namespace detail
+	{
+		namespace fixed
+		{
+			// angles in Q30
+			constexpr int64_t pi_q30 = 3373259426;
+			constexpr int64_t half_pi_q30 = 1686629713;
+			constexpr int64_t two_pi_q30 = 6746518852;
+			// what two_pi_q30 leaves out of 2 pi, in Q60, so reducing large angles does not drift
+			constexpr int64_t two_pi_rest_q60 = 280256794;
+			// 1 / prod(sqrt(1 + 2^-2i)), undoes the cordic gain
+			constexpr int64_t gain = 652032874;
+			constexpr int iterations = 30;
+			// atan(2^-i) in Q30
+			constexpr int64_t atan_table[iterations] = {
+				843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+				4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+				16384, 8192, 4096, 2048, 1024, 512, 256, 128,
+				64, 32, 16, 8, 4, 2 };
+
+			template <int F>
+			constexpr int64_t to_q30(int32_t raw) { return static_cast<int64_t>(raw) * (int64_t(1) << (30 - F)); }
+			template <int F>
+			constexpr int32_t from_q30(int64_t q)
+			{
+				if constexpr (F == 30)
+					return static_cast<int32_t>(q);
+				else
+					return static_cast<int32_t>((q + (int64_t(1) << (29 - F))) >> (30 - F));
+			}
+
+			// rotation mode, any angle in Q30, sin and cos out in Q30
+			constexpr void rotate(int64_t angle, int64_t& s, int64_t& c)
+			{
+				const int64_t turns = angle / two_pi_q30;
+				angle -= turns * two_pi_q30 + ((turns * two_pi_rest_q60 + (int64_t(1) << 29)) >> 30);
+				if (angle > pi_q30)
+					angle -= two_pi_q30;
+				else if (angle < -pi_q30)
+					angle += two_pi_q30;
+
+				// fold into [-pi/2, pi/2], cos changes sign
+				bool flip = false;
+				if (angle > half_pi_q30)
+				{
+					angle = pi_q30 - angle;
+					flip = true;
+				}
+				else if (angle < -half_pi_q30)
+				{
+					angle = -pi_q30 - angle;
+					flip = true;
+				}
+
+				int64_t x = gain;
+				int64_t y = 0;
+				for (int i = 0; i < iterations; ++i)
+				{
+					// the direction is data dependent, negating through a mask keeps the loop branch free
+					const int64_t m = -static_cast<int64_t>(angle < 0);
+					const int64_t dx = y >> i;
+					const int64_t dy = x >> i;
+					x -= (dx ^ m) - m;
+					y += (dy ^ m) - m;
+					angle -= (atan_table[i] ^ m) - m;
+				}
+				s = y;
+				c = flip ? -x : x;
+			}
+
+			// vectoring mode, angle of (x, y) in Q30 within [-pi, pi]
+			constexpr int64_t angle_of(int64_t x, int64_t y)
+			{
+				if (x == 0 && y == 0)
+					return 0;
+
+				int64_t angle = 0;
+				if (x < 0)
+				{
+					angle = y >= 0 ? pi_q30 : -pi_q30;
+					x = -x;
+					y = -y;
+				}
+				// scale up so the shifts keep precision, inputs are at most 2^31
+				while ((x < (int64_t(1) << 40)) && (y < (int64_t(1) << 40)) && (y > -(int64_t(1) << 40)))
+				{
+					x *= 2;
+					y *= 2;
+				}
+				for (int i = 0; i < iterations; ++i)
+				{
+					const int64_t m = -static_cast<int64_t>(y <= 0);
+					const int64_t dx = y >> i;
+					const int64_t dy = x >> i;
+					x += (dx ^ m) - m;
+					y -= (dy ^ m) - m;
+					angle += (atan_table[i] ^ m) - m;
+				}
+				return angle;
+			}
+
+			constexpr uint64_t isqrt(uint64_t n)
+			{
+				uint64_t r = 0;
+				uint64_t bit = uint64_t(1) << 62;
+				while (bit > n)
+					bit >>= 2;
+				while (bit)
+				{
+					const uint64_t t = r + bit;
+					const uint64_t m = uint64_t(0) - static_cast<uint64_t>(n >= t);
+					n -= t & m;
+					r = (r >> 1) + (bit & m);
+					bit >>= 2;
+				}
+				// n is now the remainder, round to nearest
+				return n > r ? r + 1 : r;
+			}
+		}
+	}
+
+	// math overloads, all of them integer only
+	template <int I, int F>
+	inline constexpr Fixed<I, F> abs(Fixed<I, F> x) { return x < Fixed<I, F>{} ? -x : x; }
+
+	template <int I, int F>
+	inline constexpr Fixed<I, F> floor(Fixed<I, F> x)
+	{
+		return Fixed<I, F>::from_raw(static_cast<int32_t>(x.raw() & ~((int32_t(1) << F) - 1)));
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> ceil(Fixed<I, F> x)
+	{
+		return -floor(-x);
+	}
+	// halves round up
+	template <int I, int F>
+	inline constexpr Fixed<I, F> round(Fixed<I, F> x)
+	{
+		return floor(x + Fixed<I, F>::from_raw(int32_t(1) << (F - 1)));
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> frac(Fixed<I, F> x) { return x - floor(x); }
+	// remainder with the sign of y like fmod
+	template <int I, int F>
+	inline constexpr Fixed<I, F> mod(Fixed<I, F> y, Fixed<I, F> x)
+	{
+		return x.raw() == 0 ? Fixed<I, F>{} : Fixed<I, F>::from_raw(y.raw() % x.raw());
+	}
+
+	// correctly rounded, negative inputs give 0
+	template <int I, int F>
+	inline constexpr Fixed<I, F> sqrt(Fixed<I, F> x)
+	{
+		if (x.raw() <= 0)
+			return Fixed<I, F>{};
+		return Fixed<I, F>::from_raw(static_cast<int32_t>(detail::fixed::isqrt(static_cast<uint64_t>(x.raw()) << F)));
+	}
+
+	// cordic in Q30 after reducing the angle by 2 pi in Q60, within half a step plus 2^-26 of the exact result
+	template <int I, int F>
+	inline constexpr void sincos(Fixed<I, F> x, Fixed<I, F>& s, Fixed<I, F>& c)
+	{
+		int64_t qs = 0;
+		int64_t qc = 0;
+		detail::fixed::rotate(detail::fixed::to_q30<F>(x.raw()), qs, qc);
+		s = Fixed<I, F>::from_raw(detail::fixed::from_q30<F>(qs));
+		c = Fixed<I, F>::from_raw(detail::fixed::from_q30<F>(qc));
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> sin(Fixed<I, F> x)
+	{
+		Fixed<I, F> s, c;
+		sincos(x, s, c);
+		return s;
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> cos(Fixed<I, F> x)
+	{
+		Fixed<I, F> s, c;
+		sincos(x, s, c);
+		return c;
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> tan(Fixed<I, F> x)
+	{
+		Fixed<I, F> s, c;
+		sincos(x, s, c);
+		return s / c;
+	}
+
+	// pi needs at least 3 integer bits, smaller types wrap
+	template <int I, int F>
+	inline constexpr Fixed<I, F> atan2(Fixed<I, F> y, Fixed<I, F> x)
+	{
+		return Fixed<I, F>::from_raw(detail::fixed::from_q30<F>(detail::fixed::angle_of(x.raw(), y.raw())));
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> atan(Fixed<I, F> x)
+	{
+		return atan2(x, Fixed<I, F>{ 1 });
+	}
+	// |x| <= 1, clamped outside
+	template <int I, int F>
+	inline constexpr Fixed<I, F> asin(Fixed<I, F> x)
+	{
+		const Fixed<I, F> a = clamp(x, Fixed<I, F>{ -1 }, Fixed<I, F>{ 1 });
+		return atan2(a, sqrt(Fixed<I, F>{ 1 } - a * a));
+	}
+	template <int I, int F>
+	inline constexpr Fixed<I, F> acos(Fixed<I, F> x)
+	{
+		const Fixed<I, F> a = clamp(x, Fixed<I, F>{ -1 }, Fixed<I, F>{ 1 });
+		return atan2(sqrt(Fixed<I, F>{ 1 } - a * a), a);
+	}
+
+} // namespace els
+
+namespace std
+{
+	template <int I, int F>
+	class numeric_limits<els::Fixed<I, F>>
+	{
+		using T = els::Fixed<I, F>;
+
+	public:
+		static constexpr bool is_specialized = true;
+		static constexpr bool is_signed = true;
+		static constexpr bool is_integer = false;
+		static constexpr bool is_exact = true;
+		static constexpr bool has_infinity = false;
+		static constexpr bool has_quiet_NaN = false;
+		static constexpr bool is_bounded = true;
+		static constexpr bool is_modulo = true;
+		static constexpr int digits = I + F - 1;
+		static constexpr int radix = 2;
+
+		static constexpr T min() noexcept { return T::from_raw(1); }
+		static constexpr T lowest() noexcept { return T::from_raw(numeric_limits<int32_t>::min()); }
+		static constexpr T max() noexcept { return T::from_raw(numeric_limits<int32_t>::max()); }
+		static constexpr T epsilon() noexcept { return T::from_raw(1); }
+		static constexpr T round_error() noexcept { return T::from_raw(int32_t(1) << (F - 1)); }
+	};
+}
+
+#endif
@@ -0,0 +1,382 @@
+#ifndef ELS_GEOMETRY
+#define ELS_GEOMETRY
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsMatrix4.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// points p with normal.dot(p) + d == 0, the normal side is the positive one
+	template <typename T>
+	struct Plane
+	{
+		using Scalar = T;
+
+		Vector3<T> normal;
+		Scalar d;
+
+		constexpr Plane() : normal{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) }, d{ static_cast<Scalar>(0) } {}
+		constexpr Plane(const Vector3<T>& n, const Scalar& dist) : normal{ n }, d{ dist } {}
+		constexpr Plane(const Vector3<T>& n, const Vector3<T>& point) : normal{ n }, d{ -n.dot(point) } {}
+
+		// counter clockwise points face the positive side
+		static constexpr Plane from_points(const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c)
+		{
+			return Plane{ (b - a).cross(c - a).normalized(), a };
+		}
+
+		// signed distance, scaled by the normal length when it is not normalized
+		constexpr Scalar distance(const Vector3<T>& p) const { return normal.dot(p) + d; }
+		constexpr Vector3<T> project(const Vector3<T>& p) const { return p - normal * distance(p); }
+
+		constexpr Plane normalized() const
+		{
+			const Scalar len = normal.length();
+			if (is_zero(len))
+				return *this;
+			return Plane{ normal / len, d / len };
+		}
+	};
+
+	template <typename T>
+	struct AABB
+	{
+		using Scalar = T;
+
+		Vector3<T> min;
+		Vector3<T> max;
+
+		// empty box, merging anything into it gives that thing
+		constexpr AABB() : min{ std::numeric_limits<Scalar>::max() }, max{ std::numeric_limits<Scalar>::lowest() } {}
+		constexpr AABB(const Vector3<T>& lo, const Vector3<T>& hi) : min{ lo }, max{ hi } {}
+
+		static constexpr AABB from_center(const Vector3<T>& center, const Vector3<T>& half_extent)
+		{
+			return AABB{ center - half_extent, center + half_extent };
+		}
+
+		constexpr Vector3<T> center() const { return (min + max) / static_cast<Scalar>(2); }
+		constexpr Vector3<T> half_extent() const { return (max - min) / static_cast<Scalar>(2); }
+		constexpr Vector3<T> size() const { return max - min; }
+		constexpr bool is_empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+		constexpr bool contains(const Vector3<T>& p) const
+		{
+			return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+		}
+		constexpr bool intersects(const AABB& rhs) const
+		{
+			return min.x <= rhs.max.x && max.x >= rhs.min.x &&
+				min.y <= rhs.max.y && max.y >= rhs.min.y &&
+				min.z <= rhs.max.z && max.z >= rhs.min.z;
+		}
+
+		// squared distance from p to the closest point of the box, 0 inside
+		constexpr Scalar distance2(const Vector3<T>& p) const
+		{
+			const Vector3<T> closest{ clamp(p.x, min.x, max.x), clamp(p.y, min.y, max.y), clamp(p.z, min.z, max.z) };
+			return closest.distance2(p);
+		}
+
+		constexpr AABB& merge(const Vector3<T>& p)
+		{
+			min = Vector3<T>{ els::min(min.x, p.x), els::min(min.y, p.y), els::min(min.z, p.z) };
+			max = Vector3<T>{ els::max(max.x, p.x), els::max(max.y, p.y), els::max(max.z, p.z) };
+			return *this;
+		}
+		constexpr AABB& merge(const AABB& rhs)
+		{
+			min = Vector3<T>{ els::min(min.x, rhs.min.x), els::min(min.y, rhs.min.y), els::min(min.z, rhs.min.z) };
+			max = Vector3<T>{ els::max(max.x, rhs.max.x), els::max(max.y, rhs.max.y), els::max(max.z, rhs.max.z) };
+			return *this;
+		}
+
+		// box around the transformed box, m must be affine
+		constexpr AABB transformed(const Matrix4<T>& m) const
+		{
+			const Vector3<T> c = m * center();
+			const Vector3<T> e = half_extent();
+			const Vector3<T> r{
+				abs(m[0][0]) * e.x + abs(m[0][1]) * e.y + abs(m[0][2]) * e.z,
+				abs(m[1][0]) * e.x + abs(m[1][1]) * e.y + abs(m[1][2]) * e.z,
+				abs(m[2][0]) * e.x + abs(m[2][1]) * e.y + abs(m[2][2]) * e.z };
+			return AABB{ c - r, c + r };
+		}
+	};
+
+	template <typename T>
+	struct Sphere
+	{
+		using Scalar = T;
+
+		Vector3<T> center;
+		Scalar radius;
+
+		constexpr Sphere() : center{}, radius{ static_cast<Scalar>(0) } {}
+		constexpr Sphere(const Vector3<T>& c, const Scalar& r) : center{ c }, radius{ r } {}
+
+		constexpr bool contains(const Vector3<T>& p) const { return center.distance2(p) <= radius * radius; }
+		constexpr bool intersects(const Sphere& rhs) const
+		{
+			const Scalar r = radius + rhs.radius;
+			return center.distance2(rhs.center) <= r * r;
+		}
+		constexpr bool intersects(const AABB<T>& box) const
+		{
+			return box.distance2(center) <= radius * radius;
+		}
+	};
+
+	// six inward facing planes in the order left, right, bottom, top, near, far
+	// the intersection tests are conservative, volumes near a frustum corner can pass while being outside
+	template <typename T>
+	struct Frustum
+	{
+		using Scalar = T;
+
+		std::array<Plane<T>, 6> planes;
+
+		// planes of the matrix taking world points to clip space, clip = m * p
+		// operator* applies its left side first, so that matrix is view * projection
+		// depth is -w..w like Transform3 projections, zero_to_one switches to 0..w
+		static constexpr Frustum from_matrix(const Matrix4<T>& m, bool zero_to_one = false)
+		{
+			const auto row = [&m](unsigned int r) { return Vector4<T>{ m[r][0], m[r][1], m[r][2], m[r][3] }; };
+			const auto plane = [](const Vector4<T>& v) { return Plane<T>{ Vector3<T>{ v.x, v.y, v.z }, v.w }.normalized(); };
+
+			const Vector4<T> w = row(3);
+			Frustum f{};
+			f.planes[0] = plane(w + row(0));
+			f.planes[1] = plane(w - row(0));
+			f.planes[2] = plane(w + row(1));
+			f.planes[3] = plane(w - row(1));
+			f.planes[4] = plane(zero_to_one ? row(2) : w + row(2));
+			f.planes[5] = plane(w - row(2));
+			return f;
+		}
+
+		constexpr bool contains(const Vector3<T>& p) const
+		{
+			for (const Plane<T>& pl : planes)
+			{
+				if (pl.distance(p) < 0)
+					return false;
+			}
+			return true;
+		}
+		constexpr bool intersects(const Sphere<T>& s) const
+		{
+			for (const Plane<T>& pl : planes)
+			{
+				if (pl.distance(s.center) < -s.radius)
+					return false;
+			}
+			return true;
+		}
+		constexpr bool intersects(const AABB<T>& box) const
+		{
+			const Vector3<T> c = box.center();
+			const Vector3<T> e = box.half_extent();
+			for (const Plane<T>& pl : planes)
+			{
+				const Scalar r = abs(pl.normal.x) * e.x + abs(pl.normal.y) * e.y + abs(pl.normal.z) * e.z;
+				if (pl.distance(c) < -r)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// closest point to p on the triangle abc
+	template <typename T>
+	inline constexpr Vector3<T> closest_point(const Vector3<T>& p, const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c)
+	{
+		// voronoi regions of the vertices, then the edges, then the face
+		const Vector3<T> ab = b - a;
+		const Vector3<T> ac = c - a;
+		const Vector3<T> ap = p - a;
+		const T d1 = ab.dot(ap);
+		const T d2 = ac.dot(ap);
+		if (d1 <= 0 && d2 <= 0)
+			return a;
+
+		const Vector3<T> bp = p - b;
+		const T d3 = ab.dot(bp);
+		const T d4 = ac.dot(bp);
+		if (d3 >= 0 && d4 <= d3)
+			return b;
+
+		const T vc = d1 * d4 - d3 * d2;
+		if (vc <= 0 && d1 >= 0 && d3 <= 0)
+			return a + ab * (d1 / (d1 - d3));
+
+		const Vector3<T> cp = p - c;
+		const T d5 = ab.dot(cp);
+		const T d6 = ac.dot(cp);
+		if (d6 >= 0 && d5 <= d6)
+			return c;
+
+		const T vb = d5 * d2 - d1 * d6;
+		if (vb <= 0 && d2 >= 0 && d6 <= 0)
+			return a + ac * (d2 / (d2 - d6));
+
+		const T va = d3 * d6 - d5 * d4;
+		if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+			return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const T denom = static_cast<T>(1) / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	// typedefs
+	using planef = Plane<float>;
+	using plane = Plane<defaultType>;
+	using aabbf = AABB<float>;
+	using aabb = AABB<defaultType>;
+	using spheref = Sphere<float>;
+	using sphere = Sphere<defaultType>;
+	using frustumf = Frustum<float>;
+	using frustum = Frustum<defaultType>;
+
+	// struct of arrays views for batch culling, all spans have the same size
+	struct SphereSoA
+	{
+		span<const float> x, y, z, radius;
+	};
+	struct AABBSoA
+	{
+		span<const float> min_x, min_y, min_z, max_x, max_y, max_z;
+	};
+
+	// elements per worker chunk, a multiple of 32 so workers never share a mask word
+	constexpr size_t culling_grain = 1 << 15;
+
+	namespace detail
+	{
+		namespace cull
+		{
+			struct cull_table
+			{
+				void (*spheres)(const float*, const float* const*, uint32_t*, size_t);
+				void (*aabbs)(const float*, const float* const*, uint32_t*, size_t);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsGeometryKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsGeometryKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const cull_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const cull_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const cull_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			inline std::array<float, 24> pack_planes(const Frustum<float>& f)
+			{
+				std::array<float, 24> r{};
+				for (size_t p = 0; p < 6; ++p)
+				{
+					r[p * 4 + 0] = f.planes[p].normal.x;
+					r[p * 4 + 1] = f.planes[p].normal.y;
+					r[p * 4 + 2] = f.planes[p].normal.z;
+					r[p * 4 + 3] = f.planes[p].d;
+				}
+				return r;
+			}
+
+			template <size_t Streams, typename Kernel>
+			inline void run(Kernel kernel, const Frustum<float>& frustum, const float* const (&in)[Streams], size_t count, uint32_t* visible)
+			{
+				const std::array<float, 24> planes = pack_planes(frustum);
+				const size_t words = (count + 31) / 32;
+				parallel::for_range(0, words, culling_grain / 32, [&](size_t first, size_t last)
+					{
+						const size_t begin = first * 32;
+						const size_t end = last * 32 < count ? last * 32 : count;
+						const float* chunk[Streams];
+						for (size_t s = 0; s < Streams; ++s)
+							chunk[s] = in[s] + begin;
+						kernel(planes.data(), chunk, visible + first, end - begin);
+					});
+			}
+
+			inline size_t compact(const std::vector<uint32_t>& visible, uint32_t* indices)
+			{
+				size_t n = 0;
+				for (size_t w = 0; w < visible.size(); ++w)
+				{
+					uint32_t bits = visible[w];
+					while (bits)
+					{
+						indices[n++] = static_cast<uint32_t>(w * 32 + simd::lowest_bit(bits));
+						bits &= bits - 1;
+					}
+				}
+				return n;
+			}
+		}
+	}
+
+	// bit i of visible[i / 32] is set when element i may intersect the frustum, same test as Frustum::intersects
+	// visible needs (size + 31) / 32 words, unused bits of the last word are cleared
+	inline void frustum_cull(const Frustum<float>& frustum, const SphereSoA& spheres, span<uint32_t> visible)
+	{
+		const float* const in[4] = { spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data() };
+		detail::cull::run(detail::cull::kernels().spheres, frustum, in, spheres.x.size(), visible.data());
+	}
+	inline void frustum_cull(const Frustum<float>& frustum, const AABBSoA& boxes, span<uint32_t> visible)
+	{
+		const float* const in[6] = {
+			boxes.min_x.data(), boxes.min_y.data(), boxes.min_z.data(),
+			boxes.max_x.data(), boxes.max_y.data(), boxes.max_z.data() };
+		detail::cull::run(detail::cull::kernels().aabbs, frustum, in, boxes.min_x.size(), visible.data());
+	}
+
+	// writes the visible element indices in increasing order and returns how many there are
+	// indices needs room for every element in the worst case
+	inline size_t frustum_cull_indices(const Frustum<float>& frustum, const SphereSoA& spheres, span<uint32_t> indices)
+	{
+		std::vector<uint32_t> visible((spheres.x.size() + 31) / 32);
+		frustum_cull(frustum, spheres, visible);
+		return detail::cull::compact(visible, indices.data());
+	}
+	inline size_t frustum_cull_indices(const Frustum<float>& frustum, const AABBSoA& boxes, span<uint32_t> indices)
+	{
+		std::vector<uint32_t> visible((boxes.min_x.size() + 31) / 32);
+		frustum_cull(frustum, boxes, visible);
+		return detail::cull::compact(visible, indices.data());
+	}
+
+} // namespace els
+
+#endif
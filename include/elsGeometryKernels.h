@@ -0,0 +1,126 @@
+// no include guard, elsGeometry.h includes this once per register width
+// the enclosing namespace provides V, splat(float) and loadv(const float*)
+
+// frustum planes splatted once per call, normals point inside
+struct planes_v
+{
+	V nx[6], ny[6], nz[6], d[6];
+	V ax[6], ay[6], az[6];
+
+	explicit planes_v(const float* planes)
+	{
+		for (int p = 0; p < 6; ++p)
+		{
+			const float* pl = planes + p * 4;
+			nx[p] = splat(pl[0]);
+			ny[p] = splat(pl[1]);
+			nz[p] = splat(pl[2]);
+			d[p] = splat(pl[3]);
+			ax[p] = splat(pl[0] < 0 ? -pl[0] : pl[0]);
+			ay[p] = splat(pl[1] < 0 ? -pl[1] : pl[1]);
+			az[p] = splat(pl[2] < 0 ? -pl[2] : pl[2]);
+		}
+	}
+};
+
+// lanes where dist + radius < 0 against plane p
+inline V behind(const planes_v& pl, int p, const V& x, const V& y, const V& z, const V& radius)
+{
+	const V dist = madd(pl.nx[p], x, madd(pl.ny[p], y, madd(pl.nz[p], z, pl.d[p])));
+	return less(dist + radius, splat(0.f));
+}
+inline V behind_box(const planes_v& pl, int p, const V& cx, const V& cy, const V& cz, const V& ex, const V& ey, const V& ez)
+{
+	return behind(pl, p, cx, cy, cz, madd(pl.ax[p], ex, madd(pl.ay[p], ey, pl.az[p] * ez)));
+}
+
+// in holds x, y, z, radius, the six planes are spelled out so they stay unrolled at -O2
+struct sphere_test
+{
+	static constexpr size_t streams = 4;
+	planes_v pl;
+
+	uint32_t operator()(const float* const* in, size_t i) const
+	{
+		const V x = loadv(in[0] + i);
+		const V y = loadv(in[1] + i);
+		const V z = loadv(in[2] + i);
+		const V r = loadv(in[3] + i);
+		const V outside =
+			(behind(pl, 0, x, y, z, r) | behind(pl, 1, x, y, z, r)) |
+			(behind(pl, 2, x, y, z, r) | behind(pl, 3, x, y, z, r)) |
+			(behind(pl, 4, x, y, z, r) | behind(pl, 5, x, y, z, r));
+		return ~mask_bits(outside);
+	}
+};
+// in holds min x, y, z then max x, y, z, tested as center and half extent
+struct aabb_test
+{
+	static constexpr size_t streams = 6;
+	planes_v pl;
+
+	uint32_t operator()(const float* const* in, size_t i) const
+	{
+		const V half = splat(0.5f);
+		const V lx = loadv(in[0] + i);
+		const V ly = loadv(in[1] + i);
+		const V lz = loadv(in[2] + i);
+		const V hx = loadv(in[3] + i);
+		const V hy = loadv(in[4] + i);
+		const V hz = loadv(in[5] + i);
+		const V cx = (lx + hx) * half;
+		const V cy = (ly + hy) * half;
+		const V cz = (lz + hz) * half;
+		const V ex = (hx - lx) * half;
+		const V ey = (hy - ly) * half;
+		const V ez = (hz - lz) * half;
+		const V outside =
+			(behind_box(pl, 0, cx, cy, cz, ex, ey, ez) | behind_box(pl, 1, cx, cy, cz, ex, ey, ez)) |
+			(behind_box(pl, 2, cx, cy, cz, ex, ey, ez) | behind_box(pl, 3, cx, cy, cz, ex, ey, ez)) |
+			(behind_box(pl, 4, cx, cy, cz, ex, ey, ez) | behind_box(pl, 5, cx, cy, cz, ex, ey, ez));
+		return ~mask_bits(outside);
+	}
+};
+
+// one word of bits per 32 elements, the last word is zero padded
+template <typename Test>
+inline void cull_words(const Test& test, const float* const* in, uint32_t* bits, size_t n)
+{
+	constexpr size_t streams = Test::streams;
+	constexpr uint32_t lanes = (1u << V::width) - 1;
+	for (size_t i = 0; i < n; i += 32)
+	{
+		const size_t end = n - i < 32 ? n - i : 32;
+		uint32_t word = 0;
+		size_t k = 0;
+		for (; k + V::width <= end; k += V::width)
+			word |= (test(in, i + k) & lanes) << k;
+		if (k < end)
+		{
+			float pad[streams][V::width] = {};
+			const float* padded[streams];
+			for (size_t s = 0; s < streams; ++s)
+			{
+				for (size_t j = 0; j < end - k; ++j)
+					pad[s][j] = in[s][i + k + j];
+				padded[s] = pad[s];
+			}
+			word |= (test(padded, 0) & ((1u << (end - k)) - 1)) << k;
+		}
+		bits[i / 32] = word;
+	}
+}
+
+inline void cull_spheres_range(const float* planes, const float* const* in, uint32_t* bits, size_t n)
+{
+	cull_words(sphere_test{ planes_v{ planes } }, in, bits, n);
+}
+inline void cull_aabbs_range(const float* planes, const float* const* in, uint32_t* bits, size_t n)
+{
+	cull_words(aabb_test{ planes_v{ planes } }, in, bits, n);
+}
+
+inline cull_table make_table()
+{
+	return cull_table{ &cull_spheres_range, &cull_aabbs_range };
+}
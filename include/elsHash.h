@@ -0,0 +1,65 @@
+#ifndef ELS_HASH
+#define ELS_HASH
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "elsHeader.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+
+namespace els
+{
+	// folds the hash of one more value into seed, same mixing as boost::hash_combine
+	inline size_t hash_combine(size_t seed, size_t value)
+	{
+		return seed ^ (value + static_cast<size_t>(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2));
+	}
+
+	// murmur3 finalizer, every input bit reaches every output bit
+	inline uint64_t hash_mix(uint64_t x)
+	{
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdull;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+} // namespace els
+
+// component wise like operator==, so equal vectors hash the same
+namespace std
+{
+	template <typename T>
+	struct hash<els::Vector2<T>>
+	{
+		size_t operator()(const els::Vector2<T>& v) const noexcept
+		{
+			const hash<T> h;
+			return els::hash_combine(h(v.x), h(v.y));
+		}
+	};
+	template <typename T>
+	struct hash<els::Vector3<T>>
+	{
+		size_t operator()(const els::Vector3<T>& v) const noexcept
+		{
+			const hash<T> h;
+			return els::hash_combine(els::hash_combine(h(v.x), h(v.y)), h(v.z));
+		}
+	};
+	template <typename T>
+	struct hash<els::Vector4<T>>
+	{
+		size_t operator()(const els::Vector4<T>& v) const noexcept
+		{
+			const hash<T> h;
+			return els::hash_combine(els::hash_combine(els::hash_combine(h(v.x), h(v.y)), h(v.z)), h(v.w));
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,307 @@
+#ifndef ELS_HIERARCHY
+#define ELS_HIERARCHY
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "elsHeader.h"
+#include "elsMatrix4.h"
+#include "elsTransform.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// flat transform hierarchy
+	// nodes are kept in depth first order in parallel arrays, so parents precede children
+	// and every subtree is the contiguous slot range [slot, end)
+	// node ids returned by add() are stable, slots are internal and change when nodes are added
+	template <typename T>
+	class TransformHierarchy
+	{
+	public:
+		using Scalar = T;
+		using id_type = uint32_t;
+
+		static constexpr id_type npos = static_cast<id_type>(-1);
+
+	private:
+		// slot order
+		std::vector<Transform<T>> locals;
+		std::vector<id_type> parents;	// parent slot or npos
+		std::vector<id_type> ends;		// one past the last slot of the subtree
+		std::vector<Matrix4<T>> worlds;
+		std::vector<uint8_t> dirty;
+		std::vector<id_type> ids;		// slot -> id
+
+		// id order
+		std::vector<id_type> slots;		// id -> slot
+		std::vector<id_type> parent_ids;
+
+		std::vector<id_type> pending;	// dirty slots
+		bool layout_dirty = false;
+
+		static Matrix4<T> mul_affine(const Matrix4<T>& a, const Matrix4<T>& b);
+
+		void relayout();
+		void update_range(id_type first, id_type last);
+		void collect(std::vector<std::pair<id_type, id_type>>& ranges);
+
+	public:
+		size_t size() const { return ids.size(); }
+		void reserve(size_t n);
+		void clear();
+
+		// parent must be npos or an existing id
+		id_type add(id_type parent, const Transform<T>& local = Transform<T>{});
+
+		id_type parent(id_type id) const { return parent_ids[id]; }
+		const Transform<T>& local(id_type id) const;
+		const Matrix4<T>& world(id_type id) const; // valid after update()
+
+		void set_local(id_type id, const Transform<T>& local);
+		void mark_dirty(id_type id);
+
+		// recomputes world matrices of dirty nodes and their subtrees
+		void update();
+		// same as update, independent dirty subtrees are spread across threads
+		void update_parallel(size_t grain = 4096);
+	};
+
+	// member functions
+	template <typename T>
+	Matrix4<T> TransformHierarchy<T>::mul_affine(const Matrix4<T>& a, const Matrix4<T>& b)
+	{
+		return Matrix4<T>{
+			a.m[0] * b.m[0] + a.m[1] * b.m[4] + a.m[2] * b.m[8],
+				a.m[0] * b.m[1] + a.m[1] * b.m[5] + a.m[2] * b.m[9],
+				a.m[0] * b.m[2] + a.m[1] * b.m[6] + a.m[2] * b.m[10],
+				a.m[0] * b.m[3] + a.m[1] * b.m[7] + a.m[2] * b.m[11] + a.m[3],
+
+				a.m[4] * b.m[0] + a.m[5] * b.m[4] + a.m[6] * b.m[8],
+				a.m[4] * b.m[1] + a.m[5] * b.m[5] + a.m[6] * b.m[9],
+				a.m[4] * b.m[2] + a.m[5] * b.m[6] + a.m[6] * b.m[10],
+				a.m[4] * b.m[3] + a.m[5] * b.m[7] + a.m[6] * b.m[11] + a.m[7],
+
+				a.m[8] * b.m[0] + a.m[9] * b.m[4] + a.m[10] * b.m[8],
+				a.m[8] * b.m[1] + a.m[9] * b.m[5] + a.m[10] * b.m[9],
+				a.m[8] * b.m[2] + a.m[9] * b.m[6] + a.m[10] * b.m[10],
+				a.m[8] * b.m[3] + a.m[9] * b.m[7] + a.m[10] * b.m[11] + a.m[11],
+
+				static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), static_cast<T>(1)
+		};
+	}
+	template <typename T>
+	void TransformHierarchy<T>::reserve(size_t n)
+	{
+		locals.reserve(n);
+		parents.reserve(n);
+		ends.reserve(n);
+		worlds.reserve(n);
+		dirty.reserve(n);
+		ids.reserve(n);
+		slots.reserve(n);
+		parent_ids.reserve(n);
+	}
+	template <typename T>
+	void TransformHierarchy<T>::clear()
+	{
+		locals.clear();
+		parents.clear();
+		ends.clear();
+		worlds.clear();
+		dirty.clear();
+		ids.clear();
+		slots.clear();
+		parent_ids.clear();
+		pending.clear();
+		layout_dirty = false;
+	}
+	template <typename T>
+	typename TransformHierarchy<T>::id_type TransformHierarchy<T>::add(id_type parent, const Transform<T>& local)
+	{
+		const id_type id = static_cast<id_type>(slots.size());
+		const id_type slot = id;
+
+		// appending keeps depth first order only if the parent subtree is the last one
+		if (parent != npos && ends[slots[parent]] != slot)
+			layout_dirty = true;
+
+		parent_ids.push_back(parent);
+		slots.push_back(slot);
+
+		locals.push_back(local);
+		parents.push_back(parent == npos ? npos : slots[parent]);
+		ends.push_back(slot + 1);
+		worlds.push_back(Matrix4<T>::I);
+		dirty.push_back(1);
+		ids.push_back(id);
+		pending.push_back(slot);
+
+		if (!layout_dirty)
+		{
+			for (id_type p = parents[slot]; p != npos; p = parents[p])
+				ends[p] = slot + 1;
+		}
+
+		return id;
+	}
+	template <typename T>
+	const Transform<T>& TransformHierarchy<T>::local(id_type id) const
+	{
+		return locals[slots[id]];
+	}
+	template <typename T>
+	const Matrix4<T>& TransformHierarchy<T>::world(id_type id) const
+	{
+		return worlds[slots[id]];
+	}
+	template <typename T>
+	void TransformHierarchy<T>::set_local(id_type id, const Transform<T>& local)
+	{
+		locals[slots[id]] = local;
+		mark_dirty(id);
+	}
+	template <typename T>
+	void TransformHierarchy<T>::mark_dirty(id_type id)
+	{
+		const id_type slot = slots[id];
+		if (!dirty[slot])
+		{
+			dirty[slot] = 1;
+			pending.push_back(slot);
+		}
+	}
+	template <typename T>
+	void TransformHierarchy<T>::relayout()
+	{
+		const id_type n = static_cast<id_type>(slots.size());
+
+		// ids are ordered parents first, so subtree sizes accumulate in reverse
+		std::vector<id_type> sizes(n, 1);
+		for (id_type id = n; id-- > 0;)
+		{
+			if (parent_ids[id] != npos)
+				sizes[parent_ids[id]] += sizes[id];
+		}
+
+		// preorder slots, each node hands out consecutive ranges to its children
+		std::vector<id_type> next(n);
+		id_type root_next = 0;
+		for (id_type id = 0; id < n; ++id)
+		{
+			const id_type p = parent_ids[id];
+			id_type& cursor = p == npos ? root_next : next[p];
+			slots[id] = cursor;
+			cursor += sizes[id];
+			next[id] = slots[id] + 1;
+		}
+
+		std::vector<Transform<T>> new_locals(n);
+		std::vector<Matrix4<T>> new_worlds(n);
+		std::vector<uint8_t> new_dirty(n);
+		// old slot of each id is found through the previous ids table
+		std::vector<id_type> old_slots(n);
+		for (id_type slot = 0; slot < n; ++slot)
+			old_slots[ids[slot]] = slot;
+
+		for (id_type id = 0; id < n; ++id)
+			ids[slots[id]] = id;
+
+		// gather in new slot order so the writes stay sequential
+		for (id_type s = 0; s < n; ++s)
+		{
+			const id_type id = ids[s];
+			const id_type old = old_slots[id];
+			new_locals[s] = locals[old];
+			new_worlds[s] = worlds[old];
+			new_dirty[s] = dirty[old];
+			parents[s] = parent_ids[id] == npos ? npos : slots[parent_ids[id]];
+			ends[s] = s + sizes[id];
+		}
+
+		locals.swap(new_locals);
+		worlds.swap(new_worlds);
+		dirty.swap(new_dirty);
+
+		pending.clear();
+		for (id_type s = 0; s < n; ++s)
+		{
+			if (dirty[s])
+				pending.push_back(s);
+		}
+
+		layout_dirty = false;
+	}
+	template <typename T>
+	void TransformHierarchy<T>::update_range(id_type first, id_type last)
+	{
+		for (id_type s = first; s < last; ++s)
+		{
+			const id_type p = parents[s];
+			worlds[s] = (p == npos) ? locals[s].matrix() : mul_affine(worlds[p], locals[s].matrix());
+			dirty[s] = 0;
+		}
+	}
+	template <typename T>
+	void TransformHierarchy<T>::collect(std::vector<std::pair<id_type, id_type>>& ranges)
+	{
+		if (layout_dirty)
+			relayout();
+
+		std::sort(pending.begin(), pending.end());
+
+		// dirty slots inside an already collected subtree are covered by it
+		id_type covered = 0;
+		for (id_type s : pending)
+		{
+			if (s < covered)
+				continue;
+			ranges.emplace_back(s, ends[s]);
+			covered = ends[s];
+		}
+		pending.clear();
+	}
+	template <typename T>
+	void TransformHierarchy<T>::update()
+	{
+		std::vector<std::pair<id_type, id_type>> ranges;
+		collect(ranges);
+
+		for (const auto& r : ranges)
+			update_range(r.first, r.second);
+	}
+	template <typename T>
+	void TransformHierarchy<T>::update_parallel(size_t grain)
+	{
+		std::vector<std::pair<id_type, id_type>> ranges;
+		collect(ranges);
+
+		// large subtrees are split at their root so the children can run independently
+		std::vector<std::pair<id_type, id_type>> tasks;
+		tasks.reserve(ranges.size());
+		while (!ranges.empty())
+		{
+			const auto r = ranges.back();
+			ranges.pop_back();
+
+			if (r.second - r.first <= grain)
+			{
+				tasks.push_back(r);
+				continue;
+			}
+
+			update_range(r.first, r.first + 1);
+			for (id_type c = r.first + 1; c < r.second; c = ends[c])
+				ranges.emplace_back(c, ends[c]);
+		}
+
+		parallel::for_range(0, tasks.size(), 1, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					update_range(tasks[i].first, tasks[i].second);
+			});
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef ELS_INTERSECT
+#define ELS_INTERSECT
+
+#include <array>
+#include <cstdint>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsGeometry.h"
+#include "elsRay.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+
+namespace els
+{
+	// woop benthin wald, rays passing through an edge or vertex shared by two triangles hit at least one of them
+	// both sides of the triangle hit, u and v weight b and c like the moller trumbore intersect
+	template <typename T>
+	inline bool intersect_watertight(const Ray<T>& ray, const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c, T& t, T& u, T& v)
+	{
+		// the dominant direction axis becomes z, the shear then takes the ray to the z axis
+		const T dx = abs(ray.direction.x);
+		const T dy = abs(ray.direction.y);
+		const T dz = abs(ray.direction.z);
+		const unsigned int kz = dx >= dy && dx >= dz ? 0 : (dy >= dz ? 1 : 2);
+		const unsigned int kx = kz == 2 ? 0 : kz + 1;
+		const unsigned int ky = kx == 2 ? 0 : kx + 1;
+		const T sz = static_cast<T>(1) / ray.direction[kz];
+		const T sx = ray.direction[kx] * sz;
+		const T sy = ray.direction[ky] * sz;
+
+		const Vector3<T> pa = a - ray.origin;
+		const Vector3<T> pb = b - ray.origin;
+		const Vector3<T> pc = c - ray.origin;
+		const T ax = pa[kx] - sx * pa[kz];
+		const T ay = pa[ky] - sy * pa[kz];
+		const T bx = pb[kx] - sx * pb[kz];
+		const T by = pb[ky] - sy * pb[kz];
+		const T cx = pc[kx] - sx * pc[kz];
+		const T cy = pc[ky] - sy * pc[kz];
+
+		// edge signs compare the two rounded products, a triangle sharing the edge compares the same pair
+		const T u0 = cx * by;
+		const T u1 = cy * bx;
+		const T v0 = ax * cy;
+		const T v1 = ay * cx;
+		const T w0 = bx * ay;
+		const T w1 = by * ax;
+		const bool negative = u0 < u1 || v0 < v1 || w0 < w1;
+		const bool positive = u1 < u0 || v1 < v0 || w1 < w0;
+		if (negative && positive)
+			return false;
+
+		const T eu = u0 - u1;
+		const T ev = v0 - v1;
+		const T ew = w0 - w1;
+		const T det = eu + ev + ew;
+		if (det == 0)
+			return false;
+
+		const T inv_det = static_cast<T>(1) / det;
+		t = (eu * (sz * pa[kz]) + ev * (sz * pb[kz]) + ew * (sz * pc[kz])) * inv_det;
+		u = ev * inv_det;
+		v = ew * inv_det;
+		return t >= ray.t_min && t <= ray.t_max;
+	}
+
+	// struct of arrays views for the packet and many primitive kernels, all spans of one view have the same size
+	// the closest hit kernels shorten t_max in place, start it at the largest distance of interest
+	struct RaySoA
+	{
+		span<const float> origin_x, origin_y, origin_z;
+		span<const float> dir_x, dir_y, dir_z;
+		span<const float> t_min;
+		span<float> t_max;
+	};
+	// primitive and barycentrics of the closest hit per ray, u and v can be left empty
+	struct HitSoA
+	{
+		span<uint32_t> prim;
+		span<float> u, v;
+	};
+	struct TriangleSoA
+	{
+		span<const float> ax, ay, az, bx, by, bz, cx, cy, cz;
+	};
+
+	// returned by the one ray against many primitive kernels when nothing is hit
+	constexpr size_t ray_miss = static_cast<size_t>(-1);
+
+	namespace detail
+	{
+		namespace packet
+		{
+			struct intersect_table
+			{
+				void (*packet_triangle)(const float*, uint32_t, const float* const*, size_t, float*, uint32_t*, float*, float*);
+				void (*packet_triangle_watertight)(const float*, uint32_t, const float* const*, size_t, float*, uint32_t*, float*, float*);
+				void (*packet_sphere)(const float*, uint32_t, const float* const*, size_t, float*, uint32_t*);
+				void (*packet_box)(const float*, const float* const*, size_t, uint32_t*);
+				size_t (*ray_triangles)(const float*, const float* const*, size_t, float&, float&, float&);
+				size_t (*ray_triangles_watertight)(const float*, const float* const*, size_t, float&, float&, float&);
+				size_t (*ray_spheres)(const float*, const float* const*, size_t, float&);
+				void (*ray_boxes)(const float*, const float* const*, size_t, uint32_t*);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsIntersectKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsIntersectKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const intersect_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const intersect_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const intersect_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			struct RayStreams
+			{
+				const float* in[8];
+
+				explicit RayStreams(const RaySoA& rays)
+					: in{ rays.origin_x.data(), rays.origin_y.data(), rays.origin_z.data(),
+						rays.dir_x.data(), rays.dir_y.data(), rays.dir_z.data(), rays.t_min.data(), rays.t_max.data() } {}
+			};
+
+			inline std::array<float, 8> pack_ray(const Ray<float>& ray)
+			{
+				return std::array<float, 8>{ ray.origin.x, ray.origin.y, ray.origin.z,
+					ray.direction.x, ray.direction.y, ray.direction.z, ray.t_min, ray.t_max };
+			}
+		}
+	}
+
+	// packet kernels run 8 rays at a time with avx2 and 4 otherwise on the calling thread, a baker threads over packets
+
+	// rays hitting the triangle closer than their t_max take it as their closest hit
+	inline void raycast(const RaySoA& rays, const Vector3<float>& a, const Vector3<float>& b, const Vector3<float>& c,
+		uint32_t prim, const HitSoA& hits, bool watertight = false)
+	{
+		const float tri[9] = { a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z };
+		const auto& k = detail::packet::kernels();
+		(watertight ? k.packet_triangle_watertight : k.packet_triangle)(tri, prim, detail::packet::RayStreams{ rays }.in,
+			rays.t_max.size(), rays.t_max.data(), hits.prim.data(),
+			hits.u.empty() ? nullptr : hits.u.data(), hits.v.empty() ? nullptr : hits.v.data());
+	}
+	// same for a sphere, u and v are left as they are
+	inline void raycast(const RaySoA& rays, const Sphere<float>& sphere, uint32_t prim, const HitSoA& hits)
+	{
+		const float s[4] = { sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius };
+		detail::packet::kernels().packet_sphere(s, prim, detail::packet::RayStreams{ rays }.in,
+			rays.t_max.size(), rays.t_max.data(), hits.prim.data());
+	}
+	// bit i of hit[i / 32] is set when ray i crosses the box within [t_min, t_max], hit needs (size + 31) / 32 words
+	inline void intersect(const RaySoA& rays, const AABB<float>& box, span<uint32_t> hit)
+	{
+		const float b[6] = { box.min.x, box.min.y, box.min.z, box.max.x, box.max.y, box.max.z };
+		detail::packet::kernels().packet_box(b, detail::packet::RayStreams{ rays }.in, rays.t_max.size(), hit.data());
+	}
+
+	// closest of many triangles, returns its index or ray_miss and leaves ray.t_max at its distance
+	inline size_t raycast(Ray<float>& ray, const TriangleSoA& tris, float& u, float& v, bool watertight = false)
+	{
+		const std::array<float, 8> r = detail::packet::pack_ray(ray);
+		const float* const in[9] = {
+			tris.ax.data(), tris.ay.data(), tris.az.data(),
+			tris.bx.data(), tris.by.data(), tris.bz.data(),
+			tris.cx.data(), tris.cy.data(), tris.cz.data() };
+		const auto& k = detail::packet::kernels();
+		return (watertight ? k.ray_triangles_watertight : k.ray_triangles)(r.data(), in, tris.ax.size(), ray.t_max, u, v);
+	}
+	inline size_t raycast(Ray<float>& ray, const SphereSoA& spheres)
+	{
+		const std::array<float, 8> r = detail::packet::pack_ray(ray);
+		const float* const in[4] = { spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data() };
+		return detail::packet::kernels().ray_spheres(r.data(), in, spheres.x.size(), ray.t_max);
+	}
+	// bit i of hit[i / 32] is set when the ray crosses box i within [t_min, t_max]
+	inline void intersect(const Ray<float>& ray, const AABBSoA& boxes, span<uint32_t> hit)
+	{
+		const std::array<float, 8> r = detail::packet::pack_ray(ray);
+		const float* const in[6] = {
+			boxes.min_x.data(), boxes.min_y.data(), boxes.min_z.data(),
+			boxes.max_x.data(), boxes.max_y.data(), boxes.max_z.data() };
+		detail::packet::kernels().ray_boxes(r.data(), in, boxes.min_x.size(), hit.data());
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,390 @@
+// no include guard, elsIntersect.h includes this once per register width
+// the enclosing namespace provides V, splat(float) and loadv(const float*)
+
+constexpr uint32_t all_lanes = (1u << V::width) - 1;
+
+inline V greater_equal(const V& a, const V& b) { return less_equal(b, a); }
+
+// lanes i to i + width of every stream, the last partial block is copied into zero padded lanes
+template <size_t Streams>
+struct block
+{
+	const float* ptr[Streams];
+	float pad[Streams][V::width];
+	uint32_t lanes;
+
+	block(const float* const* in, size_t i, size_t n)
+	{
+		if (n - i >= V::width)
+		{
+			for (size_t s = 0; s < Streams; ++s)
+				ptr[s] = in[s] + i;
+			lanes = all_lanes;
+			return;
+		}
+		for (size_t s = 0; s < Streams; ++s)
+		{
+			for (size_t j = 0; j < V::width; ++j)
+				pad[s][j] = i + j < n ? in[s][i + j] : 0.f;
+			ptr[s] = pad[s];
+		}
+		lanes = (1u << (n - i)) - 1;
+	}
+	V operator[](size_t s) const { return loadv(ptr[s]); }
+};
+
+// moller trumbore, a is the first vertex and e1, e2 the edges to the other two
+// a zero determinant gives infinities or nans that fail the barycentric range test
+inline V moller_trumbore(const V (&o)[3], const V (&d)[3], const V (&a)[3], const V (&e1)[3], const V (&e2)[3],
+	const V& t_min, const V& t_max, V& t, V& u, V& v)
+{
+	const V px = d[1] * e2[2] - d[2] * e2[1];
+	const V py = d[2] * e2[0] - d[0] * e2[2];
+	const V pz = d[0] * e2[1] - d[1] * e2[0];
+	const V inv_det = splat(1.f) / madd(e1[0], px, madd(e1[1], py, e1[2] * pz));
+
+	const V sx = o[0] - a[0];
+	const V sy = o[1] - a[1];
+	const V sz = o[2] - a[2];
+	u = madd(sx, px, madd(sy, py, sz * pz)) * inv_det;
+
+	const V qx = sy * e1[2] - sz * e1[1];
+	const V qy = sz * e1[0] - sx * e1[2];
+	const V qz = sx * e1[1] - sy * e1[0];
+	v = madd(d[0], qx, madd(d[1], qy, d[2] * qz)) * inv_det;
+	t = madd(e2[0], qx, madd(e2[1], qy, e2[2] * qz)) * inv_det;
+
+	return greater_equal(u, splat(0.f)) & greater_equal(v, splat(0.f)) & less_equal(u + v, splat(1.f)) &
+		greater_equal(t, t_min) & less_equal(t, t_max);
+}
+
+// woop benthin wald on vertices relative to the origin with the dominant ray axis last,
+// s is the shear (dx / dz, dy / dz, 1 / dz) of the permuted direction
+inline V watertight(const V (&a)[3], const V (&b)[3], const V (&c)[3], const V (&s)[3],
+	const V& t_min, const V& t_max, V& t, V& u, V& v)
+{
+	const V ax = a[0] - s[0] * a[2];
+	const V ay = a[1] - s[1] * a[2];
+	const V bx = b[0] - s[0] * b[2];
+	const V by = b[1] - s[1] * b[2];
+	const V cx = c[0] - s[0] * c[2];
+	const V cy = c[1] - s[1] * c[2];
+
+	// edge signs compare the two rounded products, a triangle sharing the edge compares the same pair
+	const V u0 = cx * by;
+	const V u1 = cy * bx;
+	const V v0 = ax * cy;
+	const V v1 = ay * cx;
+	const V w0 = bx * ay;
+	const V w1 = by * ax;
+	const V negative = less(u0, u1) | less(v0, v1) | less(w0, w1);
+	const V positive = less(u1, u0) | less(v1, v0) | less(w1, w0);
+
+	const V eu = u0 - u1;
+	const V ev = v0 - v1;
+	const V ew = w0 - w1;
+	const V det = eu + ev + ew;
+	const V inv_det = splat(1.f) / det;
+	t = madd(eu, s[2] * a[2], madd(ev, s[2] * b[2], ew * (s[2] * c[2]))) * inv_det;
+	u = ev * inv_det;
+	v = ew * inv_det;
+
+	const V miss = (negative & positive) | equal(det, splat(0.f));
+	return select(miss, splat(0.f), greater_equal(t, t_min) & less_equal(t, t_max));
+}
+
+// nearest crossing at or past t_min, the far one when the origin is inside
+inline V sphere_hit(const V (&o)[3], const V (&d)[3], const V (&center)[3], const V& radius,
+	const V& t_min, const V& t_max, V& t)
+{
+	const V ox = o[0] - center[0];
+	const V oy = o[1] - center[1];
+	const V oz = o[2] - center[2];
+	const V a = madd(d[0], d[0], madd(d[1], d[1], d[2] * d[2]));
+	const V half_b = madd(ox, d[0], madd(oy, d[1], oz * d[2]));
+	const V c = madd(ox, ox, madd(oy, oy, oz * oz)) - radius * radius;
+	const V disc = half_b * half_b - a * c;
+	const V root = sqrt(max(disc, splat(0.f)));
+	const V near = (splat(0.f) - half_b - root) / a;
+	const V far = (root - half_b) / a;
+	t = select(greater_equal(near, t_min), near, far);
+	return greater_equal(disc, splat(0.f)) & greater_equal(t, t_min) & less_equal(t, t_max);
+}
+
+inline V slab_hit(const V (&o)[3], const V (&inv)[3], const V (&lo)[3], const V (&hi)[3], const V& t_min, const V& t_max)
+{
+	const V x0 = (lo[0] - o[0]) * inv[0];
+	const V x1 = (hi[0] - o[0]) * inv[0];
+	const V y0 = (lo[1] - o[1]) * inv[1];
+	const V y1 = (hi[1] - o[1]) * inv[1];
+	const V z0 = (lo[2] - o[2]) * inv[2];
+	const V z1 = (hi[2] - o[2]) * inv[2];
+	const V t0 = max(max(min(x0, x1), min(y0, y1)), max(min(z0, z1), t_min));
+	const V t1 = min(min(max(x0, x1), max(y0, y1)), min(max(z0, z1), t_max));
+	return less_equal(t0, t1);
+}
+
+// per lane version of the scalar axis choice, m0 and m1 mark lanes whose dominant axis is x or y
+inline void permute(const V& m0, const V& m1, const V& x, const V& y, const V& z, V (&out)[3])
+{
+	out[0] = select(m0, y, select(m1, z, x));
+	out[1] = select(m0, z, select(m1, x, y));
+	out[2] = select(m0, x, select(m1, y, z));
+}
+
+// rays hold origin xyz, direction xyz, t_min and t_max, one lane each
+struct ray_lanes
+{
+	V o[3], d[3], t_min, t_max;
+
+	explicit ray_lanes(const block<8>& r)
+		: o{ r[0], r[1], r[2] }, d{ r[3], r[4], r[5] }, t_min{ r[6] }, t_max{ r[7] } {}
+};
+
+// writes hit lanes back to the packet
+inline void store_hits(uint32_t bits, size_t i, uint32_t prim, const V& t, const V& u, const V& v,
+	float* t_max, uint32_t* prims, float* us, float* vs)
+{
+	float tt[V::width], uu[V::width], vv[V::width];
+	store(tt, t);
+	store(uu, u);
+	store(vv, v);
+	while (bits)
+	{
+		const int j = simd::lowest_bit(bits);
+		t_max[i + j] = tt[j];
+		prims[i + j] = prim;
+		if (us)
+			us[i + j] = uu[j];
+		if (vs)
+			vs[i + j] = vv[j];
+		bits &= bits - 1;
+	}
+}
+
+// tri holds a, b, c
+template <bool Watertight>
+inline void packet_triangle(const float* tri, uint32_t prim, const float* const* rays, size_t n,
+	float* t_max, uint32_t* prims, float* us, float* vs)
+{
+	const V a[3] = { splat(tri[0]), splat(tri[1]), splat(tri[2]) };
+	const V b[3] = { splat(tri[3]), splat(tri[4]), splat(tri[5]) };
+	const V c[3] = { splat(tri[6]), splat(tri[7]), splat(tri[8]) };
+	const V e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	const V e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<8> r(rays, i, n);
+		const ray_lanes ray(r);
+		V t, u, v, hit;
+		if (Watertight)
+		{
+			const V dx = abs(ray.d[0]);
+			const V dy = abs(ray.d[1]);
+			const V dz = abs(ray.d[2]);
+			const V m0 = greater_equal(dx, dy) & greater_equal(dx, dz);
+			const V m1 = select(m0, splat(0.f), greater_equal(dy, dz));
+
+			V d[3], pa[3], pb[3], pc[3];
+			permute(m0, m1, ray.d[0], ray.d[1], ray.d[2], d);
+			permute(m0, m1, a[0] - ray.o[0], a[1] - ray.o[1], a[2] - ray.o[2], pa);
+			permute(m0, m1, b[0] - ray.o[0], b[1] - ray.o[1], b[2] - ray.o[2], pb);
+			permute(m0, m1, c[0] - ray.o[0], c[1] - ray.o[1], c[2] - ray.o[2], pc);
+			const V sz = splat(1.f) / d[2];
+			const V s[3] = { d[0] * sz, d[1] * sz, sz };
+			hit = watertight(pa, pb, pc, s, ray.t_min, ray.t_max, t, u, v);
+		}
+		else
+			hit = moller_trumbore(ray.o, ray.d, a, e1, e2, ray.t_min, ray.t_max, t, u, v);
+
+		const uint32_t bits = mask_bits(hit) & r.lanes;
+		if (bits)
+			store_hits(bits, i, prim, t, u, v, t_max, prims, us, vs);
+	}
+}
+
+// sphere holds center and radius
+inline void packet_sphere(const float* sphere, uint32_t prim, const float* const* rays, size_t n,
+	float* t_max, uint32_t* prims)
+{
+	const V center[3] = { splat(sphere[0]), splat(sphere[1]), splat(sphere[2]) };
+	const V radius = splat(sphere[3]);
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<8> r(rays, i, n);
+		const ray_lanes ray(r);
+		V t;
+		const uint32_t bits = mask_bits(sphere_hit(ray.o, ray.d, center, radius, ray.t_min, ray.t_max, t)) & r.lanes;
+		if (bits)
+			store_hits(bits, i, prim, t, t, t, t_max, prims, nullptr, nullptr);
+	}
+}
+
+// box holds min and max, one bit per ray like the culling masks
+inline void packet_box(const float* box, const float* const* rays, size_t n, uint32_t* bits)
+{
+	const V lo[3] = { splat(box[0]), splat(box[1]), splat(box[2]) };
+	const V hi[3] = { splat(box[3]), splat(box[4]), splat(box[5]) };
+	for (size_t w = 0; w * 32 < n; ++w)
+		bits[w] = 0;
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<8> r(rays, i, n);
+		const ray_lanes ray(r);
+		const V inv[3] = { splat(1.f) / ray.d[0], splat(1.f) / ray.d[1], splat(1.f) / ray.d[2] };
+		bits[i / 32] |= (mask_bits(slab_hit(ray.o, inv, lo, hi, ray.t_min, ray.t_max)) & r.lanes) << (i % 32);
+	}
+}
+
+// lane with the smallest distance among the hit bits, the lowest one on ties
+inline size_t nearest_lane(uint32_t bits, const V& t, float& t_lane)
+{
+	float tt[V::width];
+	store(tt, t);
+	size_t lane = static_cast<size_t>(simd::lowest_bit(bits));
+	bits &= bits - 1;
+	while (bits)
+	{
+		const size_t j = static_cast<size_t>(simd::lowest_bit(bits));
+		lane = tt[j] < tt[lane] ? j : lane;
+		bits &= bits - 1;
+	}
+	t_lane = tt[lane];
+	return lane;
+}
+
+// ray holds origin, direction, t_min and t_max, tris holds a, b, c as nine streams
+// returns the nearest triangle or npos with its distance and barycentrics
+template <bool Watertight>
+inline size_t ray_triangles(const float* ray, const float* const* tris, size_t n, float& t_out, float& u_out, float& v_out)
+{
+	const V o[3] = { splat(ray[0]), splat(ray[1]), splat(ray[2]) };
+	const V d[3] = { splat(ray[3]), splat(ray[4]), splat(ray[5]) };
+	const V t_min = splat(ray[6]);
+	float best = ray[7];
+	size_t found = static_cast<size_t>(-1);
+
+	// the watertight axis choice is the same for every triangle, so it reorders the streams instead of the lanes
+	const float* streams[9];
+	float origin[3] = { ray[0], ray[1], ray[2] };
+	V s[3];
+	if (Watertight)
+	{
+		const float dx = ray[3] < 0 ? -ray[3] : ray[3];
+		const float dy = ray[4] < 0 ? -ray[4] : ray[4];
+		const float dz = ray[5] < 0 ? -ray[5] : ray[5];
+		const int kz = dx >= dy && dx >= dz ? 0 : (dy >= dz ? 1 : 2);
+		const int kx = kz == 2 ? 0 : kz + 1;
+		const int ky = kx == 2 ? 0 : kx + 1;
+		for (int v = 0; v < 3; ++v)
+		{
+			streams[v * 3 + 0] = tris[v * 3 + kx];
+			streams[v * 3 + 1] = tris[v * 3 + ky];
+			streams[v * 3 + 2] = tris[v * 3 + kz];
+		}
+		origin[0] = ray[kx];
+		origin[1] = ray[ky];
+		origin[2] = ray[kz];
+		const float sz = 1.f / ray[3 + kz];
+		s[0] = splat(ray[3 + kx] * sz);
+		s[1] = splat(ray[3 + ky] * sz);
+		s[2] = splat(sz);
+	}
+	else
+	{
+		for (int k = 0; k < 9; ++k)
+			streams[k] = tris[k];
+	}
+	const V po[3] = { splat(origin[0]), splat(origin[1]), splat(origin[2]) };
+
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<9> b(streams, i, n);
+		const V t_max = splat(best);
+		V t, u, v, hit;
+		if (Watertight)
+		{
+			const V pa[3] = { b[0] - po[0], b[1] - po[1], b[2] - po[2] };
+			const V pb[3] = { b[3] - po[0], b[4] - po[1], b[5] - po[2] };
+			const V pc[3] = { b[6] - po[0], b[7] - po[1], b[8] - po[2] };
+			hit = watertight(pa, pb, pc, s, t_min, t_max, t, u, v);
+		}
+		else
+		{
+			const V a[3] = { b[0], b[1], b[2] };
+			const V e1[3] = { b[3] - a[0], b[4] - a[1], b[5] - a[2] };
+			const V e2[3] = { b[6] - a[0], b[7] - a[1], b[8] - a[2] };
+			hit = moller_trumbore(o, d, a, e1, e2, t_min, t_max, t, u, v);
+		}
+
+		const uint32_t bits = mask_bits(hit) & b.lanes;
+		if (!bits)
+			continue;
+		// every hit lane is within best, so only ties with an earlier block are left out
+		float t_lane;
+		const size_t lane = nearest_lane(bits, t, t_lane);
+		if (found != static_cast<size_t>(-1) && !(t_lane < best))
+			continue;
+		float uu[V::width], vv[V::width];
+		store(uu, u);
+		store(vv, v);
+		best = t_lane;
+		found = i + lane;
+		u_out = uu[lane];
+		v_out = vv[lane];
+	}
+	t_out = best;
+	return found;
+}
+
+// spheres holds center and radius as four streams
+inline size_t ray_spheres(const float* ray, const float* const* spheres, size_t n, float& t_out)
+{
+	const V o[3] = { splat(ray[0]), splat(ray[1]), splat(ray[2]) };
+	const V d[3] = { splat(ray[3]), splat(ray[4]), splat(ray[5]) };
+	const V t_min = splat(ray[6]);
+	float best = ray[7];
+	size_t found = static_cast<size_t>(-1);
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<4> b(spheres, i, n);
+		const V center[3] = { b[0], b[1], b[2] };
+		V t;
+		const uint32_t bits = mask_bits(sphere_hit(o, d, center, b[3], t_min, splat(best), t)) & b.lanes;
+		if (!bits)
+			continue;
+		float t_lane;
+		const size_t lane = nearest_lane(bits, t, t_lane);
+		if (found != static_cast<size_t>(-1) && !(t_lane < best))
+			continue;
+		best = t_lane;
+		found = i + lane;
+	}
+	t_out = best;
+	return found;
+}
+
+// boxes holds min and max as six streams, one bit per box
+inline void ray_boxes(const float* ray, const float* const* boxes, size_t n, uint32_t* bits)
+{
+	const V o[3] = { splat(ray[0]), splat(ray[1]), splat(ray[2]) };
+	const V inv[3] = { splat(1.f / ray[3]), splat(1.f / ray[4]), splat(1.f / ray[5]) };
+	const V t_min = splat(ray[6]);
+	const V t_max = splat(ray[7]);
+	for (size_t w = 0; w * 32 < n; ++w)
+		bits[w] = 0;
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const block<6> b(boxes, i, n);
+		const V lo[3] = { b[0], b[1], b[2] };
+		const V hi[3] = { b[3], b[4], b[5] };
+		bits[i / 32] |= (mask_bits(slab_hit(o, inv, lo, hi, t_min, t_max)) & b.lanes) << (i % 32);
+	}
+}
+
+inline intersect_table make_table()
+{
+	return intersect_table{
+		&packet_triangle<false>, &packet_triangle<true>, &packet_sphere, &packet_box,
+		&ray_triangles<false>, &ray_triangles<true>, &ray_spheres, &ray_boxes };
+}
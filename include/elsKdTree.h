@@ -0,0 +1,450 @@
+#ifndef ELS_KD_TREE
+#define ELS_KD_TREE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// queries per worker chunk for the batched queries
+	constexpr size_t kd_tree_query_grain = 1024;
+	// slots per worker part when one split is shared by every thread
+	constexpr size_t kd_tree_split_grain = 1 << 16;
+
+	namespace detail
+	{
+		namespace kd_tree
+		{
+			// moves the k-th smallest key of refs[0, n) to refs[k], no key before it is larger and none after it smaller
+			// sampled pivots cut out a band around rank k on all threads, only that band is left to nth_element
+			template <typename Ref, typename Key>
+			inline void select(Ref* refs, size_t n, size_t k, Key key)
+			{
+				using T = decltype(key(refs[0]));
+				const auto less = [&key](const Ref& a, const Ref& b) { return key(a) < key(b); };
+				// 4096 samples keep the band near 6% of the range, the rank of the median falls outside it at 4 sigma
+				constexpr size_t samples = 4096;
+				constexpr size_t margin = 128;
+				if (n < 4 * samples)
+				{
+					std::nth_element(refs, refs + k, refs + n, less);
+					return;
+				}
+				std::vector<T> sample(samples);
+				for (size_t i = 0; i < samples; ++i)
+					sample[i] = key(refs[i * (n / samples)]);
+				std::sort(sample.begin(), sample.end());
+				const size_t at = min(k / (n / samples), samples - 1);
+				const T lo = sample[at > margin ? at - margin : 0];
+				const T hi = sample[min(at + margin, samples - 1)];
+
+				// below lo, inside [lo, hi] and above hi, counted per part
+				const size_t parts = min(parallel::thread_count(), max<size_t>(n / kd_tree_split_grain, 1));
+				const auto slice = [n, parts](size_t part) { return n * part / parts; };
+				const auto band = [&key, lo, hi](const Ref& r) -> unsigned int { const T v = key(r); return v < lo ? 0 : (v > hi ? 2 : 1); };
+				std::vector<size_t> counts(parts * 3, 0);
+				parallel::for_range(0, parts, 1, [&](size_t first, size_t last)
+					{
+						for (size_t part = first; part < last; ++part)
+						{
+							size_t c[3] = {};
+							for (size_t i = slice(part), end = slice(part + 1); i < end; ++i)
+								++c[band(refs[i])];
+							std::copy(c, c + 3, counts.data() + part * 3);
+						}
+					});
+				size_t total[3] = {};
+				for (size_t part = 0; part < parts; ++part)
+					for (unsigned int c = 0; c < 3; ++c)
+						total[c] += counts[part * 3 + c];
+				// an unlucky sample, or keys that are not comparable
+				if (total[0] > k || total[0] + total[1] <= k)
+				{
+					std::nth_element(refs, refs + k, refs + n, less);
+					return;
+				}
+
+				// band major offsets, then every part scatters its own slice
+				std::vector<size_t> offsets(parts * 3);
+				size_t sum = 0;
+				for (unsigned int c = 0; c < 3; ++c)
+				{
+					for (size_t part = 0; part < parts; ++part)
+					{
+						offsets[part * 3 + c] = sum;
+						sum += counts[part * 3 + c];
+					}
+				}
+				std::vector<Ref> scratch(n);
+				parallel::for_range(0, parts, 1, [&](size_t first, size_t last)
+					{
+						for (size_t part = first; part < last; ++part)
+						{
+							size_t o[3] = { offsets[part * 3], offsets[part * 3 + 1], offsets[part * 3 + 2] };
+							for (size_t i = slice(part), end = slice(part + 1); i < end; ++i)
+								scratch[o[band(refs[i])]++] = refs[i];
+						}
+					});
+				parallel::for_range(0, n, kd_tree_split_grain, [&](size_t first, size_t last)
+					{
+						std::copy(scratch.begin() + first, scratch.begin() + last, refs + first);
+					});
+				std::nth_element(refs + total[0], refs + k, refs + total[0] + total[1], less);
+			}
+		}
+	}
+
+	// balanced kd tree over a static point set, split at the median so it needs no node pointers
+	// node i has children 2i + 1 and 2i + 2, the root covers every slot and each node halves its range
+	// ranges of at most leaf_size slots are leaves, only the split of every interior node is stored
+	template <typename T>
+	class KdTree
+	{
+	public:
+		using Scalar = T;
+		using index_type = uint32_t;
+
+		static constexpr index_type npos = static_cast<index_type>(-1);
+
+		struct Neighbor
+		{
+			index_type index = npos;
+			Scalar distance2 = std::numeric_limits<Scalar>::max();
+		};
+
+	private:
+		std::vector<Vector3<T>> points;	// slot order
+		std::vector<index_type> order;	// slot -> point
+		std::vector<T> splits;
+		std::vector<uint8_t> axes;
+		size_t leaf_size = 8;
+
+		// node and the slots it covers, plus a lower bound of the distance to them
+		struct Entry
+		{
+			uint32_t node, begin, end;
+			T d2;
+		};
+		// interior nodes take at most 32 levels for uint32_t slots
+		static constexpr size_t max_depth = 33;
+
+		// fn(slot) for every slot of the leaves closer than bound(), the bound may shrink along the way
+		template <typename Bound, typename Fn>
+		void search(const Vector3<T>& p, Bound&& bound, Fn&& fn) const;
+
+	public:
+		size_t size() const { return order.size(); }
+		bool empty() const { return order.empty(); }
+		size_t node_count() const { return splits.size(); }
+		// bytes held by the tree, sizeof(Vector3<T>) + 4 per point plus at most (sizeof(T) + 1) * 2 / leaf_size
+		size_t memory_bytes() const;
+		void clear();
+
+		// while a level has fewer nodes than threads each median split runs on all threads,
+		// below that every subtree is a task of its own
+		void build(span<const Vector3<T>> input, size_t leaf_size = 8);
+
+		// fn(index, distance2) for every point within radius of p
+		template <typename Fn>
+		void query(const Vector3<T>& p, Scalar radius, Fn&& fn) const;
+		// fills out with up to out.size() nearest points within max_distance, closest first, returns the count
+		size_t nearest(const Vector3<T>& p, span<Neighbor> out, Scalar max_distance = std::numeric_limits<Scalar>::max()) const;
+
+		// batched versions spread across threads, fn is called concurrently
+		template <typename Fn>
+		void query(span<const Vector3<T>> queries, Scalar radius, Fn&& fn) const; // fn(query, index, distance2)
+		// k neighbours per query in out[query * k, query * k + k), missing ones are left as Neighbor{}
+		void nearest(span<const Vector3<T>> queries, size_t k, span<Neighbor> out, Scalar max_distance = std::numeric_limits<Scalar>::max()) const;
+	};
+
+	// typedefs
+	using kd_treef = KdTree<float>;
+	using kd_tree = KdTree<defaultType>;
+
+	// member functions
+	template <typename T>
+	size_t KdTree<T>::memory_bytes() const
+	{
+		return points.capacity() * sizeof(Vector3<T>) + order.capacity() * sizeof(index_type) +
+			splits.capacity() * sizeof(T) + axes.capacity() * sizeof(uint8_t);
+	}
+	template <typename T>
+	void KdTree<T>::clear()
+	{
+		points.clear();
+		order.clear();
+		splits.clear();
+		axes.clear();
+	}
+
+	template <typename T>
+	void KdTree<T>::build(span<const Vector3<T>> input, size_t leaf)
+	{
+		clear();
+		leaf_size = leaf ? leaf : 1;
+		const size_t n = input.size();
+		if (n == 0)
+			return;
+
+		// ranges at level d hold at most ceil(n / 2^d) slots, so every node below depth levels is a leaf
+		size_t levels = 0;
+		while (((n - 1) >> levels) + 1 > leaf_size)
+			++levels;
+		splits.assign((size_t(1) << levels) - 1, static_cast<T>(0));
+		axes.assign(splits.size(), 0);
+
+		struct Ref
+		{
+			Vector3<T> point;
+			index_type index;
+		};
+		std::vector<Ref> refs(n);
+		parallel::for_range(0, n, kd_tree_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					refs[i] = Ref{ input[i], static_cast<index_type>(i) };
+			});
+
+		// the widest extent of a node split at its median, a wide node shares the work with every thread
+		const auto split = [&](size_t node, uint32_t b, uint32_t e, bool wide)
+		{
+			Vector3<T> lo{ std::numeric_limits<T>::max() };
+			Vector3<T> hi{ std::numeric_limits<T>::lowest() };
+			const auto bounds = [&](size_t first, size_t last, Vector3<T>& l, Vector3<T>& h)
+			{
+				for (size_t s = first; s < last; ++s)
+				{
+					const Vector3<T>& q = refs[s].point;
+					for (unsigned int d = 0; d < 3; ++d)
+					{
+						l[d] = q[d] < l[d] ? q[d] : l[d];
+						h[d] = q[d] > h[d] ? q[d] : h[d];
+					}
+				}
+			};
+			if (wide)
+			{
+				std::mutex lock;
+				parallel::for_range(b, e, kd_tree_split_grain, [&](size_t first, size_t last)
+					{
+						Vector3<T> l{ std::numeric_limits<T>::max() };
+						Vector3<T> h{ std::numeric_limits<T>::lowest() };
+						bounds(first, last, l, h);
+						std::lock_guard<std::mutex> guard(lock);
+						for (unsigned int d = 0; d < 3; ++d)
+						{
+							lo[d] = l[d] < lo[d] ? l[d] : lo[d];
+							hi[d] = h[d] > hi[d] ? h[d] : hi[d];
+						}
+					});
+			}
+			else
+				bounds(b, e, lo, hi);
+			const Vector3<T> extent = hi - lo;
+			const unsigned int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+			const uint32_t mid = b + (e - b) / 2;
+			if (wide)
+				detail::kd_tree::select(refs.data() + b, e - b, mid - b, [axis](const Ref& r) { return r.point[axis]; });
+			else
+			{
+				std::nth_element(refs.begin() + b, refs.begin() + mid, refs.begin() + e, [axis](const Ref& x, const Ref& y)
+					{
+						return x.point[axis] < y.point[axis];
+					});
+			}
+
+			splits[node] = refs[mid].point[axis];
+			axes[node] = static_cast<uint8_t>(axis);
+			return mid;
+		};
+
+		// slot ranges of the current level, a leaf passes on empty ranges
+		// node i of a level with count nodes is count - 1 + i, its children are 2i + 1 and 2i + 2
+		const size_t threads = parallel::thread_count();
+		std::vector<uint32_t> ranges{ 0, static_cast<uint32_t>(n) };
+		std::vector<uint32_t> next;
+		size_t level = 0;
+		for (; level < levels && (size_t(1) << level) < threads; ++level)
+		{
+			const size_t count = ranges.size() / 2;
+			next.assign(4 * count, 0);
+			for (size_t j = 0; j < count; ++j)
+			{
+				const uint32_t b = ranges[2 * j];
+				const uint32_t e = ranges[2 * j + 1];
+				if (e - b <= leaf_size)
+					continue;
+				const uint32_t mid = split(count - 1 + j, b, e, e - b >= 2 * kd_tree_split_grain);
+				next[4 * j + 0] = b;
+				next[4 * j + 1] = mid;
+				next[4 * j + 2] = mid;
+				next[4 * j + 3] = e;
+			}
+			ranges.swap(next);
+		}
+
+		// the subtrees run to their leaves without waiting on each other
+		if (level < levels)
+		{
+			struct Task
+			{
+				size_t node;
+				uint32_t b, e;
+			};
+			const size_t count = ranges.size() / 2;
+			parallel::for_range(0, count, 1, [&](size_t first, size_t last)
+				{
+					std::vector<Task> stack;
+					for (size_t j = first; j < last; ++j)
+					{
+						stack.push_back(Task{ count - 1 + j, ranges[2 * j], ranges[2 * j + 1] });
+						while (!stack.empty())
+						{
+							const Task t = stack.back();
+							stack.pop_back();
+							// levels was picked so that only leaves are left below the last one
+							if (t.e - t.b <= leaf_size)
+								continue;
+							const uint32_t mid = split(t.node, t.b, t.e, false);
+							stack.push_back(Task{ 2 * t.node + 2, mid, t.e });
+							stack.push_back(Task{ 2 * t.node + 1, t.b, mid });
+						}
+					}
+				});
+		}
+
+		points.resize(n);
+		order.resize(n);
+		parallel::for_range(0, n, kd_tree_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t s = first; s < last; ++s)
+				{
+					points[s] = refs[s].point;
+					order[s] = refs[s].index;
+				}
+			});
+	}
+
+	template <typename T>
+	template <typename Bound, typename Fn>
+	void KdTree<T>::search(const Vector3<T>& p, Bound&& bound, Fn&& fn) const
+	{
+		if (empty())
+			return;
+
+		Entry stack[max_depth];
+		size_t top = 0;
+		stack[top++] = Entry{ 0, 0, static_cast<uint32_t>(size()), static_cast<T>(0) };
+		while (top)
+		{
+			Entry e = stack[--top];
+			if (e.d2 > bound())
+				continue;
+
+			// down to the leaf on the side of p, the other sides wait with the distance to their split
+			while (e.end - e.begin > leaf_size)
+			{
+				const T diff = p[axes[e.node]] - splits[e.node];
+				const uint32_t mid = e.begin + (e.end - e.begin) / 2;
+				const T d2 = max(e.d2, diff * diff);
+				if (diff < 0)
+				{
+					stack[top++] = Entry{ 2 * e.node + 2, mid, e.end, d2 };
+					e = Entry{ 2 * e.node + 1, e.begin, mid, e.d2 };
+				}
+				else
+				{
+					stack[top++] = Entry{ 2 * e.node + 1, e.begin, mid, d2 };
+					e = Entry{ 2 * e.node + 2, mid, e.end, e.d2 };
+				}
+			}
+			for (uint32_t s = e.begin; s < e.end; ++s)
+				fn(s);
+		}
+	}
+
+	template <typename T>
+	template <typename Fn>
+	void KdTree<T>::query(const Vector3<T>& p, Scalar radius, Fn&& fn) const
+	{
+		const Scalar r2 = radius * radius;
+		search(p, [r2]() { return r2; }, [&](uint32_t s)
+			{
+				const Scalar d2 = points[s].distance2(p);
+				if (d2 <= r2)
+					fn(order[s], d2);
+			});
+	}
+
+	template <typename T>
+	size_t KdTree<T>::nearest(const Vector3<T>& p, span<Neighbor> out, Scalar max_distance) const
+	{
+		const size_t k = out.size();
+		if (k == 0)
+			return 0;
+
+		// max heap on the distance until it is full, then the top is the one to beat
+		const Scalar limit2 = max_distance < std::sqrt(std::numeric_limits<Scalar>::max()) ? max_distance * max_distance : std::numeric_limits<Scalar>::max();
+		const auto closer = [](const Neighbor& a, const Neighbor& b)
+		{
+			return a.distance2 < b.distance2 || (a.distance2 == b.distance2 && a.index < b.index);
+		};
+		Neighbor* heap = out.data();
+		size_t count = 0;
+		search(p, [&]() { return count < k ? limit2 : heap[0].distance2; }, [&](uint32_t s)
+			{
+				const Neighbor candidate{ order[s], points[s].distance2(p) };
+				if (count < k)
+				{
+					if (candidate.distance2 > limit2)
+						return;
+					heap[count++] = candidate;
+					std::push_heap(heap, heap + count, closer);
+				}
+				else if (closer(candidate, heap[0]))
+				{
+					std::pop_heap(heap, heap + k, closer);
+					heap[k - 1] = candidate;
+					std::push_heap(heap, heap + k, closer);
+				}
+			});
+		std::sort_heap(heap, heap + count, closer);
+		return count;
+	}
+
+	template <typename T>
+	template <typename Fn>
+	void KdTree<T>::query(span<const Vector3<T>> queries, Scalar radius, Fn&& fn) const
+	{
+		parallel::for_range(0, queries.size(), kd_tree_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t q = first; q < last; ++q)
+					query(queries[q], radius, [&](index_type i, Scalar d2) { fn(q, i, d2); });
+			});
+	}
+	template <typename T>
+	void KdTree<T>::nearest(span<const Vector3<T>> queries, size_t k, span<Neighbor> out, Scalar max_distance) const
+	{
+		parallel::for_range(0, queries.size(), kd_tree_query_grain, [&](size_t first, size_t last)
+			{
+				for (size_t q = first; q < last; ++q)
+				{
+					const span<Neighbor> row(out.data() + q * k, k);
+					for (size_t i = nearest(queries[q], row, max_distance); i < k; ++i)
+						row[i] = Neighbor{};
+				}
+			});
+	}
+
+} // namespace els
+
+#endif
@@ -4,6 +4,8 @@
 #pragma once
 
 #include <cmath>
+#include <limits>
+#include <type_traits>
 
 #include "elsHeader.h"
 
@@ -27,6 +29,27 @@ namespace els
 	template<typename T>
 	constexpr T epsilon2 = epsilon<T> *epsilon<T>;
 
+	// types the vector, matrix and quaternion templates accept as scalars
+	// arithmetic types plus whatever specializes it, like Fixed
+	template <typename T>
+	struct is_scalar : std::is_arithmetic<T> {};
+	template <typename T>
+	constexpr bool is_scalar_v = is_scalar<T>::value;
+
+	// true while the caller is being constant evaluated
+	// without compiler support it reports false, so run time paths are kept and
+	// constant evaluation of them fails to compile instead of silently running slow fallbacks
+	constexpr bool is_constant_evaluated() noexcept
+	{
+#if defined(__cpp_lib_is_constant_evaluated)
+		return std::is_constant_evaluated();
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+		return __builtin_is_constant_evaluated();
+#else
+		return false;
+#endif
+	}
+
 	template<size_t I, size_t E>
 	constexpr size_t pow_i()
 	{
@@ -46,30 +69,456 @@ namespace els
 	}
 
 
+	namespace detail
+	{
+		// constant evaluation fallbacks of the <cmath> functions, only used while the compiler folds an expression
+		// computed in double (long double for long double) and rounded once, float results are within 1 ulp of <cmath>,
+		// double results within a few ulp except pow with a fractional exponent (about 30 ulp)
+		// sin/cos/tan reduce the argument with a two part pi/2 and lose accuracy past |x| ~ 1e9
+		namespace ce
+		{
+			template <typename T>
+			using wide = std::conditional_t<std::is_same<T, long double>::value, long double, double>;
+
+			template <typename T>
+			constexpr bool is_nan(T x) { return x != x; }
+			template <typename T>
+			constexpr bool is_inf(T x) { return x == std::numeric_limits<T>::infinity() || x == -std::numeric_limits<T>::infinity(); }
+			template <typename T>
+			constexpr T nan() { return std::numeric_limits<T>::quiet_NaN(); }
+			template <typename T>
+			constexpr T inf() { return std::numeric_limits<T>::infinity(); }
+
+			// wide to narrow without the undefined out of range conversion
+			template <typename T, typename W>
+			constexpr T narrow(W x)
+			{
+				if (x > static_cast<W>(std::numeric_limits<T>::max()))
+					return inf<T>();
+				if (x < -static_cast<W>(std::numeric_limits<T>::max()))
+					return -inf<T>();
+				return static_cast<T>(x);
+			}
+
+			template <typename T>
+			constexpr T abs(T x) { return x < 0 ? -x : x; }
+
+			// values past 2^62 have no fractional part
+			template <typename T>
+			constexpr T trunc(T x)
+			{
+				if (is_nan(x) || abs(x) >= static_cast<T>(4.6e18))
+					return x;
+				return static_cast<T>(static_cast<long long>(x));
+			}
+			template <typename T>
+			constexpr T floor(T x)
+			{
+				const T t = trunc(x);
+				return t > x ? t - 1 : t;
+			}
+			template <typename T>
+			constexpr T ceil(T x)
+			{
+				const T t = trunc(x);
+				return t < x ? t + 1 : t;
+			}
+			// halfway cases away from zero
+			template <typename T>
+			constexpr T round(T x)
+			{
+				const T t = trunc(x);
+				if (abs(x - t) >= static_cast<T>(0.5))
+					return x < 0 ? t - 1 : t + 1;
+				return t;
+			}
+
+			// x * 2^e
+			template <typename T>
+			constexpr T ldexp(T x, long long e)
+			{
+				for (; e > 0; --e)
+					x *= 2;
+				for (; e < 0; ++e)
+					x *= static_cast<T>(0.5);
+				return x;
+			}
+
+			// exact, the divisor is scaled by powers of two and subtracted like a long division
+			template <typename T>
+			constexpr T fmod(T y, T x)
+			{
+				if (is_nan(y) || is_nan(x) || is_inf(y) || x == 0)
+					return nan<T>();
+				T a = abs(y);
+				const T b = abs(x);
+				if (a < b)
+					return y;
+				T d = b;
+				while (d <= a / 2)
+					d *= 2;
+				for (; d >= b; d /= 2)
+				{
+					if (a >= d)
+						a -= d;
+				}
+				return y < 0 ? -a : a;
+			}
+
+			template <typename T>
+			constexpr T sqrt(T x)
+			{
+				if (is_nan(x) || x < 0)
+					return nan<T>();
+				if (x == 0 || is_inf(x))
+					return x;
+
+				using W = wide<T>;
+				// bring x into [0.25, 4] so a handful of newton steps from 1 converge
+				W v = x;
+				W scale = 1;
+				while (v > 4) { v *= static_cast<W>(0.25); scale *= 2; }
+				while (v < static_cast<W>(0.25)) { v *= 4; scale *= static_cast<W>(0.5); }
+
+				W r = 1;
+				for (int i = 0; i < 8; ++i)
+					r = static_cast<W>(0.5) * (r + v / r);
+				return static_cast<T>(r * scale);
+			}
+
+			// taylor series on [-pi/4, pi/4]
+			template <typename W>
+			constexpr W sin_poly(W r)
+			{
+				const W r2 = r * r;
+				W term = r;
+				W sum = r;
+				for (int k = 1; k < 14; ++k)
+				{
+					term *= -r2 / static_cast<W>((2 * k) * (2 * k + 1));
+					sum += term;
+				}
+				return sum;
+			}
+			template <typename W>
+			constexpr W cos_poly(W r)
+			{
+				const W r2 = r * r;
+				W term = 1;
+				W sum = 1;
+				for (int k = 1; k < 14; ++k)
+				{
+					term *= -r2 / static_cast<W>((2 * k - 1) * (2 * k));
+					sum += term;
+				}
+				return sum;
+			}
+
+			template <typename T>
+			constexpr void sincos(T x, T& s, T& c)
+			{
+				if (is_nan(x) || is_inf(x))
+				{
+					s = c = nan<T>();
+					return;
+				}
+
+				using W = wide<T>;
+				// pi/2 split into a 33 bit head and the remaining tail
+				constexpr W pio2_hi = static_cast<W>(1.57079632673412561417e+00);
+				constexpr W pio2_lo = static_cast<W>(6.07710050650619224932e-11);
+				constexpr W two_over_pi = static_cast<W>(0.636619772367581343075535053490057448L);
+
+				const W v = x;
+				const W k = floor(v * two_over_pi + static_cast<W>(0.5));
+				const W r = (v - k * pio2_hi) - k * pio2_lo;
+				const W q = k - 4 * floor(k / 4);
+
+				const W sr = sin_poly(r);
+				const W cr = cos_poly(r);
+				if (q == 0) { s = static_cast<T>(sr); c = static_cast<T>(cr); }
+				else if (q == 1) { s = static_cast<T>(cr); c = static_cast<T>(-sr); }
+				else if (q == 2) { s = static_cast<T>(-sr); c = static_cast<T>(-cr); }
+				else { s = static_cast<T>(-cr); c = static_cast<T>(sr); }
+			}
+			template <typename T>
+			constexpr T sin(T x)
+			{
+				T s{}, c{};
+				sincos(x, s, c);
+				return s;
+			}
+			template <typename T>
+			constexpr T cos(T x)
+			{
+				T s{}, c{};
+				sincos(x, s, c);
+				return c;
+			}
+			template <typename T>
+			constexpr T tan(T x)
+			{
+				using W = wide<T>;
+				W s{}, c{};
+				sincos(static_cast<W>(x), s, c);
+				return narrow<T>(s / c);
+			}
+
+			template <typename T>
+			constexpr T exp(T x)
+			{
+				using W = wide<T>;
+				if (is_nan(x))
+					return x;
+				if (x > static_cast<T>(std::numeric_limits<T>::max_exponent) * static_cast<T>(0.6931471805599453))
+					return inf<T>();
+				if (x < static_cast<T>(std::numeric_limits<T>::min_exponent - std::numeric_limits<T>::digits - 1) * static_cast<T>(0.6931471805599453))
+					return 0;
+
+				// x = k ln2 + r, |r| <= ln2 / 2
+				constexpr W ln2_hi = static_cast<W>(6.93147180369123816490e-01);
+				constexpr W ln2_lo = static_cast<W>(1.90821492927058770002e-10);
+				const W k = floor(static_cast<W>(x) / (ln2_hi + ln2_lo) + static_cast<W>(0.5));
+				const W r = (static_cast<W>(x) - k * ln2_hi) - k * ln2_lo;
+
+				W term = 1;
+				W sum = 1;
+				for (int i = 1; i < 24; ++i)
+				{
+					term *= r / i;
+					sum += term;
+				}
+				return narrow<T>(ldexp(sum, static_cast<long long>(k)));
+			}
+
+			template <typename T>
+			constexpr T log(T x)
+			{
+				using W = wide<T>;
+				if (is_nan(x) || x < 0)
+					return nan<T>();
+				if (x == 0)
+					return -inf<T>();
+				if (is_inf(x))
+					return x;
+
+				// x = m 2^e with m in [sqrt(1/2), sqrt(2))
+				W m = x;
+				long long e = 0;
+				while (m >= 2) { m *= static_cast<W>(0.5); ++e; }
+				while (m < 1) { m *= 2; --e; }
+				if (m > static_cast<W>(1.41421356237309504880L)) { m *= static_cast<W>(0.5); ++e; }
+
+				// log(m) = 2 atanh(s), s = (m - 1) / (m + 1)
+				const W s = (m - 1) / (m + 1);
+				const W s2 = s * s;
+				W term = s;
+				W sum = s;
+				for (int k = 1; k < 20; ++k)
+				{
+					term *= s2;
+					sum += term / (2 * k + 1);
+				}
+
+				constexpr W ln2_hi = static_cast<W>(6.93147180369123816490e-01);
+				constexpr W ln2_lo = static_cast<W>(1.90821492927058770002e-10);
+				return static_cast<T>(e * ln2_hi + (2 * sum + e * ln2_lo));
+			}
+
+			template <typename T>
+			constexpr T pow(T b, T e)
+			{
+				using W = wide<T>;
+				if (e == 0)
+					return 1;
+				if (is_nan(b) || is_nan(e))
+					return nan<T>();
+
+				// integral exponents by squaring, exact for small results
+				if (trunc(e) == e && abs(e) < static_cast<T>(1ll << 31))
+				{
+					long long n = static_cast<long long>(abs(e));
+					W base = b;
+					W r = 1;
+					for (; n > 0; n >>= 1)
+					{
+						if (n & 1)
+							r *= base;
+						base *= base;
+					}
+					return narrow<T>(e < 0 ? 1 / r : r);
+				}
+
+				if (b < 0)
+					return nan<T>();
+				if (b == 0)
+					return e > 0 ? T(0) : inf<T>();
+				return narrow<T>(exp(static_cast<W>(e) * log(static_cast<W>(b))));
+			}
+
+			template <typename T>
+			constexpr T atan(T x)
+			{
+				using W = wide<T>;
+				constexpr W half_pi = static_cast<W>(1.57079632679489661923132169163975144L);
+				if (is_nan(x))
+					return x;
+				if (is_inf(x))
+					return static_cast<T>(x < 0 ? -half_pi : half_pi);
+
+				W v = abs(static_cast<W>(x));
+				const bool invert = v > 1;
+				if (invert)
+					v = 1 / v;
+
+				// atan(v) = 2 atan(v / (1 + sqrt(1 + v^2))), halved twice to |v| <= tan(pi/16)
+				v = v / (1 + sqrt(1 + v * v));
+				v = v / (1 + sqrt(1 + v * v));
+
+				const W v2 = v * v;
+				W term = v;
+				W sum = v;
+				for (int k = 1; k < 16; ++k)
+				{
+					term *= -v2;
+					sum += term / (2 * k + 1);
+				}
+
+				W r = 4 * sum;
+				if (invert)
+					r = half_pi - r;
+				return static_cast<T>(x < 0 ? -r : r);
+			}
+			template <typename T>
+			constexpr T atan2(T y, T x)
+			{
+				using W = wide<T>;
+				constexpr W pi_ = static_cast<W>(3.14159265358979323846264338327950288L);
+				if (is_nan(y) || is_nan(x))
+					return nan<T>();
+				if (x == 0)
+					return static_cast<T>(y > 0 ? pi_ / 2 : y < 0 ? -pi_ / 2 : 0);
+				if (is_inf(x) && is_inf(y))
+					return static_cast<T>((x > 0 ? pi_ / 4 : 3 * pi_ / 4) * (y < 0 ? -1 : 1));
+
+				const W a = atan(static_cast<W>(y) / static_cast<W>(x));
+				if (x > 0)
+					return static_cast<T>(a);
+				return static_cast<T>(y < 0 ? a - pi_ : a + pi_);
+			}
+			template <typename T>
+			constexpr T asin(T x)
+			{
+				using W = wide<T>;
+				if (is_nan(x) || abs(x) > 1)
+					return nan<T>();
+				const W v = x;
+				return static_cast<T>(atan2(v, sqrt((1 - v) * (1 + v))));
+			}
+			template <typename T>
+			constexpr T acos(T x)
+			{
+				using W = wide<T>;
+				if (is_nan(x) || abs(x) > 1)
+					return nan<T>();
+				const W v = x;
+				return static_cast<T>(atan2(sqrt((1 - v) * (1 + v)), v));
+			}
+
+			template <typename T>
+			constexpr T sinh(T x)
+			{
+				using W = wide<T>;
+				const W v = x;
+				// the exp form cancels badly near zero
+				if (abs(v) < 1)
+				{
+					const W v2 = v * v;
+					W term = v;
+					W sum = v;
+					for (int k = 1; k < 12; ++k)
+					{
+						term *= v2 / ((2 * k) * (2 * k + 1));
+						sum += term;
+					}
+					return static_cast<T>(sum);
+				}
+				const W e = exp(v);
+				return narrow<T>((e - 1 / e) / 2);
+			}
+			template <typename T>
+			constexpr T cosh(T x)
+			{
+				using W = wide<T>;
+				const W e = exp(static_cast<W>(x));
+				return narrow<T>((e + 1 / e) / 2);
+			}
+			template <typename T>
+			constexpr T tanh(T x)
+			{
+				using W = wide<T>;
+				if (is_nan(x))
+					return x;
+				if (abs(x) > 20)
+					return x < 0 ? T(-1) : T(1);
+				const W v = x;
+				if (abs(v) < static_cast<W>(0.5))
+					return static_cast<T>(sinh(v) / cosh(v));
+				const W e2 = exp(2 * v);
+				return static_cast<T>((e2 - 1) / (e2 + 1));
+			}
+		}
+	}
+
+	// each function folds at compile time through detail::ce and calls <cmath> at run time
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T sin(T a) { return ::sin(a); }
+	inline constexpr T sin(T a) { return is_constant_evaluated() ? detail::ce::sin(a) : std::sin(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType sin(T a) { return ::sin(static_cast<defaultType>(a)); }
+	inline constexpr defaultType sin(T a) { return sin(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T cos(T a) { return ::cos(a); }
+	inline constexpr T cos(T a) { return is_constant_evaluated() ? detail::ce::cos(a) : std::cos(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType cos(T a) { return ::cos(static_cast<defaultType>(a)); }
+	inline constexpr defaultType cos(T a) { return cos(static_cast<defaultType>(a)); }
 
+	// sine and cosine of the same angle in one call
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T tan(T a) { return ::tan(a); }
+	inline constexpr void sincos(T a, T& s, T& c)
+	{
+		if (is_constant_evaluated())
+		{
+			detail::ce::sincos(a, s, c);
+			return;
+		}
+#if defined(__GNUC__) && !defined(__clang__)
+		if constexpr (std::is_same<T, float>::value)
+			__builtin_sincosf(a, &s, &c);
+		else if constexpr (std::is_same<T, double>::value)
+			__builtin_sincos(a, &s, &c);
+		else
+			__builtin_sincosl(a, &s, &c);
+#else
+		// clang and msvc merge the pair into a single sincos call
+		s = std::sin(a);
+		c = std::cos(a);
+#endif
+	}
+
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline constexpr T tan(T a) { return is_constant_evaluated() ? detail::ce::tan(a) : std::tan(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType tan(T a) { return ::tan(static_cast<defaultType>(a)); }
+	inline constexpr defaultType tan(T a) { return tan(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline T sinh(T a) { return ::sinh(a); }
+	inline constexpr T sinh(T a) { return is_constant_evaluated() ? detail::ce::sinh(a) : std::sinh(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType sinh(T a) { return ::sinh(static_cast<defaultType>(a)); }
+	inline constexpr defaultType sinh(T a) { return sinh(static_cast<defaultType>(a)); }
 
+	// unnormalized, sin(x) / x
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T sinc(T a) { return ::sinc(a); }
+	inline constexpr T sinc(T a) { return a == 0 ? static_cast<T>(1) : sin(a) / a; }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType sinc(T a) { return ::sinc(static_cast<defaultType>(a)); }
+	inline constexpr defaultType sinc(T a) { return sinc(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
 	inline constexpr T sincn(T a) { return sinc<T>(pi<T> *a); }
@@ -77,85 +526,97 @@ namespace els
 	inline constexpr defaultType sincn(T a) { return sinc<defaultType>(pi<defaultType> *a); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T cosh(T a) { return ::cosh(a); }
+	inline constexpr T cosh(T a) { return is_constant_evaluated() ? detail::ce::cosh(a) : std::cosh(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType cosh(T a) { return ::cosh(static_cast<defaultType>(a)); }
+	inline constexpr defaultType cosh(T a) { return cosh(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T tanh(T a) { return ::tanh(a); }
+	inline constexpr T tanh(T a) { return is_constant_evaluated() ? detail::ce::tanh(a) : std::tanh(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType tanh(T a) { return ::tanh(static_cast<defaultType>(a)); }
+	inline constexpr defaultType tanh(T a) { return tanh(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T asin(T a) { return ::asin(a); }
+	inline constexpr T asin(T a) { return is_constant_evaluated() ? detail::ce::asin(a) : std::asin(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType asin(T a) { return ::asin(static_cast<defaultType>(a)); }
+	inline constexpr defaultType asin(T a) { return asin(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T acos(T a) { return ::acos(a); }
+	inline constexpr T acos(T a) { return is_constant_evaluated() ? detail::ce::acos(a) : std::acos(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType acos(T a) { return ::acos(static_cast<defaultType>(a)); }
+	inline constexpr defaultType acos(T a) { return acos(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T atan(T a) { return ::atan(a); }
+	inline constexpr T atan(T a) { return is_constant_evaluated() ? detail::ce::atan(a) : std::atan(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType atan(T a) { return ::atan(static_cast<defaultType>(a)); }
+	inline constexpr defaultType atan(T a) { return atan(static_cast<defaultType>(a)); }
 
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
 		std::is_floating_point<Ty>::value ||
 		std::is_floating_point<Tx>::value>>
-		inline constexpr auto atan2(Ty y, Tx x) -> decltype(::atan2(y, x)) { return ::atan2(y, x); }
+		inline constexpr auto atan2(Ty y, Tx x) -> decltype(std::atan2(y, x))
+	{
+		using R = decltype(std::atan2(y, x));
+		return is_constant_evaluated() ? detail::ce::atan2<R>(y, x) : std::atan2(y, x);
+	}
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
 		std::is_integral<Ty>::value&&
 		std::is_integral<Tx>::value>>
-		inline constexpr defaultType atan2(Ty y, Tx x) { return static_cast<defaultType>(::atan2(y, x)); }
+		inline constexpr defaultType atan2(Ty y, Tx x) { return atan2(static_cast<defaultType>(y), static_cast<defaultType>(x)); }
 
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T sqrt(T x) { return ::sqrt(x); }
+	inline constexpr T sqrt(T x) { return is_constant_evaluated() ? detail::ce::sqrt(x) : std::sqrt(x); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType sqrt(T x) { return ::sqrt(static_cast<defaultType>(x)); }
+	inline constexpr defaultType sqrt(T x) { return sqrt(static_cast<defaultType>(x)); }
 
 	template <typename Ty, typename Tx>
-	inline constexpr auto pow(Ty base, Tx exp) -> decltype(::pow(base, exp)) { return ::pow(base, exp); }
+	inline constexpr auto pow(Ty base, Tx exp) -> decltype(std::pow(base, exp))
+	{
+		using R = decltype(std::pow(base, exp));
+		return is_constant_evaluated() ? detail::ce::pow<R>(base, exp) : std::pow(base, exp);
+	}
 
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T log(T a) { return ::log(a); }
+	inline constexpr T log(T a) { return is_constant_evaluated() ? detail::ce::log(a) : std::log(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType log(T a) { return ::log(static_cast<defaultType>(a)); }
+	inline constexpr defaultType log(T a) { return log(static_cast<defaultType>(a)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T exp(T a) { return ::exp(a); }
+	inline constexpr T exp(T a) { return is_constant_evaluated() ? detail::ce::exp(a) : std::exp(a); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType exp(T a) { return ::exp(static_cast<defaultType>(a)); }
+	inline constexpr defaultType exp(T a) { return exp(static_cast<defaultType>(a)); }
 
 
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T floor(T x) { return ::floor(x); }
+	inline constexpr T floor(T x) { return is_constant_evaluated() ? detail::ce::floor(x) : std::floor(x); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType floor(T x) { return ::floor(static_cast<defaultType>(x)); }
+	inline constexpr defaultType floor(T x) { return floor(static_cast<defaultType>(x)); }
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T frac(T x) { return  x - ::floor(x); }
+	inline constexpr T frac(T x) { return  x - floor(x); }
 
 
 	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
-	inline constexpr T ceil(T x) { return ::ceil(x); }
+	inline constexpr T ceil(T x) { return is_constant_evaluated() ? detail::ce::ceil(x) : std::ceil(x); }
 	template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
-	inline constexpr defaultType ceil(T x) { return ::ceil(static_cast<defaultType>(x)); }
+	inline constexpr defaultType ceil(T x) { return ceil(static_cast<defaultType>(x)); }
 
 	template <typename T>
-	inline constexpr T abs(T x) { return ::abs(x); }
+	inline constexpr T abs(T x) { return is_constant_evaluated() ? detail::ce::abs(x) : std::abs(x); }
 
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
 		std::is_floating_point<Ty>::value ||
 		std::is_floating_point<Tx>::value>>
-		inline constexpr auto mod(Ty y, Tx x) -> decltype(::fmod(y, x)) { return ::fmod(y, x); }
+		inline constexpr auto mod(Ty y, Tx x) -> decltype(std::fmod(y, x))
+	{
+		using R = decltype(std::fmod(y, x));
+		return is_constant_evaluated() ? detail::ce::fmod<R>(y, x) : std::fmod(y, x);
+	}
 	template <typename Ty, typename Tx,
 		typename = std::enable_if_t<
 		std::is_integral<Ty>::value&&
@@ -163,7 +624,13 @@ namespace els
 		inline constexpr std::common_type_t<Ty, Tx> mod(Ty y, Tx x) { return y % x; }
 
 	template <typename T>
-	inline constexpr T round(T a) { return static_cast<T>(::round(a)); }
+	inline constexpr T round(T a)
+	{
+		if constexpr (std::is_floating_point<T>::value)
+			return is_constant_evaluated() ? detail::ce::round(a) : std::round(a);
+		else
+			return a;
+	}
 
 	template <typename TVal, typename T,
 		typename = std::enable_if_t<
@@ -225,8 +692,8 @@ namespace els
 		inline constexpr auto lerp_angle(Tfrom from, Tto to, Tweight t) -> decltype(from + to + t)
 	{
 		using promoted = decltype(from + to + t);
-		auto difference = fmod(to - from, tau<promoted>);
-		auto distance = fmod(2 * difference, tau<promoted>) - difference;
+		auto difference = mod(to - from, tau<promoted>);
+		auto distance = mod(2 * difference, tau<promoted>) - difference;
 		return from + distance * t;
 	}
 
@@ -237,8 +704,8 @@ namespace els
 		std::is_integral<Tweight>::value>>
 		inline constexpr defaultType lerp_angle(Tfrom from, Tto to, Tweight t)
 	{
-		defaultType difference = fmod(to - from, tau<defaultType>);
-		defaultType distance = fmod(2 * difference, tau<defaultType>) - difference;
+		defaultType difference = mod(to - from, tau<defaultType>);
+		defaultType distance = mod(2 * difference, tau<defaultType>) - difference;
 		return from + distance * t;
 	}
 
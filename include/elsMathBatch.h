@@ -0,0 +1,237 @@
+#ifndef ELS_MATH_BATCH
+#define ELS_MATH_BATCH
+
+#include <cmath>
+#include <cstdint>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// span versions of the elementwise functions, out must hold at least as many elements as the input
+	// and may alias it. float spans run on simd polynomial kernels, 8 wide when the cpu has avx2 and fma
+	// and 4 wide otherwise, other types loop over the scalar functions
+	//
+	// max error of the float kernels against the exact result, in ulp, measured over a few million arguments
+	//
+	//   function    max error   range
+	//   sin/cos     1.5         |x| <= pi
+	//               2.5         |x| < 8192, the argument reduction loses accuracy past that
+	//   exp         1           denormal results included, inf above 88.72, 0 below -103.97
+	//   log         1           x > 0, denormals included
+	//   pow         1.5         normal results, log(x) is carried in two floats so large exponents stay accurate
+	//   atan2       3
+	//   smoothstep  -           the scalar formulas in plain arithmetic, fma contraction
+	//   lerp        -           can change the rounding
+	//
+	// nan, inf and signed zeros follow <cmath>, pow takes negative bases with integer exponents
+	constexpr size_t math_batch_grain = 1 << 16;
+
+	namespace detail
+	{
+		namespace batch
+		{
+			struct kernel_table
+			{
+				void (*sin)(const float*, float*, size_t);
+				void (*cos)(const float*, float*, size_t);
+				void (*sincos)(const float*, float*, float*, size_t);
+				void (*exp)(const float*, float*, size_t);
+				void (*log)(const float*, float*, size_t);
+				void (*pow)(const float*, const float*, float*, size_t);
+				void (*pow_scalar)(const float*, float, float*, size_t);
+				void (*atan2)(const float*, const float*, float*, size_t);
+				void (*smoothstep)(float, float, const float*, float*, size_t);
+				void (*lerp)(const float*, const float*, float, float*, size_t);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				using VI = simd::int4;
+				using simd::shift_left;
+				using simd::shift_right;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline VI splati(int32_t s) { return simd::int4_broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsMathBatchKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				using VI = simd::int8;
+				using simd::shift_left;
+				using simd::shift_right;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline VI splati(int32_t s) { return simd::int8_broadcast(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsMathBatchKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const kernel_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const kernel_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const kernel_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			template <typename Fn>
+			inline void run(size_t count, Fn&& fn)
+			{
+				parallel::for_range(0, count, math_batch_grain, fn);
+			}
+
+			// sin and cos of n angles on the current thread, for callers that use them right away from a
+			// stack block of sincos_block elements, the batch matrix builders of Transform2 and Transform3
+			constexpr size_t sincos_block = 256;
+			inline void sincos_n(const float* in, float* s, float* c, size_t n)
+			{
+				kernels().sincos(in, s, c, n);
+			}
+			template <typename T>
+			inline void sincos_n(const T* in, T* s, T* c, size_t n)
+			{
+				for (size_t i = 0; i < n; ++i)
+					sincos(in[i], s[i], c[i]);
+			}
+		}
+	}
+
+	inline void sin(span<const float> in, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().sin;
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { kernel(in.data() + first, out.data() + first, last - first); });
+	}
+	inline void cos(span<const float> in, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().cos;
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { kernel(in.data() + first, out.data() + first, last - first); });
+	}
+	inline void sincos(span<const float> in, span<float> out_sin, span<float> out_cos)
+	{
+		const auto kernel = detail::batch::kernels().sincos;
+		detail::batch::run(in.size(), [&](size_t first, size_t last)
+			{
+				kernel(in.data() + first, out_sin.data() + first, out_cos.data() + first, last - first);
+			});
+	}
+	inline void exp(span<const float> in, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().exp;
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { kernel(in.data() + first, out.data() + first, last - first); });
+	}
+	inline void log(span<const float> in, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().log;
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { kernel(in.data() + first, out.data() + first, last - first); });
+	}
+	// elementwise base^exponent
+	inline void pow(span<const float> base, span<const float> exponent, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().pow;
+		detail::batch::run(base.size(), [&](size_t first, size_t last)
+			{
+				kernel(base.data() + first, exponent.data() + first, out.data() + first, last - first);
+			});
+	}
+	inline void pow(span<const float> base, float exponent, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().pow_scalar;
+		detail::batch::run(base.size(), [&](size_t first, size_t last)
+			{
+				kernel(base.data() + first, exponent, out.data() + first, last - first);
+			});
+	}
+	inline void atan2(span<const float> y, span<const float> x, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().atan2;
+		detail::batch::run(y.size(), [&](size_t first, size_t last)
+			{
+				kernel(y.data() + first, x.data() + first, out.data() + first, last - first);
+			});
+	}
+	inline void smoothstep(float edge0, float edge1, span<const float> x, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().smoothstep;
+		detail::batch::run(x.size(), [&](size_t first, size_t last)
+			{
+				kernel(edge0, edge1, x.data() + first, out.data() + first, last - first);
+			});
+	}
+	// elementwise lerp of two spans by the same weight
+	inline void lerp(span<const float> from, span<const float> to, float t, span<float> out)
+	{
+		const auto kernel = detail::batch::kernels().lerp;
+		detail::batch::run(from.size(), [&](size_t first, size_t last)
+			{
+				kernel(from.data() + first, to.data() + first, t, out.data() + first, last - first);
+			});
+	}
+
+	// scalar fallbacks for the other floating point types
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void sin(span<const T> in, span<T> out)
+	{
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = sin(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void cos(span<const T> in, span<T> out)
+	{
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = cos(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void sincos(span<const T> in, span<T> out_sin, span<T> out_cos)
+	{
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) sincos(in[i], out_sin[i], out_cos[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void exp(span<const T> in, span<T> out)
+	{
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = exp(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void log(span<const T> in, span<T> out)
+	{
+		detail::batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = log(in[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void pow(span<const T> base, span<const T> exponent, span<T> out)
+	{
+		detail::batch::run(base.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = pow(base[i], exponent[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void pow(span<const T> base, T exponent, span<T> out)
+	{
+		detail::batch::run(base.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = pow(base[i], exponent); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void atan2(span<const T> y, span<const T> x, span<T> out)
+	{
+		detail::batch::run(y.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = atan2(y[i], x[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void smoothstep(T edge0, T edge1, span<const T> x, span<T> out)
+	{
+		detail::batch::run(x.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = smoothstep(edge0, edge1, x[i]); });
+	}
+	template <typename T, typename = std::enable_if_t<std::is_floating_point<T>::value>>
+	inline void lerp(span<const T> from, span<const T> to, T t, span<T> out)
+	{
+		detail::batch::run(from.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = lerp(from[i], to[i], t); });
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,345 @@
+// no include guard, elsMathBatch.h includes this once per register width
+// the enclosing namespace provides V, VI, splat(float), splati(int32_t) and loadv(const float*)
+
+inline V sign_bits(const V& x)
+{
+	return x & as_float(splati(INT32_MIN));
+}
+// all bits set in the lanes where the int is 1, clear where it is 0
+inline V one_mask(const VI& bit)
+{
+	return equal(to_float(bit), splat(1.f));
+}
+
+// quadrant reduction with pi/2 split in four parts, minimax polynomials on [-pi/4, pi/4]
+// the first three parts have at most 11 bits so their products stay exact for |x| < 8192 without fma
+inline void sincos_kernel(const V& x, V& s, V& c)
+{
+	const V q = round(x * splat(0.636619772f));
+	const VI quadrant = to_int(q);
+
+	V r = madd(q, splat(-1.5703125f), x);
+	r = madd(q, splat(-4.837512969970703125e-4f), r);
+	r = madd(q, splat(-7.549533620476723e-8f), r);
+	r = madd(q, splat(-2.5633440682570896e-12f), r);
+	const V r2 = r * r;
+
+	V ps = madd(splat(-1.9515295891e-4f), r2, splat(8.3321608736e-3f));
+	ps = madd(ps, r2, splat(-1.6666654611e-1f));
+	const V sr = madd(ps, r2 * r, r);
+
+	V pc = madd(splat(2.443315711809948e-5f), r2, splat(-1.388731625493765e-3f));
+	pc = madd(pc, r2, splat(4.166664568298827e-2f));
+	const V cr = madd(pc, r2 * r2, madd(r2, splat(-0.5f), splat(1.f)));
+
+	// odd quadrants swap the pair, the sign of each follows its own quadrant bit
+	const V swap = one_mask(quadrant & splati(1));
+	s = select(swap, cr, sr) ^ as_float(shift_left<30>(quadrant & splati(2)));
+	s = select(equal(x, splat(0.f)), x, s);
+	c = select(swap, sr, cr) ^ as_float(shift_left<30>((quadrant + splati(1)) & splati(2)));
+}
+
+// e^(x + lo), lo is a small correction below the precision of x used by pow
+inline V exp_kernel(const V& x, const V& lo)
+{
+	const V xc = min(max(x, splat(-104.f)), splat(89.f));
+	const V q = round(xc * splat(1.44269504089f));
+
+	V r = madd(q, splat(-0.693359375f), xc);
+	r = madd(q, splat(2.12194440e-4f), r) + lo;
+	const V r2 = r * r;
+
+	V p = madd(splat(1.9875691500e-4f), r, splat(1.3981999507e-3f));
+	p = madd(p, r, splat(8.3334519073e-3f));
+	p = madd(p, r, splat(4.1665795894e-2f));
+	p = madd(p, r, splat(1.6666665459e-1f));
+	p = madd(p, r, splat(5.0000001201e-1f));
+	p = madd(p, r2, r) + splat(1.f);
+
+	// 2^q is applied in two halves so denormal results are rounded only once
+	const VI n = to_int(q);
+	const VI n1 = to_int(round(q * splat(0.5f)));
+	const VI n2 = n - n1;
+	p = p * as_float(shift_left<23>(n1 + splati(127)));
+	p = p * as_float(shift_left<23>(n2 + splati(127)));
+
+	p = select(greater(x, splat(88.7228394f)), splat(HUGE_VALF), p);
+	p = select(less(x, splat(-103.972084f)), splat(0.f), p);
+	return select(equal(x, x), p, x);
+}
+
+// splits x > 0 into 2^e * (1 + f) with 1 + f in [sqrt(1/2), sqrt(2)), f is exact
+inline void log_reduce(const V& x, V& e, V& f)
+{
+	// denormals are scaled into the normal range first
+	const V tiny = less(x, splat(1.17549435e-38f));
+	const VI bits = as_int(select(tiny, x * splat(8388608.f), x));
+	e = to_float(shift_right<23>(bits) - splati(126)) - (tiny & splat(23.f));
+
+	const V m = as_float(bits & splati(0x007fffff)) | splat(0.5f);
+	const V low = less(m, splat(0.707106781f));
+	e = e - (low & splat(1.f));
+	f = m + (low & m) - splat(1.f);
+}
+// f^3 part of log(1 + f)
+inline V log_tail(const V& f, const V& f2)
+{
+	V p = madd(splat(7.0376836292e-2f), f, splat(-1.1514610310e-1f));
+	p = madd(p, f, splat(1.1676998740e-1f));
+	p = madd(p, f, splat(-1.2420140846e-1f));
+	p = madd(p, f, splat(1.4249322787e-1f));
+	p = madd(p, f, splat(-1.6668057665e-1f));
+	p = madd(p, f, splat(2.0000714765e-1f));
+	p = madd(p, f, splat(-2.4999993993e-1f));
+	p = madd(p, f, splat(3.3333331174e-1f));
+	return p * f * f2;
+}
+
+inline V log_kernel(const V& x)
+{
+	V e, f;
+	log_reduce(x, e, f);
+	const V f2 = f * f;
+
+	V r = madd(e, splat(-2.12194440e-4f), log_tail(f, f2));
+	r = madd(f2, splat(-0.5f), r);
+	r = madd(e, splat(0.693359375f), f + r);
+
+	r = select(equal(x, splat(HUGE_VALF)), x, r);
+	r = select(equal(x, splat(0.f)), splat(-HUGE_VALF), r);
+	r = select(less(x, splat(0.f)), splat(NAN), r);
+	return select(equal(x, x), r, x);
+}
+
+// log(x) for x >= 0 as an unevaluated sum hi + lo, accurate to about 2^-33 absolute near 1
+// log(1 + f) = 2 atanh(t) with t = f / (2 + f) carried in two parts, the odd series of atanh is short for |t| < 0.18
+inline void log_extended(const V& x, V& hi, V& lo)
+{
+	V e, f;
+	log_reduce(x, e, f);
+
+	const V d = splat(2.f) + f;
+	const V d_lo = (splat(2.f) - d) + f;
+	// one division, the residual of t is exact so the rounding of t * (1 / d) is recovered in t_lo
+	const V inv = splat(1.f) / d;
+	const V t = f * inv;
+	const V td = t * d;
+	const V t_lo = ((f - td) - mul_error(t, d, td) - t * d_lo) * inv;
+
+	const V t2 = t * t;
+	V p = madd(splat(7.6923077e-2f), t2, splat(9.0909091e-2f));
+	p = madd(p, t2, splat(1.1111111e-1f));
+	p = madd(p, t2, splat(1.4285714e-1f));
+	p = madd(p, t2, splat(2.0000000e-1f));
+	p = madd(p, t2, splat(3.3333333e-1f));
+	const V tail = p * t2 * (t + t);
+
+	// e * ln2 split so that e times the high part is exact
+	const V big = e * splat(0.693145751953125f);
+	const V s = t + t;
+	const V sum = big + s;
+	const V sb = sum - big;
+	const V sum_lo = (big - (sum - sb)) + (s - sb);
+
+	// the low part of t also moves the series, by 2 t^2 t_lo to first order
+	const V t_lo2 = t_lo + t_lo;
+	V l = sum_lo + madd(t2, t_lo2, t_lo2) + tail;
+	l = madd(e, splat(1.42860677e-6f), l);
+	hi = sum + l;
+	lo = l - (hi - sum);
+
+	const V inf = equal(x, splat(HUGE_VALF));
+	const V zero = equal(x, splat(0.f));
+	hi = select(inf, x, select(zero, splat(-HUGE_VALF), hi));
+	lo = select(inf | zero, splat(0.f), lo);
+}
+
+inline V pow_kernel(const V& x, const V& y)
+{
+	const V ax = abs(x);
+	const V ay = abs(y);
+
+	V hi, lo;
+	log_extended(ax, hi, lo);
+	const V p = y * hi;
+	// the correction is dropped once the product is out of range, it is nan there for infinite inputs
+	const V p_lo = select(less(abs(p), splat(128.f)), madd(y, lo, mul_error(y, hi, p)), splat(0.f));
+	V r = exp_kernel(p, p_lo);
+
+	// negative finite bases only have real powers for integer exponents, odd ones keep the sign
+	// -inf goes through exp(y * inf) like +inf and only takes the sign of odd exponents
+	const V big = less_equal(splat(8388608.f), ay);
+	const V integer = big | equal(round(y), y);
+	const V odd = one_mask(to_int(y) & splati(1)) & less(ay, splat(16777216.f)) & integer;
+	r = r ^ (odd & sign_bits(x));
+	r = select(less(x, splat(0.f)) & less(splat(-HUGE_VALF), x), select(integer, r, splat(NAN)), r);
+	// log_extended does not carry a nan base through
+	r = select(equal(x, x) & equal(y, y), r, x + y);
+
+	// the exact cases of <cmath> that hold even for nan
+	const V one = equal(x, splat(1.f)) | equal(y, splat(0.f)) | (equal(x, splat(-1.f)) & equal(ay, splat(HUGE_VALF)));
+	return select(one, splat(1.f), r);
+}
+
+// atan(n / d) for 0 <= n <= d, reduced around tan(pi/8) straight from n and d to save a rounding
+inline V atan_unit(const V& n, const V& d)
+{
+	const V upper = greater(n, d * splat(0.414213562f));
+	const V u = select(upper, (n - d) / (n + d), n / d);
+	const V z = u * u;
+	V p = madd(splat(8.05374449538e-2f), z, splat(-1.38776856032e-1f));
+	p = madd(p, z, splat(1.99777106478e-1f));
+	p = madd(p, z, splat(-3.33329491539e-1f));
+	return madd(p * z, u, u) + (upper & splat(0.785398163f));
+}
+
+inline V atan2_kernel(const V& y, const V& x)
+{
+	const V ay = abs(y);
+	const V ax = abs(x);
+	const V steep = greater(ay, ax);
+
+	// equal magnitudes, zeros and infinities included, are pinned to a ratio of 1 or 0
+	const V same = equal(ay, ax);
+	// huge pairs are scaled down so n + d cannot overflow
+	const V scale = select(greater(max(ay, ax), splat(1e37f)), splat(0.25f), splat(1.f));
+	const V n = select(same, select(equal(ax, splat(0.f)), splat(0.f), splat(1.f)), min(ay, ax) * scale);
+	const V d = select(same, splat(1.f), max(ay, ax) * scale);
+
+	V a = atan_unit(n, d);
+	a = select(steep, splat(1.57079633f) - a, a);
+	a = select(one_mask(shift_right<31>(as_int(x))), splat(3.14159265f) - a, a);
+	a = a ^ sign_bits(y);
+	return select(equal(x, x) & equal(y, y), a, x + y);
+}
+
+// drivers over raw ranges, the tail goes through a zero padded register
+template <typename Op>
+inline void map1(const Op& op, const float* in, float* out, size_t n)
+{
+	size_t i = 0;
+	for (; i + V::width <= n; i += V::width)
+		store(out + i, op(loadv(in + i)));
+	if (i < n)
+	{
+		float a[V::width] = {};
+		float r[V::width];
+		for (size_t k = 0; k < n - i; ++k) a[k] = in[i + k];
+		store(r, op(loadv(a)));
+		for (size_t k = 0; k < n - i; ++k) out[i + k] = r[k];
+	}
+}
+template <typename Op>
+inline void map2(const Op& op, const float* in0, const float* in1, float* out, size_t n)
+{
+	size_t i = 0;
+	for (; i + V::width <= n; i += V::width)
+		store(out + i, op(loadv(in0 + i), loadv(in1 + i)));
+	if (i < n)
+	{
+		float a[V::width] = {};
+		float b[V::width] = {};
+		float r[V::width];
+		for (size_t k = 0; k < n - i; ++k)
+		{
+			a[k] = in0[i + k];
+			b[k] = in1[i + k];
+		}
+		store(r, op(loadv(a), loadv(b)));
+		for (size_t k = 0; k < n - i; ++k) out[i + k] = r[k];
+	}
+}
+
+struct sin_op
+{
+	V operator()(const V& x) const { V s, c; sincos_kernel(x, s, c); return s; }
+};
+struct cos_op
+{
+	V operator()(const V& x) const { V s, c; sincos_kernel(x, s, c); return c; }
+};
+struct exp_op
+{
+	V operator()(const V& x) const { return exp_kernel(x, splat(0.f)); }
+};
+struct log_op
+{
+	V operator()(const V& x) const { return log_kernel(x); }
+};
+struct pow_op
+{
+	V operator()(const V& x, const V& y) const { return pow_kernel(x, y); }
+};
+struct pow_scalar_op
+{
+	float y;
+	V operator()(const V& x) const { return pow_kernel(x, splat(y)); }
+};
+struct atan2_op
+{
+	V operator()(const V& y, const V& x) const { return atan2_kernel(y, x); }
+};
+struct smoothstep_op
+{
+	float edge0;
+	float scale;
+	V operator()(const V& x) const
+	{
+		const V t = min(max((x - splat(edge0)) * splat(scale), splat(0.f)), splat(1.f));
+		return t * t * madd(t, splat(-2.f), splat(3.f));
+	}
+};
+struct lerp_op
+{
+	float t;
+	V operator()(const V& a, const V& b) const { return madd(b, splat(t), a * splat(1.f - t)); }
+};
+
+inline void sin_range(const float* in, float* out, size_t n) { map1(sin_op{}, in, out, n); }
+inline void cos_range(const float* in, float* out, size_t n) { map1(cos_op{}, in, out, n); }
+inline void exp_range(const float* in, float* out, size_t n) { map1(exp_op{}, in, out, n); }
+inline void log_range(const float* in, float* out, size_t n) { map1(log_op{}, in, out, n); }
+inline void pow_range(const float* x, const float* y, float* out, size_t n) { map2(pow_op{}, x, y, out, n); }
+inline void pow_scalar_range(const float* x, float y, float* out, size_t n) { map1(pow_scalar_op{ y }, x, out, n); }
+inline void atan2_range(const float* y, const float* x, float* out, size_t n) { map2(atan2_op{}, y, x, out, n); }
+inline void smoothstep_range(float edge0, float edge1, const float* x, float* out, size_t n)
+{
+	map1(smoothstep_op{ edge0, 1.f / (edge1 - edge0) }, x, out, n);
+}
+inline void lerp_range(const float* a, const float* b, float t, float* out, size_t n)
+{
+	map2(lerp_op{ t }, a, b, out, n);
+}
+inline void sincos_range(const float* in, float* out_sin, float* out_cos, size_t n)
+{
+	size_t i = 0;
+	V s, c;
+	for (; i + V::width <= n; i += V::width)
+	{
+		sincos_kernel(loadv(in + i), s, c);
+		store(out_sin + i, s);
+		store(out_cos + i, c);
+	}
+	if (i < n)
+	{
+		float a[V::width] = {};
+		float rs[V::width];
+		float rc[V::width];
+		for (size_t k = 0; k < n - i; ++k) a[k] = in[i + k];
+		sincos_kernel(loadv(a), s, c);
+		store(rs, s);
+		store(rc, c);
+		for (size_t k = 0; k < n - i; ++k)
+		{
+			out_sin[i + k] = rs[k];
+			out_cos[i + k] = rc[k];
+		}
+	}
+}
+
+inline kernel_table make_table()
+{
+	return kernel_table{
+		&sin_range, &cos_range, &sincos_range, &exp_range, &log_range,
+		&pow_range, &pow_scalar_range, &atan2_range, &smoothstep_range, &lerp_range };
+}
@@ -63,10 +63,10 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Matrix2<T> Matrix2<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0),
+	constexpr Matrix2<T> Matrix2<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0)};
 	template <typename T>
-	const Matrix2<T> Matrix2<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0),
+	constexpr Matrix2<T> Matrix2<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(1)};
 
 	// static functions
@@ -229,7 +229,7 @@ namespace els
 	constexpr Matrix2<T>& Matrix2<T>::invert()
 	{
 		Scalar determinant = det();
-		if (isZero(determinant))
+		if (is_zero(determinant))
 		{
 			*this = zero;
 			return *this;
@@ -240,7 +240,7 @@ namespace els
 		m[1] = -temp.m[1] / determinant;
 
 		m[2] = -temp.m[2] / determinant;
-		m[3] = temp.m[1] / determinant;
+		m[3] = temp.m[0] / determinant;
 
 		return *this;
 	}
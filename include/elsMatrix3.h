@@ -66,11 +66,11 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Matrix3<T> Matrix3<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+	constexpr Matrix3<T> Matrix3<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) };
 	template <typename T>
-	const Matrix3<T> Matrix3<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0),
+	constexpr Matrix3<T> Matrix3<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
 
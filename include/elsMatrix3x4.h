@@ -0,0 +1,287 @@
+#ifndef ELS_MATRIX3X4
+#define ELS_MATRIX3X4
+
+#include <array>
+#include "elsHeader.h"
+#include "elsVector3.h"
+#include "elsMatrix3.h"
+#include "elsMatrix4.h"
+#include "elsMath.h"
+
+namespace els
+{
+	// affine matrix stored as the top 3 rows of a Matrix4, the implied last row is (0, 0, 0, 1)
+	template <typename T>
+	union Matrix3x4
+	{
+		using Scalar = T;
+
+		std::array<Scalar, 12> m;
+		Scalar m2[3][4];
+
+		constexpr Matrix3x4() : Matrix3x4{ I } {}
+		constexpr Matrix3x4(const Matrix3x4& rhs) = default;
+		constexpr Matrix3x4(
+			const Scalar& _00, const Scalar& _01, const Scalar& _02, const Scalar& _03,
+			const Scalar& _10, const Scalar& _11, const Scalar& _12, const Scalar& _13,
+			const Scalar& _20, const Scalar& _21, const Scalar& _22, const Scalar& _23)
+			: m{ _00, _01, _02, _03,
+				 _10, _11, _12, _13,
+				 _20, _21, _22, _23 } {}
+		constexpr Matrix3x4(const Matrix3<T>& linear, const Vector3<T>& translation)
+			: Matrix3x4{
+				linear.m[0], linear.m[1], linear.m[2], translation.x,
+				linear.m[3], linear.m[4], linear.m[5], translation.y,
+				linear.m[6], linear.m[7], linear.m[8], translation.z } {}
+		// drops the last row, which is assumed to be (0, 0, 0, 1)
+		constexpr explicit Matrix3x4(const Matrix4<T>& rhs)
+			: Matrix3x4{
+				rhs.m[0], rhs.m[1], rhs.m[2], rhs.m[3],
+				rhs.m[4], rhs.m[5], rhs.m[6], rhs.m[7],
+				rhs.m[8], rhs.m[9], rhs.m[10], rhs.m[11] } {}
+
+		constexpr Scalar* data();
+		constexpr const Scalar* data() const;
+
+		constexpr Scalar* operator[](unsigned int index);
+		constexpr const Scalar* operator[](unsigned int index) const;
+
+		constexpr bool operator==(const Matrix3x4& rhs) const;
+		constexpr bool operator!=(const Matrix3x4& rhs) const;
+
+		constexpr Matrix3x4& operator=(const Matrix3x4& rhs) = default;
+		constexpr Matrix3x4& operator*=(const Matrix3x4& rhs);
+
+		constexpr Scalar det() const;
+
+		constexpr Matrix3x4& identity();
+		constexpr Matrix3x4& invert();
+		constexpr Matrix3x4& invert_rigid();
+
+		constexpr Matrix3x4 inverse() const; // return zero matrix on fail
+		constexpr Matrix3x4 inverse_affine() const; // return zero matrix on fail
+		constexpr Matrix3x4 inverse_rigid() const; // rotation + translation only
+
+		constexpr Matrix3<T> linear() const;
+		constexpr Vector3<T> translation() const;
+		constexpr Matrix4<T> to_mtx4() const;
+
+		constexpr Vector3<T> transform_point(const Vector3<T>& p) const;
+		constexpr Vector3<T> transform_direction(const Vector3<T>& d) const;
+
+		static const Matrix3x4 I;
+		static const Matrix3x4 zero;
+	};
+
+	// typedef
+	using mat3x4f = Matrix3x4<float>;
+	using mat3x4 = Matrix3x4<defaultType>;
+
+	// constants
+	template <typename T>
+	constexpr Matrix3x4<T> Matrix3x4<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) };
+	template <typename T>
+	constexpr Matrix3x4<T> Matrix3x4<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+									static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0),
+									static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0) };
+
+	// static functions
+	template <typename T>
+	constexpr void identity(Matrix3x4<T>& rhs)
+	{
+		rhs.identity();
+	}
+	template <typename T>
+	constexpr bool invert(Matrix3x4<T>& rhs)
+	{
+		return rhs.invert() != Matrix3x4<T>::zero;
+	}
+
+	// global operators
+	// same order as Matrix4, mat3x4(a) * mat3x4(b) matches mat3x4(a * b)
+	template <typename T>
+	constexpr Matrix3x4<T> operator*(const Matrix3x4<T>& lhs, const Matrix3x4<T>& rhs)
+	{
+		Matrix3x4<T> temp = rhs;
+		temp *= lhs;
+		return temp;
+	}
+	template <typename T>
+	constexpr Vector3<T> operator*(const Matrix3x4<T>& lhs, const Vector3<T>& rhs)
+	{
+		return lhs.transform_point(rhs);
+	}
+
+	// member functions
+	template <typename T>
+	constexpr typename Matrix3x4<T>::Scalar* Matrix3x4<T>::data()
+	{
+		return &m2[0][0];
+	}
+	template <typename T>
+	constexpr const typename Matrix3x4<T>::Scalar* Matrix3x4<T>::data() const
+	{
+		return &m2[0][0];
+	}
+	template <typename T>
+	constexpr typename Matrix3x4<T>::Scalar* Matrix3x4<T>::operator[](unsigned int index)
+	{
+		return m2[index];
+	}
+	template <typename T>
+	constexpr const typename Matrix3x4<T>::Scalar* Matrix3x4<T>::operator[](unsigned int index) const
+	{
+		return m2[index];
+	}
+	template <typename T>
+	constexpr bool Matrix3x4<T>::operator==(const Matrix3x4<T>& rhs) const
+	{
+		for (size_t i = 0; i < m.size(); ++i)
+		{
+			if (m[i] != rhs.m[i])
+				return false;
+		}
+		return true;
+	}
+	template <typename T>
+	constexpr bool Matrix3x4<T>::operator!=(const Matrix3x4<T>& rhs) const
+	{
+		return !(*this == rhs);
+	}
+	template <typename T>
+	constexpr Matrix3x4<T>& Matrix3x4<T>::operator*=(const Matrix3x4<T>& rhs)
+	{
+		Matrix3x4<T> lhs = *this;
+
+		m[0] = (lhs.m[0] * rhs.m[0] + lhs.m[1] * rhs.m[4] + lhs.m[2] * rhs.m[8]);
+		m[1] = (lhs.m[0] * rhs.m[1] + lhs.m[1] * rhs.m[5] + lhs.m[2] * rhs.m[9]);
+		m[2] = (lhs.m[0] * rhs.m[2] + lhs.m[1] * rhs.m[6] + lhs.m[2] * rhs.m[10]);
+		m[3] = (lhs.m[0] * rhs.m[3] + lhs.m[1] * rhs.m[7] + lhs.m[2] * rhs.m[11] + lhs.m[3]);
+
+		m[4] = (lhs.m[4] * rhs.m[0] + lhs.m[5] * rhs.m[4] + lhs.m[6] * rhs.m[8]);
+		m[5] = (lhs.m[4] * rhs.m[1] + lhs.m[5] * rhs.m[5] + lhs.m[6] * rhs.m[9]);
+		m[6] = (lhs.m[4] * rhs.m[2] + lhs.m[5] * rhs.m[6] + lhs.m[6] * rhs.m[10]);
+		m[7] = (lhs.m[4] * rhs.m[3] + lhs.m[5] * rhs.m[7] + lhs.m[6] * rhs.m[11] + lhs.m[7]);
+
+		m[8] = (lhs.m[8] * rhs.m[0] + lhs.m[9] * rhs.m[4] + lhs.m[10] * rhs.m[8]);
+		m[9] = (lhs.m[8] * rhs.m[1] + lhs.m[9] * rhs.m[5] + lhs.m[10] * rhs.m[9]);
+		m[10] = (lhs.m[8] * rhs.m[2] + lhs.m[9] * rhs.m[6] + lhs.m[10] * rhs.m[10]);
+		m[11] = (lhs.m[8] * rhs.m[3] + lhs.m[9] * rhs.m[7] + lhs.m[10] * rhs.m[11] + lhs.m[11]);
+
+		return *this;
+	}
+	template <typename T>
+	constexpr typename Matrix3x4<T>::Scalar Matrix3x4<T>::det() const
+	{
+		return (m[0] * (m[5] * m[10] - m[6] * m[9]) - (m[1] * (m[4] * m[10] - m[6] * m[8])) + (m[2] * (m[4] * m[9] - m[5] * m[8])));
+	}
+	template <typename T>
+	constexpr Matrix3x4<T>& Matrix3x4<T>::identity()
+	{
+		*this = I;
+		return *this;
+	}
+	template <typename T>
+	constexpr Matrix3x4<T>& Matrix3x4<T>::invert()
+	{
+		*this = inverse_affine();
+		return *this;
+	}
+	template <typename T>
+	constexpr Matrix3x4<T>& Matrix3x4<T>::invert_rigid()
+	{
+		*this = inverse_rigid();
+		return *this;
+	}
+	template <typename T>
+	constexpr Matrix3x4<T> Matrix3x4<T>::inverse() const
+	{
+		return inverse_affine();
+	}
+	template <typename T>
+	constexpr Matrix3x4<T> Matrix3x4<T>::inverse_affine() const
+	{
+		// cofactors of the linear part
+		const Scalar c00 = m[5] * m[10] - m[6] * m[9];
+		const Scalar c01 = m[6] * m[8] - m[4] * m[10];
+		const Scalar c02 = m[4] * m[9] - m[5] * m[8];
+
+		const Scalar determinant = m[0] * c00 + m[1] * c01 + m[2] * c02;
+		if (is_zero(determinant))
+			return zero;
+
+		const Scalar inv = static_cast<Scalar>(1) / determinant;
+
+		const Scalar a00 = c00 * inv;
+		const Scalar a01 = (m[2] * m[9] - m[1] * m[10]) * inv;
+		const Scalar a02 = (m[1] * m[6] - m[2] * m[5]) * inv;
+		const Scalar a10 = c01 * inv;
+		const Scalar a11 = (m[0] * m[10] - m[2] * m[8]) * inv;
+		const Scalar a12 = (m[2] * m[4] - m[0] * m[6]) * inv;
+		const Scalar a20 = c02 * inv;
+		const Scalar a21 = (m[1] * m[8] - m[0] * m[9]) * inv;
+		const Scalar a22 = (m[0] * m[5] - m[1] * m[4]) * inv;
+
+		return Matrix3x4<T>{
+			a00, a01, a02, -(a00 * m[3] + a01 * m[7] + a02 * m[11]),
+				a10, a11, a12, -(a10 * m[3] + a11 * m[7] + a12 * m[11]),
+				a20, a21, a22, -(a20 * m[3] + a21 * m[7] + a22 * m[11])
+		};
+	}
+	template <typename T>
+	constexpr Matrix3x4<T> Matrix3x4<T>::inverse_rigid() const
+	{
+		return Matrix3x4<T>{
+			m[0], m[4], m[8], -(m[0] * m[3] + m[4] * m[7] + m[8] * m[11]),
+				m[1], m[5], m[9], -(m[1] * m[3] + m[5] * m[7] + m[9] * m[11]),
+				m[2], m[6], m[10], -(m[2] * m[3] + m[6] * m[7] + m[10] * m[11])
+		};
+	}
+	template <typename T>
+	constexpr Matrix3<T> Matrix3x4<T>::linear() const
+	{
+		return Matrix3<T>{
+			m[0], m[1], m[2],
+				m[4], m[5], m[6],
+				m[8], m[9], m[10]
+		};
+	}
+	template <typename T>
+	constexpr Vector3<T> Matrix3x4<T>::translation() const
+	{
+		return Vector3<T>{ m[3], m[7], m[11] };
+	}
+	template <typename T>
+	constexpr Matrix4<T> Matrix3x4<T>::to_mtx4() const
+	{
+		return Matrix4<T>{
+			m[0], m[1], m[2], m[3],
+				m[4], m[5], m[6], m[7],
+				m[8], m[9], m[10], m[11],
+				static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1)
+		};
+	}
+	template <typename T>
+	constexpr Vector3<T> Matrix3x4<T>::transform_point(const Vector3<T>& p) const
+	{
+		return Vector3<T>{
+			(m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3]),
+				(m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7]),
+				(m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11])
+		};
+	}
+	template <typename T>
+	constexpr Vector3<T> Matrix3x4<T>::transform_direction(const Vector3<T>& d) const
+	{
+		return Vector3<T>{
+			(m[0] * d.x + m[1] * d.y + m[2] * d.z),
+				(m[4] * d.x + m[5] * d.y + m[6] * d.z),
+				(m[8] * d.x + m[9] * d.y + m[10] * d.z)
+		};
+	}
+
+} // namespace els
+
+#endif
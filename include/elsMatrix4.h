@@ -50,13 +50,18 @@ namespace els
 		constexpr operator bool() const;
 
 		constexpr Scalar det() const;
+		constexpr bool is_affine() const;
 
 		constexpr Matrix4& identity();
 		constexpr Matrix4& transpose();
 		constexpr Matrix4& invert();
+		constexpr Matrix4& invert_affine();
+		constexpr Matrix4& invert_rigid();
 
 		constexpr Matrix4 transposed() const;
 		constexpr Matrix4 inverse() const;
+		constexpr Matrix4 inverse_affine() const; // assumes last row is (0, 0, 0, 1), return zero matrix on fail
+		constexpr Matrix4 inverse_rigid() const; // assumes rotation + translation only
 
 		constexpr static Matrix4<T> look_at(const Vector3<T>& eye, const Vector3<T>& target, const Vector3<T>& up)
 		{
@@ -80,12 +85,12 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Matrix4<T> Matrix4<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+	constexpr Matrix4<T> Matrix4<T>::zero{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 										static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) };
 	template <typename T>
-	const Matrix4<T> Matrix4<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
+	constexpr Matrix4<T> Matrix4<T>::I{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0),
 									static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
@@ -292,124 +297,124 @@ namespace els
 	constexpr Matrix4<T>& Matrix4<T>::invert()
 	{
 		Scalar determinant = det();
-		if (isZero(determinant))
+		if (is_zero(determinant))
 		{
 			*this = zero;
 			return *this;
 		}
 		Matrix4<T> temp = *this;
 
-		m[0] = temp[5] * temp[10] * temp[15] -
-			temp[5] * temp[11] * temp[14] -
-			temp[9] * temp[6] * temp[15] +
-			temp[9] * temp[7] * temp[14] +
-			temp[13] * temp[6] * temp[11] -
-			temp[13] * temp[7] * temp[10];
-
-		m[4] = -temp[4] * temp[10] * temp[15] +
-			temp[4] * temp[11] * temp[14] +
-			temp[8] * temp[6] * temp[15] -
-			temp[8] * temp[7] * temp[14] -
-			temp[12] * temp[6] * temp[11] +
-			temp[12] * temp[7] * temp[10];
-
-		m[8] = temp[4] * temp[9] * temp[15] -
-			temp[4] * temp[11] * temp[13] -
-			temp[8] * temp[5] * temp[15] +
-			temp[8] * temp[7] * temp[13] +
-			temp[12] * temp[5] * temp[11] -
-			temp[12] * temp[7] * temp[9];
-
-		m[12] = -temp[4] * temp[9] * temp[14] +
-			temp[4] * temp[10] * temp[13] +
-			temp[8] * temp[5] * temp[14] -
-			temp[8] * temp[6] * temp[13] -
-			temp[12] * temp[5] * temp[10] +
-			temp[12] * temp[6] * temp[9];
-
-		m[1] = -temp[1] * temp[10] * temp[15] +
-			temp[1] * temp[11] * temp[14] +
-			temp[9] * temp[2] * temp[15] -
-			temp[9] * temp[3] * temp[14] -
-			temp[13] * temp[2] * temp[11] +
-			temp[13] * temp[3] * temp[10];
-
-		m[5] = temp[0] * temp[10] * temp[15] -
-			temp[0] * temp[11] * temp[14] -
-			temp[8] * temp[2] * temp[15] +
-			temp[8] * temp[3] * temp[14] +
-			temp[12] * temp[2] * temp[11] -
-			temp[12] * temp[3] * temp[10];
-
-		m[9] = -temp[0] * temp[9] * temp[15] +
-			temp[0] * temp[11] * temp[13] +
-			temp[8] * temp[1] * temp[15] -
-			temp[8] * temp[3] * temp[13] -
-			temp[12] * temp[1] * temp[11] +
-			temp[12] * temp[3] * temp[9];
-
-		m[13] = temp[0] * temp[9] * temp[14] -
-			temp[0] * temp[10] * temp[13] -
-			temp[8] * temp[1] * temp[14] +
-			temp[8] * temp[2] * temp[13] +
-			temp[12] * temp[1] * temp[10] -
-			temp[12] * temp[2] * temp[9];
-
-		m[2] = temp[1] * temp[6] * temp[15] -
-			temp[1] * temp[7] * temp[14] -
-			temp[5] * temp[2] * temp[15] +
-			temp[5] * temp[3] * temp[14] +
-			temp[13] * temp[2] * temp[7] -
-			temp[13] * temp[3] * temp[6];
-
-		m[6] = -temp[0] * temp[6] * temp[15] +
-			temp[0] * temp[7] * temp[14] +
-			temp[4] * temp[2] * temp[15] -
-			temp[4] * temp[3] * temp[14] -
-			temp[12] * temp[2] * temp[7] +
-			temp[12] * temp[3] * temp[6];
-
-		m[10] = temp[0] * temp[5] * temp[15] -
-			temp[0] * temp[7] * temp[13] -
-			temp[4] * temp[1] * temp[15] +
-			temp[4] * temp[3] * temp[13] +
-			temp[12] * temp[1] * temp[7] -
-			temp[12] * temp[3] * temp[5];
-
-		m[14] = -temp[0] * temp[5] * temp[14] +
-			temp[0] * temp[6] * temp[13] +
-			temp[4] * temp[1] * temp[14] -
-			temp[4] * temp[2] * temp[13] -
-			temp[12] * temp[1] * temp[6] +
-			temp[12] * temp[2] * temp[5];
-
-		m[3] = -temp[1] * temp[6] * temp[11] +
-			temp[1] * temp[7] * temp[10] +
-			temp[5] * temp[2] * temp[11] -
-			temp[5] * temp[3] * temp[10] -
-			temp[9] * temp[2] * temp[7] +
-			temp[9] * temp[3] * temp[6];
-
-		m[7] = temp[0] * temp[6] * temp[11] -
-			temp[0] * temp[7] * temp[10] -
-			temp[4] * temp[2] * temp[11] +
-			temp[4] * temp[3] * temp[10] +
-			temp[8] * temp[2] * temp[7] -
-			temp[8] * temp[3] * temp[6];
-
-		m[11] = -temp[0] * temp[5] * temp[11] +
-			temp[0] * temp[7] * temp[9] +
-			temp[4] * temp[1] * temp[11] -
-			temp[4] * temp[3] * temp[9] -
-			temp[8] * temp[1] * temp[7] +
-			temp[8] * temp[3] * temp[5];
-
-		m[15] = temp[0] * temp[5] * temp[10] -
-			temp[0] * temp[6] * temp[9] -
-			temp[4] * temp[1] * temp[10] +
-			temp[4] * temp[2] * temp[9] +
-			temp[8] * temp[1] * temp[6] -
-			temp[8] * temp[2] * temp[5];
+		m[0] = temp.m[5] * temp.m[10] * temp.m[15] -
+			temp.m[5] * temp.m[11] * temp.m[14] -
+			temp.m[9] * temp.m[6] * temp.m[15] +
+			temp.m[9] * temp.m[7] * temp.m[14] +
+			temp.m[13] * temp.m[6] * temp.m[11] -
+			temp.m[13] * temp.m[7] * temp.m[10];
+
+		m[4] = -temp.m[4] * temp.m[10] * temp.m[15] +
+			temp.m[4] * temp.m[11] * temp.m[14] +
+			temp.m[8] * temp.m[6] * temp.m[15] -
+			temp.m[8] * temp.m[7] * temp.m[14] -
+			temp.m[12] * temp.m[6] * temp.m[11] +
+			temp.m[12] * temp.m[7] * temp.m[10];
+
+		m[8] = temp.m[4] * temp.m[9] * temp.m[15] -
+			temp.m[4] * temp.m[11] * temp.m[13] -
+			temp.m[8] * temp.m[5] * temp.m[15] +
+			temp.m[8] * temp.m[7] * temp.m[13] +
+			temp.m[12] * temp.m[5] * temp.m[11] -
+			temp.m[12] * temp.m[7] * temp.m[9];
+
+		m[12] = -temp.m[4] * temp.m[9] * temp.m[14] +
+			temp.m[4] * temp.m[10] * temp.m[13] +
+			temp.m[8] * temp.m[5] * temp.m[14] -
+			temp.m[8] * temp.m[6] * temp.m[13] -
+			temp.m[12] * temp.m[5] * temp.m[10] +
+			temp.m[12] * temp.m[6] * temp.m[9];
+
+		m[1] = -temp.m[1] * temp.m[10] * temp.m[15] +
+			temp.m[1] * temp.m[11] * temp.m[14] +
+			temp.m[9] * temp.m[2] * temp.m[15] -
+			temp.m[9] * temp.m[3] * temp.m[14] -
+			temp.m[13] * temp.m[2] * temp.m[11] +
+			temp.m[13] * temp.m[3] * temp.m[10];
+
+		m[5] = temp.m[0] * temp.m[10] * temp.m[15] -
+			temp.m[0] * temp.m[11] * temp.m[14] -
+			temp.m[8] * temp.m[2] * temp.m[15] +
+			temp.m[8] * temp.m[3] * temp.m[14] +
+			temp.m[12] * temp.m[2] * temp.m[11] -
+			temp.m[12] * temp.m[3] * temp.m[10];
+
+		m[9] = -temp.m[0] * temp.m[9] * temp.m[15] +
+			temp.m[0] * temp.m[11] * temp.m[13] +
+			temp.m[8] * temp.m[1] * temp.m[15] -
+			temp.m[8] * temp.m[3] * temp.m[13] -
+			temp.m[12] * temp.m[1] * temp.m[11] +
+			temp.m[12] * temp.m[3] * temp.m[9];
+
+		m[13] = temp.m[0] * temp.m[9] * temp.m[14] -
+			temp.m[0] * temp.m[10] * temp.m[13] -
+			temp.m[8] * temp.m[1] * temp.m[14] +
+			temp.m[8] * temp.m[2] * temp.m[13] +
+			temp.m[12] * temp.m[1] * temp.m[10] -
+			temp.m[12] * temp.m[2] * temp.m[9];
+
+		m[2] = temp.m[1] * temp.m[6] * temp.m[15] -
+			temp.m[1] * temp.m[7] * temp.m[14] -
+			temp.m[5] * temp.m[2] * temp.m[15] +
+			temp.m[5] * temp.m[3] * temp.m[14] +
+			temp.m[13] * temp.m[2] * temp.m[7] -
+			temp.m[13] * temp.m[3] * temp.m[6];
+
+		m[6] = -temp.m[0] * temp.m[6] * temp.m[15] +
+			temp.m[0] * temp.m[7] * temp.m[14] +
+			temp.m[4] * temp.m[2] * temp.m[15] -
+			temp.m[4] * temp.m[3] * temp.m[14] -
+			temp.m[12] * temp.m[2] * temp.m[7] +
+			temp.m[12] * temp.m[3] * temp.m[6];
+
+		m[10] = temp.m[0] * temp.m[5] * temp.m[15] -
+			temp.m[0] * temp.m[7] * temp.m[13] -
+			temp.m[4] * temp.m[1] * temp.m[15] +
+			temp.m[4] * temp.m[3] * temp.m[13] +
+			temp.m[12] * temp.m[1] * temp.m[7] -
+			temp.m[12] * temp.m[3] * temp.m[5];
+
+		m[14] = -temp.m[0] * temp.m[5] * temp.m[14] +
+			temp.m[0] * temp.m[6] * temp.m[13] +
+			temp.m[4] * temp.m[1] * temp.m[14] -
+			temp.m[4] * temp.m[2] * temp.m[13] -
+			temp.m[12] * temp.m[1] * temp.m[6] +
+			temp.m[12] * temp.m[2] * temp.m[5];
+
+		m[3] = -temp.m[1] * temp.m[6] * temp.m[11] +
+			temp.m[1] * temp.m[7] * temp.m[10] +
+			temp.m[5] * temp.m[2] * temp.m[11] -
+			temp.m[5] * temp.m[3] * temp.m[10] -
+			temp.m[9] * temp.m[2] * temp.m[7] +
+			temp.m[9] * temp.m[3] * temp.m[6];
+
+		m[7] = temp.m[0] * temp.m[6] * temp.m[11] -
+			temp.m[0] * temp.m[7] * temp.m[10] -
+			temp.m[4] * temp.m[2] * temp.m[11] +
+			temp.m[4] * temp.m[3] * temp.m[10] +
+			temp.m[8] * temp.m[2] * temp.m[7] -
+			temp.m[8] * temp.m[3] * temp.m[6];
+
+		m[11] = -temp.m[0] * temp.m[5] * temp.m[11] +
+			temp.m[0] * temp.m[7] * temp.m[9] +
+			temp.m[4] * temp.m[1] * temp.m[11] -
+			temp.m[4] * temp.m[3] * temp.m[9] -
+			temp.m[8] * temp.m[1] * temp.m[7] +
+			temp.m[8] * temp.m[3] * temp.m[5];
+
+		m[15] = temp.m[0] * temp.m[5] * temp.m[10] -
+			temp.m[0] * temp.m[6] * temp.m[9] -
+			temp.m[4] * temp.m[1] * temp.m[10] +
+			temp.m[4] * temp.m[2] * temp.m[9] +
+			temp.m[8] * temp.m[1] * temp.m[6] -
+			temp.m[8] * temp.m[2] * temp.m[5];
 
 		for (auto& i : m)
 			i /= determinant;
@@ -417,6 +422,65 @@ namespace els
 		return *this;
 	}
 	template <typename T>
+	constexpr bool Matrix4<T>::is_affine() const
+	{
+		return m[12] == static_cast<Scalar>(0) && m[13] == static_cast<Scalar>(0) &&
+			m[14] == static_cast<Scalar>(0) && m[15] == static_cast<Scalar>(1);
+	}
+	template <typename T>
+	constexpr Matrix4<T>& Matrix4<T>::invert_affine()
+	{
+		*this = inverse_affine();
+		return *this;
+	}
+	template <typename T>
+	constexpr Matrix4<T>& Matrix4<T>::invert_rigid()
+	{
+		*this = inverse_rigid();
+		return *this;
+	}
+	template <typename T>
+	constexpr Matrix4<T> Matrix4<T>::inverse_affine() const
+	{
+		// inverse of the 3x3 linear part, translation follows as -A^-1 * t
+		const Scalar c00 = m[5] * m[10] - m[6] * m[9];
+		const Scalar c01 = m[6] * m[8] - m[4] * m[10];
+		const Scalar c02 = m[4] * m[9] - m[5] * m[8];
+
+		const Scalar determinant = m[0] * c00 + m[1] * c01 + m[2] * c02;
+		if (is_zero(determinant))
+			return zero;
+
+		const Scalar inv = static_cast<Scalar>(1) / determinant;
+
+		const Scalar a00 = c00 * inv;
+		const Scalar a01 = (m[2] * m[9] - m[1] * m[10]) * inv;
+		const Scalar a02 = (m[1] * m[6] - m[2] * m[5]) * inv;
+		const Scalar a10 = c01 * inv;
+		const Scalar a11 = (m[0] * m[10] - m[2] * m[8]) * inv;
+		const Scalar a12 = (m[2] * m[4] - m[0] * m[6]) * inv;
+		const Scalar a20 = c02 * inv;
+		const Scalar a21 = (m[1] * m[8] - m[0] * m[9]) * inv;
+		const Scalar a22 = (m[0] * m[5] - m[1] * m[4]) * inv;
+
+		return Matrix4<T>{
+			a00, a01, a02, -(a00 * m[3] + a01 * m[7] + a02 * m[11]),
+				a10, a11, a12, -(a10 * m[3] + a11 * m[7] + a12 * m[11]),
+				a20, a21, a22, -(a20 * m[3] + a21 * m[7] + a22 * m[11]),
+				static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1)
+		};
+	}
+	template <typename T>
+	constexpr Matrix4<T> Matrix4<T>::inverse_rigid() const
+	{
+		return Matrix4<T>{
+			m[0], m[4], m[8], -(m[0] * m[3] + m[4] * m[7] + m[8] * m[11]),
+				m[1], m[5], m[9], -(m[1] * m[3] + m[5] * m[7] + m[9] * m[11]),
+				m[2], m[6], m[10], -(m[2] * m[3] + m[6] * m[7] + m[10] * m[11]),
+				static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1)
+		};
+	}
+	template <typename T>
 	constexpr Matrix4<T> Matrix4<T>::transposed() const
 	{
 		return Matrix4<T>{
@@ -0,0 +1,283 @@
+#ifndef ELS_MATRIX_BATCH
+#define ELS_MATRIX_BATCH
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsCompare.h"
+#include "elsMatrix3.h"
+#include "elsMatrix4.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// matrices per worker chunk for the span versions
+	constexpr size_t matrix_batch_grain = 1 << 12;
+
+	namespace detail
+	{
+		namespace matrix_batch
+		{
+			// every entry is indexed by n - 3
+			struct matrix_batch_table
+			{
+				size_t (*invert[2])(const float*, float*, size_t);
+				void (*determinant[2])(const float*, float*, size_t);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+				inline V strided(const float* p, size_t stride) { return simd::load_strided(p, stride); }
+				inline void transpose_block(V* r) { simd::transpose(r[0], r[1], r[2], r[3]); }
+#include "elsMatrixBatchKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+				inline V strided(const float* p, size_t stride) { return simd::load8_strided(p, stride); }
+				inline void transpose_block(V* r) { simd::transpose(r); }
+#include "elsMatrixBatchKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const matrix_batch_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const matrix_batch_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const matrix_batch_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			static_assert(sizeof(Matrix3<float>) == 9 * sizeof(float), "the kernels read Matrix3<float> as packed floats");
+			static_assert(sizeof(Matrix4<float>) == 16 * sizeof(float), "the kernels read Matrix4<float> as packed floats");
+
+			template <typename Matrix>
+			struct order;
+			template <typename T>
+			struct order<Matrix3<T>> : std::integral_constant<unsigned int, 3> {};
+			template <typename T>
+			struct order<Matrix4<T>> : std::integral_constant<unsigned int, 4> {};
+
+			// Matrix3 or Matrix4 of a floating point type other than float, for the scalar fallbacks
+			template <typename Matrix>
+			using fallback_t = std::enable_if_t<std::is_floating_point<typename Matrix::Scalar>::value &&
+				!std::is_same<typename Matrix::Scalar, float>::value && (order<Matrix>::value > 0)>;
+
+			template <typename Fn>
+			inline void run(size_t count, Fn&& fn)
+			{
+				parallel::for_range(0, count, matrix_batch_grain, fn);
+			}
+
+			// row r of a packed matrix in the first N lanes, the last row of a Matrix3 is read lane by lane
+			// so the load stays inside the matrix
+			template <unsigned int N>
+			inline simd::float4 load_row(const float* p, unsigned int r)
+			{
+				if (N == 3 && r == 2)
+					return simd::set(p[6], p[7], p[8], 0.f);
+				return simd::load(p + N * r);
+			}
+
+			// the rows go out in order so the spare lane of each Matrix3 row is overwritten by the next one
+			template <unsigned int N>
+			inline void store_rows(float* p, const simd::float4* rows)
+			{
+				for (unsigned int r = 0; r + 1 < N; ++r)
+					store(p + N * r, rows[r]);
+				if (N == 4)
+				{
+					store(p + 12, rows[3]);
+					return;
+				}
+				float lanes[4];
+				store(lanes, rows[2]);
+				p[6] = lanes[0];
+				p[7] = lanes[1];
+				p[8] = lanes[2];
+			}
+
+			// out = a * b as operator* does it, row r of the textbook b a is the sum over k of b[r][k] times
+			// row k of a, everything is read before out is written so out may alias a or b
+			template <unsigned int N>
+			inline void multiply_one(const float* a, const float* b, float* out)
+			{
+				simd::float4 x[N], c[N];
+				for (unsigned int k = 0; k < N; ++k)
+					x[k] = load_row<N>(a, k);
+				for (unsigned int r = 0; r < N; ++r)
+				{
+					simd::float4 s = simd::broadcast(b[N * r]) * x[0];
+					for (unsigned int k = 1; k < N; ++k)
+						s = madd(simd::broadcast(b[N * r + k]), x[k], s);
+					c[r] = s;
+				}
+				store_rows<N>(out, c);
+			}
+
+			template <unsigned int N>
+			inline void transpose_one(const float* in, float* out)
+			{
+				simd::float4 x[4];
+				for (unsigned int r = 0; r < N; ++r)
+					x[r] = load_row<N>(in, r);
+				if (N == 3)
+					x[3] = simd::zero();
+				simd::transpose(x[0], x[1], x[2], x[3]);
+				store_rows<N>(out, x);
+			}
+
+			template <typename Matrix>
+			inline void multiply(span<const Matrix> a, span<const Matrix> b, span<Matrix> out)
+			{
+				constexpr unsigned int n = order<Matrix>::value;
+				run(a.size(), [&](size_t first, size_t last)
+					{
+						for (size_t i = first; i < last; ++i)
+							multiply_one<n>(a[i].data(), b[i].data(), out[i].data());
+					});
+			}
+			// the one matrix is copied first, out may alias it too
+			template <typename Matrix>
+			inline void multiply_left(const Matrix& a, span<const Matrix> b, span<Matrix> out)
+			{
+				constexpr unsigned int n = order<Matrix>::value;
+				const Matrix m = a;
+				run(b.size(), [&](size_t first, size_t last)
+					{
+						for (size_t i = first; i < last; ++i)
+							multiply_one<n>(m.data(), b[i].data(), out[i].data());
+					});
+			}
+			template <typename Matrix>
+			inline void multiply_right(span<const Matrix> a, const Matrix& b, span<Matrix> out)
+			{
+				constexpr unsigned int n = order<Matrix>::value;
+				const Matrix m = b;
+				run(a.size(), [&](size_t first, size_t last)
+					{
+						for (size_t i = first; i < last; ++i)
+							multiply_one<n>(a[i].data(), m.data(), out[i].data());
+					});
+			}
+			template <typename Matrix>
+			inline void transpose(span<const Matrix> in, span<Matrix> out)
+			{
+				constexpr unsigned int n = order<Matrix>::value;
+				run(in.size(), [&](size_t first, size_t last)
+					{
+						for (size_t i = first; i < last; ++i)
+							transpose_one<n>(in[i].data(), out[i].data());
+					});
+			}
+			template <typename Matrix>
+			inline size_t invert(span<const Matrix> in, span<Matrix> out)
+			{
+				const auto kernel = kernels().invert[order<Matrix>::value - 3];
+				std::atomic<size_t> failed{ 0 };
+				run(in.size(), [&](size_t first, size_t last) { failed += kernel(in[first].data(), out[first].data(), last - first); });
+				return failed;
+			}
+			template <typename Matrix>
+			inline void determinant(span<const Matrix> in, span<float> out)
+			{
+				const auto kernel = kernels().determinant[order<Matrix>::value - 3];
+				run(in.size(), [&](size_t first, size_t last) { kernel(in[first].data(), out.data() + first, last - first); });
+			}
+		}
+	}
+
+	// span versions of the Matrix3 and Matrix4 products, inverse, transpose and determinant, out must
+	// hold at least as many elements as the input and may alias it
+	// float spans invert and take determinants 4 or 8 matrices per simd register, element e of every
+	// matrix in a block shares one register, the products and the transpose keep one matrix row per
+	// register since they are mostly data movement, other types loop over the scalar functions
+	// the float inverse is built from 2x2 minors and one reciprocal and fuses multiply-adds when the cpu
+	// has avx2, so it can differ from inverse() in the last bit or two
+	// the products add in the same order as operator*, they only give the same bits when the compiler
+	// does not contract either side into fma, -mfma with gcc's default -ffp-contract=fast can cost an ulp
+
+	// out[i] = a[i] * b[i], operator* order, which is b[i] a[i] in the textbook sense
+	inline void multiply(span<const Matrix3<float>> a, span<const Matrix3<float>> b, span<Matrix3<float>> out) { detail::matrix_batch::multiply(a, b, out); }
+	inline void multiply(span<const Matrix4<float>> a, span<const Matrix4<float>> b, span<Matrix4<float>> out) { detail::matrix_batch::multiply(a, b, out); }
+
+	// out[i] = a * b[i] and out[i] = a[i] * b, one matrix against a span
+	inline void multiply_by_one(const Matrix3<float>& a, span<const Matrix3<float>> b, span<Matrix3<float>> out) { detail::matrix_batch::multiply_left(a, b, out); }
+	inline void multiply_by_one(const Matrix4<float>& a, span<const Matrix4<float>> b, span<Matrix4<float>> out) { detail::matrix_batch::multiply_left(a, b, out); }
+	inline void multiply_by_one(span<const Matrix3<float>> a, const Matrix3<float>& b, span<Matrix3<float>> out) { detail::matrix_batch::multiply_right(a, b, out); }
+	inline void multiply_by_one(span<const Matrix4<float>> a, const Matrix4<float>& b, span<Matrix4<float>> out) { detail::matrix_batch::multiply_right(a, b, out); }
+
+	inline void transpose(span<const Matrix3<float>> in, span<Matrix3<float>> out) { detail::matrix_batch::transpose(in, out); }
+	inline void transpose(span<const Matrix4<float>> in, span<Matrix4<float>> out) { detail::matrix_batch::transpose(in, out); }
+
+	// a matrix whose determinant is_zero gets the zero matrix like inverse(), returns how many did
+	inline size_t invert(span<const Matrix3<float>> in, span<Matrix3<float>> out) { return detail::matrix_batch::invert(in, out); }
+	inline size_t invert(span<const Matrix4<float>> in, span<Matrix4<float>> out) { return detail::matrix_batch::invert(in, out); }
+
+	inline void determinant(span<const Matrix3<float>> in, span<float> out) { detail::matrix_batch::determinant(in, out); }
+	inline void determinant(span<const Matrix4<float>> in, span<float> out) { detail::matrix_batch::determinant(in, out); }
+
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline void multiply(span<const Matrix> a, span<const Matrix> b, span<Matrix> out)
+	{
+		detail::matrix_batch::run(a.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = a[i] * b[i]; });
+	}
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline void multiply_by_one(const Matrix& a, span<const Matrix> b, span<Matrix> out)
+	{
+		const Matrix m = a;
+		detail::matrix_batch::run(b.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = m * b[i]; });
+	}
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline void multiply_by_one(span<const Matrix> a, const Matrix& b, span<Matrix> out)
+	{
+		const Matrix m = b;
+		detail::matrix_batch::run(a.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = a[i] * m; });
+	}
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline void transpose(span<const Matrix> in, span<Matrix> out)
+	{
+		detail::matrix_batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = in[i].transposed(); });
+	}
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline size_t invert(span<const Matrix> in, span<Matrix> out)
+	{
+		std::atomic<size_t> failed{ 0 };
+		detail::matrix_batch::run(in.size(), [&](size_t first, size_t last)
+			{
+				size_t count = 0;
+				for (size_t i = first; i < last; ++i)
+				{
+					const bool singular = is_zero(in[i].det());
+					out[i] = singular ? Matrix::zero : in[i].inverse();
+					count += singular;
+				}
+				failed += count;
+			});
+		return failed;
+	}
+	template <typename Matrix, typename = detail::matrix_batch::fallback_t<Matrix>>
+	inline void determinant(span<const Matrix> in, span<typename Matrix::Scalar> out)
+	{
+		detail::matrix_batch::run(in.size(), [&](size_t first, size_t last) { for (size_t i = first; i < last; ++i) out[i] = in[i].det(); });
+	}
+
+} // namespace els
+
+#endif
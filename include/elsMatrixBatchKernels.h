@@ -0,0 +1,185 @@
+// no include guard, elsMatrixBatch.h includes this once per register width
+// the enclosing namespace provides V, splat(float), loadv(const float*), strided(const float*, size_t)
+// and transpose_block(V*), an in-place transpose of V::width registers
+//
+// a block of V::width matrices is held in one register per element, lane k is matrix k and
+// a[N * r + c] is row r column c, short blocks are padded with zero matrices
+
+// a full block moves V::width elements of every matrix at once, a square of loads turned around
+// by one register transpose, only the elements past the last full square go one lane at a time
+template <unsigned int N>
+inline void gather(const float* p, size_t count, V* a)
+{
+	constexpr unsigned int squared = N * N / V::width * V::width;
+	if (count == V::width)
+	{
+		for (unsigned int e = 0; e < squared; e += V::width)
+		{
+			for (size_t k = 0; k < V::width; ++k)
+				a[e + k] = loadv(p + N * N * k + e);
+			transpose_block(a + e);
+		}
+		for (unsigned int e = squared; e < N * N; ++e)
+			a[e] = strided(p + e, N * N);
+		return;
+	}
+
+	float lanes[N * N][V::width];
+	for (size_t k = 0; k < V::width; ++k)
+	{
+		for (unsigned int e = 0; e < N * N; ++e)
+			lanes[e][k] = k < count ? p[N * N * k + e] : 0.f;
+	}
+	for (unsigned int e = 0; e < N * N; ++e)
+		a[e] = loadv(lanes[e]);
+}
+
+template <unsigned int N>
+inline void scatter(const V* a, float* p, size_t count)
+{
+	constexpr unsigned int squared = N * N / V::width * V::width;
+	unsigned int first = 0;
+	if (count == V::width)
+	{
+		for (; first < squared; first += V::width)
+		{
+			V r[V::width];
+			for (size_t k = 0; k < V::width; ++k)
+				r[k] = a[first + k];
+			transpose_block(r);
+			for (size_t k = 0; k < V::width; ++k)
+				store(p + N * N * k + first, r[k]);
+		}
+	}
+
+	float lanes[N * N][V::width];
+	for (unsigned int e = first; e < N * N; ++e)
+		store(lanes[e], a[e]);
+	for (size_t k = 0; k < count; ++k)
+	{
+		for (unsigned int e = first; e < N * N; ++e)
+			p[N * N * k + e] = lanes[e][k];
+	}
+}
+
+// a b - c d
+inline V minor2(const V& a, const V& b, const V& c, const V& d)
+{
+	return a * b - c * d;
+}
+
+// the 2x2 minors of the top two rows and of the bottom two, the determinant and the inverse
+// are both sums of their products
+struct minors4
+{
+	V s[6];
+	V c[6];
+};
+inline minors4 minors(const V* a)
+{
+	return minors4{
+		{ minor2(a[0], a[5], a[4], a[1]), minor2(a[0], a[6], a[4], a[2]), minor2(a[0], a[7], a[4], a[3]),
+		  minor2(a[1], a[6], a[5], a[2]), minor2(a[1], a[7], a[5], a[3]), minor2(a[2], a[7], a[6], a[3]) },
+		{ minor2(a[8], a[13], a[12], a[9]), minor2(a[8], a[14], a[12], a[10]), minor2(a[8], a[15], a[12], a[11]),
+		  minor2(a[9], a[14], a[13], a[10]), minor2(a[9], a[15], a[13], a[11]), minor2(a[10], a[15], a[14], a[11]) } };
+}
+inline V det4(const minors4& m)
+{
+	return m.s[0] * m.c[5] - m.s[1] * m.c[4] + m.s[2] * m.c[3] + m.s[3] * m.c[2] - m.s[4] * m.c[1] + m.s[5] * m.c[0];
+}
+inline V det3(const V* a)
+{
+	return a[0] * minor2(a[4], a[8], a[5], a[7]) - a[1] * minor2(a[3], a[8], a[5], a[6]) + a[2] * minor2(a[3], a[7], a[4], a[6]);
+}
+
+template <unsigned int N>
+inline void determinant(const float* in, float* out, size_t n)
+{
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V x[N * N];
+		gather<N>(in + N * N * i, count, x);
+		V d;
+		if constexpr (N == 3)
+			d = det3(x);
+		else
+			d = det4(minors(x));
+
+		if (count == V::width)
+		{
+			store(out + i, d);
+			continue;
+		}
+		float lanes[V::width];
+		store(lanes, d);
+		for (size_t k = 0; k < count; ++k)
+			out[i + k] = lanes[k];
+	}
+}
+
+// matrices whose determinant is_zero get the zero matrix like inverse(), returns how many
+template <unsigned int N>
+inline size_t invert(const float* in, float* out, size_t n)
+{
+	size_t failed = 0;
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V a[N * N], b[N * N], d;
+		gather<N>(in + N * N * i, count, a);
+		if constexpr (N == 3)
+		{
+			d = det3(a);
+			b[0] = minor2(a[4], a[8], a[7], a[5]);
+			b[1] = minor2(a[2], a[7], a[1], a[8]);
+			b[2] = minor2(a[1], a[5], a[2], a[4]);
+			b[3] = minor2(a[5], a[6], a[3], a[8]);
+			b[4] = minor2(a[0], a[8], a[2], a[6]);
+			b[5] = minor2(a[3], a[2], a[0], a[5]);
+			b[6] = minor2(a[3], a[7], a[6], a[4]);
+			b[7] = minor2(a[6], a[1], a[0], a[7]);
+			b[8] = minor2(a[0], a[4], a[3], a[1]);
+		}
+		else
+		{
+			const minors4 m = minors(a);
+			d = det4(m);
+			const V* s = m.s;
+			const V* c = m.c;
+			b[0] = a[5] * c[5] - a[6] * c[4] + a[7] * c[3];
+			b[1] = a[2] * c[4] - a[1] * c[5] - a[3] * c[3];
+			b[2] = a[13] * s[5] - a[14] * s[4] + a[15] * s[3];
+			b[3] = a[10] * s[4] - a[9] * s[5] - a[11] * s[3];
+			b[4] = a[6] * c[2] - a[4] * c[5] - a[7] * c[1];
+			b[5] = a[0] * c[5] - a[2] * c[2] + a[3] * c[1];
+			b[6] = a[14] * s[2] - a[12] * s[5] - a[15] * s[1];
+			b[7] = a[8] * s[5] - a[10] * s[2] + a[11] * s[1];
+			b[8] = a[4] * c[4] - a[5] * c[2] + a[7] * c[0];
+			b[9] = a[1] * c[2] - a[0] * c[4] - a[3] * c[0];
+			b[10] = a[12] * s[4] - a[13] * s[2] + a[15] * s[0];
+			b[11] = a[9] * s[2] - a[8] * s[4] - a[11] * s[0];
+			b[12] = a[5] * c[1] - a[4] * c[3] - a[6] * c[0];
+			b[13] = a[0] * c[3] - a[1] * c[1] + a[2] * c[0];
+			b[14] = a[13] * s[1] - a[12] * s[3] - a[14] * s[0];
+			b[15] = a[8] * s[3] - a[9] * s[1] + a[10] * s[0];
+		}
+
+		// is_zero(det) in lanes, the padding lanes are singular too and are not counted
+		const V singular = less_equal(d * d, splat(epsilon2<float>));
+		const V inv = splat(1.f) / d;
+		for (unsigned int e = 0; e < N * N; ++e)
+			b[e] = select(singular, splat(0.f), b[e] * inv);
+		scatter<N>(b, out + N * N * i, count);
+		for (uint32_t bits = simd::mask_bits(singular) & ((1u << count) - 1); bits; bits &= bits - 1)
+			++failed;
+	}
+	return failed;
+}
+
+inline matrix_batch_table make_table()
+{
+	return matrix_batch_table{
+		{ &invert<3>, &invert<4> },
+		{ &determinant<3>, &determinant<4> } };
+}
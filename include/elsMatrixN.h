@@ -0,0 +1,347 @@
+#ifndef ELS_MATRIXN
+#define ELS_MATRIXN
+
+#include <utility>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsSimd.h"
+#include "elsVectorN.h"
+#include "elsMatrix2.h"
+#include "elsMatrix3.h"
+#include "elsMatrix4.h"
+#include "elsMatrix3x4.h"
+
+namespace els
+{
+	// generic R x C matrix, row-major like the fixed size matrices
+	// Matrix2/3/4 and Matrix3x4 convert to and from the matching shape
+	template <size_t R, size_t C, typename T>
+	struct Matrix
+	{
+		static_assert(R > 0 && C > 0, "empty matrix");
+
+		using Scalar = T;
+		using row_type = Vector<C, T>;
+		using col_type = Vector<R, T>;
+		static constexpr size_t rows = R;
+		static constexpr size_t cols = C;
+		static constexpr size_t size = R * C;
+
+		Scalar m[R * C];
+
+		constexpr Matrix() : Matrix{ static_cast<Scalar>(1) } {}
+		// s on the diagonal
+		constexpr explicit Matrix(const Scalar& s) : Matrix{ s, std::make_index_sequence<R * C>{} } {}
+		template <typename... Ts, typename = std::enable_if_t<sizeof...(Ts) == R * C && (R * C > 1) && (std::is_convertible<Ts, T>::value && ...)>>
+		constexpr Matrix(const Ts&... s) : m{ static_cast<Scalar>(s)... } {}
+
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 2 && C2 == 2>>
+		constexpr Matrix(const Matrix2<T>& rhs) : Matrix{ rhs.m, std::make_index_sequence<4>{} } {}
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 3 && C2 == 3>>
+		constexpr Matrix(const Matrix3<T>& rhs) : Matrix{ rhs.m, std::make_index_sequence<9>{} } {}
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 4 && C2 == 4>>
+		constexpr Matrix(const Matrix4<T>& rhs) : Matrix{ rhs.m, std::make_index_sequence<16>{} } {}
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 3 && C2 == 4>>
+		constexpr Matrix(const Matrix3x4<T>& rhs) : Matrix{ rhs.m, std::make_index_sequence<12>{} } {}
+
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 2 && C2 == 2>>
+		constexpr operator Matrix2<T>() const { return to<Matrix2<T>>(std::make_index_sequence<4>{}); }
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 3 && C2 == 3>>
+		constexpr operator Matrix3<T>() const { return to<Matrix3<T>>(std::make_index_sequence<9>{}); }
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 4 && C2 == 4>>
+		constexpr operator Matrix4<T>() const { return to<Matrix4<T>>(std::make_index_sequence<16>{}); }
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == 3 && C2 == 4>>
+		constexpr operator Matrix3x4<T>() const { return to<Matrix3x4<T>>(std::make_index_sequence<12>{}); }
+
+		constexpr Scalar* data() { return m; }
+		constexpr const Scalar* data() const { return m; }
+
+		constexpr Scalar* operator[](size_t row) { return m + row * C; }
+		constexpr const Scalar* operator[](size_t row) const { return m + row * C; }
+		constexpr Scalar& operator()(size_t row, size_t col) { return m[row * C + col]; }
+		constexpr const Scalar& operator()(size_t row, size_t col) const { return m[row * C + col]; }
+
+		constexpr bool operator==(const Matrix& rhs) const;
+		constexpr bool operator!=(const Matrix& rhs) const;
+
+		constexpr Matrix& operator+=(const Matrix& rhs);
+		constexpr Matrix& operator-=(const Matrix& rhs);
+		template <typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+		constexpr Matrix& operator*=(S rhs);
+		// only for square right hand sides, the shape must not change
+		constexpr Matrix& operator*=(const Matrix<C, C, T>& rhs);
+
+		constexpr row_type row(size_t i) const;
+		constexpr col_type col(size_t j) const;
+		constexpr Matrix& set_row(size_t i, const row_type& r);
+		constexpr Matrix& set_col(size_t j, const col_type& c);
+
+		constexpr Matrix<C, R, T> transposed() const;
+
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == C2>>
+		constexpr Scalar trace() const;
+		template <size_t R2 = R, size_t C2 = C, typename = std::enable_if_t<R2 == C2>>
+		constexpr Matrix& transpose();
+
+		constexpr Matrix& identity();
+
+		static const Matrix I;
+		static const Matrix zero;
+
+	private:
+		template <size_t... I>
+		constexpr Matrix(const Scalar& s, std::index_sequence<I...>)
+			: m{ (I / C == I % C ? s : static_cast<Scalar>(0))... } {}
+		template <typename A, size_t... I>
+		constexpr Matrix(const A& a, std::index_sequence<I...>) : m{ a[I]... } {}
+
+		template <typename M, size_t... I>
+		constexpr M to(std::index_sequence<I...>) const { return M{ m[I]... }; }
+		// element I of the transpose sits at row I / R, column I % R
+		template <size_t... I>
+		constexpr Matrix<C, R, T> transposed(std::index_sequence<I...>) const { return Matrix<C, R, T>{ m[(I % R) * C + I / R]... }; }
+		template <size_t... I>
+		constexpr Scalar trace(std::index_sequence<I...>) const { return (m[I * C + I] + ...); }
+	};
+
+	// typedefs
+	template <size_t R, size_t C>
+	using matf = Matrix<R, C, float>;
+	template <size_t R, size_t C>
+	using matn = Matrix<R, C, defaultType>;
+
+	using mat2x3f = Matrix<2, 3, float>;
+	using mat2x3 = Matrix<2, 3, defaultType>;
+	using mat3x2f = Matrix<3, 2, float>;
+	using mat3x2 = Matrix<3, 2, defaultType>;
+	using mat4x3f = Matrix<4, 3, float>;
+	using mat4x3 = Matrix<4, 3, defaultType>;
+
+	// constants
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T> Matrix<R, C, T>::I{ static_cast<Scalar>(1) };
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T> Matrix<R, C, T>::zero{ static_cast<Scalar>(0) };
+
+	namespace detail
+	{
+		// out[i] = sum_k lhs(i, k) * rhs.row(k), unrolled over k
+		template <size_t R, size_t K, size_t C, typename T, size_t... Ks>
+		constexpr Vector<C, T> mul_row(const Matrix<R, K, T>& lhs, const Matrix<K, C, T>& rhs, size_t i, std::index_sequence<Ks...>)
+		{
+			return ((rhs.row(Ks) * lhs.m[i * K + Ks]) + ...);
+		}
+		template <size_t R, size_t K, size_t C, typename T, size_t... Rs>
+		constexpr Matrix<R, C, T> mul(const Matrix<R, K, T>& lhs, const Matrix<K, C, T>& rhs, std::index_sequence<Rs...>)
+		{
+			Matrix<R, C, T> out;
+			(out.set_row(Rs, mul_row(lhs, rhs, Rs, std::make_index_sequence<K>{})), ...);
+			return out;
+		}
+		template <size_t R, size_t C, typename T, size_t... Cs>
+		constexpr T mul_dot(const Matrix<R, C, T>& lhs, const Vector<C, T>& rhs, size_t i, std::index_sequence<Cs...>)
+		{
+			return ((lhs.m[i * C + Cs] * rhs.v[Cs]) + ...);
+		}
+		template <size_t R, size_t C, typename T, size_t... Rs>
+		constexpr Vector<R, T> mul(const Matrix<R, C, T>& lhs, const Vector<C, T>& rhs, std::index_sequence<Rs...>)
+		{
+			return Vector<R, T>{ mul_dot(lhs, rhs, Rs, std::make_index_sequence<C>{})... };
+		}
+
+		// rows of 4 floats are blended in registers, one broadcast madd per lhs element
+		template <size_t R, size_t K>
+		inline Matrix<R, 4, float> mul_simd(const Matrix<R, K, float>& lhs, const Matrix<K, 4, float>& rhs)
+		{
+			using namespace simd;
+
+			float4 b[K];
+			for (size_t k = 0; k < K; ++k)
+				b[k] = load(rhs.m + k * 4);
+
+			Matrix<R, 4, float> out;
+			for (size_t i = 0; i < R; ++i)
+			{
+				const float* a = lhs.m + i * K;
+				float4 r = b[0] * broadcast(a[0]);
+				for (size_t k = 1; k < K; ++k)
+					r = madd(b[k], broadcast(a[k]), r);
+				store(out.m + i * 4, r);
+			}
+			return out;
+		}
+	}
+
+	// global operators
+	// the textbook product lhs rhs, the only order that works for every shape. it is not operator*
+	// because Matrix2/3/4 compute b a for a * b, so swapping one of them for a Matrix of the same
+	// shape fails to compile instead of reversing the product. operator*= is this rhs in both families
+	template <size_t R, size_t K, size_t C, typename T>
+	constexpr Matrix<R, C, T> product(const Matrix<R, K, T>& lhs, const Matrix<K, C, T>& rhs)
+	{
+		if constexpr (std::is_same<T, float>::value && C == 4)
+		{
+			if (!is_constant_evaluated())
+				return detail::mul_simd(lhs, rhs);
+		}
+		return detail::mul(lhs, rhs, std::make_index_sequence<R>{});
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Vector<R, T> operator*(const Matrix<R, C, T>& lhs, const Vector<C, T>& rhs)
+	{
+		return detail::mul(lhs, rhs, std::make_index_sequence<R>{});
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Vector<C, T> operator*(const Vector<R, T>& lhs, const Matrix<R, C, T>& rhs)
+	{
+		return rhs.transposed() * lhs;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T> operator+(const Matrix<R, C, T>& lhs, const Matrix<R, C, T>& rhs)
+	{
+		Matrix<R, C, T> sum = lhs;
+		sum += rhs;
+		return sum;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T> operator-(const Matrix<R, C, T>& lhs, const Matrix<R, C, T>& rhs)
+	{
+		Matrix<R, C, T> diff = lhs;
+		diff -= rhs;
+		return diff;
+	}
+	template <size_t R, size_t C, typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+	constexpr Matrix<R, C, T> operator*(const Matrix<R, C, T>& lhs, const S& rhs)
+	{
+		Matrix<R, C, T> prod = lhs;
+		prod *= rhs;
+		return prod;
+	}
+	template <size_t R, size_t C, typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+	constexpr Matrix<R, C, T> operator*(const S& lhs, const Matrix<R, C, T>& rhs)
+	{
+		return rhs * lhs;
+	}
+
+	// static functions
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<C, R, T> transposed(const Matrix<R, C, T>& rhs)
+	{
+		return rhs.transposed();
+	}
+	// outer product a * b^T
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T> outer(const Vector<R, T>& a, const Vector<C, T>& b)
+	{
+		Matrix<R, C, T> out;
+		for (size_t i = 0; i < R; ++i)
+			out.set_row(i, b * a.v[i]);
+		return out;
+	}
+
+	// member functions
+	template <size_t R, size_t C, typename T>
+	constexpr bool Matrix<R, C, T>::operator==(const Matrix& rhs) const
+	{
+		for (size_t i = 0; i < R * C; ++i)
+		{
+			if (m[i] != rhs.m[i])
+				return false;
+		}
+		return true;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr bool Matrix<R, C, T>::operator!=(const Matrix& rhs) const
+	{
+		return !(*this == rhs);
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::operator+=(const Matrix& rhs)
+	{
+		for (size_t i = 0; i < R * C; ++i)
+			m[i] += rhs.m[i];
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::operator-=(const Matrix& rhs)
+	{
+		for (size_t i = 0; i < R * C; ++i)
+			m[i] -= rhs.m[i];
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	template <typename S, typename>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::operator*=(S rhs)
+	{
+		for (auto& s : m)
+			s *= static_cast<T>(rhs);
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::operator*=(const Matrix<C, C, T>& rhs)
+	{
+		*this = product(*this, rhs);
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr typename Matrix<R, C, T>::row_type Matrix<R, C, T>::row(size_t i) const
+	{
+		row_type r;
+		for (size_t j = 0; j < C; ++j)
+			r.v[j] = m[i * C + j];
+		return r;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr typename Matrix<R, C, T>::col_type Matrix<R, C, T>::col(size_t j) const
+	{
+		col_type c;
+		for (size_t i = 0; i < R; ++i)
+			c.v[i] = m[i * C + j];
+		return c;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::set_row(size_t i, const row_type& r)
+	{
+		for (size_t j = 0; j < C; ++j)
+			m[i * C + j] = r.v[j];
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::set_col(size_t j, const col_type& c)
+	{
+		for (size_t i = 0; i < R; ++i)
+			m[i * C + j] = c.v[i];
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<C, R, T> Matrix<R, C, T>::transposed() const
+	{
+		if constexpr (R * C == 1)
+			return *this;
+		else
+			return transposed(std::make_index_sequence<R * C>{});
+	}
+	template <size_t R, size_t C, typename T>
+	template <size_t, size_t, typename>
+	constexpr typename Matrix<R, C, T>::Scalar Matrix<R, C, T>::trace() const
+	{
+		return trace(std::make_index_sequence<R>{});
+	}
+	template <size_t R, size_t C, typename T>
+	template <size_t, size_t, typename>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::transpose()
+	{
+		*this = transposed();
+		return *this;
+	}
+	template <size_t R, size_t C, typename T>
+	constexpr Matrix<R, C, T>& Matrix<R, C, T>::identity()
+	{
+		*this = Matrix{ static_cast<Scalar>(1) };
+		return *this;
+	}
+
+} // namespace els
+
+#endif
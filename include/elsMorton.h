@@ -0,0 +1,549 @@
+#ifndef ELS_MORTON
+#define ELS_MORTON
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// elements per worker chunk for the batch encoders and the radix sort
+	constexpr size_t morton_grain = 1 << 16;
+
+	namespace detail
+	{
+		namespace morton
+		{
+			constexpr uint64_t mask2 = 0x5555555555555555ull;
+			constexpr uint64_t mask3 = 0x1249249249249249ull;
+
+			// moves bit i of x to bit 2i
+			inline uint64_t spread2(uint64_t x)
+			{
+				x &= 0xffffffffull;
+				x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+				x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+				x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+				x = (x | (x << 2)) & 0x3333333333333333ull;
+				x = (x | (x << 1)) & mask2;
+				return x;
+			}
+			inline uint32_t compact2(uint64_t x)
+			{
+				x &= mask2;
+				x = (x | (x >> 1)) & 0x3333333333333333ull;
+				x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0full;
+				x = (x | (x >> 4)) & 0x00ff00ff00ff00ffull;
+				x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+				x = (x | (x >> 16)) & 0xffffffffull;
+				return static_cast<uint32_t>(x);
+			}
+			// moves bit i of x to bit 3i, 21 bits fit
+			inline uint64_t spread3(uint64_t x)
+			{
+				x &= 0x1fffffull;
+				x = (x | (x << 32)) & 0x001f00000000ffffull;
+				x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+				x = (x | (x << 8)) & 0x100f00f00f00f00full;
+				x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+				x = (x | (x << 2)) & mask3;
+				return x;
+			}
+			inline uint32_t compact3(uint64_t x)
+			{
+				x &= mask3;
+				x = (x | (x >> 2)) & 0x10c30c30c30c30c3ull;
+				x = (x | (x >> 4)) & 0x100f00f00f00f00full;
+				x = (x | (x >> 8)) & 0x001f0000ff0000ffull;
+				x = (x | (x >> 16)) & 0x001f00000000ffffull;
+				x = (x | (x >> 32)) & 0x1fffffull;
+				return static_cast<uint32_t>(x);
+			}
+
+			// skilling's transform between the hilbert axes and the transposed index, N axes of bits each
+			// every level inverts the low bits of x[0] where bit b of x[i] is set and swaps them with x[i] where it is clear
+			template <size_t N>
+			inline void axes_to_transpose(uint32_t (&x)[N], unsigned int bits)
+			{
+				for (unsigned int b = bits - 1; b > 0; --b)
+				{
+					const uint32_t low = (uint32_t(1) << b) - 1;
+					for (size_t i = 0; i < N; ++i)
+					{
+						const uint32_t invert = 0u - ((x[i] >> b) & 1u);
+						const uint32_t swap = (x[0] ^ x[i]) & low & ~invert;
+						x[0] ^= swap | (low & invert);
+						x[i] ^= swap;
+					}
+				}
+				for (size_t i = 1; i < N; ++i)
+					x[i] ^= x[i - 1];
+				// bit j of t is the parity of the bits of x[N - 1] above j
+				uint32_t t = static_cast<uint32_t>(x[N - 1] & ((uint64_t(1) << bits) - 1)) >> 1;
+				t ^= t >> 1;
+				t ^= t >> 2;
+				t ^= t >> 4;
+				t ^= t >> 8;
+				t ^= t >> 16;
+				for (size_t i = 0; i < N; ++i)
+					x[i] ^= t;
+			}
+			template <size_t N>
+			inline void transpose_to_axes(uint32_t (&x)[N], unsigned int bits)
+			{
+				const uint32_t t = x[N - 1] >> 1;
+				for (size_t i = N - 1; i > 0; --i)
+					x[i] ^= x[i - 1];
+				x[0] ^= t;
+				for (unsigned int b = 1; b < bits; ++b)
+				{
+					const uint32_t low = (uint32_t(1) << b) - 1;
+					for (size_t i = N; i-- > 0;)
+					{
+						const uint32_t invert = 0u - ((x[i] >> b) & 1u);
+						const uint32_t swap = (x[0] ^ x[i]) & low & ~invert;
+						x[0] ^= swap | (low & invert);
+						x[i] ^= swap;
+					}
+				}
+			}
+		}
+	}
+
+	// z-order code with the bits of the axes interleaved, x lowest
+	// 2d keeps all 32 bits of each axis and 3d the low 21
+	inline uint64_t morton_encode(const Vector2<uint32_t>& v)
+	{
+#if defined(ELS_FAST_BMI2)
+		return _pdep_u64(v.x, detail::morton::mask2) | _pdep_u64(v.y, detail::morton::mask2 << 1);
+#else
+		return detail::morton::spread2(v.x) | (detail::morton::spread2(v.y) << 1);
+#endif
+	}
+	inline uint64_t morton_encode(const Vector3<uint32_t>& v)
+	{
+#if defined(ELS_FAST_BMI2)
+		return _pdep_u64(v.x, detail::morton::mask3) | _pdep_u64(v.y, detail::morton::mask3 << 1) | _pdep_u64(v.z, detail::morton::mask3 << 2);
+#else
+		return detail::morton::spread3(v.x) | (detail::morton::spread3(v.y) << 1) | (detail::morton::spread3(v.z) << 2);
+#endif
+	}
+	inline Vector2<uint32_t> morton_decode2(uint64_t code)
+	{
+#if defined(ELS_FAST_BMI2)
+		return Vector2<uint32_t>{ static_cast<uint32_t>(_pext_u64(code, detail::morton::mask2)), static_cast<uint32_t>(_pext_u64(code, detail::morton::mask2 << 1)) };
+#else
+		return Vector2<uint32_t>{ detail::morton::compact2(code), detail::morton::compact2(code >> 1) };
+#endif
+	}
+	inline Vector3<uint32_t> morton_decode3(uint64_t code)
+	{
+#if defined(ELS_FAST_BMI2)
+		return Vector3<uint32_t>{ static_cast<uint32_t>(_pext_u64(code, detail::morton::mask3)), static_cast<uint32_t>(_pext_u64(code, detail::morton::mask3 << 1)),
+			static_cast<uint32_t>(_pext_u64(code, detail::morton::mask3 << 2)) };
+#else
+		return Vector3<uint32_t>{ detail::morton::compact3(code), detail::morton::compact3(code >> 1), detail::morton::compact3(code >> 2) };
+#endif
+	}
+
+	// index along the hilbert curve through a grid of 2^bits cells per axis, consecutive indices are adjacent cells
+	// bits goes up to 32 in 2d and 21 in 3d
+	inline uint64_t hilbert_encode(const Vector2<uint32_t>& v, unsigned int bits)
+	{
+		uint32_t x[2] = { v.x, v.y };
+		detail::morton::axes_to_transpose(x, bits);
+		return morton_encode(Vector2<uint32_t>{ x[1], x[0] });
+	}
+	inline uint64_t hilbert_encode(const Vector3<uint32_t>& v, unsigned int bits)
+	{
+		uint32_t x[3] = { v.x, v.y, v.z };
+		detail::morton::axes_to_transpose(x, bits);
+		return morton_encode(Vector3<uint32_t>{ x[2], x[1], x[0] });
+	}
+	inline Vector2<uint32_t> hilbert_decode2(uint64_t code, unsigned int bits)
+	{
+		const Vector2<uint32_t> t = morton_decode2(code);
+		uint32_t x[2] = { t.y, t.x };
+		detail::morton::transpose_to_axes(x, bits);
+		return Vector2<uint32_t>{ x[0], x[1] };
+	}
+	inline Vector3<uint32_t> hilbert_decode3(uint64_t code, unsigned int bits)
+	{
+		const Vector3<uint32_t> t = morton_decode3(code);
+		uint32_t x[3] = { t.z, t.y, t.x };
+		detail::morton::transpose_to_axes(x, bits);
+		return Vector3<uint32_t>{ x[0], x[1], x[2] };
+	}
+
+	// cell of x in a grid of 2^bits cells over [lo, hi], points outside land on the border cells
+	template <typename T>
+	inline uint32_t quantize(T x, T lo, T hi, unsigned int bits)
+	{
+		const double cells = static_cast<double>(uint64_t(1) << bits);
+		const double extent = static_cast<double>(hi) - static_cast<double>(lo);
+		const double c = extent > 0 ? (static_cast<double>(x) - static_cast<double>(lo)) * (cells / extent) : 0.0;
+		if (!(c > 0))
+			return 0;
+		return c < cells - 1 ? static_cast<uint32_t>(c) : static_cast<uint32_t>(cells - 1);
+	}
+	// same per axis
+	template <typename T>
+	inline Vector2<uint32_t> quantize(const Vector2<T>& p, const Vector2<T>& lo, const Vector2<T>& hi, unsigned int bits)
+	{
+		Vector2<uint32_t> q;
+		for (unsigned int d = 0; d < 2; ++d)
+			q[d] = quantize(p[d], lo[d], hi[d], bits);
+		return q;
+	}
+	template <typename T>
+	inline Vector3<uint32_t> quantize(const Vector3<T>& p, const Vector3<T>& lo, const Vector3<T>& hi, unsigned int bits)
+	{
+		Vector3<uint32_t> q;
+		for (unsigned int d = 0; d < 3; ++d)
+			q[d] = quantize(p[d], lo[d], hi[d], bits);
+		return q;
+	}
+
+	namespace detail
+	{
+		namespace morton
+		{
+			// grid resolution of the point batches, 2d codes then fit 32 bits and sort in half the passes
+			template <typename Point>
+			struct curve;
+			template <typename T>
+			struct curve<Vector2<T>>
+			{
+				static constexpr unsigned int dims = 2;
+				static constexpr unsigned int bits = 16;
+			};
+			template <typename T>
+			struct curve<Vector3<T>>
+			{
+				static constexpr unsigned int dims = 3;
+				static constexpr unsigned int bits = 21;
+			};
+
+			template <typename Point>
+			inline void encode_portable(const Point* p, size_t n, const Point& lo, const Point& hi, uint64_t* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = morton_encode(quantize(p[i], lo, hi, curve<Point>::bits));
+			}
+
+#if defined(ELS_BMI2)
+			ELS_BMI2_BEGIN
+			inline uint64_t deposit(const Vector2<uint32_t>& v)
+			{
+				return _pdep_u64(v.x, mask2) | _pdep_u64(v.y, mask2 << 1);
+			}
+			inline uint64_t deposit(const Vector3<uint32_t>& v)
+			{
+				return _pdep_u64(v.x, mask3) | _pdep_u64(v.y, mask3 << 1) | _pdep_u64(v.z, mask3 << 2);
+			}
+			template <typename Point>
+			inline void encode_bmi2(const Point* p, size_t n, const Point& lo, const Point& hi, uint64_t* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = deposit(quantize(p[i], lo, hi, curve<Point>::bits));
+			}
+			inline void decode_bmi2(const uint64_t* codes, size_t n, Vector2<uint32_t>* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = Vector2<uint32_t>{ static_cast<uint32_t>(_pext_u64(codes[i], mask2)), static_cast<uint32_t>(_pext_u64(codes[i], mask2 << 1)) };
+			}
+			inline void decode_bmi2(const uint64_t* codes, size_t n, Vector3<uint32_t>* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = Vector3<uint32_t>{ static_cast<uint32_t>(_pext_u64(codes[i], mask3)), static_cast<uint32_t>(_pext_u64(codes[i], mask3 << 1)),
+						static_cast<uint32_t>(_pext_u64(codes[i], mask3 << 2)) };
+			}
+			ELS_BMI2_END
+#endif
+
+			inline void decode_portable(const uint64_t* codes, size_t n, Vector2<uint32_t>* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = morton_decode2(codes[i]);
+			}
+			inline void decode_portable(const uint64_t* codes, size_t n, Vector3<uint32_t>* out)
+			{
+				for (size_t i = 0; i < n; ++i)
+					out[i] = morton_decode3(codes[i]);
+			}
+
+			template <typename Point>
+			inline void encode(const Point* p, size_t n, const Point& lo, const Point& hi, uint64_t* out)
+			{
+#if defined(ELS_BMI2) && !defined(ELS_FAST_BMI2)
+				// pdep is microcoded on amd before zen 3, the shifts are much faster there
+				if (simd::has_fast_bmi2())
+					return encode_bmi2(p, n, lo, hi, out);
+#endif
+				encode_portable(p, n, lo, hi, out);
+			}
+			template <typename Cell>
+			inline void decode(const uint64_t* codes, size_t n, Cell* out)
+			{
+#if defined(ELS_BMI2) && !defined(ELS_FAST_BMI2)
+				// pext is microcoded on the same cpus as pdep
+				if (simd::has_fast_bmi2())
+					return decode_bmi2(codes, n, out);
+#endif
+				decode_portable(codes, n, out);
+			}
+
+			template <typename Point>
+			inline std::pair<Point, Point> bounds(span<const Point> points)
+			{
+				using T = typename Point::Scalar;
+				constexpr unsigned int dims = curve<Point>::dims;
+				Point lo{ std::numeric_limits<T>::max() };
+				Point hi{ std::numeric_limits<T>::lowest() };
+				std::mutex lock;
+				parallel::for_range(0, points.size(), morton_grain, [&](size_t first, size_t last)
+					{
+						Point l{ std::numeric_limits<T>::max() };
+						Point h{ std::numeric_limits<T>::lowest() };
+						for (size_t i = first; i < last; ++i)
+						{
+							for (unsigned int d = 0; d < dims; ++d)
+							{
+								l[d] = points[i][d] < l[d] ? points[i][d] : l[d];
+								h[d] = points[i][d] > h[d] ? points[i][d] : h[d];
+							}
+						}
+						std::lock_guard<std::mutex> guard(lock);
+						for (unsigned int d = 0; d < dims; ++d)
+						{
+							lo[d] = l[d] < lo[d] ? l[d] : lo[d];
+							hi[d] = h[d] > hi[d] ? h[d] : hi[d];
+						}
+					});
+				return std::make_pair(lo, hi);
+			}
+
+			constexpr unsigned int digit_bits = 11;
+			constexpr size_t digits = size_t(1) << digit_bits;
+
+			// stable lsd radix sort of keys with payload carried along when it is not null
+			// every part owns a fixed slice of the input, digit major offsets keep equal digits in part order
+			template <typename Key>
+			inline void radix_sort(Key* keys, uint32_t* payload, size_t n)
+			{
+				if (n < 2)
+					return;
+
+				constexpr unsigned int passes = (8 * sizeof(Key) + digit_bits - 1) / digit_bits;
+				const size_t parts = min(parallel::thread_count(), max<size_t>(n / morton_grain, 1));
+				const auto slice = [n, parts](size_t part) { return n * part / parts; };
+
+				// digit counts of every pass in one read, per part of the input
+				std::vector<uint32_t> counts(parts * passes * digits, 0);
+				const auto count = [&](const Key* src, unsigned int pass_first, unsigned int pass_last)
+				{
+					parallel::for_range(0, parts, 1, [&](size_t first, size_t last)
+						{
+							for (size_t part = first; part < last; ++part)
+							{
+								uint32_t* c = counts.data() + part * passes * digits;
+								for (unsigned int pass = pass_first; pass < pass_last; ++pass)
+									std::fill(c + pass * digits, c + (pass + 1) * digits, 0u);
+								for (size_t i = slice(part), end = slice(part + 1); i < end; ++i)
+								{
+									const Key key = src[i];
+									for (unsigned int pass = pass_first; pass < pass_last; ++pass)
+										++c[pass * digits + ((key >> (pass * digit_bits)) & (digits - 1))];
+								}
+							}
+						});
+				};
+				count(keys, 0, passes);
+
+				std::vector<Key> key_scratch;
+				std::vector<uint32_t> payload_scratch;
+				std::vector<uint32_t> offsets(parts * digits);
+				Key* src = keys;
+				uint32_t* payload_src = payload;
+				Key* dst = nullptr;
+				uint32_t* payload_dst = nullptr;
+				bool moved = false;
+				for (unsigned int pass = 0; pass < passes; ++pass)
+				{
+					// a digit every key shares leaves the order as it is
+					bool shared = false;
+					for (size_t d = 0; d < digits && !shared; ++d)
+					{
+						size_t total = 0;
+						for (size_t part = 0; part < parts; ++part)
+							total += counts[(part * passes + pass) * digits + d];
+						shared = total == n;
+					}
+					if (shared)
+						continue;
+
+					if (!moved)
+					{
+						key_scratch.resize(n);
+						payload_scratch.resize(payload ? n : 0);
+						dst = key_scratch.data();
+						payload_dst = payload ? payload_scratch.data() : nullptr;
+					}
+					else if (parts > 1)
+						count(src, pass, pass + 1);  // the parts hold other keys once they moved
+
+					uint32_t sum = 0;
+					for (size_t d = 0; d < digits; ++d)
+					{
+						for (size_t part = 0; part < parts; ++part)
+						{
+							offsets[part * digits + d] = sum;
+							sum += counts[(part * passes + pass) * digits + d];
+						}
+					}
+
+					const unsigned int shift = pass * digit_bits;
+					parallel::for_range(0, parts, 1, [&, src, dst, payload_src, payload_dst](size_t first, size_t last)
+						{
+							for (size_t part = first; part < last; ++part)
+							{
+								// local offsets so the stores below cannot alias them
+								uint32_t next[digits];
+								std::copy(offsets.begin() + part * digits, offsets.begin() + (part + 1) * digits, next);
+								const size_t begin = slice(part);
+								const size_t end = slice(part + 1);
+								if (payload_src)
+								{
+									for (size_t i = begin; i < end; ++i)
+									{
+										const uint32_t s = next[(src[i] >> shift) & (digits - 1)]++;
+										dst[s] = src[i];
+										payload_dst[s] = payload_src[i];
+									}
+								}
+								else
+								{
+									for (size_t i = begin; i < end; ++i)
+										dst[next[(src[i] >> shift) & (digits - 1)]++] = src[i];
+								}
+							}
+						});
+					std::swap(src, dst);
+					std::swap(payload_src, payload_dst);
+					moved = true;
+				}
+
+				if (src != keys)
+				{
+					parallel::for_range(0, n, morton_grain, [&](size_t first, size_t last)
+						{
+							std::copy(src + first, src + last, keys + first);
+							if (payload)
+								std::copy(payload_src + first, payload_src + last, payload + first);
+						});
+				}
+			}
+
+			// out[i] = in[order[i]], then back into in
+			template <typename Value>
+			inline void gather(span<Value> values, const std::vector<uint32_t>& order)
+			{
+				std::vector<Value> sorted(values.size());
+				parallel::for_range(0, values.size(), morton_grain, [&](size_t first, size_t last)
+					{
+						for (size_t i = first; i < last; ++i)
+							sorted[i] = values[order[i]];
+					});
+				parallel::for_range(0, values.size(), morton_grain, [&](size_t first, size_t last)
+					{
+						std::copy(sorted.begin() + first, sorted.begin() + last, values.begin() + first);
+					});
+			}
+		}
+	}
+
+	// morton codes of points over [lo, hi], 16 bits per axis in 2d and 21 in 3d
+	// picks bmi2 pdep at run time where it is not microcoded and spreads the work across threads
+	template <typename Point>
+	inline void morton_encode(span<const Point> points, const Point& lo, const Point& hi, span<uint64_t> codes)
+	{
+		parallel::for_range(0, points.size(), morton_grain, [&](size_t first, size_t last)
+			{
+				detail::morton::encode(points.data() + first, last - first, lo, hi, codes.data() + first);
+			});
+	}
+	// cells of morton codes, Vector2<uint32_t> or Vector3<uint32_t>, picking bmi2 pext the same way
+	template <typename Cell>
+	inline void morton_decode(span<const uint64_t> codes, span<Cell> cells)
+	{
+		parallel::for_range(0, codes.size(), morton_grain, [&](size_t first, size_t last)
+			{
+				detail::morton::decode(codes.data() + first, last - first, cells.data() + first);
+			});
+	}
+	// hilbert indices at the same resolution
+	template <typename Point>
+	inline void hilbert_encode(span<const Point> points, const Point& lo, const Point& hi, span<uint64_t> codes)
+	{
+		constexpr unsigned int bits = detail::morton::curve<Point>::bits;
+		parallel::for_range(0, points.size(), morton_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					codes[i] = hilbert_encode(quantize(points[i], lo, hi, bits), bits);
+			});
+	}
+
+	// stable sort of unsigned integer keys, 11 bits per pass and digits that are equal for every key are skipped
+	// payload follows its key and may be empty, large inputs sort on all threads
+	template <typename Key>
+	inline void radix_sort(span<Key> keys, span<uint32_t> payload)
+	{
+		detail::morton::radix_sort(keys.data(), payload.empty() ? nullptr : payload.data(), keys.size());
+	}
+	// values and payload end up in the order of the sorted keys, the keys move and values are gathered once at the end
+	template <typename Key, typename Value>
+	inline void radix_sort(span<Key> keys, span<Value> values, span<uint32_t> payload)
+	{
+		std::vector<uint32_t> order(keys.size());
+		parallel::for_range(0, order.size(), morton_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					order[i] = static_cast<uint32_t>(i);
+			});
+		detail::morton::radix_sort(keys.data(), order.data(), keys.size());
+		detail::morton::gather(values, order);
+		if (!payload.empty())
+			detail::morton::gather(payload, order);
+	}
+
+	// reorders points along the z-order or hilbert curve through their bounds, payload may be empty
+	template <typename Point>
+	inline void morton_sort(span<Point> points, span<uint32_t> payload)
+	{
+		const auto b = detail::morton::bounds(span<const Point>(points.data(), points.size()));
+		std::vector<uint64_t> codes(points.size());
+		morton_encode(span<const Point>(points.data(), points.size()), b.first, b.second, span<uint64_t>(codes.data(), codes.size()));
+		radix_sort(span<uint64_t>(codes.data(), codes.size()), points, payload);
+	}
+	template <typename Point>
+	inline void hilbert_sort(span<Point> points, span<uint32_t> payload)
+	{
+		const auto b = detail::morton::bounds(span<const Point>(points.data(), points.size()));
+		std::vector<uint64_t> codes(points.size());
+		hilbert_encode(span<const Point>(points.data(), points.size()), b.first, b.second, span<uint64_t>(codes.data(), codes.size()));
+		radix_sort(span<uint64_t>(codes.data(), codes.size()), points, payload);
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,412 @@
+#ifndef ELS_PACKED
+#define ELS_PACKED
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+#include "elsQuaternion.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// storage types for buffers and snapshots, they only convert to and from the working types
+	// and are used as the scalar of Vector2/3/4 so to_vec3<float>(v) and to_vec3<half>(v) work both ways
+
+	// elements per worker chunk for the batch conversions
+	constexpr size_t packing_grain = 1 << 16;
+
+	namespace detail
+	{
+		inline uint32_t float_bits(float x)
+		{
+			uint32_t u;
+			std::memcpy(&u, &x, sizeof u);
+			return u;
+		}
+		inline float bits_float(uint32_t u)
+		{
+			float x;
+			std::memcpy(&x, &u, sizeof x);
+			return x;
+		}
+
+		// round to nearest even, overflow goes to inf, nan stays quiet nan
+		inline uint16_t float_to_half(float f)
+		{
+			uint32_t x = float_bits(f);
+			const uint32_t sign = (x >> 16) & 0x8000u;
+			x &= 0x7fffffffu;
+
+			if (x >= 0x7f800000u)
+				return static_cast<uint16_t>(sign | 0x7c00u | (x > 0x7f800000u ? 0x200u | ((x >> 13) & 0x3ffu) : 0u));
+			if (x >= 0x477ff000u)
+				return static_cast<uint16_t>(sign | 0x7c00u);
+			if (x < 0x38800000u)
+			{
+				// below 2^-14 the half is denormal, adding 0.5 lines the float ulp up with the half ulp
+				const float t = bits_float(x) + 0.5f;
+				return static_cast<uint16_t>(sign | (float_bits(t) - 0x3f000000u));
+			}
+			// rebias the exponent and round on the 13 dropped bits
+			x += 0xc8000fffu + ((x >> 13) & 1u);
+			return static_cast<uint16_t>(sign | (x >> 13));
+		}
+		inline float half_to_float(uint16_t h)
+		{
+			const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+			const uint32_t em = h & 0x7fffu;
+			// a signaling nan comes out quiet, the same as f16c
+			if (em > 0x7c00u)
+				return bits_float(sign | 0x7fc00000u | ((em & 0x3ffu) << 13));
+			if (em == 0x7c00u)
+				return bits_float(sign | 0x7f800000u);
+			if (em < 0x400u)
+			{
+				const float f = static_cast<float>(em) * 5.96046448e-8f;
+				return sign ? -f : f;
+			}
+			return bits_float(sign | ((em << 13) + 0x38000000u));
+		}
+	}
+
+	// ieee binary16, 11 bits of precision and a range of +-65504
+	struct half
+	{
+		uint16_t bits;
+
+		half() = default;
+		explicit half(float f) : bits{ detail::float_to_half(f) } {}
+		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		explicit half(S s) : half{ static_cast<float>(s) } {}
+
+		operator float() const { return detail::half_to_float(bits); }
+
+		static half from_bits(uint16_t b)
+		{
+			half h;
+			h.bits = b;
+			return h;
+		}
+	};
+
+	// [-1, 1] in 16 bits, -32768 decodes to -1 like -32767
+	struct snorm16
+	{
+		int16_t bits;
+
+		snorm16() = default;
+		explicit snorm16(float f)
+			: bits{ static_cast<int16_t>(round(clamp(f, -1.f, 1.f) * 32767.f)) } {}
+		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		explicit snorm16(S s) : snorm16{ static_cast<float>(s) } {}
+
+		operator float() const
+		{
+			const float f = static_cast<float>(bits) * (1.f / 32767.f);
+			return f < -1.f ? -1.f : f;
+		}
+	};
+
+	// [0, 1] in 8 bits
+	struct unorm8
+	{
+		uint8_t bits;
+
+		unorm8() = default;
+		explicit unorm8(float f)
+			: bits{ static_cast<uint8_t>(clamp(f, 0.f, 1.f) * 255.f + 0.5f) } {}
+		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		explicit unorm8(S s) : unorm8{ static_cast<float>(s) } {}
+
+		operator float() const { return static_cast<float>(bits) * (1.f / 255.f); }
+	};
+
+	// typedefs
+	using vec2h = Vector2<half>;
+	using vec3h = Vector3<half>;
+	using vec4h = Vector4<half>;
+	using vec2snorm = Vector2<snorm16>;
+	using vec3snorm = Vector3<snorm16>;
+	using vec4snorm = Vector4<snorm16>;
+	using rgba8 = Vector4<unorm8>;
+
+	// unit vector folded onto an octahedron and stored as two snorm16, 4 bytes
+	// round trip error stays below 7e-5 rad
+	struct octahedral
+	{
+		snorm16 u;
+		snorm16 v;
+
+		octahedral() = default;
+		template <typename T>
+		explicit octahedral(const Vector3<T>& n)
+		{
+			const float inv = 1.f / static_cast<float>(abs(n.x) + abs(n.y) + abs(n.z));
+			float px = static_cast<float>(n.x) * inv;
+			float py = static_cast<float>(n.y) * inv;
+			if (n.z < 0)
+			{
+				// the lower half is folded over the diagonals
+				const float fx = (1.f - abs(py)) * (px >= 0.f ? 1.f : -1.f);
+				const float fy = (1.f - abs(px)) * (py >= 0.f ? 1.f : -1.f);
+				px = fx;
+				py = fy;
+			}
+			u = snorm16{ px };
+			v = snorm16{ py };
+		}
+
+		template <typename T = defaultType>
+		Vector3<T> decode() const
+		{
+			const float px = u;
+			const float py = v;
+			const float pz = 1.f - abs(px) - abs(py);
+			const float t = pz < 0.f ? -pz : 0.f;
+			const Vector3<float> n{ px >= 0.f ? px - t : px + t, py >= 0.f ? py - t : py + t, pz };
+			return to_vec3<T>(n.normalized());
+		}
+	};
+
+	// unit quaternion in 8 bytes, the largest component is dropped and rebuilt from the other three
+	// which then lie in [-1/sqrt2, 1/sqrt2] and get 20 bits each, max component error 2e-6
+	struct smallest_three
+	{
+		uint64_t bits;
+
+		smallest_three() = default;
+		template <typename T>
+		explicit smallest_three(const Quaternion<T>& q)
+		{
+			const Quaternion<T> n = q.normalized();
+			const T* c = n.data();
+
+			uint64_t largest = 0;
+			for (uint64_t i = 1; i < 4; ++i)
+			{
+				if (abs(c[i]) > abs(c[largest]))
+					largest = i;
+			}
+			// q and -q are the same rotation, the dropped one is kept positive
+			const float flip = c[largest] < 0 ? -1.f : 1.f;
+
+			bits = largest << 60;
+			int shift = 40;
+			for (uint64_t i = 0; i < 4; ++i)
+			{
+				if (i == largest)
+					continue;
+				const float s = clamp(static_cast<float>(c[i]) * flip * sqrt2<float>, -1.f, 1.f);
+				const uint64_t q20 = static_cast<uint64_t>((s * 0.5f + 0.5f) * scale + 0.5f);
+				bits |= q20 << shift;
+				shift -= 20;
+			}
+		}
+
+		template <typename T = defaultType>
+		Quaternion<T> decode() const
+		{
+			const uint64_t largest = (bits >> 60) & 3u;
+			float c[4];
+			float sum = 0.f;
+			int shift = 40;
+			for (uint64_t i = 0; i < 4; ++i)
+			{
+				if (i == largest)
+					continue;
+				const float s = static_cast<float>((bits >> shift) & 0xfffffu) * (2.f / scale) - 1.f;
+				c[i] = s * (1.f / sqrt2<float>);
+				sum += c[i] * c[i];
+				shift -= 20;
+			}
+			c[largest] = sqrt(1.f - sum > 0.f ? 1.f - sum : 0.f);
+			return Quaternion<T>{ static_cast<T>(c[0]), static_cast<T>(c[1]), static_cast<T>(c[2]), static_cast<T>(c[3]) };
+		}
+
+	private:
+		static constexpr float scale = 1048575.f;
+	};
+
+	// to_vec3 / to_quat style helpers for the encoded types
+	template <typename T = defaultType>
+	inline Vector3<T> to_vec3(const octahedral& n)
+	{
+		return n.decode<T>();
+	}
+	template <typename T = defaultType>
+	inline Quaternion<T> to_quat(const smallest_three& q)
+	{
+		return q.decode<T>();
+	}
+	template <typename T>
+	inline octahedral to_octahedral(const Vector3<T>& n)
+	{
+		return octahedral{ n };
+	}
+	template <typename T>
+	inline smallest_three to_smallest_three(const Quaternion<T>& q)
+	{
+		return smallest_three{ q };
+	}
+
+	namespace detail
+	{
+		inline void pack_half_scalar(const float* in, half* out, size_t n)
+		{
+			for (size_t i = 0; i < n; ++i)
+				out[i].bits = float_to_half(in[i]);
+		}
+		inline void unpack_half_scalar(const half* in, float* out, size_t n)
+		{
+			for (size_t i = 0; i < n; ++i)
+				out[i] = half_to_float(in[i].bits);
+		}
+
+#if defined(ELS_SIMD_AVX2)
+		ELS_AVX2_BEGIN
+		// f16c, 8 lanes per instruction with the same rounding as float_to_half
+		inline void pack_half_f16c(const float* in, half* out, size_t n)
+		{
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+			}
+			pack_half_scalar(in + i, out + i, n - i);
+		}
+		inline void unpack_half_f16c(const half* in, float* out, size_t n)
+		{
+			size_t i = 0;
+			for (; i + 8 <= n; i += 8)
+			{
+				const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				_mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+			}
+			unpack_half_scalar(in + i, out + i, n - i);
+		}
+		ELS_AVX2_END
+#endif
+
+		inline void pack_half(const float* in, half* out, size_t n)
+		{
+#if defined(ELS_SIMD_AVX2)
+			if (simd::has_avx2())
+				return pack_half_f16c(in, out, n);
+#elif defined(ELS_SIMD_NEON) && defined(__aarch64__)
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+				vst1_u16(&out[i].bits, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+			in += i;
+			out += i;
+			n -= i;
+#endif
+			pack_half_scalar(in, out, n);
+		}
+		inline void unpack_half(const half* in, float* out, size_t n)
+		{
+#if defined(ELS_SIMD_AVX2)
+			if (simd::has_avx2())
+				return unpack_half_f16c(in, out, n);
+#elif defined(ELS_SIMD_NEON) && defined(__aarch64__)
+			size_t i = 0;
+			for (; i + 4 <= n; i += 4)
+				vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&in[i].bits))));
+			in += i;
+			out += i;
+			n -= i;
+#endif
+			unpack_half_scalar(in, out, n);
+		}
+
+		template <typename From, typename To, typename Fn>
+		inline void pack_each(span<const From> in, span<To> out, Fn&& fn)
+		{
+			parallel::for_range(0, in.size(), packing_grain, [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+						out[i] = fn(in[i]);
+				});
+		}
+	}
+
+	// batch conversions, out must hold at least in.size() elements
+	inline void pack(span<const float> in, span<half> out)
+	{
+		parallel::for_range(0, in.size(), packing_grain, [&](size_t first, size_t last)
+			{
+				detail::pack_half(in.data() + first, out.data() + first, last - first);
+			});
+	}
+	inline void unpack(span<const half> in, span<float> out)
+	{
+		parallel::for_range(0, in.size(), packing_grain, [&](size_t first, size_t last)
+			{
+				detail::unpack_half(in.data() + first, out.data() + first, last - first);
+			});
+	}
+
+	// half vectors are converted as flat scalar arrays
+	template <template <typename> class V>
+	inline void pack(span<const V<float>> in, span<V<half>> out)
+	{
+		constexpr size_t width = sizeof(V<float>) / sizeof(float);
+		static_assert(sizeof(V<half>) == width * sizeof(half), "packed vectors must not have padding");
+		pack(span<const float>{ reinterpret_cast<const float*>(in.data()), in.size() * width },
+			span<half>{ reinterpret_cast<half*>(out.data()), in.size() * width });
+	}
+	template <template <typename> class V>
+	inline void unpack(span<const V<half>> in, span<V<float>> out)
+	{
+		constexpr size_t width = sizeof(V<float>) / sizeof(float);
+		static_assert(sizeof(V<half>) == width * sizeof(half), "packed vectors must not have padding");
+		unpack(span<const half>{ reinterpret_cast<const half*>(in.data()), in.size() * width },
+			span<float>{ reinterpret_cast<float*>(out.data()), in.size() * width });
+	}
+
+	// normalized integer vectors
+	template <template <typename> class V, typename T, typename P,
+		typename = std::enable_if_t<std::is_same<P, snorm16>::value || std::is_same<P, unorm8>::value>>
+	inline void pack(span<const V<T>> in, span<V<P>> out)
+	{
+		detail::pack_each(in, out, [](const V<T>& v) { return static_cast<V<P>>(v); });
+	}
+	template <template <typename> class V, typename T, typename P,
+		typename = std::enable_if_t<std::is_same<P, snorm16>::value || std::is_same<P, unorm8>::value>>
+	inline void unpack(span<const V<P>> in, span<V<T>> out)
+	{
+		detail::pack_each(in, out, [](const V<P>& v) { return static_cast<V<T>>(v); });
+	}
+
+	template <typename T>
+	inline void pack(span<const Vector3<T>> in, span<octahedral> out)
+	{
+		detail::pack_each(in, out, [](const Vector3<T>& n) { return octahedral{ n }; });
+	}
+	template <typename T>
+	inline void unpack(span<const octahedral> in, span<Vector3<T>> out)
+	{
+		detail::pack_each(in, out, [](const octahedral& n) { return n.decode<T>(); });
+	}
+
+	template <typename T>
+	inline void pack(span<const Quaternion<T>> in, span<smallest_three> out)
+	{
+		detail::pack_each(in, out, [](const Quaternion<T>& q) { return smallest_three{ q }; });
+	}
+	template <typename T>
+	inline void unpack(span<const smallest_three> in, span<Quaternion<T>> out)
+	{
+		detail::pack_each(in, out, [](const smallest_three& q) { return q.decode<T>(); });
+	}
+
+} // namespace els
+
+#endif
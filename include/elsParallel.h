@@ -0,0 +1,91 @@
+#ifndef ELS_PARALLEL
+#define ELS_PARALLEL
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include "elsHeader.h"
+
+namespace els
+{
+	namespace parallel
+	{
+		// number of workers used by the batch routines, 1 disables threading
+		inline size_t thread_count()
+		{
+#ifdef ELS_NO_THREADS
+			return 1;
+#else
+			const size_t n = std::thread::hardware_concurrency();
+			return n ? n : 1;
+#endif
+		}
+
+		// splits [begin, end) into contiguous chunks of at least grain elements
+		// and calls fn(first, last) for each chunk, the caller runs the last chunk
+		template <typename Fn>
+		inline void for_range(size_t begin, size_t end, size_t grain, Fn&& fn)
+		{
+			if (end <= begin)
+				return;
+
+			const size_t count = end - begin;
+			grain = grain ? grain : 1;
+
+			size_t chunks = (count + grain - 1) / grain;
+			const size_t threads = thread_count();
+			if (chunks > threads)
+				chunks = threads;
+
+			if (chunks <= 1)
+			{
+				fn(begin, end);
+				return;
+			}
+
+			const size_t step = count / chunks;
+			const size_t rem = count % chunks;
+
+			std::vector<std::thread> workers;
+			std::vector<std::exception_ptr> errors(chunks);
+			workers.reserve(chunks - 1);
+
+			size_t first = begin;
+			for (size_t c = 0; c < chunks - 1; ++c)
+			{
+				const size_t last = first + step + (c < rem ? 1 : 0);
+				workers.emplace_back([&fn, &errors, c, first, last]()
+					{
+						try { fn(first, last); }
+						catch (...) { errors[c] = std::current_exception(); }
+					});
+				first = last;
+			}
+
+			try { fn(first, end); }
+			catch (...) { errors[chunks - 1] = std::current_exception(); }
+
+			for (auto& w : workers)
+				w.join();
+
+			for (auto& e : errors)
+			{
+				if (e)
+					std::rethrow_exception(e);
+			}
+		}
+
+		// calls fn(i) for every index in [begin, end)
+		template <typename Fn>
+		inline void for_each(size_t begin, size_t end, size_t grain, Fn&& fn)
+		{
+			for_range(begin, end, grain, [&fn](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+						fn(i);
+				});
+		}
+	}
+}
+
+#endif
@@ -3,6 +3,7 @@
 #define ELS_QUATERNION
 
 #include "elsHeader.h"
+#include "elsMatrix3.h"
 #include "elsMatrix4.h"
 
 namespace els
@@ -23,7 +24,7 @@ namespace els
 		constexpr Quaternion()
 			: Quaternion{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) } {}
 		constexpr Quaternion(const Scalar& i, const Scalar& j, const Scalar& k, const Scalar& s) : x{ i }, y{ j }, z{ k }, w{ s } {}
-		constexpr Quaternion(const Quaternion& rhs) : x{ rhs.x }, y{ rhs.y }, z{ rhs.z }, w{ rhs.w }{}
+		constexpr Quaternion(const Quaternion&) = default;
 		constexpr Quaternion(const Vector3<T>& axis, const Scalar& angle)
 			: Quaternion{}
 		{
@@ -36,7 +37,7 @@ namespace els
 		}
 		
 
-		constexpr Quaternion& operator=(const Quaternion&);
+		constexpr Quaternion& operator=(const Quaternion&) = default;
 		constexpr Quaternion& operator+=(const Quaternion&);
 		constexpr Quaternion& operator-=(const Quaternion&);
 		constexpr Quaternion& operator*=(const Quaternion&);
@@ -59,15 +60,22 @@ namespace els
 		constexpr Quaternion normalized() const;
 		constexpr Quaternion conjugate() const;
 		constexpr Quaternion inverse() const;
-		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template <typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Quaternion slerp(const Quaternion&, S t) const;
 
 		constexpr Scalar dot(const Quaternion&) const;
 		constexpr Scalar length2() const;
 		constexpr Scalar length() const;
 
+		constexpr Matrix3<T> to_mtx3() const;
 		constexpr Matrix4<T> to_mtx4() const;
 
+		// inverse of to_mtx3, shepperd's method takes the largest of w, x, y, z from the diagonal so nothing
+		// divides by a small number, the input is expected to be a rotation and the result is normalized
+		static constexpr Quaternion from_mtx3(const Matrix3<T>& m);
+		// rotation part of the upper 3x3, see decompose in elsTransform.h for matrices with scale
+		static constexpr Quaternion from_mtx4(const Matrix4<T>& m);
+
 		constexpr void normalize();
 		constexpr void invert();
 
@@ -149,16 +157,6 @@ namespace els
 
 	// member functions
 	template <typename T>
-	constexpr Quaternion<T>& Quaternion<T>::operator=(const Quaternion<T>& rhs)
-	{
-		x = rhs.x;
-		y = rhs.y;
-		z = rhs.z;
-		w = rhs.w;
-
-		return *this;
-	}
-	template <typename T>
 	constexpr Quaternion<T>& Quaternion<T>::operator+=(const Quaternion<T>& rhs)
 	{
 		x += rhs.x;
@@ -215,7 +213,7 @@ namespace els
 		return Quaternion<T>{ -w, -x, -y, -z };
 	}
 	template <typename T>
-	constexpr const Quaternion<T>::Scalar* Quaternion<T>::data() const
+	constexpr const typename Quaternion<T>::Scalar* Quaternion<T>::data() const
 	{
 		return &x;
 	}
@@ -277,6 +275,30 @@ namespace els
 		return sqrt(length2());
 	}
 	template <typename T>
+	constexpr Matrix3<T> Quaternion<T>::to_mtx3() const
+	{
+		const T x2 = x * 2;
+		const T y2 = y * 2;
+		const T z2 = z * 2;
+
+		const T xx = x * x2;
+		const T xy = x * y2;
+		const T xz = x * z2;
+		const T yy = y * y2;
+		const T yz = y * z2;
+		const T zz = z * z2;
+
+		const T xw = w * x2;
+		const T yw = w * y2;
+		const T zw = w * z2;
+
+		return Matrix3<T>{
+			1 - (yy + zz), xy - zw, xz + yw,
+				xy + zw, 1 - (xx + zz), yz - xw,
+				xz - yw, yz + xw, 1 - (xx + yy)
+		};
+	}
+	template <typename T>
 	constexpr Matrix4<T> Quaternion<T>::to_mtx4() const
 	{
 		const T x2 = x * 2;
@@ -302,6 +324,47 @@ namespace els
 		};
 	}
 	template <typename T>
+	constexpr Quaternion<T> Quaternion<T>::from_mtx3(const Matrix3<T>& m)
+	{
+		const T m00 = m[0][0], m11 = m[1][1], m22 = m[2][2];
+		const T trace = m00 + m11 + m22;
+		Quaternion<T> q;
+		if (trace >= m00 && trace >= m11 && trace >= m22)
+		{
+			const T r = sqrt(1 + trace);
+			const T s = static_cast<T>(0.5) / r;
+			q = Quaternion<T>{ (m[2][1] - m[1][2]) * s, (m[0][2] - m[2][0]) * s, (m[1][0] - m[0][1]) * s, r * static_cast<T>(0.5) };
+		}
+		else if (m00 >= m11 && m00 >= m22)
+		{
+			const T r = sqrt(1 + m00 - m11 - m22);
+			const T s = static_cast<T>(0.5) / r;
+			q = Quaternion<T>{ r * static_cast<T>(0.5), (m[0][1] + m[1][0]) * s, (m[0][2] + m[2][0]) * s, (m[2][1] - m[1][2]) * s };
+		}
+		else if (m11 >= m22)
+		{
+			const T r = sqrt(1 - m00 + m11 - m22);
+			const T s = static_cast<T>(0.5) / r;
+			q = Quaternion<T>{ (m[0][1] + m[1][0]) * s, r * static_cast<T>(0.5), (m[1][2] + m[2][1]) * s, (m[0][2] - m[2][0]) * s };
+		}
+		else
+		{
+			const T r = sqrt(1 - m00 - m11 + m22);
+			const T s = static_cast<T>(0.5) / r;
+			q = Quaternion<T>{ (m[0][2] + m[2][0]) * s, (m[1][2] + m[2][1]) * s, r * static_cast<T>(0.5), (m[1][0] - m[0][1]) * s };
+		}
+		return q.normalized();
+	}
+	template <typename T>
+	constexpr Quaternion<T> Quaternion<T>::from_mtx4(const Matrix4<T>& m)
+	{
+		return from_mtx3(Matrix3<T>{
+			m[0][0], m[0][1], m[0][2],
+				m[1][0], m[1][1], m[1][2],
+				m[2][0], m[2][1], m[2][2]
+		});
+	}
+	template <typename T>
 	constexpr void Quaternion<T>::normalize()
 	{
 		*this /= length();
@@ -0,0 +1,111 @@
+#ifndef ELS_RAY
+#define ELS_RAY
+
+#include <limits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsGeometry.h"
+
+namespace els
+{
+	// points origin + t * direction for t in [t_min, t_max], direction does not need to be normalized
+	template <typename T>
+	struct Ray
+	{
+		using Scalar = T;
+
+		Vector3<T> origin;
+		Vector3<T> direction;
+		Scalar t_min;
+		Scalar t_max;
+
+		constexpr Ray()
+			: origin{}, direction{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) },
+			t_min{ static_cast<Scalar>(0) }, t_max{ std::numeric_limits<Scalar>::max() } {}
+		constexpr Ray(const Vector3<T>& o, const Vector3<T>& d,
+			const Scalar& t_start = static_cast<Scalar>(0), const Scalar& t_end = std::numeric_limits<Scalar>::max())
+			: origin{ o }, direction{ d }, t_min{ t_start }, t_max{ t_end } {}
+
+		constexpr Vector3<T> at(const Scalar& t) const { return origin + direction * t; }
+		// zero components give infinities, which the slab test handles
+		constexpr Vector3<T> inv_direction() const
+		{
+			return Vector3<T>{ static_cast<Scalar>(1) / direction.x, static_cast<Scalar>(1) / direction.y, static_cast<Scalar>(1) / direction.z };
+		}
+	};
+
+	// typedefs
+	using rayf = Ray<float>;
+	using ray = Ray<defaultType>;
+
+	// slab test, t_entry is the distance where the ray enters the box clipped to [t_min, t_max]
+	template <typename T>
+	inline constexpr bool intersect(const Ray<T>& ray, const Vector3<T>& inv_dir, const AABB<T>& box, T& t_entry)
+	{
+		const T x0 = (box.min.x - ray.origin.x) * inv_dir.x;
+		const T x1 = (box.max.x - ray.origin.x) * inv_dir.x;
+		const T y0 = (box.min.y - ray.origin.y) * inv_dir.y;
+		const T y1 = (box.max.y - ray.origin.y) * inv_dir.y;
+		const T z0 = (box.min.z - ray.origin.z) * inv_dir.z;
+		const T z1 = (box.max.z - ray.origin.z) * inv_dir.z;
+
+		const T t0 = max(max(min(x0, x1), min(y0, y1)), max(min(z0, z1), ray.t_min));
+		const T t1 = min(min(max(x0, x1), max(y0, y1)), min(max(z0, z1), ray.t_max));
+		t_entry = t0;
+		return t0 <= t1;
+	}
+	template <typename T>
+	inline constexpr bool intersect(const Ray<T>& ray, const AABB<T>& box, T& t_entry)
+	{
+		return intersect(ray, ray.inv_direction(), box, t_entry);
+	}
+
+	// moller trumbore, both sides of the triangle hit, u and v weight b and c
+	template <typename T>
+	inline constexpr bool intersect(const Ray<T>& ray, const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c, T& t, T& u, T& v)
+	{
+		const Vector3<T> e1 = b - a;
+		const Vector3<T> e2 = c - a;
+		const Vector3<T> p = ray.direction.cross(e2);
+		const T det = e1.dot(p);
+		if (det == 0)
+			return false;
+
+		const T inv_det = static_cast<T>(1) / det;
+		const Vector3<T> s = ray.origin - a;
+		u = s.dot(p) * inv_det;
+		if (u < 0 || u > 1)
+			return false;
+
+		const Vector3<T> q = s.cross(e1);
+		v = ray.direction.dot(q) * inv_det;
+		if (v < 0 || u + v > 1)
+			return false;
+
+		t = e2.dot(q) * inv_det;
+		return t >= ray.t_min && t <= ray.t_max;
+	}
+
+	// nearest of the two crossings inside [t_min, t_max], the far one when the origin is inside
+	template <typename T>
+	inline constexpr bool intersect(const Ray<T>& ray, const Sphere<T>& sphere, T& t)
+	{
+		const Vector3<T> oc = ray.origin - sphere.center;
+		const T a = ray.direction.length2();
+		const T half_b = oc.dot(ray.direction);
+		const T c = oc.length2() - sphere.radius * sphere.radius;
+		const T disc = half_b * half_b - a * c;
+		if (disc < 0 || a == 0)
+			return false;
+
+		const T root = sqrt(disc);
+		t = (-half_b - root) / a;
+		if (t < ray.t_min)
+			t = (-half_b + root) / a;
+		return t >= ray.t_min && t <= ray.t_max;
+	}
+
+} // namespace els
+
+#endif
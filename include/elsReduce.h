@@ -0,0 +1,467 @@
+#ifndef ELS_REDUCE
+#define ELS_REDUCE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsMatrix3.h"
+#include "elsGeometry.h"
+#include "elsHash.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// reductions over point spans, float spans run on simd kernels 8 wide with avx2 and 4 wide otherwise,
+	// other types on the scalar loops the kernels also use for their tails
+	// the input is cut into fixed chunks of reduce_grain points that are reduced on all threads and then
+	// combined in order, so the result does not depend on the thread count
+	constexpr size_t reduce_grain = 1 << 16;
+
+	namespace detail
+	{
+		namespace reduce
+		{
+			// float sums are carried in double, the rest compensate in their own type
+			template <typename T>
+			using wide_t = std::conditional_t<std::is_same<T, float>::value, double, T>;
+
+			// blocks the float kernels add in registers before folding them into double
+			constexpr size_t fold_blocks = 32;
+
+			template <typename T>
+			inline void bounds_scalar(const Vector3<T>* p, size_t n, T* lo, T* hi)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					for (unsigned int d = 0; d < 3; ++d)
+					{
+						lo[d] = p[i][d] < lo[d] ? p[i][d] : lo[d];
+						hi[d] = p[i][d] > hi[d] ? p[i][d] : hi[d];
+					}
+				}
+			}
+
+			// kahan summation, out gets the compensated sums added
+			template <typename T>
+			inline void sum_scalar(const Vector3<T>* p, size_t n, wide_t<T>* out)
+			{
+				using W = wide_t<T>;
+				W sum[3] = {}, carry[3] = {};
+				for (size_t i = 0; i < n; ++i)
+				{
+					for (unsigned int d = 0; d < 3; ++d)
+					{
+						const W y = static_cast<W>(p[i][d]) - carry[d];
+						const W t = sum[d] + y;
+						carry[d] = (t - sum[d]) - y;
+						sum[d] = t;
+					}
+				}
+				for (unsigned int d = 0; d < 3; ++d)
+					out[d] += sum[d] - carry[d];
+			}
+
+			// out gets xx, yy, zz, xy, yz, zx of the points relative to c added
+			template <typename T>
+			inline void moments_scalar(const Vector3<T>* p, size_t n, const T* c, wide_t<T>* out)
+			{
+				using W = wide_t<T>;
+				W m[6] = {};
+				for (size_t i = 0; i < n; ++i)
+				{
+					const W x = static_cast<W>(p[i].x - c[0]);
+					const W y = static_cast<W>(p[i].y - c[1]);
+					const W z = static_cast<W>(p[i].z - c[2]);
+					m[0] += x * x;
+					m[1] += y * y;
+					m[2] += z * z;
+					m[3] += x * y;
+					m[4] += y * z;
+					m[5] += z * x;
+				}
+				for (unsigned int k = 0; k < 6; ++k)
+					out[k] += m[k];
+			}
+
+			// first point farthest from c, best gets its squared distance or -1 for no points
+			template <typename T>
+			inline size_t farthest_scalar(const Vector3<T>* p, size_t n, const Vector3<T>& c, T& best)
+			{
+				size_t index = 0;
+				best = static_cast<T>(-1);
+				for (size_t i = 0; i < n; ++i)
+				{
+					const T d2 = p[i].distance2(c);
+					if (d2 > best)
+					{
+						best = d2;
+						index = i;
+					}
+				}
+				return index;
+			}
+
+			// ritter's update, a point outside moves the sphere toward it just enough to take it in
+			template <typename T>
+			inline void grow_scalar(const Vector3<T>* p, size_t n, T* c, T& radius)
+			{
+				for (size_t i = 0; i < n; ++i)
+				{
+					const Vector3<T> center(c[0], c[1], c[2]);
+					const T d2 = p[i].distance2(center);
+					if (d2 <= radius * radius)
+						continue;
+					const T d = std::sqrt(d2);
+					const T r = (radius + d) / 2;
+					const Vector3<T> moved = center + (p[i] - center) * ((r - radius) / d);
+					c[0] = moved.x;
+					c[1] = moved.y;
+					c[2] = moved.z;
+					radius = r;
+				}
+			}
+
+			struct reduce_table
+			{
+				void (*bounds)(const float*, size_t, float*, float*);
+				void (*sum)(const float*, size_t, double*);
+				void (*moments)(const float*, size_t, const float*, double*);
+				size_t (*farthest)(const float*, size_t, const float*, float&);
+				void (*grow)(const float*, size_t, float*, float&);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+#include "elsReduceKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+#include "elsReduceKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const reduce_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const reduce_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const reduce_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			template <typename T>
+			constexpr bool simd_v = std::is_same<T, float>::value;
+			static_assert(sizeof(Vector3<float>) == 3 * sizeof(float), "the float kernels read points as packed floats");
+
+			// fn(result, first, last) for every chunk of reduce_grain points on all threads, the results in chunk order
+			template <typename R, typename Fn>
+			inline std::vector<R> chunks(size_t n, const R& init, Fn&& fn)
+			{
+				std::vector<R> out((n + reduce_grain - 1) / reduce_grain, init);
+				parallel::for_range(0, out.size(), 1, [&](size_t first, size_t last)
+					{
+						for (size_t c = first; c < last; ++c)
+							fn(out[c], c * reduce_grain, min(n, (c + 1) * reduce_grain));
+					});
+				return out;
+			}
+
+			template <typename T>
+			inline Vector3<wide_t<T>> sum(span<const Vector3<T>> points)
+			{
+				using W = wide_t<T>;
+				struct Sums
+				{
+					W s[3];
+				};
+				const auto parts = chunks(points.size(), Sums{}, [&](Sums& r, size_t first, size_t last)
+					{
+						if constexpr (simd_v<T>)
+							kernels().sum(&points[first].x, last - first, r.s);
+						else
+							sum_scalar(points.data() + first, last - first, r.s);
+					});
+				W total[3] = {};
+				for (const Sums& r : parts)
+				{
+					for (unsigned int d = 0; d < 3; ++d)
+						total[d] += r.s[d];
+				}
+				return Vector3<W>(total[0], total[1], total[2]);
+			}
+
+			// first point farthest from c over all threads, best gets its squared distance
+			template <typename T>
+			inline size_t farthest(span<const Vector3<T>> points, const Vector3<T>& c, T& best)
+			{
+				struct Far
+				{
+					size_t index;
+					T d2;
+				};
+				const auto parts = chunks(points.size(), Far{ 0, static_cast<T>(-1) }, [&](Far& r, size_t first, size_t last)
+					{
+						if constexpr (simd_v<T>)
+							r.index = first + kernels().farthest(&points[first].x, last - first, &c.x, r.d2);
+						else
+							r.index = first + farthest_scalar(points.data() + first, last - first, c, r.d2);
+					});
+				Far result{ 0, static_cast<T>(-1) };
+				for (const Far& r : parts)
+				{
+					if (r.d2 > result.d2)
+						result = r;
+				}
+				best = result.d2;
+				return result.index;
+			}
+
+			// radius taking in every point around c, a couple of ulp above the farthest one
+			// so that Sphere::contains holds whatever rounding the kernels used
+			template <typename T>
+			inline Sphere<T> fit(span<const Vector3<T>> points, const Vector3<T>& c)
+			{
+				T d2;
+				farthest(points, c, d2);
+				return Sphere<T>(c, std::sqrt(d2) * (1 + 4 * std::numeric_limits<T>::epsilon()));
+			}
+
+			// welzl's support spheres, degenerate sets fall back to the sphere through fewer points
+			template <typename W>
+			struct Ball
+			{
+				Vector3<W> center;
+				W radius2;
+
+				bool contains(const Vector3<W>& p) const { return center.distance2(p) <= radius2 * (1 + 1e-12); }
+			};
+			template <typename W>
+			inline Ball<W> ball(const Vector3<W>& a, const Vector3<W>& b)
+			{
+				const Vector3<W> c = (a + b) * static_cast<W>(0.5);
+				return Ball<W>{ c, max(c.distance2(a), c.distance2(b)) };
+			}
+			template <typename W>
+			inline Ball<W> ball(const Vector3<W>& a, const Vector3<W>& b, const Vector3<W>& c)
+			{
+				const Vector3<W> ab = b - a;
+				const Vector3<W> ac = c - a;
+				const Vector3<W> n = ab.cross(ac);
+				const W n2 = n.length2();
+				if (n2 <= std::numeric_limits<W>::epsilon() * ab.length2() * ac.length2())
+				{
+					// collinear, the two farthest apart
+					const Ball<W> s[3] = { ball(a, b), ball(a, c), ball(b, c) };
+					const Ball<W>& far = s[0].radius2 >= s[1].radius2 ? (s[0].radius2 >= s[2].radius2 ? s[0] : s[2]) : (s[1].radius2 >= s[2].radius2 ? s[1] : s[2]);
+					return far;
+				}
+				const Vector3<W> center = a + (n.cross(ab) * ac.length2() + ac.cross(n) * ab.length2()) / (2 * n2);
+				return Ball<W>{ center, max(center.distance2(a), max(center.distance2(b), center.distance2(c))) };
+			}
+			template <typename W>
+			inline Ball<W> ball(const Vector3<W>& a, const Vector3<W>& b, const Vector3<W>& c, const Vector3<W>& d)
+			{
+				const Vector3<W> ab = b - a;
+				const Vector3<W> ac = c - a;
+				const Vector3<W> ad = d - a;
+				const W det = ab.dot(ac.cross(ad));
+				const W scale = std::sqrt(ab.length2() * ac.length2() * ad.length2());
+				if (std::abs(det) <= 64 * std::numeric_limits<W>::epsilon() * scale)
+				{
+					// coplanar, the circle through three of them grown to take in the fourth
+					Ball<W> s = ball(a, b, c);
+					s.radius2 = max(s.radius2, s.center.distance2(d));
+					return s;
+				}
+				const Vector3<W> center = a + (ac.cross(ad) * ab.length2() + ad.cross(ab) * ac.length2() + ab.cross(ac) * ad.length2()) / (2 * det);
+				return Ball<W>{ center, max(max(center.distance2(a), center.distance2(b)), max(center.distance2(c), center.distance2(d))) };
+			}
+		}
+	}
+
+	// component wise min and max, the empty box for no points
+	template <typename T>
+	inline AABB<T> bounds(span<const Vector3<T>> points)
+	{
+		using namespace detail::reduce;
+		struct Box
+		{
+			T lo[3], hi[3];
+		};
+		const T big = std::numeric_limits<T>::max();
+		const T low = std::numeric_limits<T>::lowest();
+		const Box empty{ { big, big, big }, { low, low, low } };
+		const auto parts = chunks(points.size(), empty, [&](Box& r, size_t first, size_t last)
+			{
+				if constexpr (simd_v<T>)
+					kernels().bounds(&points[first].x, last - first, r.lo, r.hi);
+				else
+					bounds_scalar(points.data() + first, last - first, r.lo, r.hi);
+			});
+		Box box = empty;
+		for (const Box& r : parts)
+		{
+			for (unsigned int d = 0; d < 3; ++d)
+			{
+				box.lo[d] = r.lo[d] < box.lo[d] ? r.lo[d] : box.lo[d];
+				box.hi[d] = r.hi[d] > box.hi[d] ? r.hi[d] : box.hi[d];
+			}
+		}
+		return AABB<T>(Vector3<T>(box.lo[0], box.lo[1], box.lo[2]), Vector3<T>(box.hi[0], box.hi[1], box.hi[2]));
+	}
+
+	// float points add up in double, others with kahan compensation
+	template <typename T>
+	inline Vector3<T> sum(span<const Vector3<T>> points)
+	{
+		const auto s = detail::reduce::sum(points);
+		return Vector3<T>(static_cast<T>(s.x), static_cast<T>(s.y), static_cast<T>(s.z));
+	}
+
+	// zero for no points
+	template <typename T>
+	inline Vector3<T> centroid(span<const Vector3<T>> points)
+	{
+		if (points.empty())
+			return Vector3<T>(static_cast<T>(0));
+		const auto s = detail::reduce::sum(points) / static_cast<detail::reduce::wide_t<T>>(points.size());
+		return Vector3<T>(static_cast<T>(s.x), static_cast<T>(s.y), static_cast<T>(s.z));
+	}
+
+	// population covariance, the second pass sums products about the centroid so large offsets cancel exactly
+	template <typename T>
+	inline Matrix3<T> covariance(span<const Vector3<T>> points)
+	{
+		using namespace detail::reduce;
+		using W = wide_t<T>;
+		if (points.empty())
+			return Matrix3<T>(static_cast<T>(0));
+
+		const Vector3<T> c = centroid(points);
+		struct Moments
+		{
+			W m[6];
+		};
+		const auto parts = chunks(points.size(), Moments{}, [&](Moments& r, size_t first, size_t last)
+			{
+				if constexpr (simd_v<T>)
+					kernels().moments(&points[first].x, last - first, &c.x, r.m);
+				else
+					moments_scalar(points.data() + first, last - first, &c.x, r.m);
+			});
+		W m[6] = {};
+		for (const Moments& r : parts)
+		{
+			for (unsigned int k = 0; k < 6; ++k)
+				m[k] += r.m[k];
+		}
+
+		T v[6];
+		for (unsigned int k = 0; k < 6; ++k)
+			v[k] = static_cast<T>(m[k] / static_cast<W>(points.size()));
+		return Matrix3<T>(
+			v[0], v[3], v[5],
+			v[3], v[1], v[4],
+			v[5], v[4], v[2]);
+	}
+
+	// ritter's sphere, at most a few percent above the minimal one on typical inputs
+	// the farthest point searches run on all threads, the growing pass on the calling thread
+	template <typename T>
+	inline Sphere<T> bounding_sphere(span<const Vector3<T>> points)
+	{
+		using namespace detail::reduce;
+		if (points.empty())
+			return Sphere<T>();
+
+		T d2;
+		const Vector3<T>& a = points[farthest(points, points[0], d2)];
+		const Vector3<T>& b = points[farthest(points, a, d2)];
+		Vector3<T> c = (a + b) / static_cast<T>(2);
+		T radius = std::sqrt(d2) / 2;
+		if constexpr (simd_v<T>)
+			kernels().grow(&points[0].x, points.size(), &c.x, radius);
+		else
+			grow_scalar(points.data(), points.size(), &c.x, radius);
+		return fit(points, c);
+	}
+
+	// smallest enclosing sphere, welzl's algorithm over a shuffled copy in expected linear time
+	// the support spheres are solved in double for float points, nearly degenerate ones are approximated
+	template <typename T>
+	inline Sphere<T> minimal_bounding_sphere(span<const Vector3<T>> points)
+	{
+		using namespace detail::reduce;
+		using W = wide_t<T>;
+		const size_t n = points.size();
+		if (n == 0)
+			return Sphere<T>();
+
+		// welzl's expected time needs a uniform random order, so the indices get one fisher-yates
+		// shuffle and the copy gathers through them, the fixed seed keeps the result repeatable
+		std::vector<size_t> order(n);
+		for (size_t i = 0; i < n; ++i)
+			order[i] = i;
+		for (size_t i = n - 1; i > 0; --i)
+			std::swap(order[i], order[hash_mix(i) % (i + 1)]);
+
+		std::vector<Vector3<W>> p(n);
+		parallel::for_range(0, n, reduce_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					const Vector3<T>& q = points[order[i]];
+					p[i] = Vector3<W>(q.x, q.y, q.z);
+				}
+			});
+
+		Ball<W> s{ p[0], 0 };
+		for (size_t i = 1; i < n; ++i)
+		{
+			if (s.contains(p[i]))
+				continue;
+			s = Ball<W>{ p[i], 0 };
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (s.contains(p[j]))
+					continue;
+				s = ball(p[i], p[j]);
+				for (size_t k = 0; k < j; ++k)
+				{
+					if (s.contains(p[k]))
+						continue;
+					s = ball(p[i], p[j], p[k]);
+					for (size_t l = 0; l < k; ++l)
+					{
+						if (!s.contains(p[l]))
+							s = ball(p[i], p[j], p[k], p[l]);
+					}
+				}
+			}
+		}
+		return fit(points, Vector3<T>(static_cast<T>(s.center.x), static_cast<T>(s.center.y), static_cast<T>(s.center.z)));
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,243 @@
+// no include guard, elsReduce.h includes this once per register width
+// the enclosing namespace provides V, splat(float) and loadv(const float*)
+//
+// a block is V::width points read as three registers straight from the xyz xyz layout,
+// lane k of register r then holds component (r * width + k) % 3 of its point
+
+constexpr size_t block_floats = 3 * V::width;
+
+// registers of (c[s % 3], c[(s + 1) % 3], ...) lined up with register r of a block read s floats later
+struct pattern
+{
+	V at[3][3];
+
+	explicit pattern(const float* c)
+	{
+		float lanes[block_floats + 2];
+		for (size_t i = 0; i < block_floats + 2; ++i)
+			lanes[i] = c[i % 3];
+		for (size_t r = 0; r < 3; ++r)
+		{
+			for (size_t s = 0; s < 3; ++s)
+				at[r][s] = loadv(lanes + r * V::width + s);
+		}
+	}
+};
+
+// lanes holding the x of a point
+struct x_lanes
+{
+	V at[3];
+
+	x_lanes()
+	{
+		float lanes[block_floats];
+		for (size_t i = 0; i < block_floats; ++i)
+			lanes[i] = static_cast<float>(i % 3);
+		for (size_t r = 0; r < 3; ++r)
+			at[r] = equal(loadv(lanes + r * V::width), splat(0.f));
+	}
+};
+
+// squared distance to c in the x lanes, the loads run two floats past the block
+inline V distance2(const float* f, size_t r, const pattern& c)
+{
+	const V a0 = loadv(f + r * V::width) - c.at[r][0];
+	const V a1 = loadv(f + r * V::width + 1) - c.at[r][1];
+	const V a2 = loadv(f + r * V::width + 2) - c.at[r][2];
+	return madd(a0, a0, madd(a1, a1, a2 * a2));
+}
+
+inline const Vector3<float>* points_at(const float* p, size_t i) { return reinterpret_cast<const Vector3<float>*>(p) + i; }
+
+// lo and hi hold the running bounds on entry
+inline void bounds(const float* p, size_t n, float* lo, float* hi)
+{
+	size_t i = 0;
+	if (n >= V::width)
+	{
+		V l[3], h[3];
+		for (size_t r = 0; r < 3; ++r)
+			l[r] = h[r] = loadv(p + r * V::width);
+		for (; i + V::width <= n; i += V::width)
+		{
+			const float* f = p + 3 * i;
+			for (size_t r = 0; r < 3; ++r)
+			{
+				const V x = loadv(f + r * V::width);
+				l[r] = min(l[r], x);
+				h[r] = max(h[r], x);
+			}
+		}
+
+		float tl[block_floats], th[block_floats];
+		for (size_t r = 0; r < 3; ++r)
+		{
+			store(tl + r * V::width, l[r]);
+			store(th + r * V::width, h[r]);
+		}
+		for (size_t k = 0; k < block_floats; ++k)
+		{
+			lo[k % 3] = tl[k] < lo[k % 3] ? tl[k] : lo[k % 3];
+			hi[k % 3] = th[k] > hi[k % 3] ? th[k] : hi[k % 3];
+		}
+	}
+	detail::reduce::bounds_scalar(points_at(p, i), n - i, lo, hi);
+}
+
+// out gets the x, y, z sums, float lanes add fold_blocks blocks before they are folded into double
+inline void sum(const float* p, size_t n, double* out)
+{
+	size_t i = 0;
+	while (i + V::width <= n)
+	{
+		V s[3] = { splat(0.f), splat(0.f), splat(0.f) };
+		const size_t end = min(n - (n - i) % V::width, i + fold_blocks * V::width);
+		for (; i < end; i += V::width)
+		{
+			const float* f = p + 3 * i;
+			for (size_t r = 0; r < 3; ++r)
+				s[r] = s[r] + loadv(f + r * V::width);
+		}
+
+		float t[block_floats];
+		for (size_t r = 0; r < 3; ++r)
+			store(t + r * V::width, s[r]);
+		for (size_t k = 0; k < block_floats; ++k)
+			out[k % 3] += t[k];
+	}
+	detail::reduce::sum_scalar(points_at(p, i), n - i, out);
+}
+
+// out gets xx, yy, zz, xy, yz, zx of the points relative to c
+// the x lanes pair with the next two floats for xy and xz, the y lanes with the next one for yz
+inline void moments(const float* p, size_t n, const float* c, double* out)
+{
+	const pattern center(c);
+	size_t i = 0;
+	while (i + V::width < n)
+	{
+		V d[3], o1[3], o2[3];
+		for (size_t r = 0; r < 3; ++r)
+			d[r] = o1[r] = o2[r] = splat(0.f);
+		const size_t end = min(i + fold_blocks * V::width, n - 1);
+		for (; i + V::width <= end; i += V::width)
+		{
+			const float* f = p + 3 * i;
+			for (size_t r = 0; r < 3; ++r)
+			{
+				const V a0 = loadv(f + r * V::width) - center.at[r][0];
+				const V a1 = loadv(f + r * V::width + 1) - center.at[r][1];
+				const V a2 = loadv(f + r * V::width + 2) - center.at[r][2];
+				d[r] = madd(a0, a0, d[r]);
+				o1[r] = madd(a0, a1, o1[r]);
+				o2[r] = madd(a0, a2, o2[r]);
+			}
+		}
+
+		float td[block_floats], t1[block_floats], t2[block_floats];
+		for (size_t r = 0; r < 3; ++r)
+		{
+			store(td + r * V::width, d[r]);
+			store(t1 + r * V::width, o1[r]);
+			store(t2 + r * V::width, o2[r]);
+		}
+		for (size_t k = 0; k < block_floats; ++k)
+		{
+			out[k % 3] += td[k];
+			if (k % 3 == 0)
+			{
+				out[3] += t1[k];
+				out[5] += t2[k];
+			}
+			else if (k % 3 == 1)
+				out[4] += t1[k];
+		}
+	}
+	detail::reduce::moments_scalar(points_at(p, i), n - i, c, out);
+}
+
+// first point farthest from c and its squared distance, n stays below 2^24 blocks
+inline size_t farthest(const float* p, size_t n, const float* c, float& best)
+{
+	const pattern from(c);
+	const x_lanes xs;
+	V far[3], at[3];
+	for (size_t r = 0; r < 3; ++r)
+	{
+		far[r] = splat(-1.f);
+		at[r] = splat(0.f);
+	}
+
+	size_t i = 0;
+	for (; i + V::width < n; i += V::width)
+	{
+		const float* f = p + 3 * i;
+		const V block = splat(static_cast<float>(i / V::width));
+		for (size_t r = 0; r < 3; ++r)
+		{
+			const V d2 = select(xs.at[r], distance2(f, r, from), splat(-1.f));
+			const V more = less(far[r], d2);
+			far[r] = select(more, d2, far[r]);
+			at[r] = select(more, block, at[r]);
+		}
+	}
+
+	size_t index = 0;
+	best = -1.f;
+	float tf[block_floats], ta[block_floats];
+	for (size_t r = 0; r < 3; ++r)
+	{
+		store(tf + r * V::width, far[r]);
+		store(ta + r * V::width, at[r]);
+	}
+	for (size_t k = 0; k < block_floats; k += 3)
+	{
+		const size_t point = static_cast<size_t>(ta[k]) * V::width + k / 3;
+		if (tf[k] > best || (tf[k] == best && point < index))
+		{
+			best = tf[k];
+			index = point;
+		}
+	}
+
+	float tail = -1.f;
+	const size_t last = i + detail::reduce::farthest_scalar(points_at(p, i), n - i, Vector3<float>{ c[0], c[1], c[2] }, tail);
+	if (tail > best)
+	{
+		best = tail;
+		index = last;
+	}
+	return index;
+}
+
+// ritter's pass, the sphere grows to take in every point outside it in order
+inline void grow(const float* p, size_t n, float* c, float& radius)
+{
+	const x_lanes xs;
+	size_t i = 0;
+	while (i + V::width < n)
+	{
+		const pattern center(c);
+		const V r2 = splat(radius * radius);
+		uint32_t outside = 0;
+		for (; i + V::width < n && !outside; i += V::width)
+		{
+			const float* f = p + 3 * i;
+			for (size_t r = 0; r < 3; ++r)
+				outside |= simd::mask_bits(xs.at[r] & less(r2, distance2(f, r, center))) << (r * V::width);
+		}
+		if (outside)
+		{
+			i -= V::width;
+			detail::reduce::grow_scalar(points_at(p, i), V::width, c, radius);
+			i += V::width;
+		}
+	}
+	detail::reduce::grow_scalar(points_at(p, i), n - i, c, radius);
+}
+
+inline reduce_table make_table()
+{
+	return reduce_table{ &bounds, &sum, &moments, &farthest, &grow };
+}
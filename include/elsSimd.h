@@ -0,0 +1,702 @@
+#ifndef ELS_SIMD
+#define ELS_SIMD
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "elsHeader.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(ELS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ELS_SIMD_SSE
+#include <emmintrin.h>
+#elif !defined(ELS_NO_SIMD) && ((defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64))
+#define ELS_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define ELS_SIMD_SCALAR
+#endif
+
+// 8 wide avx2 registers are compiled in next to sse and picked at run time with has_avx2()
+// the functions using them must sit between ELS_AVX2_BEGIN and ELS_AVX2_END, which also enables fma and f16c
+#if defined(ELS_SIMD_SSE) && !defined(ELS_NO_AVX2) && (defined(__x86_64__) || defined(_M_X64))
+#define ELS_SIMD_AVX2
+#include <immintrin.h>
+#if defined(__clang__)
+#define ELS_AVX2_BEGIN _Pragma("clang attribute push (__attribute__((target(\"avx2,fma,f16c\"))), apply_to = function)")
+#define ELS_AVX2_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define ELS_AVX2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma,f16c\")")
+#define ELS_AVX2_END _Pragma("GCC pop_options")
+#else
+#define ELS_AVX2_BEGIN
+#define ELS_AVX2_END
+#endif
+#endif
+
+// bmi2 bit deposit and extract are compiled in on x86-64 and picked at run time with has_bmi2()
+// the functions using them must sit between ELS_BMI2_BEGIN and ELS_BMI2_END
+#if !defined(ELS_NO_BMI2) && (defined(__x86_64__) || defined(_M_X64))
+#define ELS_BMI2
+#include <immintrin.h>
+#if defined(__clang__)
+#define ELS_BMI2_BEGIN _Pragma("clang attribute push (__attribute__((target(\"bmi2\"))), apply_to = function)")
+#define ELS_BMI2_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define ELS_BMI2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"bmi2\")")
+#define ELS_BMI2_END _Pragma("GCC pop_options")
+#else
+#define ELS_BMI2_BEGIN
+#define ELS_BMI2_END
+#endif
+#endif
+
+// pdep and pext are microcoded on amd before zen 3 and lose to plain shifts there, ELS_FAST_BMI2 is
+// set when the build targets a cpu where they are single instructions
+#if defined(ELS_BMI2) && defined(__BMI2__) && !defined(__bdver4__) && !defined(__znver1__) && !defined(__znver2__)
+#define ELS_FAST_BMI2
+#endif
+
+namespace els
+{
+	namespace simd
+	{
+		// 4 wide float register, falls back to plain arrays without sse/neon
+		struct float4
+		{
+#if defined(ELS_SIMD_SSE)
+			__m128 v;
+#elif defined(ELS_SIMD_NEON)
+			float32x4_t v;
+#else
+			float v[4];
+#endif
+			static constexpr size_t width = 4;
+		};
+		// 4 wide int32 register, used for bit manipulation of float lanes
+		struct int4
+		{
+#if defined(ELS_SIMD_SSE)
+			__m128i v;
+#elif defined(ELS_SIMD_NEON)
+			int32x4_t v;
+#else
+			int32_t v[4];
+#endif
+			static constexpr size_t width = 4;
+		};
+
+		inline float4 load(const float* p)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_loadu_ps(p) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vld1q_f32(p) };
+#else
+			return float4{ { p[0], p[1], p[2], p[3] } };
+#endif
+		}
+		inline void store(float* p, const float4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			_mm_storeu_ps(p, a.v);
+#elif defined(ELS_SIMD_NEON)
+			vst1q_f32(p, a.v);
+#else
+			for (int i = 0; i < 4; ++i) p[i] = a.v[i];
+#endif
+		}
+		inline float4 set(float x, float y, float z, float w)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_set_ps(w, z, y, x) };
+#elif defined(ELS_SIMD_NEON)
+			const float tmp[4] = { x, y, z, w };
+			return float4{ vld1q_f32(tmp) };
+#else
+			return float4{ { x, y, z, w } };
+#endif
+		}
+		// p[0], p[stride], p[2 * stride], p[3 * stride], for transposing small structs into lanes
+		inline float4 load_strided(const float* p, size_t stride)
+		{
+			return set(p[0], p[stride], p[2 * stride], p[3 * stride]);
+		}
+		inline float4 broadcast(float s)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_set1_ps(s) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vdupq_n_f32(s) };
+#else
+			return float4{ { s, s, s, s } };
+#endif
+		}
+		inline float4 zero()
+		{
+			return broadcast(0.f);
+		}
+
+		inline float4 operator+(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_add_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vaddq_f32(a.v, b.v) };
+#else
+			return float4{ { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+#endif
+		}
+		inline float4 operator-(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_sub_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vsubq_f32(a.v, b.v) };
+#else
+			return float4{ { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+#endif
+		}
+		inline float4 operator*(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_mul_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vmulq_f32(a.v, b.v) };
+#else
+			return float4{ { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } };
+#endif
+		}
+		inline float4 operator/(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_div_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vdivq_f32(a.v, b.v) };
+#else
+			return float4{ { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } };
+#endif
+		}
+		inline float4& operator+=(float4& a, const float4& b) { a = a + b; return a; }
+		inline float4& operator-=(float4& a, const float4& b) { a = a - b; return a; }
+		inline float4& operator*=(float4& a, const float4& b) { a = a * b; return a; }
+
+		// a * b + c
+		inline float4 madd(const float4& a, const float4& b, const float4& c)
+		{
+#if defined(ELS_SIMD_NEON)
+			return float4{ vmlaq_f32(c.v, a.v, b.v) };
+#else
+			return a * b + c;
+#endif
+		}
+		inline float4 min(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_min_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vminq_f32(a.v, b.v) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+			return r;
+#endif
+		}
+		inline float4 max(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_max_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vmaxq_f32(a.v, b.v) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+			return r;
+#endif
+		}
+
+		inline int4 int4_broadcast(int32_t s)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_set1_epi32(s) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vdupq_n_s32(s) };
+#else
+			return int4{ { s, s, s, s } };
+#endif
+		}
+		inline int4 operator+(const int4& a, const int4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_add_epi32(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vaddq_s32(a.v, b.v) };
+#else
+			return int4{ { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+#endif
+		}
+		inline int4 operator-(const int4& a, const int4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_sub_epi32(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vsubq_s32(a.v, b.v) };
+#else
+			return int4{ { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } };
+#endif
+		}
+		inline int4 operator&(const int4& a, const int4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_and_si128(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vandq_s32(a.v, b.v) };
+#else
+			return int4{ { a.v[0] & b.v[0], a.v[1] & b.v[1], a.v[2] & b.v[2], a.v[3] & b.v[3] } };
+#endif
+		}
+		template <int N>
+		inline int4 shift_left(const int4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_slli_epi32(a.v, N) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vshlq_n_s32(a.v, N) };
+#else
+			int4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = static_cast<int32_t>(static_cast<uint32_t>(a.v[i]) << N);
+			return r;
+#endif
+		}
+		// logical, zeros are shifted in
+		template <int N>
+		inline int4 shift_right(const int4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_srli_epi32(a.v, N) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a.v), N)) };
+#else
+			int4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = static_cast<int32_t>(static_cast<uint32_t>(a.v[i]) >> N);
+			return r;
+#endif
+		}
+		// comparisons return lane masks, all bits set where true
+		inline float4 less(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_cmplt_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) { const uint32_t m = a.v[i] < b.v[i] ? ~0u : 0u; std::memcpy(&r.v[i], &m, 4); }
+			return r;
+#endif
+		}
+		inline float4 less_equal(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_cmple_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(vcleq_f32(a.v, b.v)) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) { const uint32_t m = a.v[i] <= b.v[i] ? ~0u : 0u; std::memcpy(&r.v[i], &m, 4); }
+			return r;
+#endif
+		}
+		inline float4 equal(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_cmpeq_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(vceqq_f32(a.v, b.v)) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) { const uint32_t m = a.v[i] == b.v[i] ? ~0u : 0u; std::memcpy(&r.v[i], &m, 4); }
+			return r;
+#endif
+		}
+		inline float4 greater(const float4& a, const float4& b) { return less(b, a); }
+
+		inline int4 as_int(const float4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_castps_si128(a.v) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vreinterpretq_s32_f32(a.v) };
+#else
+			int4 r;
+			std::memcpy(r.v, a.v, 16);
+			return r;
+#endif
+		}
+		inline float4 as_float(const int4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_castsi128_ps(a.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_s32(a.v) };
+#else
+			float4 r;
+			std::memcpy(r.v, a.v, 16);
+			return r;
+#endif
+		}
+
+		inline float4 operator&(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_and_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+#else
+			int4 r = as_int(a);
+			const int4 m = as_int(b);
+			for (int i = 0; i < 4; ++i) r.v[i] &= m.v[i];
+			return as_float(r);
+#endif
+		}
+		inline float4 operator|(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_or_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+#else
+			int4 r = as_int(a);
+			const int4 m = as_int(b);
+			for (int i = 0; i < 4; ++i) r.v[i] |= m.v[i];
+			return as_float(r);
+#endif
+		}
+		inline float4 operator^(const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_xor_ps(a.v, b.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) };
+#else
+			int4 r = as_int(a);
+			const int4 m = as_int(b);
+			for (int i = 0; i < 4; ++i) r.v[i] ^= m.v[i];
+			return as_float(r);
+#endif
+		}
+		// mask ? a : b per lane
+		inline float4 select(const float4& mask, const float4& a, const float4& b)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) };
+#else
+			const int4 m = as_int(mask);
+			const int4 x = as_int(a);
+			int4 r = as_int(b);
+			for (int i = 0; i < 4; ++i) r.v[i] = (m.v[i] & x.v[i]) | (~m.v[i] & r.v[i]);
+			return as_float(r);
+#endif
+		}
+		// sign bit of every lane packed into the low 4 bits, lane 0 first
+		inline uint32_t mask_bits(const float4& mask)
+		{
+#if defined(ELS_SIMD_SSE)
+			return static_cast<uint32_t>(_mm_movemask_ps(mask.v));
+#elif defined(ELS_SIMD_NEON)
+			static const uint32_t weights[4] = { 1, 2, 4, 8 };
+			const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(mask.v), 31);
+			return vaddvq_u32(vmulq_u32(bits, vld1q_u32(weights)));
+#else
+			const int4 m = as_int(mask);
+			uint32_t r = 0;
+			for (int i = 0; i < 4; ++i) r |= (static_cast<uint32_t>(m.v[i]) >> 31) << i;
+			return r;
+#endif
+		}
+		inline float4 abs(const float4& a)
+		{
+			return as_float(as_int(a) & int4_broadcast(0x7fffffff));
+		}
+		inline float4 sqrt(const float4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_sqrt_ps(a.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vsqrtq_f32(a.v) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = std::sqrt(a.v[i]);
+			return r;
+#endif
+		}
+
+		// float to int rounding to nearest even, valid for |a| < 2^31
+		inline int4 to_int(const float4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return int4{ _mm_cvtps_epi32(a.v) };
+#elif defined(ELS_SIMD_NEON)
+			return int4{ vcvtnq_s32_f32(a.v) };
+#else
+			int4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = static_cast<int32_t>(std::nearbyint(a.v[i]));
+			return r;
+#endif
+		}
+		inline float4 to_float(const int4& a)
+		{
+#if defined(ELS_SIMD_SSE)
+			return float4{ _mm_cvtepi32_ps(a.v) };
+#elif defined(ELS_SIMD_NEON)
+			return float4{ vcvtq_f32_s32(a.v) };
+#else
+			float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = static_cast<float>(a.v[i]);
+			return r;
+#endif
+		}
+		inline float4 round(const float4& a)
+		{
+			return to_float(to_int(a));
+		}
+
+		// rounding error of the product p = a * b, so that a * b == p + mul_error(a, b, p) exactly
+		inline float4 mul_error(const float4& a, const float4& b, const float4& p)
+		{
+#if defined(ELS_SIMD_SSE) && defined(__FMA__)
+			return float4{ _mm_fmsub_ps(a.v, b.v, p.v) };
+#elif defined(ELS_SIMD_NEON) && defined(__aarch64__)
+			return float4{ vfmaq_f32(vnegq_f32(p.v), a.v, b.v) };
+#elif defined(ELS_SIMD_SCALAR)
+			float4 r;
+			for (int i = 0; i < 4; ++i) r.v[i] = static_cast<float>(static_cast<double>(a.v[i]) * b.v[i] - p.v[i]);
+			return r;
+#else
+			// dekker's split into 12 bit halves
+			const float4 split = broadcast(4097.f);
+			const float4 ca = a * split;
+			const float4 cb = b * split;
+			const float4 ah = ca - (ca - a);
+			const float4 bh = cb - (cb - b);
+			const float4 al = a - ah;
+			const float4 bl = b - bh;
+			return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+		}
+
+		// index of the lowest set bit, bits must not be 0
+		inline int lowest_bit(uint32_t bits)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_ctz(bits);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, bits);
+			return static_cast<int>(index);
+#else
+			int n = 0;
+			while (!(bits & 1))
+			{
+				bits >>= 1;
+				++n;
+			}
+			return n;
+#endif
+		}
+
+		// in-place 4x4 transpose of four row registers
+		inline void transpose(float4& r0, float4& r1, float4& r2, float4& r3)
+		{
+#if defined(ELS_SIMD_SSE)
+			_MM_TRANSPOSE4_PS(r0.v, r1.v, r2.v, r3.v);
+#elif defined(ELS_SIMD_NEON)
+			const float32x4x2_t a = vtrnq_f32(r0.v, r1.v);
+			const float32x4x2_t b = vtrnq_f32(r2.v, r3.v);
+			r0.v = vcombine_f32(vget_low_f32(a.val[0]), vget_low_f32(b.val[0]));
+			r1.v = vcombine_f32(vget_low_f32(a.val[1]), vget_low_f32(b.val[1]));
+			r2.v = vcombine_f32(vget_high_f32(a.val[0]), vget_high_f32(b.val[0]));
+			r3.v = vcombine_f32(vget_high_f32(a.val[1]), vget_high_f32(b.val[1]));
+#else
+			float4 t[4] = { r0, r1, r2, r3 };
+			for (int i = 0; i < 4; ++i)
+			{
+				r0.v[i] = t[i].v[0];
+				r1.v[i] = t[i].v[1];
+				r2.v[i] = t[i].v[2];
+				r3.v[i] = t[i].v[3];
+			}
+#endif
+		}
+
+#if defined(ELS_SIMD_AVX2)
+		// true if the cpu and os support avx2, fma and f16c, checked once
+		inline bool has_avx2()
+		{
+			static const bool supported = []
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+#else
+				int info[4];
+				__cpuid(info, 1);
+				const bool fma = (info[2] & (1 << 12)) != 0;
+				const bool f16c = (info[2] & (1 << 29)) != 0;
+				const bool osxsave = (info[2] & (1 << 27)) != 0;
+				__cpuidex(info, 7, 0);
+				const bool avx2 = (info[1] & (1 << 5)) != 0;
+				return fma && f16c && avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+#endif
+			}();
+			return supported;
+		}
+
+		ELS_AVX2_BEGIN
+		struct float8
+		{
+			__m256 v;
+			static constexpr size_t width = 8;
+		};
+		struct int8
+		{
+			__m256i v;
+			static constexpr size_t width = 8;
+		};
+
+		inline float8 load8(const float* p) { return float8{ _mm256_loadu_ps(p) }; }
+		inline void store(float* p, const float8& a) { _mm256_storeu_ps(p, a.v); }
+		inline float8 load8_strided(const float* p, size_t stride)
+		{
+			return float8{ _mm256_set_ps(p[7 * stride], p[6 * stride], p[5 * stride], p[4 * stride], p[3 * stride], p[2 * stride], p[stride], p[0]) };
+		}
+		inline float8 broadcast8(float s) { return float8{ _mm256_set1_ps(s) }; }
+		inline int8 int8_broadcast(int32_t s) { return int8{ _mm256_set1_epi32(s) }; }
+
+		inline float8 operator+(const float8& a, const float8& b) { return float8{ _mm256_add_ps(a.v, b.v) }; }
+		inline float8 operator-(const float8& a, const float8& b) { return float8{ _mm256_sub_ps(a.v, b.v) }; }
+		inline float8 operator*(const float8& a, const float8& b) { return float8{ _mm256_mul_ps(a.v, b.v) }; }
+		inline float8 operator/(const float8& a, const float8& b) { return float8{ _mm256_div_ps(a.v, b.v) }; }
+		inline float8 madd(const float8& a, const float8& b, const float8& c) { return float8{ _mm256_fmadd_ps(a.v, b.v, c.v) }; }
+		inline float8 min(const float8& a, const float8& b) { return float8{ _mm256_min_ps(a.v, b.v) }; }
+		inline float8 max(const float8& a, const float8& b) { return float8{ _mm256_max_ps(a.v, b.v) }; }
+		inline float8 sqrt(const float8& a) { return float8{ _mm256_sqrt_ps(a.v) }; }
+
+		inline float8 less(const float8& a, const float8& b) { return float8{ _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		inline float8 less_equal(const float8& a, const float8& b) { return float8{ _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+		inline float8 equal(const float8& a, const float8& b) { return float8{ _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+		inline float8 greater(const float8& a, const float8& b) { return less(b, a); }
+
+		inline float8 operator&(const float8& a, const float8& b) { return float8{ _mm256_and_ps(a.v, b.v) }; }
+		inline float8 operator|(const float8& a, const float8& b) { return float8{ _mm256_or_ps(a.v, b.v) }; }
+		inline float8 operator^(const float8& a, const float8& b) { return float8{ _mm256_xor_ps(a.v, b.v) }; }
+		inline float8 select(const float8& mask, const float8& a, const float8& b) { return float8{ _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+		inline uint32_t mask_bits(const float8& mask) { return static_cast<uint32_t>(_mm256_movemask_ps(mask.v)); }
+
+		inline int8 as_int(const float8& a) { return int8{ _mm256_castps_si256(a.v) }; }
+		inline float8 as_float(const int8& a) { return float8{ _mm256_castsi256_ps(a.v) }; }
+		inline int8 to_int(const float8& a) { return int8{ _mm256_cvtps_epi32(a.v) }; }
+		inline float8 to_float(const int8& a) { return float8{ _mm256_cvtepi32_ps(a.v) }; }
+		inline float8 round(const float8& a) { return float8{ _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+		inline float8 mul_error(const float8& a, const float8& b, const float8& p) { return float8{ _mm256_fmsub_ps(a.v, b.v, p.v) }; }
+
+		inline int8 operator+(const int8& a, const int8& b) { return int8{ _mm256_add_epi32(a.v, b.v) }; }
+		inline int8 operator-(const int8& a, const int8& b) { return int8{ _mm256_sub_epi32(a.v, b.v) }; }
+		inline int8 operator&(const int8& a, const int8& b) { return int8{ _mm256_and_si256(a.v, b.v) }; }
+		template <int N>
+		inline int8 shift_left(const int8& a) { return int8{ _mm256_slli_epi32(a.v, N) }; }
+		template <int N>
+		inline int8 shift_right(const int8& a) { return int8{ _mm256_srli_epi32(a.v, N) }; }
+
+		inline float8 abs(const float8& a) { return as_float(as_int(a) & int8_broadcast(0x7fffffff)); }
+
+		// in-place 8x8 transpose of eight row registers
+		inline void transpose(float8* r)
+		{
+			const __m256 t0 = _mm256_unpacklo_ps(r[0].v, r[1].v);
+			const __m256 t1 = _mm256_unpackhi_ps(r[0].v, r[1].v);
+			const __m256 t2 = _mm256_unpacklo_ps(r[2].v, r[3].v);
+			const __m256 t3 = _mm256_unpackhi_ps(r[2].v, r[3].v);
+			const __m256 t4 = _mm256_unpacklo_ps(r[4].v, r[5].v);
+			const __m256 t5 = _mm256_unpackhi_ps(r[4].v, r[5].v);
+			const __m256 t6 = _mm256_unpacklo_ps(r[6].v, r[7].v);
+			const __m256 t7 = _mm256_unpackhi_ps(r[6].v, r[7].v);
+			const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+			const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+			const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+			r[0].v = _mm256_permute2f128_ps(s0, s4, 0x20);
+			r[1].v = _mm256_permute2f128_ps(s1, s5, 0x20);
+			r[2].v = _mm256_permute2f128_ps(s2, s6, 0x20);
+			r[3].v = _mm256_permute2f128_ps(s3, s7, 0x20);
+			r[4].v = _mm256_permute2f128_ps(s0, s4, 0x31);
+			r[5].v = _mm256_permute2f128_ps(s1, s5, 0x31);
+			r[6].v = _mm256_permute2f128_ps(s2, s6, 0x31);
+			r[7].v = _mm256_permute2f128_ps(s3, s7, 0x31);
+		}
+		ELS_AVX2_END
+#else
+		inline bool has_avx2() { return false; }
+#endif
+
+#if defined(ELS_BMI2)
+		// true if the cpu supports bmi2, checked once
+		inline bool has_bmi2()
+		{
+			static const bool supported = []
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("bmi2");
+#else
+				int info[4];
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 8)) != 0;
+#endif
+			}();
+			return supported;
+		}
+		// has_bmi2() and not an amd cpu before zen 3, the families 15h to 18h microcode pdep and pext
+		inline bool has_fast_bmi2()
+		{
+			static const bool fast = []
+			{
+				if (!has_bmi2())
+					return false;
+#if defined(__GNUC__) || defined(__clang__)
+				unsigned int eax, ebx, ecx, edx;
+				__asm__("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0), "c"(0));
+				const unsigned int vendor = ebx;
+				__asm__("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+				const unsigned int signature = eax;
+#else
+				int info[4];
+				__cpuid(info, 0);
+				const unsigned int vendor = static_cast<unsigned int>(info[1]);
+				__cpuid(info, 1);
+				const unsigned int signature = static_cast<unsigned int>(info[0]);
+#endif
+				// "Auth" of AuthenticAMD and "Hygo" of HygonGenuine
+				const bool amd = vendor == 0x68747541u || vendor == 0x6f677948u;
+				const unsigned int family = ((signature >> 8) & 0xf) + ((signature >> 20) & 0xff);
+				return !amd || family >= 0x19;
+			}();
+			return fast;
+		}
+#else
+		inline bool has_bmi2() { return false; }
+		inline bool has_fast_bmi2() { return false; }
+#endif
+	}
+}
+
+#endif
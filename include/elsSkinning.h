@@ -0,0 +1,195 @@
+#ifndef ELS_SKINNING
+#define ELS_SKINNING
+
+#include <cstdint>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+#include "elsMatrix4.h"
+#include "elsMatrix3x4.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// vertices per worker chunk
+	constexpr size_t skinning_grain = 4096;
+
+	namespace detail
+	{
+		// palette is read as rows of Stride scalars, only the first 3 rows (affine part) are used
+		template <size_t Stride, typename T>
+		inline void skin_range(
+			const T* palette,
+			const Vector4<uint16_t>* bones,
+			const Vector4<T>* weights,
+			const Vector3<T>* positions,
+			Vector3<T>* out_positions,
+			const Vector3<T>* normals,
+			Vector3<T>* out_normals,
+			size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				const Vector4<uint16_t>& b = bones[i];
+				const Vector4<T>& w = weights[i];
+
+				const T* m0 = palette + b.x * Stride;
+				const T* m1 = palette + b.y * Stride;
+				const T* m2 = palette + b.z * Stride;
+				const T* m3 = palette + b.w * Stride;
+
+				// weighted affine matrix, accumulated once per vertex
+				T blend[12];
+				for (size_t k = 0; k < 12; ++k)
+					blend[k] = m0[k] * w.x + m1[k] * w.y + m2[k] * w.z + m3[k] * w.w;
+
+				const Vector3<T>& p = positions[i];
+				out_positions[i] = Vector3<T>{
+					blend[0] * p.x + blend[1] * p.y + blend[2] * p.z + blend[3],
+					blend[4] * p.x + blend[5] * p.y + blend[6] * p.z + blend[7],
+					blend[8] * p.x + blend[9] * p.y + blend[10] * p.z + blend[11] };
+
+				if (normals)
+				{
+					const Vector3<T>& n = normals[i];
+					Vector3<T> r{
+						blend[0] * n.x + blend[1] * n.y + blend[2] * n.z,
+						blend[4] * n.x + blend[5] * n.y + blend[6] * n.z,
+						blend[8] * n.x + blend[9] * n.y + blend[10] * n.z };
+					const T len2 = r.length2();
+					if (len2 > static_cast<T>(0))
+						r /= sqrt(len2);
+					out_normals[i] = r;
+				}
+			}
+		}
+
+		template <size_t Stride>
+		inline void skin_range(
+			const float* palette,
+			const Vector4<uint16_t>* bones,
+			const Vector4<float>* weights,
+			const Vector3<float>* positions,
+			Vector3<float>* out_positions,
+			const Vector3<float>* normals,
+			Vector3<float>* out_normals,
+			size_t first, size_t last)
+		{
+			using namespace simd;
+
+			for (size_t i = first; i < last; ++i)
+			{
+				const Vector4<uint16_t>& b = bones[i];
+				const Vector4<float>& w = weights[i];
+
+				const float* m0 = palette + b.x * Stride;
+				const float* m1 = palette + b.y * Stride;
+				const float* m2 = palette + b.z * Stride;
+				const float* m3 = palette + b.w * Stride;
+
+				const float4 w0 = broadcast(w.x);
+				const float4 w1 = broadcast(w.y);
+				const float4 w2 = broadcast(w.z);
+				const float4 w3 = broadcast(w.w);
+
+				// blended rows of the affine matrix
+				float4 r0 = madd(load(m3), w3, madd(load(m2), w2, madd(load(m1), w1, load(m0) * w0)));
+				float4 r1 = madd(load(m3 + 4), w3, madd(load(m2 + 4), w2, madd(load(m1 + 4), w1, load(m0 + 4) * w0)));
+				float4 r2 = madd(load(m3 + 8), w3, madd(load(m2 + 8), w2, madd(load(m1 + 8), w1, load(m0 + 8) * w0)));
+				float4 r3 = zero();
+
+				// rows to columns so the transform is 3 madds per vertex
+				transpose(r0, r1, r2, r3);
+
+				float res[4];
+				const Vector3<float>& p = positions[i];
+				store(res, madd(r0, broadcast(p.x), madd(r1, broadcast(p.y), madd(r2, broadcast(p.z), r3))));
+				out_positions[i] = Vector3<float>{ res[0], res[1], res[2] };
+
+				if (normals)
+				{
+					const Vector3<float>& n = normals[i];
+					store(res, madd(r0, broadcast(n.x), madd(r1, broadcast(n.y), r2 * broadcast(n.z))));
+					const float len2 = res[0] * res[0] + res[1] * res[1] + res[2] * res[2];
+					const float inv = len2 > 0.f ? 1.f / sqrt(len2) : 0.f;
+					out_normals[i] = Vector3<float>{ res[0] * inv, res[1] * inv, res[2] * inv };
+				}
+			}
+		}
+
+		template <size_t Stride, typename T>
+		inline bool skin(
+			const T* palette,
+			size_t palette_size,
+			span<const Vector4<uint16_t>> bones,
+			span<const Vector4<T>> weights,
+			span<const Vector3<T>> positions,
+			span<Vector3<T>> out_positions,
+			span<const Vector3<T>> normals,
+			span<Vector3<T>> out_normals)
+		{
+			const size_t n = positions.size();
+			if (n == 0)
+				return true;
+			if (palette_size == 0 || bones.size() < n || weights.size() < n || out_positions.size() < n)
+				return false;
+			// normals come in pairs, one without the other is a mistake and not a request to skip them
+			const bool skin_normals = !normals.empty() || !out_normals.empty();
+			if (skin_normals && (normals.size() < n || out_normals.size() < n))
+				return false;
+
+			parallel::for_range(0, positions.size(), skinning_grain, [&](size_t first, size_t last)
+				{
+					skin_range<Stride>(
+						palette,
+						bones.data(),
+						weights.data(),
+						positions.data(),
+						out_positions.data(),
+						skin_normals ? normals.data() : nullptr,
+						skin_normals ? out_normals.data() : nullptr,
+						first, last);
+				});
+			return true;
+		}
+	}
+
+	// linear blend skinning with up to 4 influences per vertex
+	// weights are expected to sum to 1, unused influences should carry weight 0
+	// normals are optional and are renormalized after blending
+	// bones, weights, out_positions and the normal spans when given must hold at least positions.size()
+	// elements, otherwise nothing is written and false is returned
+	// every bone index must be below palette.size(), they are not checked since that costs a compare per
+	// influence, an unused influence with weight 0 still has to point at a valid bone such as 0
+	template <typename T>
+	inline bool linear_blend_skin(
+		span<const Matrix4<T>> palette,
+		span<const Vector4<uint16_t>> bones,
+		span<const Vector4<T>> weights,
+		span<const Vector3<T>> positions,
+		span<Vector3<T>> out_positions,
+		span<const Vector3<T>> normals = {},
+		span<Vector3<T>> out_normals = {})
+	{
+		return detail::skin<16>(palette.empty() ? nullptr : palette.data()->data(), palette.size(), bones, weights, positions, out_positions, normals, out_normals);
+	}
+	// compact palette, 48 bytes per bone in float
+	template <typename T>
+	inline bool linear_blend_skin(
+		span<const Matrix3x4<T>> palette,
+		span<const Vector4<uint16_t>> bones,
+		span<const Vector4<T>> weights,
+		span<const Vector3<T>> positions,
+		span<Vector3<T>> out_positions,
+		span<const Vector3<T>> normals = {},
+		span<Vector3<T>> out_normals = {})
+	{
+		return detail::skin<12>(palette.empty() ? nullptr : palette.data()->data(), palette.size(), bones, weights, positions, out_positions, normals, out_normals);
+	}
+
+} // namespace els
+
+#endif
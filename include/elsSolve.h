@@ -0,0 +1,498 @@
+#ifndef ELS_SOLVE
+#define ELS_SOLVE
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+#include "elsMatrix2.h"
+#include "elsMatrix3.h"
+#include "elsMatrix4.h"
+#include "elsSpan.h"
+#include "elsSimd.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// systems per worker chunk for the span versions
+	constexpr size_t solve_grain = 1 << 12;
+
+	namespace detail
+	{
+		namespace solve
+		{
+			template <typename Matrix>
+			struct shape;
+			template <typename T>
+			struct shape<Matrix2<T>>
+			{
+				static constexpr unsigned int n = 2;
+				using vector = Vector2<T>;
+			};
+			template <typename T>
+			struct shape<Matrix3<T>>
+			{
+				static constexpr unsigned int n = 3;
+				using vector = Vector3<T>;
+			};
+			template <typename T>
+			struct shape<Matrix4<T>>
+			{
+				static constexpr unsigned int n = 4;
+				using vector = Vector4<T>;
+			};
+
+			// a pivot at or below this times the largest entry counts as zero
+			template <typename T>
+			constexpr T solve_tolerance(unsigned int n)
+			{
+				return static_cast<T>(n) * std::numeric_limits<T>::epsilon();
+			}
+
+			// fn(std::integral_constant<unsigned int, i>) for i in [First, Last), gcc -O2 keeps the
+			// short fixed loops of the scalar factorizations as loops with the matrix on the stack
+			template <unsigned int First, typename Fn, unsigned int... I>
+			inline void unroll(Fn&& fn, std::integer_sequence<unsigned int, I...>)
+			{
+				(fn(std::integral_constant<unsigned int, First + I>{}), ...);
+			}
+			template <unsigned int First, unsigned int Last, typename Fn>
+			inline void unroll(Fn&& fn)
+			{
+				unroll<First>(fn, std::make_integer_sequence<unsigned int, Last - First>{});
+			}
+
+			struct solve_table
+			{
+				size_t (*lu[3])(const float*, const float*, float*, size_t);
+				size_t (*ldlt[3])(const float*, const float*, float*, size_t);
+			};
+
+			namespace x4
+			{
+				using V = simd::float4;
+				inline V splat(float s) { return simd::broadcast(s); }
+				inline V loadv(const float* p) { return simd::load(p); }
+				inline V strided(const float* p, size_t stride) { return simd::load_strided(p, stride); }
+#include "elsSolveKernels.h"
+			}
+
+#if defined(ELS_SIMD_AVX2)
+			ELS_AVX2_BEGIN
+			namespace x8
+			{
+				using V = simd::float8;
+				inline V splat(float s) { return simd::broadcast8(s); }
+				inline V loadv(const float* p) { return simd::load8(p); }
+				inline V strided(const float* p, size_t stride) { return simd::load8_strided(p, stride); }
+#include "elsSolveKernels.h"
+			}
+			ELS_AVX2_END
+#endif
+
+			// picked once on first use
+			inline const solve_table& kernels()
+			{
+#if defined(ELS_SIMD_AVX2)
+				static const solve_table table = simd::has_avx2() ? x8::make_table() : x4::make_table();
+#else
+				static const solve_table table = x4::make_table();
+#endif
+				return table;
+			}
+
+			// kernel(a, b, x, count) on all threads, returns the number of singular systems
+			template <typename Kernel>
+			inline size_t run(size_t count, Kernel&& kernel)
+			{
+				std::atomic<size_t> failed{ 0 };
+				parallel::for_range(0, count, solve_grain, [&](size_t first, size_t last)
+					{
+						failed += kernel(first, last);
+					});
+				return failed;
+			}
+		}
+	}
+
+	// lu factorization with partial pivoting of Matrix2, Matrix3 or Matrix4, for A x = b without forming the inverse
+	// a pivot at or below tolerance times the largest entry marks the matrix singular, ok() is false
+	// and solve and inverse return zero like Matrix::inverse does
+	template <typename Matrix>
+	class LU
+	{
+	public:
+		using Scalar = typename Matrix::Scalar;
+		using Vector = typename detail::solve::shape<Matrix>::vector;
+
+		static constexpr unsigned int n = detail::solve::shape<Matrix>::n;
+
+	private:
+		Matrix lu;			// unit lower l below the diagonal, u on and above it
+		uint8_t perm[n];	// row r of lu comes from row perm[r] of the input
+		Scalar norm1;		// of the input, for rcond
+		bool odd;			// odd number of row swaps
+		bool singular;
+
+	public:
+		explicit LU(const Matrix& m, Scalar tolerance = detail::solve::solve_tolerance<Scalar>(n));
+
+		bool ok() const { return !singular; }
+		Scalar det() const;
+		// 1 / (|m|_1 |m^-1|_1), near 0 for ill conditioned matrices and 0 for singular ones
+		Scalar rcond() const;
+
+		Vector solve(const Vector& b) const;
+		Matrix inverse() const;
+	};
+
+	// l d l^T factorization of a symmetric Matrix2, Matrix3 or Matrix4, only the upper triangle is read
+	// there is no pivoting, so it suits positive definite matrices and quasi definite ones like saddle points
+	// a d entry at or below tolerance times the largest entry marks the matrix singular
+	template <typename Matrix>
+	class LDLT
+	{
+	public:
+		using Scalar = typename Matrix::Scalar;
+		using Vector = typename detail::solve::shape<Matrix>::vector;
+
+		static constexpr unsigned int n = detail::solve::shape<Matrix>::n;
+
+	private:
+		Matrix ld;		// unit lower l below the diagonal, d on it
+		Scalar norm1;
+		bool singular;
+
+	public:
+		explicit LDLT(const Matrix& m, Scalar tolerance = detail::solve::solve_tolerance<Scalar>(n));
+
+		bool ok() const { return !singular; }
+		// every d entry positive, the matrix is positive definite
+		bool positive() const;
+		Scalar det() const;
+		Scalar rcond() const;
+
+		Vector solve(const Vector& b) const;
+		Matrix inverse() const;
+	};
+
+	// member functions
+	template <typename Matrix>
+	LU<Matrix>::LU(const Matrix& m, Scalar tolerance)
+		: lu{ m }, perm{}, norm1{ 0 }, odd{ false }, singular{ false }
+	{
+		using detail::solve::unroll;
+
+		// a local copy with fixed indices stays in registers, and the pivot rows are swapped
+		// by compare and select like the span kernels, random pivots would mispredict every branch
+		Scalar a[n * n];
+		Scalar row[n];
+		unroll<0, n * n>([&](auto e) { a[e] = m.data()[e]; });
+		unroll<0, n>([&](auto r) { row[r] = static_cast<Scalar>(r); });
+		unroll<0, n>([&](auto c)
+			{
+				Scalar column = 0;
+				unroll<0, n>([&](auto r) { column += abs(a[n * r + c]); });
+				norm1 = max(norm1, column);
+			});
+
+		Scalar largest = 0;
+		unroll<0, n * n>([&](auto e) { largest = max(largest, abs(a[e])); });
+		const Scalar limit = tolerance * largest;
+		unroll<0, n>([&](auto pivot)
+			{
+				constexpr unsigned int k = decltype(pivot)::value;
+				unroll<k + 1, n>([&](auto r)
+					{
+						const bool swap = abs(a[n * k + k]) < abs(a[n * r + k]);
+						unroll<0, n>([&](auto c)
+							{
+								const Scalar top = a[n * k + c];
+								a[n * k + c] = swap ? a[n * r + c] : top;
+								a[n * r + c] = swap ? top : a[n * r + c];
+							});
+						const Scalar top = row[k];
+						row[k] = swap ? row[r] : top;
+						row[r] = swap ? top : row[r];
+						odd = odd != swap;
+					});
+				singular = singular | (abs(a[n * k + k]) <= limit);
+
+				const Scalar inv = 1 / a[n * k + k];
+				unroll<k + 1, n>([&](auto r)
+					{
+						const Scalar f = a[n * r + k] * inv;
+						a[n * r + k] = f;
+						unroll<k + 1, n>([&](auto c) { a[n * r + c] -= f * a[n * k + c]; });
+					});
+			});
+
+		unroll<0, n * n>([&](auto e) { lu.data()[e] = a[e]; });
+		unroll<0, n>([&](auto r) { perm[r] = static_cast<uint8_t>(row[r]); });
+	}
+	template <typename Matrix>
+	typename LU<Matrix>::Scalar LU<Matrix>::det() const
+	{
+		if (singular)
+			return 0;
+		Scalar d = odd ? -1 : 1;
+		for (unsigned int k = 0; k < n; ++k)
+			d *= lu[k][k];
+		return d;
+	}
+	template <typename Matrix>
+	typename LU<Matrix>::Scalar LU<Matrix>::rcond() const
+	{
+		if (singular)
+			return 0;
+		const Matrix inv = inverse();
+		Scalar inv_norm1 = 0;
+		for (unsigned int c = 0; c < n; ++c)
+		{
+			Scalar column = 0;
+			for (unsigned int r = 0; r < n; ++r)
+				column += abs(inv[r][c]);
+			inv_norm1 = max(inv_norm1, column);
+		}
+		return 1 / (norm1 * inv_norm1);
+	}
+	template <typename Matrix>
+	typename LU<Matrix>::Vector LU<Matrix>::solve(const Vector& b) const
+	{
+		using detail::solve::unroll;
+
+		if (singular)
+			return Vector::zero;
+
+		// l y = p b then u x = y, the second pass runs backwards through r = n - 1 - i
+		Vector x;
+		const Scalar* a = lu.data();
+		unroll<0, n>([&](auto r)
+			{
+				Scalar s = b[perm[r]];
+				unroll<0, r>([&](auto c) { s -= a[n * r + c] * x[c]; });
+				x[r] = s;
+			});
+		unroll<0, n>([&](auto i)
+			{
+				constexpr unsigned int r = n - 1 - decltype(i)::value;
+				Scalar s = x[r];
+				unroll<r + 1, n>([&](auto c) { s -= a[n * r + c] * x[c]; });
+				x[r] = s / a[n * r + r];
+			});
+		return x;
+	}
+	template <typename Matrix>
+	Matrix LU<Matrix>::inverse() const
+	{
+		if (singular)
+			return Matrix::zero;
+
+		Matrix inv;
+		for (unsigned int c = 0; c < n; ++c)
+		{
+			Vector e = Vector::zero;
+			e[c] = 1;
+			const Vector x = solve(e);
+			for (unsigned int r = 0; r < n; ++r)
+				inv[r][c] = x[r];
+		}
+		return inv;
+	}
+
+	template <typename Matrix>
+	LDLT<Matrix>::LDLT(const Matrix& m, Scalar tolerance)
+		: ld{ m }, norm1{ 0 }, singular{ false }
+	{
+		using detail::solve::unroll;
+
+		// the upper triangle mirrored, so column sums give the 1 norm
+		Scalar a[n * n];
+		unroll<0, n>([&](auto r)
+			{
+				unroll<r, n>([&](auto c)
+					{
+						a[n * r + c] = m.data()[n * r + c];
+						a[n * c + r] = a[n * r + c];
+					});
+			});
+		unroll<0, n>([&](auto c)
+			{
+				Scalar column = 0;
+				unroll<0, n>([&](auto r) { column += abs(a[n * r + c]); });
+				norm1 = max(norm1, column);
+			});
+
+		Scalar largest = 0;
+		unroll<0, n * n>([&](auto e) { largest = max(largest, abs(a[e])); });
+		const Scalar limit = tolerance * largest;
+
+		// l overwrites the lower triangle of a, d its diagonal
+		unroll<0, n>([&](auto column)
+			{
+				constexpr unsigned int j = decltype(column)::value;
+				Scalar d = a[n * j + j];
+				unroll<0, j>([&](auto k) { d -= a[n * j + k] * a[n * j + k] * a[n * k + k]; });
+				singular = singular | (abs(d) <= limit);
+				a[n * j + j] = d;
+				const Scalar inv = 1 / d;
+				unroll<j + 1, n>([&](auto r)
+					{
+						Scalar s = a[n * j + r];
+						unroll<0, j>([&](auto k) { s -= a[n * r + k] * a[n * j + k] * a[n * k + k]; });
+						a[n * r + j] = s * inv;
+					});
+			});
+		unroll<0, n * n>([&](auto e) { ld.data()[e] = a[e]; });
+	}
+	template <typename Matrix>
+	bool LDLT<Matrix>::positive() const
+	{
+		if (singular)
+			return false;
+		for (unsigned int k = 0; k < n; ++k)
+		{
+			if (!(ld[k][k] > 0))
+				return false;
+		}
+		return true;
+	}
+	template <typename Matrix>
+	typename LDLT<Matrix>::Scalar LDLT<Matrix>::det() const
+	{
+		if (singular)
+			return 0;
+		Scalar d = 1;
+		for (unsigned int k = 0; k < n; ++k)
+			d *= ld[k][k];
+		return d;
+	}
+	template <typename Matrix>
+	typename LDLT<Matrix>::Scalar LDLT<Matrix>::rcond() const
+	{
+		if (singular)
+			return 0;
+		const Matrix inv = inverse();
+		Scalar inv_norm1 = 0;
+		for (unsigned int c = 0; c < n; ++c)
+		{
+			Scalar column = 0;
+			for (unsigned int r = 0; r < n; ++r)
+				column += abs(inv[r][c]);
+			inv_norm1 = max(inv_norm1, column);
+		}
+		return 1 / (norm1 * inv_norm1);
+	}
+	template <typename Matrix>
+	typename LDLT<Matrix>::Vector LDLT<Matrix>::solve(const Vector& b) const
+	{
+		using detail::solve::unroll;
+
+		if (singular)
+			return Vector::zero;
+
+		// l y = b, z = y / d, l^T x = z with the last pass running backwards through r = n - 1 - i
+		Vector x = b;
+		const Scalar* a = ld.data();
+		unroll<1, n>([&](auto r) { unroll<0, r>([&](auto k) { x[r] -= a[n * r + k] * x[k]; }); });
+		unroll<0, n>([&](auto r) { x[r] /= a[n * r + r]; });
+		unroll<0, n>([&](auto i)
+			{
+				constexpr unsigned int r = n - 1 - decltype(i)::value;
+				unroll<r + 1, n>([&](auto k) { x[r] -= a[n * k + r] * x[k]; });
+			});
+		return x;
+	}
+	template <typename Matrix>
+	Matrix LDLT<Matrix>::inverse() const
+	{
+		if (singular)
+			return Matrix::zero;
+
+		Matrix inv;
+		for (unsigned int c = 0; c < n; ++c)
+		{
+			Vector e = Vector::zero;
+			e[c] = 1;
+			const Vector x = solve(e);
+			for (unsigned int r = 0; r < n; ++r)
+				inv[r][c] = x[r];
+		}
+		return inv;
+	}
+
+	// a[i] x[i] = b[i] for whole spans, float systems run 4 or 8 per simd register with the pivoting
+	// done by compare and select, other types use the classes above
+	// returns the number of singular systems, their x is zero
+	inline size_t solve(span<const Matrix2<float>> a, span<const Vector2<float>> b, span<Vector2<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().lu[0];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+	inline size_t solve(span<const Matrix3<float>> a, span<const Vector3<float>> b, span<Vector3<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().lu[1];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+	inline size_t solve(span<const Matrix4<float>> a, span<const Vector4<float>> b, span<Vector4<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().lu[2];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+	// the same with ldlt for symmetric systems, about twice as fast as the lu ones
+	inline size_t solve_symmetric(span<const Matrix2<float>> a, span<const Vector2<float>> b, span<Vector2<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().ldlt[0];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+	inline size_t solve_symmetric(span<const Matrix3<float>> a, span<const Vector3<float>> b, span<Vector3<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().ldlt[1];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+	inline size_t solve_symmetric(span<const Matrix4<float>> a, span<const Vector4<float>> b, span<Vector4<float>> x)
+	{
+		const auto kernel = detail::solve::kernels().ldlt[2];
+		return detail::solve::run(a.size(), [&](size_t first, size_t last) { return kernel(a[first].data(), &b[first].x, &x[first].x, last - first); });
+	}
+
+	template <typename Matrix, typename Vector = typename detail::solve::shape<Matrix>::vector>
+	inline size_t solve(span<const Matrix> a, span<const Vector> b, span<Vector> x)
+	{
+		return detail::solve::run(a.size(), [&](size_t first, size_t last)
+			{
+				size_t failed = 0;
+				for (size_t i = first; i < last; ++i)
+				{
+					const LU<Matrix> f(a[i]);
+					failed += f.ok() ? 0 : 1;
+					x[i] = f.solve(b[i]);
+				}
+				return failed;
+			});
+	}
+	template <typename Matrix, typename Vector = typename detail::solve::shape<Matrix>::vector>
+	inline size_t solve_symmetric(span<const Matrix> a, span<const Vector> b, span<Vector> x)
+	{
+		return detail::solve::run(a.size(), [&](size_t first, size_t last)
+			{
+				size_t failed = 0;
+				for (size_t i = first; i < last; ++i)
+				{
+					const LDLT<Matrix> f(a[i]);
+					failed += f.ok() ? 0 : 1;
+					x[i] = f.solve(b[i]);
+				}
+				return failed;
+			});
+	}
+
+} // namespace els
+
+#endif
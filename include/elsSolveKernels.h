@@ -0,0 +1,160 @@
+// no include guard, elsSolve.h includes this once per register width
+// the enclosing namespace provides V, splat(float), loadv(const float*) and strided(const float*, size_t)
+//
+// every lane holds one system, a[n * r + c] is row r column c, short blocks are padded with identities
+
+template <unsigned int N>
+inline void gather(const float* a, const float* b, size_t count, V* va, V* vb)
+{
+	if (count == V::width)
+	{
+		for (unsigned int e = 0; e < N * N; ++e)
+			va[e] = strided(a + e, N * N);
+		for (unsigned int i = 0; i < N; ++i)
+			vb[i] = strided(b + i, N);
+		return;
+	}
+
+	float lanes[N * N + N][V::width];
+	for (size_t k = 0; k < V::width; ++k)
+	{
+		for (unsigned int e = 0; e < N * N; ++e)
+			lanes[e][k] = k < count ? a[N * N * k + e] : (e % (N + 1) == 0 ? 1.f : 0.f);
+		for (unsigned int i = 0; i < N; ++i)
+			lanes[N * N + i][k] = k < count ? b[N * k + i] : 0.f;
+	}
+	for (unsigned int e = 0; e < N * N; ++e)
+		va[e] = loadv(lanes[e]);
+	for (unsigned int i = 0; i < N; ++i)
+		vb[i] = loadv(lanes[N * N + i]);
+}
+
+// x of the first count lanes, zero where singular is set, returns how many of them are
+template <unsigned int N>
+inline size_t scatter(const V* vx, const V& singular, float* x, size_t count)
+{
+	float lanes[N][V::width];
+	for (unsigned int i = 0; i < N; ++i)
+		store(lanes[i], select(singular, splat(0.f), vx[i]));
+	for (size_t k = 0; k < count; ++k)
+	{
+		for (unsigned int i = 0; i < N; ++i)
+			x[N * k + i] = lanes[i][k];
+	}
+	size_t failed = 0;
+	for (uint32_t bits = simd::mask_bits(singular) & ((1u << count) - 1); bits; bits &= bits - 1)
+		++failed;
+	return failed;
+}
+
+template <unsigned int N>
+inline V largest(const V* a)
+{
+	V m = abs(a[0]);
+	for (unsigned int e = 1; e < N * N; ++e)
+		m = max(m, abs(a[e]));
+	return m;
+}
+
+// partial pivoting picks the row by compare and select, every lane runs the same instructions
+template <unsigned int N>
+inline size_t lu(const float* a, const float* b, float* x, size_t n)
+{
+	size_t failed = 0;
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V m[N * N], y[N];
+		gather<N>(a + N * N * i, b + N * i, count, m, y);
+
+		const V limit = splat(solve_tolerance<float>(N)) * largest<N>(m);
+		V singular = less(splat(0.f), splat(0.f));
+		for (unsigned int k = 0; k < N; ++k)
+		{
+			for (unsigned int r = k + 1; r < N; ++r)
+			{
+				const V swap = less(abs(m[N * k + k]), abs(m[N * r + k]));
+				for (unsigned int c = k; c < N; ++c)
+				{
+					const V top = m[N * k + c];
+					m[N * k + c] = select(swap, m[N * r + c], top);
+					m[N * r + c] = select(swap, top, m[N * r + c]);
+				}
+				const V top = y[k];
+				y[k] = select(swap, y[r], top);
+				y[r] = select(swap, top, y[r]);
+			}
+			singular = singular | less_equal(abs(m[N * k + k]), limit);
+			const V inv = splat(1.f) / m[N * k + k];
+			for (unsigned int r = k + 1; r < N; ++r)
+			{
+				const V f = m[N * r + k] * inv;
+				for (unsigned int c = k + 1; c < N; ++c)
+					m[N * r + c] = m[N * r + c] - f * m[N * k + c];
+				y[r] = y[r] - f * y[k];
+			}
+		}
+		for (unsigned int k = N; k-- > 0;)
+		{
+			V s = y[k];
+			for (unsigned int c = k + 1; c < N; ++c)
+				s = s - m[N * k + c] * y[c];
+			y[k] = s / m[N * k + k];
+		}
+		failed += scatter<N>(y, singular, x + N * i, count);
+	}
+	return failed;
+}
+
+// l d l^T without pivoting from the upper triangle
+template <unsigned int N>
+inline size_t ldlt(const float* a, const float* b, float* x, size_t n)
+{
+	size_t failed = 0;
+	for (size_t i = 0; i < n; i += V::width)
+	{
+		const size_t count = min(V::width, n - i);
+		V m[N * N], y[N];
+		gather<N>(a + N * N * i, b + N * i, count, m, y);
+
+		const V limit = splat(solve_tolerance<float>(N)) * largest<N>(m);
+		V singular = less(splat(0.f), splat(0.f));
+		// l below the diagonal, d on it
+		V l[N * N], d[N], inv[N];
+		for (unsigned int j = 0; j < N; ++j)
+		{
+			V dj = m[N * j + j];
+			for (unsigned int k = 0; k < j; ++k)
+				dj = dj - l[N * j + k] * l[N * j + k] * d[k];
+			d[j] = dj;
+			singular = singular | less_equal(abs(dj), limit);
+			inv[j] = splat(1.f) / dj;
+			for (unsigned int r = j + 1; r < N; ++r)
+			{
+				V s = m[N * j + r];
+				for (unsigned int k = 0; k < j; ++k)
+					s = s - l[N * r + k] * l[N * j + k] * d[k];
+				l[N * r + j] = s * inv[j];
+			}
+		}
+		for (unsigned int r = 1; r < N; ++r)
+		{
+			for (unsigned int k = 0; k < r; ++k)
+				y[r] = y[r] - l[N * r + k] * y[k];
+		}
+		for (unsigned int r = 0; r < N; ++r)
+			y[r] = y[r] * inv[r];
+		for (unsigned int r = N - 1; r-- > 0;)
+		{
+			for (unsigned int k = r + 1; k < N; ++k)
+				y[r] = y[r] - l[N * k + r] * y[k];
+		}
+		failed += scatter<N>(y, singular, x + N * i, count);
+	}
+	return failed;
+}
+
+inline solve_table make_table()
+{
+	return solve_table{ { &lu<2>, &lu<3>, &lu<4> }, { &ldlt<2>, &ldlt<3>, &ldlt<4> } };
+}
@@ -0,0 +1,79 @@
+#ifndef ELS_SPAN
+#define ELS_SPAN
+
+#include <cstddef>
+#include <type_traits>
+#include "elsHeader.h"
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
+namespace els
+{
+#ifdef __cpp_lib_span
+	template <typename T>
+	using span = std::span<T>;
+#else
+	// minimal stand-in for std::span on pre c++20 builds
+	template <typename T>
+	class span
+	{
+	public:
+		using element_type = T;
+		using value_type = std::remove_cv_t<T>;
+		using size_type = size_t;
+		using pointer = T*;
+		using reference = T&;
+		using iterator = T*;
+
+	private:
+		pointer ptr;
+		size_type count;
+
+	public:
+		constexpr span() : ptr{ nullptr }, count{ 0 } {}
+		constexpr span(pointer p, size_type n) : ptr{ p }, count{ n } {}
+		constexpr span(pointer first, pointer last) : ptr{ first }, count{ static_cast<size_type>(last - first) } {}
+		template <size_t N>
+		constexpr span(element_type(&arr)[N]) : ptr{ arr }, count{ N } {}
+		template <typename U, typename = std::enable_if_t<std::is_convertible<U(*)[], T(*)[]>::value>>
+		constexpr span(const span<U>& rhs) : ptr{ rhs.data() }, count{ rhs.size() } {}
+		template <typename C, typename = std::enable_if_t<
+			!std::is_array<C>::value &&
+			std::is_convertible<std::remove_pointer_t<decltype(std::declval<C&>().data())>(*)[], T(*)[]>::value>>
+		constexpr span(C& c) : ptr{ c.data() }, count{ c.size() } {}
+		template <typename C, typename = std::enable_if_t<
+			!std::is_array<C>::value &&
+			std::is_convertible<std::remove_pointer_t<decltype(std::declval<const C&>().data())>(*)[], T(*)[]>::value>>
+		constexpr span(const C& c) : ptr{ c.data() }, count{ c.size() } {}
+
+		constexpr pointer data() const { return ptr; }
+		constexpr size_type size() const { return count; }
+		constexpr size_type size_bytes() const { return count * sizeof(T); }
+		constexpr bool empty() const { return count == 0; }
+
+		constexpr reference operator[](size_type index) const { return ptr[index]; }
+		constexpr reference front() const { return ptr[0]; }
+		constexpr reference back() const { return ptr[count - 1]; }
+
+		constexpr iterator begin() const { return ptr; }
+		constexpr iterator end() const { return ptr + count; }
+
+		constexpr span first(size_type n) const { return span{ ptr, n }; }
+		constexpr span last(size_type n) const { return span{ ptr + count - n, n }; }
+		constexpr span subspan(size_type offset, size_type n = static_cast<size_type>(-1)) const
+		{
+			return span{ ptr + offset, n == static_cast<size_type>(-1) ? count - offset : n };
+		}
+	};
+#endif
+}
+
+#endif
@@ -0,0 +1,600 @@
+#ifndef ELS_SPARSE
+#define ELS_SPARSE
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsMatrix3.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+#include "elsSolve.h"
+
+namespace els
+{
+	// rows per worker chunk for the matrix vector products and the solver
+	constexpr size_t sparse_grain = 1 << 12;
+
+	// one entry for assembly, entries with the same row and column are summed
+	template <typename B>
+	struct Triplet
+	{
+		size_t row;
+		size_t col;
+		B value;
+	};
+
+	enum class Preconditioner : uint8_t
+	{
+		none,
+		jacobi,
+		incomplete_cholesky,
+	};
+
+	template <typename T>
+	struct CgResult
+	{
+		using Scalar = T;
+
+		size_t iterations;
+		T residual;		// |b - a x| / |b|
+		bool converged;
+	};
+
+	namespace detail
+	{
+		namespace sparse
+		{
+			// dot products of float vectors are carried in double
+			template <typename T>
+			using wide_t = std::conditional_t<std::is_same<T, float>::value, double, T>;
+
+			template <typename B>
+			struct block_traits
+			{
+				using scalar = B;
+				static constexpr B zero() { return static_cast<B>(0); }
+				static constexpr B one() { return static_cast<B>(1); }
+			};
+			template <typename T>
+			struct block_traits<Matrix3<T>>
+			{
+				using scalar = T;
+				static constexpr Matrix3<T> zero() { return Matrix3<T>::zero; }
+				static constexpr Matrix3<T> one() { return Matrix3<T>::I; }
+			};
+			template <typename B>
+			using scalar_t = typename block_traits<B>::scalar;
+
+			template <typename X>
+			constexpr X zero_of()
+			{
+				if constexpr (std::is_arithmetic<X>::value)
+					return static_cast<X>(0);
+				else
+					return X::zero;
+			}
+
+			// a b in the textbook sense and a^T x, operator* on Matrix3 composes the other way around
+			template <typename T>
+			constexpr T product(const T& a, const T& b) { return a * b; }
+			template <typename T>
+			constexpr Matrix3<T> product(const Matrix3<T>& a, const Matrix3<T>& b) { return b * a; }
+			template <typename T>
+			constexpr T transposed(const T& a) { return a; }
+			template <typename T>
+			constexpr Matrix3<T> transposed(const Matrix3<T>& a) { return a.transposed(); }
+			template <typename B, typename X>
+			constexpr X apply_transposed(const B& a, const X& x) { return x * a; }
+
+			template <typename T>
+			constexpr T inner(const T& a, const T& b) { return a * b; }
+			template <typename T>
+			constexpr T inner(const Vector3<T>& a, const Vector3<T>& b) { return a.dot(b); }
+
+			// inverse of a positive pivot, false when it is not positive
+			template <typename T>
+			inline bool invert_positive(const T& d, T& inv)
+			{
+				if (!(d > 0))
+					return false;
+				inv = 1 / d;
+				return true;
+			}
+			template <typename T>
+			inline bool invert_positive(const Matrix3<T>& d, Matrix3<T>& inv)
+			{
+				const LDLT<Matrix3<T>> f(d);
+				if (!f.positive())
+					return false;
+				inv = f.inverse();
+				return true;
+			}
+
+			// fn(first, last) for every chunk of sparse_grain rows on all threads, its results summed
+			// in chunk order so that the sum does not depend on the thread count
+			template <typename W, typename Fn>
+			inline W sum(size_t n, Fn&& fn)
+			{
+				std::vector<W> parts((n + sparse_grain - 1) / sparse_grain, static_cast<W>(0));
+				parallel::for_range(0, parts.size(), 1, [&](size_t first, size_t last)
+					{
+						for (size_t c = first; c < last; ++c)
+							parts[c] = fn(c * sparse_grain, min(n, (c + 1) * sparse_grain));
+					});
+				W s = 0;
+				for (const W& p : parts)
+					s += p;
+				return s;
+			}
+		}
+	}
+
+	// compressed sparse rows of scalar or Matrix3 blocks, SparseMatrix<Matrix3<T>> is the 3x3 block
+	// version whose block (i, j) couples the Vector3 unknowns i and j
+	// the pattern is fixed once assembled, values() can be rewritten in place for a new assembly
+	// with the same pattern
+	template <typename B>
+	class SparseMatrix
+	{
+	public:
+		using Block = B;
+		using Scalar = detail::sparse::scalar_t<B>;
+
+	private:
+		size_t r = 0;
+		size_t c = 0;
+		std::vector<size_t> offsets{ 0 };	// row i holds entries [offsets[i], offsets[i + 1])
+		std::vector<uint32_t> indices;		// column of every entry, increasing within a row
+		std::vector<B> entries;
+
+	public:
+		SparseMatrix() = default;
+		// duplicates are summed in the order they are given, rows and columns index blocks
+		// and cols must fit 32 bits
+		SparseMatrix(size_t rows, size_t cols, span<const Triplet<B>> triplets);
+
+		size_t rows() const { return r; }
+		size_t cols() const { return c; }
+		size_t nonzeros() const { return entries.size(); }
+
+		span<const size_t> row_offsets() const { return offsets; }
+		span<const uint32_t> columns() const { return indices; }
+		span<const B> values() const { return entries; }
+		span<B> values() { return entries; }
+
+		// stored entry or nullptr
+		B* find(size_t row, size_t col);
+		const B* find(size_t row, size_t col) const;
+		// zero when not stored
+		B operator()(size_t row, size_t col) const;
+
+		// keeps the pattern
+		SparseMatrix& set_zero();
+	};
+
+	// typedefs
+	using sparse_matf = SparseMatrix<float>;
+	using sparse_matd = SparseMatrix<double>;
+	using sparse_mat = SparseMatrix<defaultType>;
+	using block_sparse_matf = SparseMatrix<Matrix3<float>>;
+	using block_sparse_matd = SparseMatrix<Matrix3<double>>;
+	using block_sparse_mat = SparseMatrix<Matrix3<defaultType>>;
+
+	// y = a x threaded over rows, x holds a.cols() and y a.rows() elements and must not overlap
+	// scalar matrices multiply scalar or Vector3 vectors, the same matrix acting on every component,
+	// block matrices multiply Vector3 vectors
+	template <typename B, typename X>
+	void multiply(const SparseMatrix<B>& a, span<const X> x, span<X> y);
+
+	// preconditioned conjugate gradient for symmetric positive definite a
+	// jacobi scales by the inverse diagonal blocks and is threaded like the rest of the iteration,
+	// incomplete_cholesky is l d l^T on the pattern of a, a pivot that is not positive falls back to
+	// the diagonal block of a, it converges in fewer iterations but its triangular solves run on
+	// one thread
+	// the preconditioner is built once, a must outlive the solver and keep its values
+	template <typename B>
+	class ConjugateGradient
+	{
+	public:
+		using Block = B;
+		using Scalar = detail::sparse::scalar_t<B>;
+
+	private:
+		const SparseMatrix<B>* a;
+		Preconditioner kind;
+		std::vector<B> inverse_diagonal;	// of a for jacobi, of d for incomplete_cholesky
+		std::vector<size_t> lower_offsets;	// unit lower l below the diagonal, by rows
+		std::vector<uint32_t> lower_columns;
+		std::vector<B> lower;
+
+	public:
+		explicit ConjugateGradient(const SparseMatrix<B>& matrix, Preconditioner preconditioner = Preconditioner::jacobi);
+
+		Preconditioner preconditioner() const { return kind; }
+
+		// x holds the initial guess and gets the solution, stops once |b - a x| <= tolerance |b|
+		// or after max_iterations, or when a turns out not to be positive definite
+		// the residual is recomputed from x before it is reported, float systems with a condition
+		// number near 1e6 bottom out around 1e-5
+		template <typename X>
+		CgResult<Scalar> solve(span<const X> b, span<X> x, Scalar tolerance = static_cast<Scalar>(1e-6), size_t max_iterations = 1000) const;
+
+		// z = m^-1 r, z and r must not overlap
+		template <typename X>
+		void precondition(span<const X> r, span<X> z) const;
+	};
+
+	// member functions
+	template <typename B>
+	SparseMatrix<B>::SparseMatrix(size_t rows, size_t cols, span<const Triplet<B>> triplets)
+		: r{ rows }, c{ cols }, offsets(rows + 1, 0)
+	{
+		// counting sort by row, then each row sorted by column and its duplicates summed
+		for (const Triplet<B>& t : triplets)
+			++offsets[t.row + 1];
+		for (size_t i = 0; i < rows; ++i)
+			offsets[i + 1] += offsets[i];
+		std::vector<size_t> order(triplets.size());
+		{
+			std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t t = 0; t < triplets.size(); ++t)
+				order[cursor[triplets[t].row]++] = t;
+		}
+
+		std::vector<size_t> kept(rows + 1, 0);
+		parallel::for_range(0, rows, sparse_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					const auto begin = order.begin() + offsets[i], end = order.begin() + offsets[i + 1];
+					std::sort(begin, end, [&](size_t lhs, size_t rhs)
+						{
+							return triplets[lhs].col < triplets[rhs].col || (triplets[lhs].col == triplets[rhs].col && lhs < rhs);
+						});
+					for (auto e = begin; e != end; ++e)
+						kept[i + 1] += e == begin || triplets[*e].col != triplets[*(e - 1)].col;
+				}
+			});
+		for (size_t i = 0; i < rows; ++i)
+			kept[i + 1] += kept[i];
+
+		indices.resize(kept[rows]);
+		entries.assign(kept[rows], detail::sparse::block_traits<B>::zero());
+		parallel::for_range(0, rows, sparse_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					size_t out = kept[i];
+					for (size_t e = offsets[i]; e < offsets[i + 1]; ++e)
+					{
+						const Triplet<B>& t = triplets[order[e]];
+						if (e > offsets[i] && t.col == indices[out - 1])
+						{
+							entries[out - 1] += t.value;
+							continue;
+						}
+						indices[out] = static_cast<uint32_t>(t.col);
+						entries[out++] = t.value;
+					}
+				}
+			});
+		offsets.swap(kept);
+	}
+	template <typename B>
+	B* SparseMatrix<B>::find(size_t row, size_t col)
+	{
+		return const_cast<B*>(static_cast<const SparseMatrix&>(*this).find(row, col));
+	}
+	template <typename B>
+	const B* SparseMatrix<B>::find(size_t row, size_t col) const
+	{
+		const auto begin = indices.begin() + offsets[row], end = indices.begin() + offsets[row + 1];
+		const auto it = std::lower_bound(begin, end, static_cast<uint32_t>(col));
+		return it != end && *it == col ? &entries[it - indices.begin()] : nullptr;
+	}
+	template <typename B>
+	B SparseMatrix<B>::operator()(size_t row, size_t col) const
+	{
+		const B* e = find(row, col);
+		return e ? *e : detail::sparse::block_traits<B>::zero();
+	}
+	template <typename B>
+	SparseMatrix<B>& SparseMatrix<B>::set_zero()
+	{
+		std::fill(entries.begin(), entries.end(), detail::sparse::block_traits<B>::zero());
+		return *this;
+	}
+
+	template <typename B>
+	ConjugateGradient<B>::ConjugateGradient(const SparseMatrix<B>& matrix, Preconditioner preconditioner)
+		: a{ &matrix }, kind{ preconditioner }
+	{
+		using traits = detail::sparse::block_traits<B>;
+		using detail::sparse::invert_positive;
+		using detail::sparse::product;
+		using detail::sparse::transposed;
+
+		const size_t n = a->rows();
+		if (kind == Preconditioner::none)
+			return;
+
+		inverse_diagonal.resize(n);
+		if (kind == Preconditioner::jacobi)
+		{
+			parallel::for_range(0, n, sparse_grain, [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+					{
+						if (!invert_positive((*a)(i, i), inverse_diagonal[i]))
+							inverse_diagonal[i] = traits::one();
+					}
+				});
+			return;
+		}
+
+		// l takes the strictly lower pattern of a, row i of l d l^T matches a on it
+		const span<const size_t> offsets = a->row_offsets();
+		const span<const uint32_t> columns = a->columns();
+		const span<const B> values = a->values();
+		lower_offsets.assign(n + 1, 0);
+		for (size_t i = 0; i < n; ++i)
+		{
+			size_t e = offsets[i];
+			while (e < offsets[i + 1] && columns[e] < i)
+				++e;
+			lower_offsets[i + 1] = lower_offsets[i] + e - offsets[i];
+		}
+		lower_columns.resize(lower_offsets[n]);
+		lower.resize(lower_offsets[n]);
+
+		// slot of every column of the current row in lower, or none
+		constexpr size_t none = std::numeric_limits<size_t>::max();
+		std::vector<size_t> slot(n, none);
+		std::vector<B> d(n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const size_t first = lower_offsets[i], last = lower_offsets[i + 1];
+			for (size_t e = first; e < last; ++e)
+			{
+				lower_columns[e] = columns[offsets[i] + e - first];
+				slot[lower_columns[e]] = e;
+			}
+
+			B diagonal = (*a)(i, i);
+			for (size_t e = first; e < last; ++e)
+			{
+				const size_t k = lower_columns[e];
+				B s = values[offsets[i] + e - first];
+				for (size_t f = lower_offsets[k]; f < lower_offsets[k + 1]; ++f)
+				{
+					const size_t at = slot[lower_columns[f]];
+					if (at != none)
+						s -= product(product(lower[at], d[lower_columns[f]]), transposed(lower[f]));
+				}
+				lower[e] = product(s, inverse_diagonal[k]);
+				diagonal -= product(s, transposed(lower[e]));
+			}
+
+			d[i] = diagonal;
+			if (!invert_positive(d[i], inverse_diagonal[i]))
+			{
+				d[i] = (*a)(i, i);
+				if (!invert_positive(d[i], inverse_diagonal[i]))
+				{
+					d[i] = traits::one();
+					inverse_diagonal[i] = traits::one();
+				}
+			}
+			for (size_t e = first; e < last; ++e)
+				slot[lower_columns[e]] = none;
+		}
+	}
+
+	template <typename B>
+	template <typename X>
+	void ConjugateGradient<B>::precondition(span<const X> r, span<X> z) const
+	{
+		const size_t n = a->rows();
+		if (kind == Preconditioner::none)
+		{
+			std::copy(r.begin(), r.end(), z.begin());
+			return;
+		}
+		if (kind == Preconditioner::jacobi)
+		{
+			parallel::for_range(0, n, sparse_grain, [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+						z[i] = inverse_diagonal[i] * r[i];
+				});
+			return;
+		}
+
+		// l w = r, then w = d^-1 w, then l^T z = w by columns of l^T, which are the rows of l
+		for (size_t i = 0; i < n; ++i)
+		{
+			X s = r[i];
+			for (size_t e = lower_offsets[i]; e < lower_offsets[i + 1]; ++e)
+				s -= lower[e] * z[lower_columns[e]];
+			z[i] = s;
+		}
+		for (size_t i = 0; i < n; ++i)
+			z[i] = inverse_diagonal[i] * z[i];
+		for (size_t i = n; i-- > 0;)
+		{
+			for (size_t e = lower_offsets[i]; e < lower_offsets[i + 1]; ++e)
+				z[lower_columns[e]] -= detail::sparse::apply_transposed(lower[e], z[i]);
+		}
+	}
+
+	template <typename B>
+	template <typename X>
+	CgResult<typename ConjugateGradient<B>::Scalar> ConjugateGradient<B>::solve(span<const X> b, span<X> x, Scalar tolerance, size_t max_iterations) const
+	{
+		using W = detail::sparse::wide_t<Scalar>;
+		using detail::sparse::inner;
+
+		const size_t n = a->rows();
+		const span<const size_t> offsets = a->row_offsets();
+		const span<const uint32_t> columns = a->columns();
+		const span<const B> values = a->values();
+
+		const W bb = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+			{
+				W s = 0;
+				for (size_t i = first; i < last; ++i)
+					s += inner(b[i], b[i]);
+				return s;
+			});
+		if (bb == 0)
+		{
+			std::fill(x.begin(), x.end(), detail::sparse::zero_of<X>());
+			return CgResult<Scalar>{ 0, static_cast<Scalar>(0), true };
+		}
+
+		std::vector<X> r(n), z(kind == Preconditioner::none ? 0 : n), p(n), q(n);
+		// without a preconditioner z is r
+		const std::vector<X>& zr = kind == Preconditioner::none ? r : z;
+		W rr = 0, rz = 0;
+		// r = b - a x and p = z, at the start and again when the updated r has drifted from the true
+		// residual, which float vectors do on stiff systems
+		const auto restart = [&]()
+			{
+				multiply(*a, span<const X>(x), span<X>(q));
+				rr = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+					{
+						W s = 0;
+						for (size_t i = first; i < last; ++i)
+						{
+							r[i] = b[i] - q[i];
+							s += inner(r[i], r[i]);
+						}
+						return s;
+					});
+				if (kind != Preconditioner::none)
+					precondition(span<const X>(r), span<X>(z));
+				rz = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+					{
+						W s = 0;
+						for (size_t i = first; i < last; ++i)
+						{
+							p[i] = zr[i];
+							s += inner(r[i], zr[i]);
+						}
+						return s;
+					});
+			};
+		restart();
+
+		size_t iteration = 0;
+		bool converged = false;
+		for (; iteration < max_iterations; ++iteration)
+		{
+			if (std::sqrt(rr / bb) <= tolerance)
+			{
+				restart();
+				converged = std::sqrt(rr / bb) <= tolerance;
+				if (converged)
+					break;
+			}
+
+			// q = a p with p q in the same pass
+			const W pq = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+				{
+					W s = 0;
+					for (size_t i = first; i < last; ++i)
+					{
+						X t = detail::sparse::zero_of<X>();
+						for (size_t e = offsets[i]; e < offsets[i + 1]; ++e)
+							t += values[e] * p[columns[e]];
+						q[i] = t;
+						s += inner(p[i], t);
+					}
+					return s;
+				});
+			if (!(pq > 0))
+				break;
+
+			// jacobi scales r in the same pass as its update
+			const Scalar alpha = static_cast<Scalar>(rz / pq);
+			W rz_next = 0;
+			rr = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+				{
+					W s = 0;
+					for (size_t i = first; i < last; ++i)
+					{
+						x[i] += alpha * p[i];
+						r[i] -= alpha * q[i];
+						s += inner(r[i], r[i]);
+						if (kind == Preconditioner::jacobi)
+							z[i] = inverse_diagonal[i] * r[i];
+					}
+					return s;
+				});
+			if (kind == Preconditioner::incomplete_cholesky)
+				precondition(span<const X>(r), span<X>(z));
+			if (kind == Preconditioner::none)
+				rz_next = rr;
+			else
+			{
+				rz_next = detail::sparse::sum<W>(n, [&](size_t first, size_t last)
+					{
+						W s = 0;
+						for (size_t i = first; i < last; ++i)
+							s += inner(r[i], z[i]);
+						return s;
+					});
+			}
+
+			const Scalar beta = static_cast<Scalar>(rz_next / rz);
+			rz = rz_next;
+			parallel::for_range(0, n, sparse_grain, [&](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+						p[i] = zr[i] + beta * p[i];
+				});
+		}
+
+		if (!converged)
+			restart();
+		return CgResult<Scalar>{ iteration, static_cast<Scalar>(std::sqrt(rr / bb)), converged };
+	}
+
+	// static functions
+	template <typename B, typename X>
+	void multiply(const SparseMatrix<B>& a, span<const X> x, span<X> y)
+	{
+		const span<const size_t> offsets = a.row_offsets();
+		const span<const uint32_t> columns = a.columns();
+		const span<const B> values = a.values();
+		parallel::for_range(0, a.rows(), sparse_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					X s = detail::sparse::zero_of<X>();
+					for (size_t e = offsets[i]; e < offsets[i + 1]; ++e)
+						s += values[e] * x[columns[e]];
+					y[i] = s;
+				}
+			});
+	}
+
+	// one solve with a fresh preconditioner, see ConjugateGradient
+	template <typename B, typename X>
+	inline CgResult<detail::sparse::scalar_t<B>> conjugate_gradient(const SparseMatrix<B>& a, span<const X> b, span<X> x,
+		Preconditioner preconditioner = Preconditioner::jacobi,
+		detail::sparse::scalar_t<B> tolerance = static_cast<detail::sparse::scalar_t<B>>(1e-6), size_t max_iterations = 1000)
+	{
+		return ConjugateGradient<B>(a, preconditioner).solve(b, x, tolerance, max_iterations);
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,543 @@
+#ifndef ELS_SPATIAL_HASH
+#define ELS_SPATIAL_HASH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsHash.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// points per worker chunk in the build and the batched neighbour loop
+	constexpr size_t spatial_hash_grain = 1 << 14;
+	// most bucket blocks of the build sort, its per thread counts are threads * blocks
+	constexpr size_t spatial_hash_blocks = 1 << 12;
+
+	namespace detail
+	{
+		namespace grid
+		{
+			// integer cell coordinates, the third one stays 0 in 2d
+			using Cell = std::array<int32_t, 3>;
+
+			template <typename Point>
+			struct dims;
+			template <typename T>
+			struct dims<Vector2<T>> { static constexpr int value = 2; };
+			template <typename T>
+			struct dims<Vector3<T>> { static constexpr int value = 3; };
+
+			// one 64 bit key per cell with x in the low bits, so the cells of a row have consecutive keys
+			// coordinates past the limit are clamped onto the border cells
+			template <int Dims>
+			struct Keys;
+			template <>
+			struct Keys<2>
+			{
+				static constexpr int32_t limit = 1 << 30;
+				static constexpr int x_bits = 32;
+				static uint64_t pack(const Cell& c)
+				{
+					const int64_t bias = int64_t(1) << 30;
+					return (static_cast<uint64_t>(c[1] + bias) << 32) | static_cast<uint64_t>(c[0] + bias);
+				}
+			};
+			template <>
+			struct Keys<3>
+			{
+				static constexpr int32_t limit = (1 << 20) - 1;
+				static constexpr int x_bits = 21;
+				static uint64_t pack(const Cell& c)
+				{
+					const int64_t bias = int64_t(1) << 20;
+					return (static_cast<uint64_t>(c[2] + bias) << 42) | (static_cast<uint64_t>(c[1] + bias) << 21) | static_cast<uint64_t>(c[0] + bias);
+				}
+			};
+
+			template <typename T>
+			inline int32_t coordinate(T x, T inv_cell, int32_t limit)
+			{
+				const T c = std::floor(x * inv_cell);
+				if (!(c >= static_cast<T>(-limit)))
+					return -limit;
+				return c > static_cast<T>(limit) ? limit : static_cast<int32_t>(c);
+			}
+		}
+	}
+
+	// uniform grid over a point set, cells are hashed into a table so the domain is unbounded
+	// the build counting sorts the points by bucket, each cell is one contiguous run of slots
+	// rows are hashed and x is added on top, so cells next to each other along x sit in neighbouring
+	// buckets and a query reads one stretch of slots per row
+	template <typename Point>
+	class SpatialHash
+	{
+	public:
+		using Scalar = typename Point::Scalar;
+		static constexpr int dimensions = detail::grid::dims<Point>::value;
+
+		struct Neighbor
+		{
+			uint32_t index = 0;
+			Scalar distance2 = std::numeric_limits<Scalar>::max();
+		};
+
+	private:
+		using Cell = detail::grid::Cell;
+		using Keys = detail::grid::Keys<dimensions>;
+
+		Scalar cell = static_cast<Scalar>(1);
+		Scalar inv_cell = static_cast<Scalar>(1);
+		uint64_t mask = 0;
+		// occupied cell range, queries never look outside it
+		Cell lo{ { 0, 0, 0 } };
+		Cell hi{ { -1, -1, -1 } };
+
+		std::vector<uint32_t> starts;
+		std::vector<uint32_t> order;
+		std::vector<Point> points;
+		std::vector<uint64_t> keys;
+		// per input point, kept between builds to avoid reallocating every frame
+		std::vector<uint64_t> point_keys;
+		std::vector<uint32_t> point_buckets;
+
+		Cell cell_of(const Point& p) const;
+		size_t bucket_of(uint64_t key) const
+		{
+			const uint64_t x = key & ((uint64_t(1) << Keys::x_bits) - 1);
+			return static_cast<size_t>((hash_mix(key >> Keys::x_bits) + x) & mask);
+		}
+		// fn(slot) for every point in cells x0 to x1 of the row through c
+		template <typename Fn>
+		void for_row(Cell c, int32_t x0, int32_t x1, Fn&& fn) const;
+		int32_t reach(Scalar radius) const { return static_cast<int32_t>(std::ceil(radius * inv_cell)); }
+
+	public:
+		size_t size() const { return order.size(); }
+		bool empty() const { return order.empty(); }
+		Scalar cell_size() const { return cell; }
+		// original point index of every slot, points of one cell are adjacent
+		span<const uint32_t> sorted_indices() const { return span<const uint32_t>(order.data(), order.size()); }
+		span<const Point> sorted_points() const { return span<const Point>(points.data(), points.size()); }
+
+		// cell_size near the usual query radius works best, the point indices are uint32_t
+		void build(span<const Point> input, Scalar cell_size);
+
+		// fn(index, distance2) for every point within radius of p
+		template <typename Fn>
+		void query(const Point& p, Scalar radius, Fn&& fn) const;
+		// fills out with up to out.size() nearest points within max_distance, closest first, returns the count
+		size_t nearest(const Point& p, span<Neighbor> out, Scalar max_distance = std::numeric_limits<Scalar>::max()) const;
+
+		// fn(i, j, distance2) once for every unordered pair closer than radius, cell by cell on the calling thread
+		template <typename Fn>
+		void for_each_pair(Scalar radius, Fn&& fn) const;
+		// fn(i, j, distance2) for every point i and each neighbour j != i within radius
+		// spread across threads, all calls for one i come from the same thread
+		template <typename Fn>
+		void for_each_neighbor(Scalar radius, Fn&& fn) const;
+	};
+
+	// typedefs
+	using spatial_hash2f = SpatialHash<Vector2<float>>;
+	using spatial_hash3f = SpatialHash<Vector3<float>>;
+	using spatial_hash2 = SpatialHash<Vector2<defaultType>>;
+	using spatial_hash3 = SpatialHash<Vector3<defaultType>>;
+
+	// member functions
+	template <typename Point>
+	typename SpatialHash<Point>::Cell SpatialHash<Point>::cell_of(const Point& p) const
+	{
+		Cell c{ { 0, 0, 0 } };
+		for (unsigned int d = 0; d < dimensions; ++d)
+			c[d] = detail::grid::coordinate(p[d], inv_cell, Keys::limit);
+		return c;
+	}
+	template <typename Point>
+	template <typename Fn>
+	void SpatialHash<Point>::for_row(Cell c, int32_t x0, int32_t x1, Fn&& fn) const
+	{
+		if (c[1] < lo[1] || c[1] > hi[1] || c[2] < lo[2] || c[2] > hi[2])
+			return;
+		x0 = max(x0, lo[0]);
+		x1 = min(x1, hi[0]);
+		if (x0 > x1)
+			return;
+
+		c[0] = x0;
+		const uint64_t first = Keys::pack(c);
+		const uint64_t width = static_cast<uint64_t>(x1 - x0);
+		const auto scan = [&](size_t b0, size_t b1)
+		{
+			for (uint32_t s = starts[b0]; s < starts[b1]; ++s)
+			{
+				if (keys[s] - first <= width)
+					fn(s);
+			}
+		};
+
+		// the buckets of the row are consecutive unless they wrap around the end of the table
+		const size_t buckets = static_cast<size_t>(mask) + 1;
+		const size_t b0 = bucket_of(first);
+		const size_t count = width < buckets ? static_cast<size_t>(width) + 1 : buckets;
+		if (b0 + count <= buckets)
+			scan(b0, b0 + count);
+		else
+		{
+			scan(b0, buckets);
+			scan(0, b0 + count - buckets);
+		}
+	}
+
+	template <typename Point>
+	void SpatialHash<Point>::build(span<const Point> input, Scalar cell_size)
+	{
+		const size_t n = input.size();
+		cell = cell_size;
+		inv_cell = static_cast<Scalar>(1) / cell_size;
+		size_t buckets = 1;
+		while (buckets < n)
+			buckets <<= 1;
+		mask = buckets - 1;
+
+		starts.assign(buckets + 1, 0);
+		order.resize(n);
+		points.resize(n);
+		keys.resize(n);
+		point_keys.resize(n);
+		point_buckets.resize(n);
+
+		const Cell none_lo{ { Keys::limit, Keys::limit, dimensions == 3 ? Keys::limit : 0 } };
+		const Cell none_hi{ { -Keys::limit, -Keys::limit, dimensions == 3 ? -Keys::limit : 0 } };
+		lo = none_lo;
+		hi = none_hi;
+		std::mutex lock;
+		parallel::for_range(0, n, spatial_hash_grain, [&](size_t first, size_t last)
+			{
+				Cell l = none_lo;
+				Cell h = none_hi;
+				for (size_t i = first; i < last; ++i)
+				{
+					const Cell c = cell_of(input[i]);
+					for (int d = 0; d < 3; ++d)
+					{
+						l[d] = c[d] < l[d] ? c[d] : l[d];
+						h[d] = c[d] > h[d] ? c[d] : h[d];
+					}
+					point_keys[i] = Keys::pack(c);
+					point_buckets[i] = static_cast<uint32_t>(bucket_of(point_keys[i]));
+				}
+				std::lock_guard<std::mutex> guard(lock);
+				for (int d = 0; d < 3; ++d)
+				{
+					lo[d] = l[d] < lo[d] ? l[d] : lo[d];
+					hi[d] = h[d] > hi[d] ? h[d] : hi[d];
+				}
+			});
+
+		// stable counting sort by bucket in two steps so the work stays O(n) for any thread count
+		// first the points go to blocks of consecutive buckets, every part counts and scatters its own
+		// slice of the points and block major offsets keep a block in part order, then every part sorts
+		// a range of blocks by bucket on its own
+		const size_t parts = min(parallel::thread_count(), max<size_t>(n / spatial_hash_grain, 1));
+		const auto slice = [n, parts](size_t part) { return n * part / parts; };
+		unsigned int shift = 0;
+		while ((buckets >> shift) > spatial_hash_blocks)
+			++shift;
+		const size_t blocks = buckets >> shift;
+
+		std::vector<uint32_t> offsets(parts * blocks, 0);
+		parallel::for_range(0, parts, 1, [&](size_t first, size_t last)
+			{
+				for (size_t part = first; part < last; ++part)
+				{
+					uint32_t* count = offsets.data() + part * blocks;
+					for (size_t i = slice(part), end = slice(part + 1); i < end; ++i)
+						++count[point_buckets[i] >> shift];
+				}
+			});
+		std::vector<uint32_t> block_starts(blocks + 1);
+		uint32_t sum = 0;
+		for (size_t block = 0; block < blocks; ++block)
+		{
+			block_starts[block] = sum;
+			for (size_t part = 0; part < parts; ++part)
+			{
+				const uint32_t count = offsets[part * blocks + block];
+				offsets[part * blocks + block] = sum;
+				sum += count;
+			}
+		}
+		block_starts[blocks] = sum;
+
+		std::vector<uint32_t> grouped(n);
+		parallel::for_range(0, parts, 1, [&](size_t first, size_t last)
+			{
+				for (size_t part = first; part < last; ++part)
+				{
+					uint32_t* next = offsets.data() + part * blocks;
+					for (size_t i = slice(part), end = slice(part + 1); i < end; ++i)
+						grouped[next[point_buckets[i] >> shift]++] = static_cast<uint32_t>(i);
+				}
+			});
+
+		parallel::for_range(0, blocks, max<size_t>(blocks / parts, 1), [&](size_t first, size_t last)
+			{
+				std::vector<std::pair<uint64_t, uint32_t>> scratch;
+				for (size_t block = first; block < last; ++block)
+				{
+					const size_t b0 = block << shift;
+					const size_t b1 = (block + 1) << shift;
+					const uint32_t s0 = block_starts[block];
+					const uint32_t s1 = block_starts[block + 1];
+					for (uint32_t s = s0; s < s1; ++s)
+						++starts[point_buckets[grouped[s]]];
+					uint32_t start = s0;
+					for (size_t b = b0; b < b1; ++b)
+					{
+						const uint32_t count = starts[b];
+						starts[b] = start;
+						start += count;
+					}
+					// grouped is in index order within the block, so filling forwards keeps the sort stable
+					for (uint32_t s = s0; s < s1; ++s)
+					{
+						const uint32_t i = grouped[s];
+						const uint32_t t = starts[point_buckets[i]]++;
+						order[t] = i;
+						keys[t] = point_keys[i];
+					}
+					for (size_t b = b1; b-- > b0 + 1;)
+						starts[b] = starts[b - 1];
+					starts[b0] = s0;
+
+					// cells sharing a bucket are grouped so every cell is one run
+					for (size_t b = b0; b < b1; ++b)
+					{
+						const uint32_t t0 = starts[b];
+						const uint32_t t1 = b + 1 < b1 ? starts[b + 1] : s1;
+						bool mixed = false;
+						for (uint32_t t = t0 + 1; t < t1 && !mixed; ++t)
+							mixed = keys[t] != keys[t0];
+						if (!mixed)
+							continue;
+
+						scratch.clear();
+						for (uint32_t t = t0; t < t1; ++t)
+							scratch.emplace_back(keys[t], order[t]);
+						std::sort(scratch.begin(), scratch.end());
+						for (uint32_t t = t0; t < t1; ++t)
+						{
+							keys[t] = scratch[t - t0].first;
+							order[t] = scratch[t - t0].second;
+						}
+					}
+				}
+			});
+		starts[buckets] = static_cast<uint32_t>(n);
+
+		parallel::for_range(0, n, spatial_hash_grain, [&](size_t first, size_t last)
+			{
+				for (size_t s = first; s < last; ++s)
+					points[s] = input[order[s]];
+			});
+	}
+
+	template <typename Point>
+	template <typename Fn>
+	void SpatialHash<Point>::query(const Point& p, Scalar radius, Fn&& fn) const
+	{
+		Cell from{ { 0, 0, 0 } };
+		Cell to{ { 0, 0, 0 } };
+		for (unsigned int d = 0; d < dimensions; ++d)
+		{
+			from[d] = detail::grid::coordinate(p[d] - radius, inv_cell, Keys::limit);
+			to[d] = detail::grid::coordinate(p[d] + radius, inv_cell, Keys::limit);
+		}
+		if (empty())
+			return;
+
+		const Scalar r2 = radius * radius;
+		Cell row = from;
+		for (row[2] = from[2]; row[2] <= to[2]; ++row[2])
+		{
+			for (row[1] = from[1]; row[1] <= to[1]; ++row[1])
+			{
+				for_row(row, from[0], to[0], [&](uint32_t s)
+					{
+						const Scalar d2 = points[s].distance2(p);
+						if (d2 <= r2)
+							fn(order[s], d2);
+					});
+			}
+		}
+	}
+
+	template <typename Point>
+	size_t SpatialHash<Point>::nearest(const Point& p, span<Neighbor> out, Scalar max_distance) const
+	{
+		const size_t k = out.size();
+		if (k == 0 || empty())
+			return 0;
+
+		const Scalar limit2 = max_distance < std::sqrt(std::numeric_limits<Scalar>::max()) ? max_distance * max_distance : std::numeric_limits<Scalar>::max();
+		size_t count = 0;
+		const auto insert = [&](uint32_t s)
+		{
+			const Scalar d2 = points[s].distance2(p);
+			if (count == k ? d2 >= out[k - 1].distance2 : d2 > limit2)
+				return;
+			size_t i = count < k ? count++ : k - 1;
+			for (; i > 0 && out[i - 1].distance2 > d2; --i)
+				out[i] = out[i - 1];
+			out[i] = Neighbor{ order[s], d2 };
+		};
+
+		// rings of cells around the cell of p until the k found are closer than anything outside them
+		const Cell c = cell_of(p);
+		int32_t rings = 0;
+		for (int d = 0; d < dimensions; ++d)
+			rings = max(rings, max(c[d] - lo[d], hi[d] - c[d]));
+		size_t visited = 0;
+		for (int32_t ring = 0; ring <= rings; ++ring)
+		{
+			if (ring > 0)
+			{
+				// distance from p to the outside of the rings visited so far
+				Scalar gap = std::numeric_limits<Scalar>::max();
+				for (unsigned int d = 0; d < dimensions; ++d)
+				{
+					gap = min(gap, p[d] - static_cast<Scalar>(c[d] - ring + 1) * cell);
+					gap = min(gap, static_cast<Scalar>(c[d] + ring) * cell - p[d]);
+				}
+				const Scalar bound2 = gap > 0 ? gap * gap : static_cast<Scalar>(0);
+				if (bound2 > limit2 || (count == k && out[k - 1].distance2 <= bound2))
+					break;
+			}
+
+			// sparse points far apart would take more ring cells than there are points, scan them all instead
+			const size_t side = static_cast<size_t>(2 * ring + 1);
+			const size_t cells = dimensions == 3 ? side * side * side : side * side;
+			if (cells - visited > size())
+			{
+				count = 0;
+				for (uint32_t s = 0; s < size(); ++s)
+					insert(s);
+				break;
+			}
+			visited = cells;
+
+			const int32_t rz = dimensions == 3 ? ring : 0;
+			for (int32_t dz = -rz; dz <= rz; ++dz)
+			{
+				for (int32_t dy = -ring; dy <= ring; ++dy)
+				{
+					// shell rows are visited whole, inner rows only at their two ends
+					const Cell row{ { c[0], c[1] + dy, c[2] + dz } };
+					const bool shell = dy == -ring || dy == ring || (dimensions == 3 && (dz == -ring || dz == ring));
+					if (shell)
+						for_row(row, c[0] - ring, c[0] + ring, insert);
+					else
+					{
+						for_row(row, c[0] - ring, c[0] - ring, insert);
+						for_row(row, c[0] + ring, c[0] + ring, insert);
+					}
+				}
+			}
+		}
+		return count;
+	}
+
+	template <typename Point>
+	template <typename Fn>
+	void SpatialHash<Point>::for_each_pair(Scalar radius, Fn&& fn) const
+	{
+		const Scalar r2 = radius * radius;
+		const int32_t r = reach(radius);
+		const int32_t rz = dimensions == 3 ? r : 0;
+		const size_t n = size();
+		for (size_t s0 = 0; s0 < n;)
+		{
+			size_t s1 = s0 + 1;
+			while (s1 < n && keys[s1] == keys[s0])
+				++s1;
+
+			const auto test = [&](size_t a, uint32_t t)
+			{
+				const Scalar d2 = points[a].distance2(points[t]);
+				if (d2 <= r2)
+					fn(order[a], order[t], d2);
+			};
+			for (size_t a = s0; a < s1; ++a)
+			{
+				for (size_t b = a + 1; b < s1; ++b)
+					test(a, static_cast<uint32_t>(b));
+			}
+
+			// cells after this one in z, y, x order, so each pair of cells comes up once
+			const Cell c = cell_of(points[s0]);
+			const auto visit = [&](uint32_t t)
+			{
+				for (size_t a = s0; a < s1; ++a)
+					test(a, t);
+			};
+			for_row(c, c[0] + 1, c[0] + r, visit);
+			for (int32_t dz = 0; dz <= rz; ++dz)
+			{
+				for (int32_t dy = dz == 0 ? 1 : -r; dy <= r; ++dy)
+					for_row(Cell{ { c[0], c[1] + dy, c[2] + dz } }, c[0] - r, c[0] + r, visit);
+			}
+			s0 = s1;
+		}
+	}
+
+	template <typename Point>
+	template <typename Fn>
+	void SpatialHash<Point>::for_each_neighbor(Scalar radius, Fn&& fn) const
+	{
+		const Scalar r2 = radius * radius;
+		const int32_t r = reach(radius);
+		const int32_t rz = dimensions == 3 ? r : 0;
+		parallel::for_range(0, size(), spatial_hash_grain, [&](size_t first, size_t last)
+			{
+				// a run of one cell shares its row scans, a chunk may start or end inside a run
+				for (size_t s0 = first; s0 < last;)
+				{
+					size_t s1 = s0 + 1;
+					while (s1 < last && keys[s1] == keys[s0])
+						++s1;
+
+					const Cell c = cell_of(points[s0]);
+					for (int32_t dz = -rz; dz <= rz; ++dz)
+					{
+						for (int32_t dy = -r; dy <= r; ++dy)
+						{
+							for_row(Cell{ { c[0], c[1] + dy, c[2] + dz } }, c[0] - r, c[0] + r, [&](uint32_t t)
+								{
+									for (size_t a = s0; a < s1; ++a)
+									{
+										const Scalar d2 = points[a].distance2(points[t]);
+										if (t != a && d2 <= r2)
+											fn(order[a], order[t], d2);
+									}
+								});
+						}
+					}
+					s0 = s1;
+				}
+			});
+	}
+
+} // namespace els
+
+#endif
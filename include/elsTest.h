@@ -1,19 +1,48 @@
 
 #pragma once
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
 
 #include "elsHeader.h"
 #include "elsValue.h"
+#include "elsFastMath.h"
+#include "elsMathBatch.h"
+#include "elsPacked.h"
+#include "elsFixed.h"
+#include "elsGeometry.h"
+#include "elsRay.h"
+#include "elsBvh.h"
+#include "elsIntersect.h"
+#include "elsHash.h"
+#include "elsSpatialHash.h"
+#include "elsKdTree.h"
+#include "elsMorton.h"
+#include "elsReduce.h"
+#include "elsEigen.h"
+#include "elsSolve.h"
+#include "elsDynMatrix.h"
+#include "elsSparse.h"
+#include "elsMatrixBatch.h"
 
 #include "elsMatrix2.h"
 #include "elsMatrix3.h"
 #include "elsMatrix4.h"
+#include "elsMatrix3x4.h"
+#include "elsMatrixN.h"
 #include "elsVector2.h"
 #include "elsVector3.h"
 #include "elsVector4.h"
+#include "elsVectorN.h"
 #include "elsQuaternion.h"
+#include "elsVectorExpr.h"
 #include "elsTransform2.h"
 #include "elsTransform3.h"
+#include "elsTransform.h"
+#include "elsHierarchy.h"
+#include "elsSkinning.h"
 
 #include "elsCompare.h"
 #include "elsNoise.h"
@@ -93,6 +122,30 @@ namespace els
 			return true;
 		}
 
+		static bool test_mat2_inverse()
+		{
+			const mat2f a{ 1.f, 2.f, 3.f, 4.f };
+			const mat2f b{ 0.5f, -3.f, 2.f, 7.f };
+			for (const mat2f& m : { a, b })
+			{
+				const mat2f product = m * m.inverse();
+				for (unsigned int i = 0; i < 4; ++i)
+					if (abs(product.data()[i] - mat2f::I.data()[i]) > 1e-6f)
+						return false;
+			}
+			return mat2f{ 1.f, 2.f, 2.f, 4.f }.inverse() == mat2f::zero;
+		}
+
+		static bool test_mat4_inverse()
+		{
+			const mat4f a{ 2.f, 0.f, 1.f, 3.f, 1.f, 4.f, 0.f, -1.f, 0.f, 2.f, 5.f, 1.f, 1.f, -2.f, 0.f, 3.f };
+			const mat4f product = a * a.inverse();
+			for (unsigned int i = 0; i < 16; ++i)
+				if (abs(product.data()[i] - mat4f::I.data()[i]) > 1e-5f)
+					return false;
+			return mat4f{ 1.f, 2.f, 3.f, 4.f, 2.f, 4.f, 6.f, 8.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f, 0.f }.inverse() == mat4f::zero;
+		}
+
 		static bool test_vec2_functions()
 		{
 			vec2f tester = vec2f::i;
@@ -185,6 +238,1138 @@ namespace els
 
 			return true;
 		}
+
+		// largest absolute difference over all elements of two matrices or vectors
+		template <typename M>
+		static typename M::Scalar max_difference(const M& lhs, const M& rhs)
+		{
+			constexpr size_t count = sizeof(M) / sizeof(typename M::Scalar);
+			typename M::Scalar largest = 0;
+			for (size_t i = 0; i < count; ++i)
+				largest = std::max(largest, abs(lhs.data()[i] - rhs.data()[i]));
+			return largest;
+		}
+
+		static bool test_decompose()
+		{
+			const quatf identity{ 0.f, 0.f, 0.f, 1.f };
+			const quatf turn{ 0.3f, -0.7f, 1.1f };
+			const vec3f scales[] = {
+				{ 1.f, 2.f, 3.f }, { -2.f, 1.f, 0.5f }, { 2.f, 0.f, 3.f }, { 0.f, 2.f, 3.f },
+				{ 2.f, 3.f, 0.f }, { 0.f, 0.f, 3.f }, { 0.f, 2.f, 0.f }, { 2.f, 0.f, 0.f }, { 0.f, 0.f, 0.f } };
+			for (const quatf& rotation : { identity, turn })
+				for (const vec3f& scale : scales)
+				{
+					const mat4f m = trsf::to_mtx4({ 1.f, 2.f, 3.f }, rotation, scale);
+					const Decomposition<float> d = decompose(m);
+					if (max_difference(compose(d), m) > 1e-5f)
+						return false;
+					// the rotation stays a rotation, the identity basis stays the identity
+					if (abs(d.rotation.length2() - 1.f) > 1e-5f)
+						return false;
+					if (abs(abs(d.rotation.dot(identity)) - 1.f) > 1e-6f && rotation.dot(identity) == 1.f)
+						return false;
+				}
+
+			// rank deficient columns: y parallel to x with two different z, then y and z both along x
+			const mat4f parallel[] = {
+				mat4f{ 1.f, 2.f, 3.f, 4.f, 2.f, 4.f, 1.f, 5.f, -1.f, -2.f, 0.5f, 6.f, 0.f, 0.f, 0.f, 1.f },
+				mat4f{ 1.f, 2.f, 0.f, 4.f, 2.f, 4.f, 1.f, 5.f, -1.f, -2.f, 1.f, 6.f, 0.f, 0.f, 0.f, 1.f },
+				mat4f{ 1.f, 2.f, -3.f, 4.f, 2.f, 4.f, -6.f, 5.f, -1.f, -2.f, 3.f, 6.f, 0.f, 0.f, 0.f, 1.f } };
+			for (const mat4f& m : parallel)
+			{
+				const Decomposition<float> d = decompose(m);
+				if (d.scale.y != 0.f || max_difference(compose(d), m) > 1e-5f)
+					return false;
+			}
+			return true;
+		}
+
+		// per element checks against brute force loops, fixed seeds so a failure reproduces
+		static bool test_skinning()
+		{
+			std::mt19937 rng{ 26 };
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			std::vector<mat4f> palette;
+			std::vector<mat3x4f> compact;
+			for (unsigned int i = 0; i < 8; ++i)
+			{
+				palette.push_back(t3f::rotateX(u(rng)) * t3f::rotateY(u(rng)) * t3f::rotateZ(u(rng)) * t3f::translate(vec3f{ u(rng), u(rng), u(rng) }));
+				compact.push_back(mat3x4f{ palette.back() });
+			}
+
+			const size_t n = 1000;
+			std::vector<Vector4<uint16_t>> bones(n);
+			std::vector<vec4f> weights(n);
+			std::vector<vec3f> positions(n), normals(n), out(n), out_normals(n), compact_out(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				bones[i] = Vector4<uint16_t>{ static_cast<uint16_t>(rng() % 8), static_cast<uint16_t>(rng() % 8), static_cast<uint16_t>(rng() % 8), static_cast<uint16_t>(rng() % 8) };
+				const vec4f w{ u(rng) + 1.f, u(rng) + 1.f, u(rng) + 1.f, i % 2 ? 0.f : u(rng) + 1.f };
+				weights[i] = w / (w.x + w.y + w.z + w.w);
+				positions[i] = vec3f{ u(rng), u(rng), u(rng) } * 5.f;
+				normals[i] = vec3f{ u(rng), u(rng), u(rng) + 2.f }.normalized();
+			}
+			if (!linear_blend_skin<float>(palette, bones, weights, positions, out, normals, out_normals) ||
+				!linear_blend_skin<float>(compact, bones, weights, positions, compact_out))
+				return false;
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				vec3f p{ 0.f }, normal{ 0.f };
+				for (unsigned int k = 0; k < 4; ++k)
+				{
+					const mat4f& m = palette[bones[i][k]];
+					p += (m * positions[i]) * weights[i][k];
+					normal += (m * normals[i] - m * vec3f{ 0.f }) * weights[i][k];
+				}
+				if (out[i].distance(p) > 1e-4f || compact_out[i].distance(p) > 1e-4f || out_normals[i].distance(normal.normalized()) > 1e-5f)
+					return false;
+			}
+
+			// short spans are refused before anything is written
+			std::vector<vec3f> untouched(n, vec3f{ 7.f });
+			const span<const vec4f> short_weights(weights.data(), n - 1);
+			if (linear_blend_skin<float>(palette, bones, short_weights, positions, untouched) ||
+				linear_blend_skin<float>(compact, bones, weights, positions, untouched, normals, {}) ||
+				linear_blend_skin<float>(span<const mat4f>{}, bones, weights, positions, untouched))
+				return false;
+			return untouched[0] == vec3f{ 7.f } && linear_blend_skin<float>(span<const mat4f>{}, bones, weights, {}, {});
+		}
+
+		static bool test_mat3x4()
+		{
+			const mat4f a = t3f::scale(2.f, 0.5f, 1.5f) * t3f::euler(0.3f, -0.7f, 1.1f) * t3f::translate(vec3f{ 1.f, 2.f, 3.f });
+			const mat4f b = t3f::euler(-1.2f, 0.4f, 0.2f) * t3f::translate(vec3f{ -3.f, 0.5f, 2.f });
+			const mat3x4f ca{ a }, cb{ b };
+
+			if (max_difference(mat3x4f{ a * b }, ca * cb) > 1e-5f)
+				return false;
+			if (max_difference(ca * ca.inverse_affine(), mat3x4f::I) > 1e-5f || max_difference(cb.inverse_rigid(), cb.inverse_affine()) > 1e-5f)
+				return false;
+			if (max_difference(ca.to_mtx4(), a) != 0.f)
+				return false;
+			const vec3f p{ 0.5f, -2.f, 4.f };
+			return ca.transform_point(p).distance(a * p) < 1e-5f && std::is_trivially_copyable<mat3x4f>::value;
+		}
+
+		static bool test_transform()
+		{
+			const vec3f translation{ 1.f, -2.f, 3.f }, scale{ 2.f, 0.5f, 1.5f };
+			const quatf rotation = quatf{ 0.3f, -0.2f, 0.9f }.normalized();
+			trsf t{ translation, rotation, scale };
+			if (max_difference(t.matrix(), trsf::to_mtx4(translation, rotation, scale)) != 0.f)
+				return false;
+			if (max_difference(t.matrix() * t.inverse_matrix(), mat4f::I) > 1e-5f)
+				return false;
+			if (max_difference(t.inverse_matrix(), trsf::to_inverse_mtx4(translation, rotation, scale)) > 1e-6f)
+				return false;
+
+			// a setter dirties the cached matrices
+			t.set_translation(vec3f{ 4.f, 5.f, 6.f });
+			const vec3f p{ 0.5f, 1.f, -1.f };
+			return t.transform_point(p).distance(t.matrix() * p) < 1e-5f && t.matrix()[0][3] == 4.f;
+		}
+
+		static bool test_hierarchy()
+		{
+			using hierarchy = TransformHierarchy<float>;
+			hierarchy h;
+			const trsf a{ vec3f{ 1.f, 2.f, 3.f }, quatf{ 0.3f, 0.1f, -0.2f }.normalized(), vec3f{ 2.f } };
+			const trsf b{ vec3f{ -1.f, 0.f, 2.f }, quatf{ -0.5f, 0.4f, 0.1f }.normalized(), vec3f{ 1.f, 0.5f, 1.f } };
+			const trsf c{ vec3f{ 0.f, 3.f, 0.f }, quatf{ 1.f, 0.f, 0.f }.normalized(), vec3f{ 1.f } };
+			const hierarchy::id_type root = h.add(hierarchy::npos, a);
+			const hierarchy::id_type child = h.add(root, b);
+			const hierarchy::id_type sibling = h.add(root, c);
+			const hierarchy::id_type grandchild = h.add(child, c);
+			h.update();
+
+			// world = parent world * local in textbook order, the other way around with operator*
+			if (max_difference(h.world(root), a.matrix()) > 1e-6f || max_difference(h.world(sibling), c.matrix() * a.matrix()) > 1e-5f)
+				return false;
+			if (max_difference(h.world(grandchild), c.matrix() * b.matrix() * a.matrix()) > 1e-5f)
+				return false;
+
+			h.set_local(child, c);
+			h.update_parallel(1);
+			return max_difference(h.world(grandchild), c.matrix() * c.matrix() * a.matrix()) < 1e-5f
+				&& max_difference(h.world(sibling), c.matrix() * a.matrix()) < 1e-5f;
+		}
+
+		static bool test_rotation_builders()
+		{
+			const float angles[][3] = { { 0.3f, -0.7f, 1.1f }, { -2.f, 0.5f, 3.f }, { 1.5f, 1.5f, -1.5f } };
+			std::vector<vec3f> translations, scales;
+			std::vector<float> yaw, pitch, roll;
+			for (const auto& e : angles)
+			{
+				const mat4f m = t3f::euler(e[0], e[1], e[2]);
+				if (max_difference(m, t3f::rotateZ(e[2]) * t3f::rotateX(e[1]) * t3f::rotateY(e[0])) > 1e-6f)
+					return false;
+				if (max_difference(m, quatf{ e[0], e[1], e[2] }.to_mtx4()) > 1e-6f)
+					return false;
+
+				float s = 0.f, c = 0.f;
+				sincos(e[0], s, c);
+				if (s != std::sin(e[0]) || c != std::cos(e[0]))
+					return false;
+
+				yaw.push_back(e[0]);
+				pitch.push_back(e[1]);
+				roll.push_back(e[2]);
+				translations.push_back(vec3f{ e[1], e[2], e[0] });
+				scales.push_back(vec3f{ 2.f, 0.5f, e[2] });
+			}
+
+			// past one block and one worker chunk, so the simd sincos and the block tails are covered
+			std::mt19937 rng{ 30 };
+			std::uniform_real_distribution<float> u(-4.f, 4.f);
+			for (size_t i = 0; i < 5000; ++i)
+			{
+				yaw.push_back(u(rng));
+				pitch.push_back(u(rng));
+				roll.push_back(u(rng));
+				translations.push_back(vec3f{ u(rng), u(rng), u(rng) });
+				scales.push_back(vec3f{ u(rng), u(rng), u(rng) });
+			}
+
+			std::vector<mat4f> out(yaw.size()), rotations(yaw.size());
+			t3f::trs(translations, yaw, pitch, roll, scales, out);
+			t3f::euler(yaw, pitch, roll, rotations);
+			for (size_t i = 0; i < out.size(); ++i)
+			{
+				if (max_difference(out[i], t3f::scale(scales[i]) * t3f::euler(yaw[i], pitch[i], roll[i]) * t3f::translate(translations[i])) > 4e-6f)
+					return false;
+				if (max_difference(rotations[i], t3f::euler(yaw[i], pitch[i], roll[i])) > 1e-6f)
+					return false;
+			}
+
+			std::vector<float> sx, sy;
+			for (const vec3f& k : scales)
+			{
+				sx.push_back(k.x);
+				sy.push_back(k.y);
+			}
+			std::vector<mat3f> planar(yaw.size()), turns(yaw.size());
+			t2f::trs(pitch, roll, yaw, sx, sy, planar);
+			t2f::rotate(yaw, turns);
+			for (size_t i = 0; i < turns.size(); ++i)
+			{
+				if (max_difference(planar[i], t2f::trs(pitch[i], roll[i], yaw[i], sx[i], sy[i])) > 4e-6f || max_difference(turns[i], t2f::rotate(yaw[i])) > 1e-6f)
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_lazy()
+		{
+			const vec3f a{ 1.f, 2.f, 3.f }, b{ -4.f, 5.f, 0.5f }, c{ 0.25f, -1.f, 2.f };
+			const vec3f eager = a * 2.f + b * 3.f - c;
+			const vec3f deferred = lazy(a) * 2.f + lazy(b) * 3.f - c;
+			if (eager != deferred)
+				return false;
+			return (lazy(a) + b).dot(lazy(c)) == (a + b).dot(c) && (lazy(a) - b).length2() == (a - b).length2();
+		}
+
+		static bool test_matrix_n()
+		{
+			const mat2x3f a{ 1.f, 2.f, 3.f, 4.f, 5.f, 6.f };
+			const mat3x2f b{ 0.5f, -1.f, 2.f, 0.f, -3.f, 1.5f };
+			const Matrix<2, 2, float> ab = product(a, b);
+			for (size_t i = 0; i < 2; ++i)
+			{
+				for (size_t j = 0; j < 2; ++j)
+				{
+					float sum = 0.f;
+					for (size_t k = 0; k < 3; ++k)
+						sum += a(i, k) * b(k, j);
+					if (ab(i, j) != sum || a.transposed()(j, i) != a(i, j))
+						return false;
+				}
+			}
+
+			// textbook order, so the square product is Matrix3 operator* with its operands swapped
+			const mat3f p = t3f::euler3(0.3f, -0.7f, 1.1f), q = t3f::rotate3(vec3f{ 1.f, 2.f, 3.f }, 0.5f);
+			const mat3f textbook = product(Matrix<3, 3, float>{ p }, Matrix<3, 3, float>{ q });
+			Matrix<3, 3, float> in_place{ p };
+			in_place *= Matrix<3, 3, float>{ q };
+			return max_difference(textbook, q * p) < 1e-6f && max_difference(mat3f{ in_place }, textbook) == 0.f;
+		}
+
+		static bool test_constexpr_math()
+		{
+			constexpr float s = els::sin(0.5f);
+			constexpr mat4f r = t3f::rotateZ(0.5f);
+			if (abs(s - std::sin(0.5f)) > 1e-7f || r[1][0] != s)
+				return false;
+
+			// the constant evaluated versions against <cmath>
+			for (double x = -6.; x < 6.; x += 0.01)
+			{
+				if (abs(detail::ce::sin(x) - std::sin(x)) > 1e-14 || abs(detail::ce::cos(x) - std::cos(x)) > 1e-14)
+					return false;
+				if (abs(detail::ce::exp(x) - std::exp(x)) > 1e-14 * std::exp(x))
+					return false;
+				const double y = abs(x) + 1e-3;
+				if (abs(detail::ce::log(y) - std::log(y)) > 1e-14 || abs(detail::ce::sqrt(y) - std::sqrt(y)) > 1e-15 * std::sqrt(y))
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_fast_math()
+		{
+			// the bounds from the table in elsFastMath.h
+#if defined(ELS_SIMD_SSE) || defined(ELS_SIMD_NEON)
+			const double rsqrt_bound = 2.6e-7, sqrt_bound = 2.9e-7, asin_bound = 4.9e-7;
+#else
+			const double rsqrt_bound = 4.8e-6, sqrt_bound = 4.8e-6, asin_bound = 5.4e-6;
+#endif
+			for (int i = 0; i <= 100000; ++i)
+			{
+				const double t = i / 100000.;
+				const float x = static_cast<float>(-8192. + 16384. * t);
+				if (abs(fast::sin(x) - std::sin(static_cast<double>(x))) > 9.2e-8 || abs(fast::cos(x) - std::cos(static_cast<double>(x))) > 9.2e-8)
+					return false;
+
+				const float positive = static_cast<float>(std::ldexp(1. + t, i % 200 - 100));
+				const double root = std::sqrt(static_cast<double>(positive));
+				if (abs(fast::sqrt(positive) - root) > sqrt_bound * root || abs(fast::rsqrt(positive) - 1. / root) > rsqrt_bound / root)
+					return false;
+				const double log2 = std::log2(static_cast<double>(positive));
+				if (abs(fast::log2(positive) - log2) > 1.2e-7 + std::nextafter(static_cast<float>(abs(log2)), 1e30f) - static_cast<float>(abs(log2)))
+					return false;
+
+				const float e = static_cast<float>(-126. + 254. * t);
+				const double exact = std::exp2(static_cast<double>(e));
+				if (e < 128.f && !(abs(fast::exp2(e) - exact) <= 2.4e-7 * exact))
+					return false;
+
+				const float unit = static_cast<float>(2. * t - 1.);
+				if (abs(fast::asin(unit) - std::asin(static_cast<double>(unit))) > asin_bound || abs(fast::acos(unit) - std::acos(static_cast<double>(unit))) > asin_bound)
+					return false;
+				const float angle = static_cast<float>(tau<double> * t);
+				const float y = std::sin(angle) * (1.f + unit), z = std::cos(angle) * (1.f + unit);
+				if (abs(fast::atan2(y, z) - std::atan2(static_cast<double>(y), static_cast<double>(z))) > 3.1e-7)
+					return false;
+			}
+
+			const vec3f v{ 3.f, 4.f, 12.f };
+			if (abs(fast::length(v) - 13.) > sqrt_bound * 14. || fast::normalized(v).distance(v / 13.f) > rsqrt_bound * 2.)
+				return false;
+			if (abs(fast::angle(vec2f{ 1.f, 0.f }, vec2f{ 0.f, 2.f }) - pi<double> / 2) > asin_bound || fast::angle(vec4f{ 1.f }, vec4f::zero) != 0.f)
+				return false;
+			return true;
+		}
+
+		// error of a float result in units of the last place of the exact one
+		static double ulp_error(float result, double exact)
+		{
+			const float rounded = static_cast<float>(abs(exact));
+			const double ulp = static_cast<double>(std::nextafter(rounded, std::numeric_limits<float>::infinity())) - rounded;
+			return abs(result - exact) / ulp;
+		}
+
+		static bool test_math_batch()
+		{
+			const size_t n = 4099;
+			std::vector<float> x(n), y(n), out(n), out2(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				x[i] = static_cast<float>(-pi<double> + 2. * pi<double> * i / (n - 1));
+				y[i] = static_cast<float>(-80. + 160. * i / (n - 1));
+			}
+
+			els::sincos(span<const float>(x), span<float>(out), span<float>(out2));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (ulp_error(out[i], std::sin(static_cast<double>(x[i]))) > 1.5 || ulp_error(out2[i], std::cos(static_cast<double>(x[i]))) > 1.5)
+					return false;
+			}
+			els::exp(span<const float>(y), span<float>(out));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (ulp_error(out[i], std::exp(static_cast<double>(y[i]))) > 1.)
+					return false;
+			}
+			for (size_t i = 0; i < n; ++i)
+				out2[i] = std::exp(y[i] * 0.25f);
+			els::log(span<const float>(out2), span<float>(out));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (ulp_error(out[i], std::log(static_cast<double>(out2[i]))) > 1.)
+					return false;
+			}
+			els::atan2(span<const float>(x), span<const float>(y), span<float>(out));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (ulp_error(out[i], std::atan2(static_cast<double>(x[i]), static_cast<double>(y[i]))) > 3.)
+					return false;
+			}
+
+			// pow on normal results, then every pair of special bases and exponents against <cmath>
+			const auto same_as_cmath = [](float base, float exponent, float result)
+			{
+				const double exact = std::pow(static_cast<double>(base), static_cast<double>(exponent));
+				if (exact != exact)
+					return result != result;
+				if (exact == 0. || abs(exact) == HUGE_VAL)
+					return result == exact && std::signbit(result) == std::signbit(exact);
+				return ulp_error(result, exact) <= 1.5;
+			};
+			for (size_t i = 0; i < n; ++i)
+				out2[i] = static_cast<float>(0.05 + 19.95 * i / (n - 1));
+			std::vector<float> exponent(n);
+			for (size_t i = 0; i < n; ++i)
+				exponent[i] = y[(i * 7) % n] * 0.25f;
+			els::pow(span<const float>(out2), span<const float>(exponent), span<float>(out));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (!same_as_cmath(out2[i], exponent[i], out[i]))
+					return false;
+			}
+			const float inf = std::numeric_limits<float>::infinity(), nan = std::numeric_limits<float>::quiet_NaN();
+			const std::vector<float> special{ nan, inf, -inf, 0.f, -0.f, 1.f, -1.f, 0.5f, -0.5f, 2.f, -2.f, 3.f, -3.f, 2.5f, -2.5f };
+			std::vector<float> bases, exponents, powers(special.size() * special.size()), scalar_powers(special.size());
+			for (const float b : special)
+			{
+				for (const float e : special)
+				{
+					bases.push_back(b);
+					exponents.push_back(e);
+				}
+			}
+			els::pow(span<const float>(bases), span<const float>(exponents), span<float>(powers));
+			for (size_t i = 0; i < bases.size(); ++i)
+			{
+				if (!same_as_cmath(bases[i], exponents[i], powers[i]))
+					return false;
+			}
+			for (const float e : special)
+			{
+				els::pow(span<const float>(special), e, span<float>(scalar_powers));
+				for (size_t i = 0; i < special.size(); ++i)
+				{
+					if (!same_as_cmath(special[i], e, scalar_powers[i]))
+						return false;
+				}
+			}
+
+			// smoothstep and lerp against the formulas in double
+			els::smoothstep(-0.5f, 1.5f, span<const float>(x), span<float>(out));
+			els::lerp(span<const float>(x), span<const float>(y), 0.3f, span<float>(out2));
+			for (size_t i = 0; i < n; ++i)
+			{
+				const double t = min(max((x[i] + 0.5) / 2., 0.), 1.);
+				const double from = x[i], to = y[i], weight = 0.3f;
+				if (abs(out[i] - t * t * (3. - 2. * t)) > 2.5e-7 || abs(out2[i] - (from * (1. - weight) + to * weight)) > 2.4e-7 * max(abs(from), abs(to)))
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_packed()
+		{
+			// every half that is a number survives the trip through float
+			for (uint32_t bits = 0; bits < 0x10000; ++bits)
+			{
+				const float f = half::from_bits(static_cast<uint16_t>(bits));
+				if (f == f && half{ f }.bits != bits)
+					return false;
+			}
+			// the batch path gives the same bits for every half, signaling nans included
+			std::vector<half> every(0x10000);
+			std::vector<float> widened(every.size());
+			for (uint32_t bits = 0; bits < 0x10000; ++bits)
+				every[bits] = half::from_bits(static_cast<uint16_t>(bits));
+			unpack(every, widened);
+			for (uint32_t bits = 0; bits < 0x10000; ++bits)
+			{
+				const float f = every[bits];
+				if (std::memcmp(&f, &widened[bits], sizeof(float)) != 0)
+					return false;
+			}
+			for (int32_t bits = -32767; bits <= 32767; ++bits)
+			{
+				snorm16 s;
+				s.bits = static_cast<int16_t>(bits);
+				if (snorm16{ static_cast<float>(s) }.bits != bits)
+					return false;
+			}
+
+			std::vector<float> floats{ 0.f, -0.f, 1.f, 0.333f, 65504.f, 1e5f, 6e-8f, -2.5f, 1e-3f };
+			std::vector<half> halves(floats.size());
+			pack(floats, halves);
+			for (size_t i = 0; i < floats.size(); ++i)
+			{
+				if (halves[i].bits != half{ floats[i] }.bits)
+					return false;
+			}
+
+			std::mt19937 rng{ 36 };
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			const quatf identity{ 0.f, 0.f, 0.f, 1.f };
+			for (unsigned int i = 0; i < 10000; ++i)
+			{
+				const vec3f n = vec3f{ u(rng), u(rng), u(rng) }.normalized();
+				const vec3f decoded = to_vec3<float>(to_octahedral(n));
+				if (n.cross(decoded).length() > 7e-5f || n.dot(decoded) < 0.f)
+					return false;
+
+				const quatf q = quatf{ u(rng), u(rng), u(rng), u(rng) }.normalized();
+				const quatf r = to_quat<float>(to_smallest_three(q));
+				const float sign = q.dot(r) < 0.f ? -1.f : 1.f;
+				for (unsigned int k = 0; k < 4; ++k)
+				{
+					if (abs(q.data()[k] - sign * r.data()[k]) > 2e-6f)
+						return false;
+				}
+			}
+			return identity.dot(to_quat<float>(to_smallest_three(identity))) == 1.f;
+		}
+
+		static bool test_fixed()
+		{
+			static_assert(Fixed32{ 1.5 } * Fixed32{ 2 } == Fixed32{ 3 }, "fixed point is constexpr");
+			const double step = 1. / 65536.;
+			std::mt19937 rng{ 37 };
+			std::uniform_real_distribution<double> u(-100., 100.);
+			for (unsigned int i = 0; i < 10000; ++i)
+			{
+				const Fixed32 a{ u(rng) }, b{ u(rng) };
+				const double x = static_cast<double>(a), y = static_cast<double>(b);
+				if (abs(static_cast<double>(a * b) - x * y) > step / 2)
+					return false;
+				if (abs(y) >= 1.)
+				{
+					const double quotient = static_cast<double>(a / b);
+					// truncated, up to the rounding of the reference quotient
+					if (abs(quotient) > abs(x / y) || abs(quotient - x / y) > step)
+						return false;
+				}
+				if (abs(static_cast<double>(sqrt(abs(a))) - std::sqrt(abs(x))) > step / 2)
+					return false;
+				const double trig = step / 2 + std::ldexp(1., -26);
+				if (abs(static_cast<double>(sin(a)) - std::sin(x)) > trig || abs(static_cast<double>(cos(a)) - std::cos(x)) > trig)
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_frustum_cull()
+		{
+			// gl style perspective looking down -z, near 0.5 and far 50
+			const float near = 0.5f, far = 50.f;
+			const frustumf f = frustumf::from_matrix(mat4f{
+				near, 0.f, 0.f, 0.f,
+					0.f, 1.5f * near, 0.f, 0.f,
+					0.f, 0.f, -(far + near) / (far - near), -2.f * far * near / (far - near),
+					0.f, 0.f, -1.f, 0.f });
+			std::mt19937 rng{ 38 };
+			std::uniform_real_distribution<float> u(-40.f, 40.f), r(0.1f, 3.f);
+			const size_t n = 1000;
+			std::vector<float> x(n), y(n), z(n), radius(n), hi_x(n), hi_y(n), hi_z(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				x[i] = u(rng);
+				y[i] = u(rng);
+				z[i] = u(rng);
+				radius[i] = r(rng);
+				hi_x[i] = x[i] + radius[i];
+				hi_y[i] = y[i] + 2.f * radius[i];
+				hi_z[i] = z[i] + radius[i];
+			}
+
+			std::vector<uint32_t> spheres((n + 31) / 32), boxes((n + 31) / 32), indices(n);
+			frustum_cull(f, SphereSoA{ x, y, z, radius }, spheres);
+			frustum_cull(f, AABBSoA{ x, y, z, hi_x, hi_y, hi_z }, boxes);
+			size_t visible = 0;
+			for (size_t i = 0; i < n; ++i)
+			{
+				const bool sphere = f.intersects(spheref{ vec3f{ x[i], y[i], z[i] }, radius[i] });
+				const bool box = f.intersects(aabbf{ vec3f{ x[i], y[i], z[i] }, vec3f{ hi_x[i], hi_y[i], hi_z[i] } });
+				if (sphere != (((spheres[i / 32] >> (i % 32)) & 1) != 0) || box != (((boxes[i / 32] >> (i % 32)) & 1) != 0))
+					return false;
+				visible += sphere;
+			}
+			return visible > 0 && visible < n && frustum_cull_indices(f, SphereSoA{ x, y, z, radius }, indices) == visible;
+		}
+
+		static bool test_bvh()
+		{
+			std::mt19937 rng{ 39 };
+			std::uniform_real_distribution<float> u(-10.f, 10.f), r(0.05f, 0.3f);
+			const size_t n = 2000;
+			std::vector<spheref> spheres(n);
+			std::vector<aabbf> boxes(n), points(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				spheres[i] = spheref{ vec3f{ u(rng), u(rng), u(rng) }, r(rng) };
+				boxes[i] = aabbf::from_center(spheres[i].center, vec3f{ spheres[i].radius });
+				points[i] = aabbf{ spheres[i].center, spheres[i].center };
+			}
+
+			bvhf tree, point_tree;
+			tree.build(boxes);
+			point_tree.build(points);
+			const auto hit_sphere = [&](uint32_t prim, rayf& ray)
+			{
+				float t = 0.f;
+				if (!intersect(ray, spheres[prim], t))
+					return false;
+				ray.t_max = t;
+				return true;
+			};
+
+			for (unsigned int pass = 0; pass < 2; ++pass)
+			{
+				for (unsigned int q = 0; q < 200; ++q)
+				{
+					rayf ray{ vec3f{ u(rng), u(rng), u(rng) } * 1.5f, vec3f{ u(rng), u(rng), u(rng) } };
+					rayf brute = ray;
+					uint32_t closest = bvhf::npos;
+					for (uint32_t i = 0; i < n; ++i)
+					{
+						if (hit_sphere(i, brute))
+							closest = i;
+					}
+					if (tree.raycast(ray, hit_sphere) != closest || ray.t_max != brute.t_max)
+						return false;
+
+					const aabbf box = aabbf::from_center(vec3f{ u(rng), u(rng), u(rng) }, vec3f{ 1.f, 2.f, 0.5f });
+					size_t found = 0, expected = 0;
+					bool exact = true;
+					tree.query(box, [&](uint32_t prim) { ++found; exact = exact && boxes[prim].intersects(box); });
+					for (size_t i = 0; i < n; ++i)
+						expected += boxes[i].intersects(box);
+					if (!exact || found != expected)
+						return false;
+
+					const vec3f p{ u(rng), u(rng), u(rng) };
+					float nearest = std::numeric_limits<float>::max();
+					for (size_t i = 0; i < n; ++i)
+						nearest = min(nearest, p.distance2(points[i].min));
+					if (point_tree.nearest(p).distance2 != nearest)
+						return false;
+				}
+
+				// moved primitives keep the tree after a refit
+				for (size_t i = 0; i < n; ++i)
+				{
+					spheres[i].center += vec3f{ u(rng), u(rng), u(rng) } * 0.5f;
+					boxes[i] = aabbf::from_center(spheres[i].center, vec3f{ spheres[i].radius });
+				}
+				tree.refit(boxes);
+			}
+			return true;
+		}
+
+		static bool test_intersect()
+		{
+			std::mt19937 rng{ 40 };
+			std::uniform_real_distribution<float> u(-5.f, 5.f);
+			const size_t n = 101;
+			std::vector<float> tri[9], sphere[4];
+			for (size_t i = 0; i < n; ++i)
+			{
+				const vec3f center{ u(rng), u(rng), u(rng) };
+				for (unsigned int k = 0; k < 9; ++k)
+					tri[k].push_back(center[k % 3] + u(rng) * 0.3f);
+				for (unsigned int k = 0; k < 3; ++k)
+					sphere[k].push_back(center[k]);
+				sphere[3].push_back(abs(u(rng)) * 0.1f + 0.05f);
+			}
+			const TriangleSoA triangles{ tri[0], tri[1], tri[2], tri[3], tri[4], tri[5], tri[6], tri[7], tri[8] };
+			const SphereSoA spheres{ sphere[0], sphere[1], sphere[2], sphere[3] };
+
+			for (unsigned int q = 0; q < 500; ++q)
+			{
+				const rayf ray{ vec3f{ u(rng), u(rng), u(rng) } * 2.f, vec3f{ u(rng), u(rng), u(rng) } };
+				size_t closest = ray_miss, closest_sphere = ray_miss;
+				float best = ray.t_max, best_sphere = ray.t_max;
+				for (size_t i = 0; i < n; ++i)
+				{
+					rayf r = ray;
+					r.t_max = best;
+					float t = 0.f, a = 0.f, b = 0.f;
+					if (intersect(r, vec3f{ tri[0][i], tri[1][i], tri[2][i] }, vec3f{ tri[3][i], tri[4][i], tri[5][i] }, vec3f{ tri[6][i], tri[7][i], tri[8][i] }, t, a, b))
+					{
+						best = t;
+						closest = i;
+					}
+					r.t_max = best_sphere;
+					if (intersect(r, spheref{ vec3f{ sphere[0][i], sphere[1][i], sphere[2][i] }, sphere[3][i] }, t))
+					{
+						best_sphere = t;
+						closest_sphere = i;
+					}
+				}
+
+				rayf r = ray;
+				float a = 0.f, b = 0.f;
+				if (raycast(r, triangles, a, b) != closest || abs(r.t_max - best) > 1e-4f * best)
+					return false;
+				r = ray;
+				if (raycast(r, spheres) != closest_sphere || abs(r.t_max - best_sphere) > 1e-4f * best_sphere)
+					return false;
+			}
+
+			// rays down the shared edge of two triangles hit at least one of them
+			const vec3f a{ 0.f, 0.f, 0.f }, b{ 1.f, 0.f, 0.f }, c{ 1.f, 1.f, 0.f }, d{ 0.f, 1.f, 0.f };
+			for (unsigned int i = 1; i < 1000; ++i)
+			{
+				const float s = i / 1000.f;
+				const rayf ray{ vec3f{ s, s, 1.f }, vec3f{ 0.f, 0.f, -1.f } };
+				float t = 0.f, v = 0.f, w = 0.f;
+				if (!intersect_watertight(ray, a, b, c, t, v, w) && !intersect_watertight(ray, a, c, d, t, v, w))
+					return false;
+			}
+			return true;
+		}
+
+		template <typename Index, typename Tree, typename Neighbor>
+		static bool check_point_queries(const Tree& tree, const std::vector<vec3f>& points, std::mt19937& rng)
+		{
+			std::uniform_real_distribution<float> u(-10.f, 10.f);
+			std::vector<float> distances(points.size());
+			std::vector<Neighbor> nearest(8);
+			for (unsigned int q = 0; q < 200; ++q)
+			{
+				const vec3f p{ u(rng), u(rng), u(rng) };
+				const float radius = 1.5f;
+				for (size_t i = 0; i < points.size(); ++i)
+					distances[i] = p.distance2(points[i]);
+
+				size_t found = 0;
+				bool exact = true;
+				tree.query(p, radius, [&](Index i, float d2) { ++found; exact = exact && d2 == distances[i] && d2 <= radius * radius; });
+				if (!exact || found != static_cast<size_t>(std::count_if(distances.begin(), distances.end(), [&](float d2) { return d2 <= radius * radius; })))
+					return false;
+
+				const size_t count = tree.nearest(p, span<Neighbor>(nearest));
+				std::partial_sort(distances.begin(), distances.begin() + count, distances.end());
+				for (size_t k = 0; k < count; ++k)
+				{
+					if (nearest[k].distance2 != distances[k] || p.distance2(points[nearest[k].index]) != distances[k])
+						return false;
+				}
+			}
+			return true;
+		}
+
+		static bool test_spatial_hash()
+		{
+			std::mt19937 rng{ 41 };
+			std::uniform_real_distribution<float> u(-10.f, 10.f);
+			std::vector<vec3f> points(3000);
+			for (vec3f& p : points)
+				p = vec3f{ u(rng), u(rng), u(rng) };
+			spatial_hash3f grid;
+			grid.build(points, 1.5f);
+
+			size_t pairs = 0, expected = 0;
+			grid.for_each_pair(1.f, [&](uint32_t, uint32_t, float) { ++pairs; });
+			for (size_t i = 0; i < points.size(); ++i)
+			{
+				for (size_t j = i + 1; j < points.size(); ++j)
+					expected += points[i].distance2(points[j]) <= 1.f;
+			}
+			return pairs == expected && std::hash<vec3f>{}(points[0]) == std::hash<vec3f>{}(vec3f{ points[0] })
+				&& check_point_queries<uint32_t, spatial_hash3f, spatial_hash3f::Neighbor>(grid, points, rng);
+		}
+
+		static bool test_kd_tree()
+		{
+			std::mt19937 rng{ 42 };
+			std::uniform_real_distribution<float> u(-10.f, 10.f);
+			std::vector<vec3f> points(3000);
+			for (vec3f& p : points)
+				p = vec3f{ u(rng), u(rng), u(rng) };
+			kd_treef tree;
+			tree.build(points);
+			return check_point_queries<uint32_t, kd_treef, kd_treef::Neighbor>(tree, points, rng);
+		}
+
+		static bool test_morton()
+		{
+			std::mt19937_64 rng{ 43 };
+			for (unsigned int i = 0; i < 10000; ++i)
+			{
+				const uint64_t bits = rng();
+				const Vector2<uint32_t> v2{ static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32) };
+				const Vector3<uint32_t> v3{ static_cast<uint32_t>(bits & 0x1fffff), static_cast<uint32_t>((bits >> 21) & 0x1fffff), static_cast<uint32_t>(bits >> 43) };
+				if (morton_decode2(morton_encode(v2)) != v2 || morton_decode3(morton_encode(v3)) != v3)
+					return false;
+				if (hilbert_decode2(hilbert_encode(v2, 32), 32) != v2 || hilbert_decode3(hilbert_encode(v3, 21), 21) != v3)
+					return false;
+			}
+
+			// the batch versions agree with the single ones
+			std::vector<vec3f> points(5000);
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			for (vec3f& p : points)
+				p = vec3f{ u(rng), u(rng), u(rng) };
+			std::vector<uint64_t> codes(points.size());
+			std::vector<Vector3<uint32_t>> cells(points.size());
+			morton_encode(span<const vec3f>(points), vec3f{ -1.f }, vec3f{ 1.f }, span<uint64_t>(codes));
+			morton_decode(span<const uint64_t>(codes), span<Vector3<uint32_t>>(cells));
+			for (size_t i = 0; i < points.size(); ++i)
+			{
+				if (cells[i] != quantize(points[i], vec3f{ -1.f }, vec3f{ 1.f }, 21) || morton_encode(cells[i]) != codes[i])
+					return false;
+			}
+			std::vector<Vector2<uint32_t>> cells2(codes.size());
+			morton_decode(span<const uint64_t>(codes), span<Vector2<uint32_t>>(cells2));
+			for (size_t i = 0; i < codes.size(); ++i)
+			{
+				if (cells2[i] != morton_decode2(codes[i]))
+					return false;
+			}
+
+			// consecutive hilbert indices are neighbouring cells
+			for (uint64_t code = 0; code + 1 < 4096; ++code)
+			{
+				const Vector3<uint32_t> a = hilbert_decode3(code, 4), b = hilbert_decode3(code + 1, 4);
+				const uint32_t steps = (a.x > b.x ? a.x - b.x : b.x - a.x) + (a.y > b.y ? a.y - b.y : b.y - a.y) + (a.z > b.z ? a.z - b.z : b.z - a.z);
+				if (steps != 1)
+					return false;
+			}
+
+			// stable, the payload follows its key
+			std::vector<uint64_t> keys(100000), sorted;
+			std::vector<uint32_t> payload(keys.size());
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				keys[i] = i % 3 ? rng() : rng() % 100;
+				payload[i] = static_cast<uint32_t>(i);
+			}
+			sorted = keys;
+			radix_sort(span<uint64_t>(sorted), span<uint32_t>(payload));
+			for (size_t i = 0; i < keys.size(); ++i)
+			{
+				if (keys[payload[i]] != sorted[i] || (i > 0 && (sorted[i - 1] > sorted[i] || (sorted[i - 1] == sorted[i] && payload[i - 1] > payload[i]))))
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_reduce()
+		{
+			std::mt19937 rng{ 44 };
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			std::vector<vec3f> points(100000);
+			for (vec3f& p : points)
+				p = vec3f{ u(rng) + 1000.f, u(rng) * 2.f - 500.f, u(rng) * 0.5f + 20.f };
+
+			aabbf box;
+			Vector3<double> sum{ 0. };
+			for (const vec3f& p : points)
+			{
+				box.merge(p);
+				sum += Vector3<double>{ p.x, p.y, p.z };
+			}
+			const Vector3<double> mean = sum / static_cast<double>(points.size());
+			double expected[3][3] = {};
+			for (const vec3f& p : points)
+			{
+				const Vector3<double> d = Vector3<double>{ p.x, p.y, p.z } - mean;
+				for (unsigned int r = 0; r < 3; ++r)
+				{
+					for (unsigned int c = 0; c < 3; ++c)
+						expected[r][c] += d[r] * d[c] / static_cast<double>(points.size());
+				}
+			}
+
+			const span<const vec3f> all(points);
+			const aabbf reduced = bounds(all);
+			if (reduced.min != box.min || reduced.max != box.max)
+				return false;
+			const vec3f center = centroid(all);
+			if (abs(center.x - mean.x) > 1e-4 || abs(center.y - mean.y) > 1e-4 || abs(center.z - mean.z) > 1e-4)
+				return false;
+			const mat3f covariance_matrix = covariance(all);
+			for (unsigned int r = 0; r < 3; ++r)
+			{
+				for (unsigned int c = 0; c < 3; ++c)
+				{
+					if (abs(covariance_matrix[r][c] - expected[r][c]) > 1e-5)
+						return false;
+				}
+			}
+
+			const spheref ritter = bounding_sphere(all), minimal = minimal_bounding_sphere(all);
+			for (const vec3f& p : points)
+			{
+				if (p.distance(ritter.center) > ritter.radius * 1.00001f || p.distance(minimal.center) > minimal.radius * 1.00001f)
+					return false;
+			}
+			return minimal.radius <= ritter.radius * 1.00001f;
+		}
+
+		// entries in [-1, 1] plus diagonal on the diagonal
+		template <typename M>
+		static M random_matrix(std::mt19937& rng, float diagonal = 0.f)
+		{
+			constexpr unsigned int n = sizeof(M) == 9 * sizeof(float) ? 3 : 4;
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			M m;
+			for (unsigned int i = 0; i < n * n; ++i)
+				m.data()[i] = u(rng) + (i % (n + 1) == 0 ? diagonal : 0.f);
+			return m;
+		}
+
+		static bool test_eigen()
+		{
+			std::mt19937 rng{ 45 };
+			std::vector<mat3f> matrices(67);
+			for (mat3f& m : matrices)
+				m = random_matrix<mat3f>(rng);
+			std::vector<Svd3<float>> batch(matrices.size());
+			svd(span<const mat3f>(matrices), span<Svd3<float>>(batch));
+
+			for (size_t i = 0; i < matrices.size(); ++i)
+			{
+				const mat3f& m = matrices[i];
+				// textbook a b is b * a with operator*
+				const mat3f symmetric = m * m.transposed();
+				const Eigen3<float> e = eigen_symmetric(symmetric);
+				for (unsigned int k = 0; k < 3; ++k)
+				{
+					const vec3f v{ e.vectors[0][k], e.vectors[1][k], e.vectors[2][k] };
+					if ((symmetric * v - v * e.values[k]).length() > 1e-5f || (k > 0 && e.values[k - 1] < e.values[k]))
+						return false;
+				}
+
+				for (const Svd3<float>& d : { svd(m), batch[i] })
+				{
+					mat3f sigma = mat3f::I;
+					for (unsigned int k = 0; k < 3; ++k)
+						sigma[k][k] = d.sigma[k];
+					if (max_difference(d.v.transposed() * sigma * d.u, m) > 1e-5f || abs(d.u.det() - 1.f) > 1e-5f || abs(d.v.det() - 1.f) > 1e-5f)
+						return false;
+				}
+
+				const Polar3<float> p = polar(m);
+				if (max_difference(p.stretch * p.rotation, m) > 1e-5f || max_difference(p.rotation * p.rotation.transposed(), mat3f::I) > 1e-5f)
+					return false;
+				if (abs(p.rotation.det() - 1.f) > 1e-5f || max_difference(p.stretch, p.stretch.transposed()) > 1e-5f)
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_solve()
+		{
+			std::mt19937 rng{ 47 };
+			std::uniform_real_distribution<float> u(-1.f, 1.f);
+			const size_t n = 37;
+			std::vector<mat4f> a(n), spd(n);
+			std::vector<vec4f> b(n), x(n), y(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				a[i] = random_matrix<mat4f>(rng, 3.f);
+				spd[i] = a[i] * a[i].transposed();
+				spd[i] += mat4f::I;
+				b[i] = vec4f{ u(rng), u(rng), u(rng), u(rng) };
+			}
+			a[n / 2] = mat4f::zero;
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (i == n / 2)
+					continue;
+				const LU<mat4f> lu(a[i]);
+				const LDLT<mat4f> ldlt(spd[i]);
+				if (!lu.ok() || !ldlt.ok() || !ldlt.positive())
+					return false;
+				if ((a[i] * lu.solve(b[i]) - b[i]).length() > 1e-5f || (spd[i] * ldlt.solve(b[i]) - b[i]).length() > 1e-5f)
+					return false;
+				if (max_difference(lu.inverse() * a[i], mat4f::I) > 1e-5f || abs(lu.det() - a[i].det()) > 1e-4f * abs(a[i].det()))
+					return false;
+			}
+			if (LU<mat4f>{ a[n / 2] }.ok())
+				return false;
+
+			// the batched solves report the singular system and leave its x at zero
+			if (solve(span<const mat4f>(a), span<const vec4f>(b), span<vec4f>(x)) != 1 || x[n / 2] != vec4f{ 0.f })
+				return false;
+			if (solve_symmetric(span<const mat4f>(spd), span<const vec4f>(b), span<vec4f>(y)) != 0)
+				return false;
+			for (size_t i = 0; i < n; ++i)
+			{
+				if ((i != n / 2 && (a[i] * x[i] - b[i]).length() > 1e-5f) || (spd[i] * y[i] - b[i]).length() > 1e-5f)
+					return false;
+			}
+
+			const mat3f small = random_matrix<mat3f>(rng, 3.f);
+			const vec3f rhs{ 1.f, 2.f, 3.f };
+			const mat2f tiny{ 4.f, 1.f, 2.f, 3.f };
+			return (small * LU<mat3f>{ small }.solve(rhs) - rhs).length() < 1e-5f
+				&& (tiny * LU<mat2f>{ tiny }.solve(vec2f{ 1.f, -1.f }) - vec2f{ 1.f, -1.f }).length() < 1e-6f;
+		}
+
+		static bool test_dyn_matrix()
+		{
+			std::mt19937 rng{ 48 };
+			std::uniform_real_distribution<double> u(-1., 1.);
+			const auto random = [&](size_t rows, size_t cols, StorageOrder order)
+			{
+				dyn_matd m(rows, cols, order);
+				for (size_t i = 0; i < rows; ++i)
+				{
+					for (size_t j = 0; j < cols; ++j)
+						m(i, j) = u(rng);
+				}
+				return m;
+			};
+
+			// odd sizes so every tile has a ragged edge
+			const size_t m = 131, k = 300, n = 77;
+			const dyn_matd a = random(m, k, StorageOrder::row_major), bt = random(n, k, StorageOrder::col_major);
+			dyn_matd c = random(m, n, StorageOrder::row_major);
+			const dyn_matd c0 = c;
+			if (!gemm(2., a, bt.view().transposed(), 0.5, c))
+				return false;
+			std::vector<double> x(k), y(m, 1.);
+			for (double& v : x)
+				v = u(rng);
+			if (!gemv(1.5, a, span<const double>(x), -1., span<double>(y)))
+				return false;
+			for (size_t i = 0; i < m; ++i)
+			{
+				double row = 0.;
+				for (size_t q = 0; q < k; ++q)
+					row += a(i, q) * x[q];
+				if (abs(y[i] - (1.5 * row - 1.)) > 1e-12)
+					return false;
+				for (size_t j = 0; j < n; ++j)
+				{
+					double sum = 0.;
+					for (size_t q = 0; q < k; ++q)
+						sum += a(i, q) * bt(j, q);
+					if (abs(c(i, j) - (2. * sum + 0.5 * c0(i, j))) > 1e-12)
+						return false;
+				}
+			}
+
+			// more than one lu block and a residual in the input scale
+			dyn_matd s = random(150, 150, StorageOrder::row_major);
+			for (size_t i = 0; i < s.rows(); ++i)
+				s(i, i) += 4.;
+			const LU<dyn_matd> lu(s);
+			std::vector<double> rhs(s.rows()), solution(s.rows()), residual(s.rows());
+			for (double& v : rhs)
+				v = u(rng);
+			lu.solve(span<const double>(rhs), span<double>(solution));
+			gemv(1., s, span<const double>(solution), 0., span<double>(residual));
+			for (size_t i = 0; i < s.rows(); ++i)
+			{
+				if (abs(residual[i] - rhs[i]) > 1e-12)
+					return false;
+			}
+			const dyn_matd identity = s * lu.inverse();
+			for (size_t i = 0; i < s.rows(); ++i)
+			{
+				for (size_t j = 0; j < s.cols(); ++j)
+				{
+					if (abs(identity(i, j) - (i == j ? 1. : 0.)) > 1e-12)
+						return false;
+				}
+			}
+
+			// mismatched shapes are refused and leave the output alone
+			dyn_matd wrong(m, n + 1);
+			if (gemm(1., a, bt.view().transposed(), 0., wrong.view()) || gemv(1., a, span<const double>(x), 0., span<double>(y.data(), m - 1))
+				|| transpose<double>(a, wrong) || wrong(0, 0) != 0. || lu.solve(span<const double>(rhs.data(), 10), span<double>(solution)))
+				return false;
+			if (LU<dyn_matd>(a).ok())
+				return false;
+			return lu.ok();
+		}
+
+		static bool test_sparse()
+		{
+			// 2d laplacian with a small shift, symmetric positive definite
+			const size_t g = 24, n = g * g;
+			std::vector<Triplet<double>> triplets;
+			for (size_t i = 0; i < n; ++i)
+			{
+				triplets.push_back(Triplet<double>{ i, i, 0.01 });
+				const size_t x = i % g, y = i / g;
+				for (const size_t j : { x > 0 ? i - 1 : i, x + 1 < g ? i + 1 : i, y > 0 ? i - g : i, y + 1 < g ? i + g : i })
+				{
+					if (j == i)
+						continue;
+					triplets.push_back(Triplet<double>{ i, i, 1. });
+					triplets.push_back(Triplet<double>{ i, j, -1. });
+				}
+			}
+			const sparse_matd a(n, n, triplets);
+
+			std::mt19937 rng{ 49 };
+			std::uniform_real_distribution<double> u(-1., 1.);
+			std::vector<double> b(n), x(n), y(n);
+			for (double& v : b)
+				v = u(rng);
+			multiply(a, span<const double>(b), span<double>(y));
+			for (size_t i = 0; i < n; ++i)
+			{
+				double row = 0.;
+				for (size_t j = 0; j < n; ++j)
+					row += a(i, j) * b[j];
+				if (abs(row - y[i]) > 1e-12)
+					return false;
+			}
+
+			for (const Preconditioner p : { Preconditioner::none, Preconditioner::jacobi, Preconditioner::incomplete_cholesky })
+			{
+				std::fill(x.begin(), x.end(), 0.);
+				const CgResult<double> result = conjugate_gradient(a, span<const double>(b), span<double>(x), p, 1e-10, 5000);
+				multiply(a, span<const double>(x), span<double>(y));
+				double error = 0., norm = 0.;
+				for (size_t i = 0; i < n; ++i)
+				{
+					error += (y[i] - b[i]) * (y[i] - b[i]);
+					norm += b[i] * b[i];
+				}
+				if (!result.converged || std::sqrt(error / norm) > 1e-9)
+					return false;
+			}
+			return true;
+		}
+
+		static bool test_matrix_batch()
+		{
+			std::mt19937 rng{ 50 };
+			const size_t n = 37;
+			std::vector<mat4f> a(n), b(n), product(n), inverse(n), transposed(n);
+			std::vector<mat3f> c(n), c_inverse(n);
+			std::vector<float> det(n), c_det(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				a[i] = random_matrix<mat4f>(rng, 2.f);
+				b[i] = random_matrix<mat4f>(rng);
+				c[i] = random_matrix<mat3f>(rng, 2.f);
+			}
+			a[5] = mat4f::zero;
+
+			multiply(span<const mat4f>(a), span<const mat4f>(b), span<mat4f>(product));
+			transpose(span<const mat4f>(a), span<mat4f>(transposed));
+			if (invert(span<const mat4f>(a), span<mat4f>(inverse)) != 1 || invert(span<const mat3f>(c), span<mat3f>(c_inverse)) != 0)
+				return false;
+			determinant(span<const mat4f>(a), span<float>(det));
+			determinant(span<const mat3f>(c), span<float>(c_det));
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (max_difference(product[i], a[i] * b[i]) > 1e-5f || transposed[i] != a[i].transposed())
+					return false;
+				if (max_difference(inverse[i], a[i].inverse()) > 1e-4f || max_difference(c_inverse[i], c[i].inverse()) > 1e-4f)
+					return false;
+				if (abs(det[i] - a[i].det()) > 1e-4f * max(1.f, abs(a[i].det())) || abs(c_det[i] - c[i].det()) > 1e-4f * max(1.f, abs(c[i].det())))
+					return false;
+			}
+			return inverse[5] == mat4f::zero;
+		}
 	}
 
 }
\ No newline at end of file
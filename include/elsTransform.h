@@ -0,0 +1,399 @@
+#ifndef ELS_TRANSFORM
+#define ELS_TRANSFORM
+
+#include <cstdint>
+#include <limits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+#include "elsMatrix3.h"
+#include "elsMatrix4.h"
+#include "elsQuaternion.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+
+namespace els
+{
+	// translation, rotation, scale transform
+	// the matrix and its inverse are rebuilt lazily, only after a setter has touched the transform
+	// the cache is mutable, so concurrent const access to a dirty transform is not thread safe
+	template <typename T>
+	class Transform
+	{
+	public:
+		using Scalar = T;
+
+	private:
+		enum : uint8_t
+		{
+			matrix_dirty = 0b01,
+			inverse_dirty = 0b10,
+			all_dirty = matrix_dirty | inverse_dirty,
+		};
+
+		Vector3<T> t;
+		Quaternion<T> r;
+		Vector3<T> s;
+
+		mutable Matrix4<T> mtx;
+		mutable Matrix4<T> inv;
+		mutable uint8_t dirty;
+
+	public:
+		constexpr Transform()
+			: t{}, r{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) },
+			s{ static_cast<Scalar>(1) }, mtx{}, inv{}, dirty{ 0 } {}
+		constexpr Transform(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale)
+			: t{ translation }, r{ rotation }, s{ scale }, mtx{}, inv{}, dirty{ all_dirty } {}
+		constexpr explicit Transform(const Vector3<T>& translation)
+			: Transform{}
+		{
+			set_translation(translation);
+		}
+
+		constexpr const Vector3<T>& translation() const { return t; }
+		constexpr const Quaternion<T>& rotation() const { return r; }
+		constexpr const Vector3<T>& scale() const { return s; }
+
+		constexpr Transform& set(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale);
+		constexpr Transform& set_translation(const Vector3<T>& translation);
+		constexpr Transform& set_rotation(const Quaternion<T>& rotation);
+		constexpr Transform& set_scale(const Vector3<T>& scale);
+		constexpr Transform& set_scale(const Scalar& scale);
+
+		constexpr Transform& translate(const Vector3<T>& delta);
+		constexpr Transform& rotate(const Quaternion<T>& delta); // applied after the current rotation
+		constexpr Transform& scale_by(const Vector3<T>& factor);
+
+		constexpr bool is_dirty() const;
+
+		constexpr const Matrix4<T>& matrix() const;
+		constexpr const Matrix4<T>& inverse_matrix() const;
+
+		constexpr Vector3<T> transform_point(const Vector3<T>& p) const;
+		constexpr Vector3<T> transform_direction(const Vector3<T>& d) const;
+
+		// T * R * S built directly, rotation is expected to be normalized
+		static constexpr Matrix4<T> to_mtx4(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale);
+		// S^-1 * R^T * -T, returns zero matrix if any scale component is zero
+		static constexpr Matrix4<T> to_inverse_mtx4(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale);
+	};
+
+	// typedef
+	using trsf = Transform<float>;
+	using trs = Transform<defaultType>;
+
+	// affine matrix split as translation * rotation * shear * scale, the shear is unit upper triangular
+	// with xy, xz and yz above the diagonal, a mirror shows up as a negative scale.x
+	// a column with scale 0 keeps its shear entries unscaled, so rank deficient matrices still compose back
+	template <typename T>
+	struct Decomposition
+	{
+		using Scalar = T;
+
+		Vector3<T> translation;
+		Quaternion<T> rotation;
+		Vector3<T> scale;
+		Vector3<T> shear;
+	};
+
+	// matrices per worker chunk for the span versions
+	constexpr size_t decompose_grain = 1024;
+
+	// gram schmidt on the columns of the upper 3x3, the last row is assumed to be (0, 0, 0, 1)
+	// a column with no length left gets scale 0 and an axis built from the other columns, so a zero
+	// scale keeps the rotation of the rest and an all zero matrix gives the identity rotation
+	template <typename T>
+	constexpr Decomposition<T> decompose(const Matrix4<T>& m);
+	// the matrix decompose came from, to_mtx4 when the shear is zero
+	template <typename T>
+	constexpr Matrix4<T> compose(const Decomposition<T>& d);
+
+	template <typename T>
+	inline void decompose(span<const Matrix4<T>> in, span<Decomposition<T>> out)
+	{
+		parallel::for_range(0, in.size(), decompose_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					out[i] = decompose(in[i]);
+			});
+	}
+	template <typename T>
+	inline void compose(span<const Decomposition<T>> in, span<Matrix4<T>> out)
+	{
+		parallel::for_range(0, in.size(), decompose_grain, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+					out[i] = compose(in[i]);
+			});
+	}
+
+	// member functions
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::set(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale)
+	{
+		t = translation;
+		r = rotation;
+		s = scale;
+		dirty = all_dirty;
+		return *this;
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::set_translation(const Vector3<T>& translation)
+	{
+		t = translation;
+		dirty = all_dirty;
+		return *this;
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::set_rotation(const Quaternion<T>& rotation)
+	{
+		r = rotation;
+		dirty = all_dirty;
+		return *this;
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::set_scale(const Vector3<T>& scale)
+	{
+		s = scale;
+		dirty = all_dirty;
+		return *this;
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::set_scale(const Scalar& scale)
+	{
+		return set_scale(Vector3<T>{ scale });
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::translate(const Vector3<T>& delta)
+	{
+		return set_translation(t + delta);
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::rotate(const Quaternion<T>& delta)
+	{
+		return set_rotation(delta * r);
+	}
+	template <typename T>
+	constexpr Transform<T>& Transform<T>::scale_by(const Vector3<T>& factor)
+	{
+		return set_scale(Vector3<T>{ s.x * factor.x, s.y * factor.y, s.z * factor.z });
+	}
+	template <typename T>
+	constexpr bool Transform<T>::is_dirty() const
+	{
+		return dirty != 0;
+	}
+	template <typename T>
+	constexpr const Matrix4<T>& Transform<T>::matrix() const
+	{
+		if (dirty & matrix_dirty)
+		{
+			mtx = to_mtx4(t, r, s);
+			dirty &= ~matrix_dirty;
+		}
+		return mtx;
+	}
+	template <typename T>
+	constexpr const Matrix4<T>& Transform<T>::inverse_matrix() const
+	{
+		if (dirty & inverse_dirty)
+		{
+			inv = to_inverse_mtx4(t, r, s);
+			dirty &= ~inverse_dirty;
+		}
+		return inv;
+	}
+	template <typename T>
+	constexpr Vector3<T> Transform<T>::transform_point(const Vector3<T>& p) const
+	{
+		return matrix() * p;
+	}
+	template <typename T>
+	constexpr Vector3<T> Transform<T>::transform_direction(const Vector3<T>& d) const
+	{
+		const Matrix4<T>& m = matrix();
+		return Vector3<T>{
+			(m.m[0] * d.x + m.m[1] * d.y + m.m[2] * d.z),
+				(m.m[4] * d.x + m.m[5] * d.y + m.m[6] * d.z),
+				(m.m[8] * d.x + m.m[9] * d.y + m.m[10] * d.z)
+		};
+	}
+
+	// static functions
+	template <typename T>
+	constexpr Matrix4<T> Transform<T>::to_mtx4(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale)
+	{
+		const Vector4<T> q = static_cast<Vector4<T>>(rotation);
+
+		const T x2 = q.x * 2;
+		const T y2 = q.y * 2;
+		const T z2 = q.z * 2;
+
+		const T xx = q.x * x2;
+		const T xy = q.x * y2;
+		const T xz = q.x * z2;
+		const T yy = q.y * y2;
+		const T yz = q.y * z2;
+		const T zz = q.z * z2;
+
+		const T xw = q.w * x2;
+		const T yw = q.w * y2;
+		const T zw = q.w * z2;
+
+		return Matrix4<T>{
+			(1 - (yy + zz)) * scale.x, (xy - zw) * scale.y, (xz + yw) * scale.z, translation.x,
+				(xy + zw) * scale.x, (1 - (xx + zz)) * scale.y, (yz - xw) * scale.z, translation.y,
+				(xz - yw) * scale.x, (yz + xw) * scale.y, (1 - (xx + yy)) * scale.z, translation.z,
+				0, 0, 0, 1
+		};
+	}
+	template <typename T>
+	constexpr Matrix4<T> Transform<T>::to_inverse_mtx4(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale)
+	{
+		if (scale.x == static_cast<T>(0) || scale.y == static_cast<T>(0) || scale.z == static_cast<T>(0))
+			return Matrix4<T>::zero;
+
+		const Vector4<T> q = static_cast<Vector4<T>>(rotation);
+
+		const T x2 = q.x * 2;
+		const T y2 = q.y * 2;
+		const T z2 = q.z * 2;
+
+		const T xx = q.x * x2;
+		const T xy = q.x * y2;
+		const T xz = q.x * z2;
+		const T yy = q.y * y2;
+		const T yz = q.y * z2;
+		const T zz = q.z * z2;
+
+		const T xw = q.w * x2;
+		const T yw = q.w * y2;
+		const T zw = q.w * z2;
+
+		const T sx = static_cast<T>(1) / scale.x;
+		const T sy = static_cast<T>(1) / scale.y;
+		const T sz = static_cast<T>(1) / scale.z;
+
+		// rows of S^-1 * R^T
+		const T a00 = (1 - (yy + zz)) * sx, a01 = (xy + zw) * sx, a02 = (xz - yw) * sx;
+		const T a10 = (xy - zw) * sy, a11 = (1 - (xx + zz)) * sy, a12 = (yz + xw) * sy;
+		const T a20 = (xz + yw) * sz, a21 = (yz - xw) * sz, a22 = (1 - (xx + yy)) * sz;
+
+		return Matrix4<T>{
+			a00, a01, a02, -(a00 * translation.x + a01 * translation.y + a02 * translation.z),
+				a10, a11, a12, -(a10 * translation.x + a11 * translation.y + a12 * translation.z),
+				a20, a21, a22, -(a20 * translation.x + a21 * translation.y + a22 * translation.z),
+				0, 0, 0, 1
+		};
+	}
+
+	template <typename T>
+	constexpr Decomposition<T> decompose(const Matrix4<T>& m)
+	{
+		Vector3<T> c[3] = {
+			Vector3<T>{ m[0][0], m[1][0], m[2][0] },
+			Vector3<T>{ m[0][1], m[1][1], m[2][1] },
+			Vector3<T>{ m[0][2], m[1][2], m[2][2] }
+		};
+		const T largest = max(c[0].length2(), max(c[1].length2(), c[2].length2()));
+		const T tiny = std::numeric_limits<T>::epsilon() * std::numeric_limits<T>::epsilon() * largest;
+
+		// columns = axes * k with k upper triangular, k[i][i] is the scale
+		// a column with no length left leaves its axis open, it is filled in below
+		Vector3<T> axes[3];
+		bool found[3] = {};
+		T k[3][3] = {};
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			Vector3<T> rest = c[i];
+			for (unsigned int j = 0; j < i; ++j)
+			{
+				if (!found[j])
+					continue;
+				k[j][i] = axes[j].dot(c[i]);
+				rest -= axes[j] * k[j][i];
+			}
+			const T length2 = rest.length2();
+			if (length2 > tiny && length2 > std::numeric_limits<T>::min())
+			{
+				k[i][i] = sqrt(length2);
+				axes[i] = rest / k[i][i];
+				found[i] = true;
+			}
+		}
+
+		// the open axes are orthogonal to the found ones, so the columns keep their k
+		// with one found axis the next open one is the closest unit axis, the last is always a cross product
+		const unsigned int count = found[0] + found[1] + found[2];
+		if (count == 0)
+		{
+			axes[0] = Vector3<T>{ static_cast<T>(1), static_cast<T>(0), static_cast<T>(0) };
+			axes[1] = Vector3<T>{ static_cast<T>(0), static_cast<T>(1), static_cast<T>(0) };
+			axes[2] = Vector3<T>{ static_cast<T>(0), static_cast<T>(0), static_cast<T>(1) };
+		}
+		else if (count == 1)
+		{
+			const unsigned int p = found[0] ? 0 : (found[1] ? 1 : 2);
+			const unsigned int a = (p + 1) % 3, b = (p + 2) % 3;
+			const unsigned int next = abs(axes[p][a]) < static_cast<T>(0.9) ? a : b;
+			Vector3<T> unit{ static_cast<T>(0), static_cast<T>(0), static_cast<T>(0) };
+			unit[next] = static_cast<T>(1);
+			axes[next] = (unit - axes[p] * axes[p][next]).normalized();
+			const unsigned int last = next == a ? b : a;
+			axes[last] = axes[(last + 1) % 3].cross(axes[(last + 2) % 3]);
+		}
+		else if (count == 2)
+		{
+			const unsigned int open = !found[0] ? 0 : (!found[1] ? 1 : 2);
+			axes[open] = axes[(open + 1) % 3].cross(axes[(open + 2) % 3]);
+		}
+
+		// a reflection moves into the x scale
+		if (axes[0].cross(axes[1]).dot(axes[2]) < 0)
+		{
+			axes[0] = -axes[0];
+			for (unsigned int j = 0; j < 3; ++j)
+				k[0][j] = -k[0][j];
+		}
+
+		const Matrix3<T> rotation{
+			axes[0].x, axes[1].x, axes[2].x,
+				axes[0].y, axes[1].y, axes[2].y,
+				axes[0].z, axes[1].z, axes[2].z
+		};
+		// a zero scale has nothing to divide by, its column then stores the k entry itself
+		const auto ratio = [](T a, T b) { return b != 0 ? a / b : a; };
+		return Decomposition<T>{
+			Vector3<T>{ m[0][3], m[1][3], m[2][3] },
+				Quaternion<T>::from_mtx3(rotation),
+				Vector3<T>{ k[0][0], k[1][1], k[2][2] },
+				Vector3<T>{ ratio(k[0][1], k[1][1]), ratio(k[0][2], k[2][2]), ratio(k[1][2], k[2][2]) }
+		};
+	}
+	template <typename T>
+	constexpr Matrix4<T> compose(const Decomposition<T>& d)
+	{
+		const Matrix3<T> r = d.rotation.to_mtx3();
+		const Vector3<T>& s = d.scale;
+		// k = shear * scale, a zero scale column holds its k entries as they are
+		const auto times = [](T a, T b) { return b != 0 ? a * b : a; };
+		const T k[3][3] = {
+			{ s.x, times(d.shear.x, s.y), times(d.shear.y, s.z) },
+			{ static_cast<T>(0), s.y, times(d.shear.z, s.z) },
+			{ static_cast<T>(0), static_cast<T>(0), s.z }
+		};
+		Matrix4<T> result;
+		for (unsigned int row = 0; row < 3; ++row)
+		{
+			for (unsigned int col = 0; col < 3; ++col)
+				result[row][col] = r[row][0] * k[0][col] + r[row][1] * k[1][col] + r[row][2] * k[2][col];
+			result[row][3] = d.translation[row];
+		}
+		return result;
+	}
+
+} // namespace els
+
+#endif
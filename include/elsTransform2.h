@@ -5,6 +5,9 @@
 #include "elsHeader.h"
 #include "elsMath.h"
 #include "elsMatrix3.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+#include "elsMathBatch.h"
 
 namespace els
 {
@@ -30,9 +33,12 @@ namespace els
 		template <typename S>
 		static inline constexpr Matrix3<T> rotate(S angle)
 		{
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
+
 			return Matrix3<T>{
-				cos(static_cast<T>(angle)), -sin(static_cast<T>(angle)), 0,
-					sin(static_cast<T>(angle)), cos(static_cast<T>(angle)), 0,
+				c, -s, 0,
+					s, c, 0,
 					0, 0, 1
 			};
 		}
@@ -56,6 +62,74 @@ namespace els
 		{
 			return scale(v.x, v.y);
 		}
+
+		// scale * rotate * translate with the library operator*, the textbook T R S, in one pass
+		template <typename S>
+		static inline constexpr Matrix3<T> trs(S x, S y, S angle, S sx, S sy)
+		{
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
+
+			return Matrix3<T>{
+				c * static_cast<T>(sx), -s * static_cast<T>(sy), static_cast<T>(x),
+					s * static_cast<T>(sx), c * static_cast<T>(sy), static_cast<T>(y),
+					0, 0, 1
+			};
+		}
+		template <typename S>
+		static inline constexpr Matrix3<T> trs(const Vector2<S>& translation, S angle, const Vector2<S>& scale)
+		{
+			return trs(translation.x, translation.y, angle, scale.x, scale.y);
+		}
+
+		// matrices per worker chunk for the batch builders
+		static constexpr size_t batch_grain = 1 << 12;
+
+		// batch trs from structure of arrays parameters, all spans must be out.size() long
+		// the angles of a block go through the span sincos kernels of elsMathBatch.h, then every matrix
+		// is written from them, large spans are split across threads
+		static inline void trs(
+			span<const T> x, span<const T> y, span<const T> angle,
+			span<const T> sx, span<const T> sy,
+			span<Matrix3<T>> out)
+		{
+			build(angle, out, [&](size_t i, T s, T c, T* m)
+				{
+					m[0] = c * sx[i]; m[1] = -s * sy[i]; m[2] = x[i];
+					m[3] = s * sx[i]; m[4] = c * sy[i]; m[5] = y[i];
+				});
+		}
+		static inline void rotate(span<const T> angle, span<Matrix3<T>> out)
+		{
+			build(angle, out, [](size_t, T s, T c, T* m)
+				{
+					m[0] = c; m[1] = -s; m[2] = 0;
+					m[3] = s; m[4] = c; m[5] = 0;
+				});
+		}
+
+	private:
+		// fn(i, sin, cos, m) fills the first two rows of out[i]
+		template <typename Fn>
+		static inline void build(span<const T> angle, span<Matrix3<T>> out, Fn&& fn)
+		{
+			using detail::batch::sincos_block;
+			parallel::for_range(0, out.size(), batch_grain, [&](size_t first, size_t last)
+				{
+					T s[sincos_block], c[sincos_block];
+					for (size_t b = first; b < last; b += sincos_block)
+					{
+						const size_t n = min(sincos_block, last - b);
+						detail::batch::sincos_n(angle.data() + b, s, c, n);
+						for (size_t j = 0; j < n; ++j)
+						{
+							T* m = out[b + j].data();
+							fn(b + j, s[j], c[j], m);
+							m[6] = 0; m[7] = 0; m[8] = 1;
+						}
+					}
+				});
+		}
 	};
 
 	using t2f = Transform2<float>;
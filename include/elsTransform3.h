@@ -4,7 +4,11 @@
 
 #include "elsHeader.h"
 #include "elsMath.h"
+#include "elsMatrix3.h"
 #include "elsMatrix4.h"
+#include "elsSpan.h"
+#include "elsParallel.h"
+#include "elsMathBatch.h"
 
 
 namespace els
@@ -33,8 +37,8 @@ namespace els
 		template <typename S>
 		static inline constexpr Matrix4<T> rotateX(S angle)
 		{
-			const T c = cos(static_cast<T>(angle));
-			const T s = sin(static_cast<T>(angle));
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
 
 			return Matrix4<T>{
 				1, 0, 0, 0,
@@ -46,8 +50,8 @@ namespace els
 		template <typename S>
 		static inline constexpr Matrix4<T> rotateY(S angle)
 		{
-			const T c = cos(static_cast<T>(angle));
-			const T s = sin(static_cast<T>(angle));
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
 
 			return Matrix4<T>{
 				c, 0, s, 0,
@@ -59,8 +63,8 @@ namespace els
 		template <typename S>
 		static inline constexpr Matrix4<T> rotateZ(S angle)
 		{
-			const T c = cos(static_cast<T>(angle));
-			const T s = sin(static_cast<T>(angle));
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
 
 			return Matrix4<T>{
 				c, -s, 0, 0,
@@ -70,6 +74,108 @@ namespace els
 			};
 		}
 
+		// rotateZ(roll) * rotateX(pitch) * rotateY(yaw) with the library operator*, in one pass, same order
+		// as Quaternion::set_euler
+		template <typename S>
+		static inline constexpr Matrix4<T> euler(S yaw, S pitch, S roll)
+		{
+			const Matrix3<T> r = euler3(yaw, pitch, roll);
+
+			return Matrix4<T>{
+				r.m[0], r.m[1], r.m[2], 0,
+					r.m[3], r.m[4], r.m[5], 0,
+					r.m[6], r.m[7], r.m[8], 0,
+					0, 0, 0, 1
+			};
+		}
+		template <typename S>
+		static inline constexpr Matrix3<T> euler3(S yaw, S pitch, S roll)
+		{
+			T sy{}, cy{}, sp{}, cp{}, sr{}, cr{};
+			sincos(static_cast<T>(yaw), sy, cy);
+			sincos(static_cast<T>(pitch), sp, cp);
+			sincos(static_cast<T>(roll), sr, cr);
+
+			return Matrix3<T>{
+				cy * cr + sy * sp * sr, sy * sp * cr - cy * sr, sy * cp,
+					cp * sr, cp * cr, -sp,
+					cy * sp * sr - sy * cr, sy * sr + cy * sp * cr, cy * cp
+			};
+		}
+
+		// rotation about an arbitrary axis, the axis does not need to be normalized
+		template <typename S>
+		static inline constexpr Matrix4<T> rotate(const Vector3<S>& axis, S angle)
+		{
+			const Matrix3<T> r = rotate3(axis, angle);
+
+			return Matrix4<T>{
+				r.m[0], r.m[1], r.m[2], 0,
+					r.m[3], r.m[4], r.m[5], 0,
+					r.m[6], r.m[7], r.m[8], 0,
+					0, 0, 0, 1
+			};
+		}
+		template <typename S>
+		static inline constexpr Matrix3<T> rotate3(const Vector3<S>& axis, S angle)
+		{
+			const Vector3<T> a = static_cast<Vector3<T>>(axis).normalized();
+
+			T s{}, c{};
+			sincos(static_cast<T>(angle), s, c);
+			const T t = 1 - c;
+
+			return Matrix3<T>{
+				t * a.x * a.x + c, t * a.x * a.y - s * a.z, t * a.x * a.z + s * a.y,
+					t * a.x * a.y + s * a.z, t * a.y * a.y + c, t * a.y * a.z - s * a.x,
+					t * a.x * a.z - s * a.y, t * a.y * a.z + s * a.x, t * a.z * a.z + c
+			};
+		}
+
+		// matrices per worker chunk for the batch builders
+		static constexpr size_t batch_grain = 1 << 12;
+
+		// batch euler rotations from structure of arrays angles, all spans must be out.size() long
+		// the angles of a block go through the span sincos kernels of elsMathBatch.h, then every matrix
+		// is written from them, large spans are split across threads
+		static inline void euler(span<const T> yaw, span<const T> pitch, span<const T> roll, span<Matrix4<T>> out)
+		{
+			trs({}, yaw, pitch, roll, {}, out);
+		}
+		// batch translation + euler rotation + scale, an empty translation or scale span leaves that part out
+		static inline void trs(
+			span<const Vector3<T>> translation,
+			span<const T> yaw, span<const T> pitch, span<const T> roll,
+			span<const Vector3<T>> scale,
+			span<Matrix4<T>> out)
+		{
+			using detail::batch::sincos_block;
+			parallel::for_range(0, out.size(), batch_grain, [&](size_t first, size_t last)
+				{
+					T sy[sincos_block], cy[sincos_block], sp[sincos_block], cp[sincos_block], sr[sincos_block], cr[sincos_block];
+					for (size_t b = first; b < last; b += sincos_block)
+					{
+						const size_t n = min(sincos_block, last - b);
+						detail::batch::sincos_n(yaw.data() + b, sy, cy, n);
+						detail::batch::sincos_n(pitch.data() + b, sp, cp, n);
+						detail::batch::sincos_n(roll.data() + b, sr, cr, n);
+
+						for (size_t j = 0; j < n; ++j)
+						{
+							const size_t i = b + j;
+							const Vector3<T> t = translation.empty() ? Vector3<T>{ T(0), T(0), T(0) } : translation[i];
+							const Vector3<T> k = scale.empty() ? Vector3<T>{ T(1), T(1), T(1) } : scale[i];
+
+							T* m = out[i].data();
+							m[0] = (cy[j] * cr[j] + sy[j] * sp[j] * sr[j]) * k.x; m[1] = (sy[j] * sp[j] * cr[j] - cy[j] * sr[j]) * k.y; m[2] = sy[j] * cp[j] * k.z; m[3] = t.x;
+							m[4] = cp[j] * sr[j] * k.x; m[5] = cp[j] * cr[j] * k.y; m[6] = -sp[j] * k.z; m[7] = t.y;
+							m[8] = (cy[j] * sp[j] * sr[j] - sy[j] * cr[j]) * k.x; m[9] = (sy[j] * sr[j] + cy[j] * sp[j] * cr[j]) * k.y; m[10] = cy[j] * cp[j] * k.z; m[11] = t.z;
+							m[12] = 0; m[13] = 0; m[14] = 0; m[15] = 1;
+						}
+					}
+				});
+		}
+
 		template <typename S>
 		static inline constexpr Matrix4<T> scale(S x, S y, S z)
 		{
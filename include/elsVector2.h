@@ -20,8 +20,8 @@ namespace els
 		constexpr Vector2() : Vector2{ static_cast<Scalar>(0) } {}
 		constexpr explicit Vector2(const Scalar& s) : Vector2{ static_cast<Scalar>(s), static_cast<Scalar>(s) } {}
 		constexpr Vector2(const Scalar& _x, const Scalar& _y) : x{ _x }, y{ _y }{}
-		constexpr Vector2(const Vector2& rhs) : Vector2{ rhs.x, rhs.y } {}
-		constexpr Vector2& operator=(const Vector2&);
+		constexpr Vector2(const Vector2&) = default;
+		constexpr Vector2& operator=(const Vector2&) = default;
 
 
 		constexpr Scalar* data();
@@ -37,12 +37,12 @@ namespace els
 		constexpr Vector2 operator-() const;
 		constexpr Vector2& operator+=(const Vector2&);
 		constexpr Vector2& operator-=(const Vector2&);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector2& operator*=(S);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector2& operator/=(S);
 
-		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template <typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr explicit operator Vector2<S>() const
 		{
 			return Vector2<S>{S(x), S(y)};
@@ -58,7 +58,7 @@ namespace els
 		constexpr Vector2 ccw_normal() const;
 		constexpr Vector2 normalized() const;
 		constexpr Vector2 projection(const Vector2&) const;
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector2 lerp(const Vector2&, S) const;
 
 		constexpr Scalar cross(const Vector2&) const;
@@ -83,11 +83,11 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Vector2<T> Vector2<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0) };
+	constexpr Vector2<T> Vector2<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector2<T> Vector2<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1) };
+	constexpr Vector2<T> Vector2<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1) };
 	template <typename T>
-	const Vector2<T> Vector2<T>::zero{};
+	constexpr Vector2<T> Vector2<T>::zero{};
 
 	// static functions
 	template <typename T = defaultType, typename TVec>
@@ -114,37 +114,27 @@ namespace els
 		diff -= rhs;
 		return diff;
 	}
-	template<typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template<typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector2<T> operator*(const Vector2<T>& lhs, S rhs)
 	{
 		Vector2<T> prod = lhs;
 		prod *= rhs;
 		return prod;
 	}
-	template<typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template<typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector2<T> operator/(const Vector2<T>& lhs, S rhs)
 	{
 		Vector2<T> quot = lhs;
 		quot /= rhs;
 		return quot;
 	}
-	template<typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template<typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector2<T> operator*(S lhs, const Vector2<T>& rhs)
 	{
 		return rhs * lhs;
 	}
 
 	// member functions
-	template<typename T>
-	constexpr Vector2<T>& Vector2<T>::operator=(const Vector2<T>& rhs)
-	{
-		if (this != &rhs)
-		{
-			x = rhs.x;
-			y = rhs.y;
-		}
-		return *this;
-	}
 
 	template<typename T>
 	constexpr typename Vector2<T>::Scalar* Vector2<T>::data()
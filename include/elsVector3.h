@@ -33,8 +33,8 @@ namespace els
 		constexpr Vector3() : Vector3{ static_cast<Scalar>(0) } {}
 		constexpr explicit Vector3(const Scalar& s) : Vector3{ static_cast<Scalar>(s), static_cast<Scalar>(s), static_cast<Scalar>(s) } {}
 		constexpr Vector3(const Scalar& _x, const Scalar& _y, const Scalar& _z) : x{ _x }, y{ _y }, z{ _z }{}
-		constexpr Vector3(const Vector3& rhs) : Vector3{ rhs.x, rhs.y, rhs.z } {}
-		constexpr Vector3& operator=(const Vector3&);
+		constexpr Vector3(const Vector3&) = default;
+		constexpr Vector3& operator=(const Vector3&) = default;
 
 
 		constexpr Scalar* data();
@@ -49,12 +49,12 @@ namespace els
 		constexpr Vector3 operator-() const;
 		constexpr Vector3& operator+=(const Vector3&);
 		constexpr Vector3& operator-=(const Vector3&);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector3& operator*=(S);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector3& operator/=(S);
 
-		template <typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template <typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr explicit operator Vector3<S>() const
 		{
 			return Vector3<S>{S(x), S(y), S(z)};
@@ -68,7 +68,7 @@ namespace els
 
 		constexpr Vector3 normalized() const;
 		constexpr Vector3 projection(const Vector3&) const;
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector3 lerp(const Vector3&, S) const;
 		constexpr Vector3 cross(const Vector3&) const;
 
@@ -97,13 +97,13 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Vector3<T> Vector3<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0) };
+	constexpr Vector3<T> Vector3<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector3<T> Vector3<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0) };
+	constexpr Vector3<T> Vector3<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector3<T> Vector3<T>::k{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
+	constexpr Vector3<T> Vector3<T>::k{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
 	template <typename T>
-	const Vector3<T> Vector3<T>::zero{};
+	constexpr Vector3<T> Vector3<T>::zero{};
 
 	// static functions
 	template <typename T = defaultType, typename TVec>
@@ -131,14 +131,14 @@ namespace els
 		diff -= rhs;
 		return diff;
 	}
-	template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template <typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector3<T> operator*(const Vector3<T>& lhs, const S& rhs)
 	{
 		Vector3<T> prod = lhs;
 		prod *= rhs;
 		return prod;
 	}
-	template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template <typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector3<T> operator/(const Vector3<T>& lhs, const S& rhs)
 	{
 		Vector3<T> quot = lhs;
@@ -172,17 +172,6 @@ namespace els
 	{
 		return data()[index];
 	}
-	template <typename T>
-	constexpr Vector3<T>& Vector3<T>::operator=(const Vector3<T>& rhs)
-	{
-		if (this != &rhs)
-		{
-			x = rhs.x;
-			y = rhs.y;
-			z = rhs.z;
-		}
-		return *this;
-	}
 	
 	template <typename T>
 	constexpr bool Vector3<T>::operator==(const Vector3<T>& rhs) const
@@ -37,8 +37,8 @@ namespace els
 		constexpr Vector4() : Vector4{ static_cast<Scalar>(0) } {}
 		constexpr explicit Vector4(const Scalar& s) : Vector4{ static_cast<Scalar>(s), static_cast<Scalar>(s), static_cast<Scalar>(s), static_cast<Scalar>(s) } {}
 		constexpr Vector4(const Scalar& _x, const Scalar& _y, const Scalar& _z, const Scalar& _w) : x{ _x }, y{ _y }, z{ _z }, w{ _w }{}
-		constexpr Vector4(const Vector4& rhs) : Vector4{ rhs.x, rhs.y, rhs.z, rhs.w } {}
-		constexpr Vector4& operator=(const Vector4&);
+		constexpr Vector4(const Vector4&) = default;
+		constexpr Vector4& operator=(const Vector4&) = default;
 
 		constexpr Scalar* data();
 		constexpr const Scalar* data() const;
@@ -52,9 +52,9 @@ namespace els
 		constexpr Vector4 operator-() const;
 		constexpr Vector4& operator+=(const Vector4&);
 		constexpr Vector4& operator-=(const Vector4&);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector4& operator*=(S);
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector4& operator/=(S);
 
 		template <typename S>
@@ -71,7 +71,7 @@ namespace els
 
 		constexpr Vector4 normalized() const;
 		constexpr Vector4 projection(const Vector4&) const;
-		template<typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 		constexpr Vector4 lerp(const Vector4&, S) const;
 
 		constexpr Scalar dot(const Vector4&) const;
@@ -99,15 +99,15 @@ namespace els
 
 	// constants
 	template <typename T>
-	const Vector4<T> Vector4<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) };
+	constexpr Vector4<T> Vector4<T>::i{ static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector4<T> Vector4<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0) };
+	constexpr Vector4<T> Vector4<T>::j{ static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector4<T> Vector4<T>::k{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0) };
+	constexpr Vector4<T> Vector4<T>::k{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1), static_cast<Scalar>(0) };
 	template <typename T>
-	const Vector4<T> Vector4<T>::l{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
+	constexpr Vector4<T> Vector4<T>::l{ static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(0), static_cast<Scalar>(1) };
 	template <typename T>
-	const Vector4<T> Vector4<T>::zero{};
+	constexpr Vector4<T> Vector4<T>::zero{};
 
 	// static functions
 	template <typename T = defaultType, typename TVec>
@@ -137,21 +137,21 @@ namespace els
 		diff -= rhs;
 		return diff;
 	}
-	template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template <typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector4<T> operator*(const Vector4<T>& lhs, S rhs)
 	{
 		Vector4<T> prod = lhs;
 		prod *= rhs;
 		return prod;
 	}
-	template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template <typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector4<T> operator/(const Vector4<T>& lhs, S rhs)
 	{
 		Vector4<T> quot = lhs;
 		quot /= rhs;
 		return quot;
 	}
-	template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic<S>::value>>
+	template <typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
 	constexpr Vector4<T> operator*(S lhs, const Vector4<T>& rhs)
 	{
 		return rhs * lhs;
@@ -178,18 +178,6 @@ namespace els
 	{
 		return data()[index];
 	}
-	template <typename T>
-	constexpr Vector4<T>& Vector4<T>::operator=(const Vector4<T>& rhs)
-	{
-		if (this != &rhs)
-		{
-			x = rhs.x;
-			y = rhs.y;
-			z = rhs.z;
-			w = rhs.w;
-		}
-		return *this;
-	}
 	
 	template <typename T>
 	constexpr bool Vector4<T>::operator==(const Vector4<T>& rhs) const
@@ -0,0 +1,207 @@
+#ifndef ELS_VECTOR_EXPR
+#define ELS_VECTOR_EXPR
+
+#include <utility>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+#include "elsQuaternion.h"
+
+namespace els
+{
+	// opt-in expression templates
+	// lazy(a) * s + lazy(b) * t - c builds a tree of references that is evaluated
+	// in a single per-component loop when assigned to a vector, without temporaries
+	// expressions hold references to their operands, do not keep them past the full expression
+	namespace expr
+	{
+		template <typename V>
+		struct is_vector : std::false_type {};
+		template <typename T>
+		struct is_vector<Vector2<T>> : std::true_type {};
+		template <typename T>
+		struct is_vector<Vector3<T>> : std::true_type {};
+		template <typename T>
+		struct is_vector<Vector4<T>> : std::true_type {};
+		template <typename T>
+		struct is_vector<Quaternion<T>> : std::true_type {};
+
+		template <typename V>
+		constexpr size_t size_of = sizeof(V) / sizeof(typename V::Scalar);
+
+		template <typename E>
+		struct Expr
+		{
+			constexpr const E& self() const { return static_cast<const E&>(*this); }
+
+			constexpr auto eval() const
+			{
+				return make(std::make_index_sequence<E::size>{});
+			}
+			template <typename V, typename D = E, typename = std::enable_if_t<std::is_same<V, typename D::vector_type>::value>>
+			constexpr operator V() const
+			{
+				return eval();
+			}
+
+			template <typename R>
+			constexpr auto dot(const Expr<R>& rhs) const
+			{
+				return dot(rhs.self(), std::make_index_sequence<E::size>{});
+			}
+			constexpr auto length2() const
+			{
+				return dot(*this);
+			}
+			constexpr auto length() const
+			{
+				return sqrt(length2());
+			}
+
+		private:
+			template <size_t... I>
+			constexpr auto make(std::index_sequence<I...>) const
+			{
+				return typename E::vector_type{ self()[I]... };
+			}
+			// unrolled like make, gcc -O2 keeps the loop version as a loop
+			template <typename R, size_t... I>
+			constexpr auto dot(const R& rhs, std::index_sequence<I...>) const
+			{
+				return ((self()[I] * rhs[I]) + ...);
+			}
+		};
+
+		template <typename V>
+		struct Leaf : Expr<Leaf<V>>
+		{
+			using vector_type = V;
+			using Scalar = typename V::Scalar;
+			static constexpr size_t size = size_of<V>;
+
+			const V& v;
+
+			constexpr explicit Leaf(const V& vec) : v{ vec } {}
+			constexpr Scalar operator[](size_t i) const { return v.data()[i]; }
+		};
+
+		template <typename L, typename R, typename Op>
+		struct Binary : Expr<Binary<L, R, Op>>
+		{
+			static_assert(std::is_same<typename L::vector_type, typename R::vector_type>::value, "mismatched vector types");
+
+			using vector_type = typename L::vector_type;
+			using Scalar = typename L::Scalar;
+			static constexpr size_t size = L::size;
+
+			L lhs;
+			R rhs;
+
+			constexpr Binary(const L& l, const R& r) : lhs{ l }, rhs{ r } {}
+			constexpr Scalar operator[](size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+		};
+
+		template <typename E, typename Op>
+		struct Scaled : Expr<Scaled<E, Op>>
+		{
+			using vector_type = typename E::vector_type;
+			using Scalar = typename E::Scalar;
+			static constexpr size_t size = E::size;
+
+			E e;
+			Scalar s;
+
+			constexpr Scaled(const E& ex, Scalar scalar) : e{ ex }, s{ scalar } {}
+			constexpr Scalar operator[](size_t i) const { return Op::apply(e[i], s); }
+		};
+
+		template <typename E>
+		struct Negate : Expr<Negate<E>>
+		{
+			using vector_type = typename E::vector_type;
+			using Scalar = typename E::Scalar;
+			static constexpr size_t size = E::size;
+
+			E e;
+
+			constexpr explicit Negate(const E& ex) : e{ ex } {}
+			constexpr Scalar operator[](size_t i) const { return -e[i]; }
+		};
+
+		struct add { template <typename T> static constexpr T apply(T a, T b) { return a + b; } };
+		struct sub { template <typename T> static constexpr T apply(T a, T b) { return a - b; } };
+		struct mul { template <typename T> static constexpr T apply(T a, T b) { return a * b; } };
+		struct div { template <typename T> static constexpr T apply(T a, T b) { return a / b; } };
+
+		// operands are either expressions or plain vectors
+		template <typename E>
+		constexpr const E& wrap(const Expr<E>& e) { return e.self(); }
+		template <typename V, typename = std::enable_if_t<is_vector<V>::value>>
+		constexpr Leaf<V> wrap(const V& v) { return Leaf<V>{ v }; }
+
+		template <typename A>
+		using wrapped = std::decay_t<decltype(wrap(std::declval<const A&>()))>;
+
+		template <typename A, typename B>
+		constexpr bool is_operand_pair =
+			(std::is_base_of<Expr<A>, A>::value || is_vector<A>::value) &&
+			(std::is_base_of<Expr<B>, B>::value || is_vector<B>::value) &&
+			!(is_vector<A>::value && is_vector<B>::value);
+
+		template <typename E>
+		constexpr bool is_expr = std::is_base_of<Expr<E>, E>::value;
+
+		// global operators
+		template <typename A, typename B, typename = std::enable_if_t<is_operand_pair<A, B>>>
+		constexpr Binary<wrapped<A>, wrapped<B>, add> operator+(const A& a, const B& b)
+		{
+			return { wrap(a), wrap(b) };
+		}
+		template <typename A, typename B, typename = std::enable_if_t<is_operand_pair<A, B>>>
+		constexpr Binary<wrapped<A>, wrapped<B>, sub> operator-(const A& a, const B& b)
+		{
+			return { wrap(a), wrap(b) };
+		}
+		template <typename E, typename S, typename = std::enable_if_t<is_expr<E>&& is_scalar<S>::value>>
+		constexpr Scaled<E, mul> operator*(const E& e, S s)
+		{
+			return { e, static_cast<typename E::Scalar>(s) };
+		}
+		template <typename E, typename S, typename = std::enable_if_t<is_expr<E>&& is_scalar<S>::value>>
+		constexpr Scaled<E, mul> operator*(S s, const E& e)
+		{
+			return { e, static_cast<typename E::Scalar>(s) };
+		}
+		template <typename E, typename S, typename = std::enable_if_t<is_expr<E>&& is_scalar<S>::value>>
+		constexpr Scaled<E, div> operator/(const E& e, S s)
+		{
+			return { e, static_cast<typename E::Scalar>(s) };
+		}
+		template <typename E, typename = std::enable_if_t<is_expr<E>>>
+		constexpr Negate<E> operator-(const E& e)
+		{
+			return Negate<E>{ e };
+		}
+
+		// assigns an expression to an existing vector in one pass
+		template <typename V, typename E>
+		constexpr V& assign(V& out, const Expr<E>& e)
+		{
+			out = e.self().eval();
+			return out;
+		}
+	}
+
+	// entry point of an expression
+	template <typename V, typename = std::enable_if_t<expr::is_vector<V>::value>>
+	constexpr expr::Leaf<V> lazy(const V& v)
+	{
+		return expr::Leaf<V>{ v };
+	}
+
+} // namespace els
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef ELS_VECTORN
+#define ELS_VECTORN
+
+#include <utility>
+#include <type_traits>
+#include "elsHeader.h"
+#include "elsMath.h"
+#include "elsCompare.h"
+#include "elsSimd.h"
+#include "elsVectorGeneric.h"
+#include "elsVector2.h"
+#include "elsVector3.h"
+#include "elsVector4.h"
+
+namespace els
+{
+	// generic N component vector
+	// every operation is unrolled at compile time through index sequences
+	// Vector2/3/4 convert to and from the matching size
+	template <size_t N, typename T>
+	struct Vector
+	{
+		static_assert(N > 0, "empty vector");
+
+		using Scalar = T;
+		static constexpr size_t size = N;
+
+		Scalar v[N];
+
+		constexpr Vector() : Vector{ static_cast<Scalar>(0) } {}
+		constexpr explicit Vector(const Scalar& s) : Vector{ s, std::make_index_sequence<N>{} } {}
+		template <typename... Ts, typename = std::enable_if_t<sizeof...(Ts) == N && (N > 1) && (std::is_convertible<Ts, T>::value && ...)>>
+		constexpr Vector(const Ts&... s) : v{ static_cast<Scalar>(s)... } {}
+
+		template <size_t M = N, typename = std::enable_if_t<M == 2>>
+		constexpr Vector(const Vector2<T>& rhs) : v{ rhs.x, rhs.y } {}
+		template <size_t M = N, typename = std::enable_if_t<M == 3>>
+		constexpr Vector(const Vector3<T>& rhs) : v{ rhs.x, rhs.y, rhs.z } {}
+		template <size_t M = N, typename = std::enable_if_t<M == 4>>
+		constexpr Vector(const Vector4<T>& rhs) : v{ rhs.x, rhs.y, rhs.z, rhs.w } {}
+
+		template <size_t M = N, typename = std::enable_if_t<M == 2>>
+		constexpr operator Vector2<T>() const { return Vector2<T>{ v[0], v[1] }; }
+		template <size_t M = N, typename = std::enable_if_t<M == 3>>
+		constexpr operator Vector3<T>() const { return Vector3<T>{ v[0], v[1], v[2] }; }
+		template <size_t M = N, typename = std::enable_if_t<M == 4>>
+		constexpr operator Vector4<T>() const { return Vector4<T>{ v[0], v[1], v[2], v[3] }; }
+
+		template <typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+		constexpr explicit operator Vector<N, S>() const
+		{
+			return map([](const T& a) { return static_cast<S>(a); });
+		}
+
+		constexpr Scalar* data() { return v; }
+		constexpr const Scalar* data() const { return v; }
+
+		constexpr Scalar& operator[](size_t index) { return v[index]; }
+		constexpr const Scalar& operator[](size_t index) const { return v[index]; }
+
+		constexpr bool operator==(const Vector&) const;
+		constexpr bool operator!=(const Vector&) const;
+
+		constexpr Vector operator-() const;
+		constexpr Vector& operator+=(const Vector&);
+		constexpr Vector& operator-=(const Vector&);
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+		constexpr Vector& operator*=(S);
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+		constexpr Vector& operator/=(S);
+
+		// f(a[i]) for each component
+		template <typename F>
+		constexpr auto map(F&& f) const;
+		// f(a[i], b[i]) for each component
+		template <typename F>
+		constexpr Vector zip(const Vector&, F&& f) const;
+
+		constexpr Vector normalized() const;
+		constexpr Vector projection(const Vector&) const;
+		template<typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+		constexpr Vector lerp(const Vector&, S) const;
+		constexpr Vector hadamard(const Vector&) const; // componentwise product
+
+		constexpr Scalar dot(const Vector&) const;
+		constexpr Scalar distance2(const Vector&) const;
+		constexpr Scalar distance(const Vector&) const;
+		constexpr Scalar length2() const;
+		constexpr Scalar length() const;
+		constexpr Scalar proj_length(const Vector&) const;
+		constexpr Scalar angle(const Vector&) const;
+
+		// reductions
+		constexpr Scalar sum() const;
+		constexpr Scalar product() const;
+		constexpr Scalar min_component() const;
+		constexpr Scalar max_component() const;
+
+		constexpr void normalize();
+
+		// unit vector along axis i
+		static constexpr Vector unit(size_t i);
+
+	private:
+		template <size_t... I>
+		constexpr Vector(const Scalar& s, std::index_sequence<I...>) : v{ (static_cast<void>(I), s)... } {}
+
+		template <typename F, size_t... I>
+		constexpr auto map(F& f, std::index_sequence<I...>) const;
+		template <typename F, size_t... I>
+		constexpr Vector zip(const Vector&, F& f, std::index_sequence<I...>) const;
+		template <size_t... I>
+		constexpr Scalar dot(const Vector&, std::index_sequence<I...>) const;
+		template <size_t... I>
+		constexpr Scalar sum(std::index_sequence<I...>) const;
+		template <size_t... I>
+		constexpr Scalar product(std::index_sequence<I...>) const;
+	};
+
+	// typedefs
+	template <size_t N>
+	using vecf = Vector<N, float>;
+	template <size_t N>
+	using vecn = Vector<N, defaultType>;
+
+	// static functions
+	template <typename T = defaultType, size_t N, typename S>
+	constexpr Vector<N, T> to_vecn(const Vector<N, S>& rhs)
+	{
+		return static_cast<Vector<N, T>>(rhs);
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> min(const Vector<N, T>& a, const Vector<N, T>& b)
+	{
+		return a.zip(b, [](const T& x, const T& y) { return x < y ? x : y; });
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> max(const Vector<N, T>& a, const Vector<N, T>& b)
+	{
+		return a.zip(b, [](const T& x, const T& y) { return x < y ? y : x; });
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> lerp(const Vector<N, T>& a, const Vector<N, T>& b, T t)
+	{
+		return a.lerp(b, t);
+	}
+
+	// global operators
+	template <size_t N, typename T>
+	constexpr Vector<N, T> operator+(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
+	{
+		Vector<N, T> sum = lhs;
+		sum += rhs;
+		return sum;
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> operator-(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
+	{
+		Vector<N, T> diff = lhs;
+		diff -= rhs;
+		return diff;
+	}
+	template <size_t N, typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+	constexpr Vector<N, T> operator*(const Vector<N, T>& lhs, const S& rhs)
+	{
+		Vector<N, T> prod = lhs;
+		prod *= rhs;
+		return prod;
+	}
+	template <size_t N, typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+	constexpr Vector<N, T> operator*(const S& lhs, const Vector<N, T>& rhs)
+	{
+		return rhs * lhs;
+	}
+	template <size_t N, typename T, typename S, typename = std::enable_if_t<is_scalar<S>::value>>
+	constexpr Vector<N, T> operator/(const Vector<N, T>& lhs, const S& rhs)
+	{
+		Vector<N, T> quot = lhs;
+		quot /= rhs;
+		return quot;
+	}
+
+	// member functions
+	template <size_t N, typename T>
+	template <typename F, size_t... I>
+	constexpr auto Vector<N, T>::map(F& f, std::index_sequence<I...>) const
+	{
+		using R = std::decay_t<decltype(f(v[0]))>;
+		return Vector<N, R>{ R(f(v[I]))... };
+	}
+	template <size_t N, typename T>
+	template <typename F>
+	constexpr auto Vector<N, T>::map(F&& f) const
+	{
+		return map(f, std::make_index_sequence<N>{});
+	}
+	template <size_t N, typename T>
+	template <typename F, size_t... I>
+	constexpr Vector<N, T> Vector<N, T>::zip(const Vector<N, T>& rhs, F& f, std::index_sequence<I...>) const
+	{
+		return Vector<N, T>{ static_cast<T>(f(v[I], rhs.v[I]))... };
+	}
+	template <size_t N, typename T>
+	template <typename F>
+	constexpr Vector<N, T> Vector<N, T>::zip(const Vector<N, T>& rhs, F&& f) const
+	{
+		return zip(rhs, f, std::make_index_sequence<N>{});
+	}
+	template <size_t N, typename T>
+	template <size_t... I>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::dot(const Vector<N, T>& rhs, std::index_sequence<I...>) const
+	{
+		return ((v[I] * rhs.v[I]) + ...);
+	}
+	template <size_t N, typename T>
+	template <size_t... I>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::sum(std::index_sequence<I...>) const
+	{
+		return (v[I] + ...);
+	}
+	template <size_t N, typename T>
+	template <size_t... I>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::product(std::index_sequence<I...>) const
+	{
+		return (v[I] * ...);
+	}
+
+	template <size_t N, typename T>
+	constexpr bool Vector<N, T>::operator==(const Vector<N, T>& rhs) const
+	{
+		for (size_t i = 0; i < N; ++i)
+		{
+			if (v[i] != rhs.v[i])
+				return false;
+		}
+		return true;
+	}
+	template <size_t N, typename T>
+	constexpr bool Vector<N, T>::operator!=(const Vector<N, T>& rhs) const
+	{
+		return !(*this == rhs);
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> Vector<N, T>::operator-() const
+	{
+		return map([](const T& a) { return -a; });
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T>& Vector<N, T>::operator+=(const Vector<N, T>& rhs)
+	{
+		if constexpr (std::is_same<T, float>::value && N % 4 == 0)
+		{
+			if (!is_constant_evaluated())
+			{
+				for (size_t i = 0; i < N; i += 4)
+					simd::store(v + i, simd::load(v + i) + simd::load(rhs.v + i));
+				return *this;
+			}
+		}
+		*this = zip(rhs, [](const T& a, const T& b) { return a + b; });
+		return *this;
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T>& Vector<N, T>::operator-=(const Vector<N, T>& rhs)
+	{
+		if constexpr (std::is_same<T, float>::value && N % 4 == 0)
+		{
+			if (!is_constant_evaluated())
+			{
+				for (size_t i = 0; i < N; i += 4)
+					simd::store(v + i, simd::load(v + i) - simd::load(rhs.v + i));
+				return *this;
+			}
+		}
+		*this = zip(rhs, [](const T& a, const T& b) { return a - b; });
+		return *this;
+	}
+	template <size_t N, typename T>
+	template <typename S, typename>
+	constexpr Vector<N, T>& Vector<N, T>::operator*=(S rhs)
+	{
+		const T s = static_cast<T>(rhs);
+		*this = map([s](const T& a) { return static_cast<T>(a * s); });
+		return *this;
+	}
+	template <size_t N, typename T>
+	template <typename S, typename>
+	constexpr Vector<N, T>& Vector<N, T>::operator/=(S rhs)
+	{
+		const T s = static_cast<T>(rhs);
+		*this = map([s](const T& a) { return static_cast<T>(a / s); });
+		return *this;
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> Vector<N, T>::normalized() const
+	{
+		Vector<N, T> norm = *this;
+		norm /= length();
+		return norm;
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> Vector<N, T>::projection(const Vector<N, T>& rhs) const
+	{
+		return proj_length(rhs) * rhs.normalized();
+	}
+	template <size_t N, typename T>
+	template <typename S, typename>
+	constexpr Vector<N, T> Vector<N, T>::lerp(const Vector<N, T>& b, S t) const
+	{
+		return *this * (1 - t) + b * t;
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> Vector<N, T>::hadamard(const Vector<N, T>& rhs) const
+	{
+		return zip(rhs, [](const T& a, const T& b) { return a * b; });
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::dot(const Vector<N, T>& rhs) const
+	{
+		return dot(rhs, std::make_index_sequence<N>{});
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::distance2(const Vector<N, T>& rhs) const
+	{
+		return (*this - rhs).length2();
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::distance(const Vector<N, T>& rhs) const
+	{
+		return sqrt(distance2(rhs));
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::length2() const
+	{
+		return dot(*this);
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::length() const
+	{
+		return sqrt(length2());
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::proj_length(const Vector<N, T>& rhs) const
+	{
+		return dot(rhs.normalized());
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::angle(const Vector<N, T>& rhs) const
+	{
+		T denominator2 = length2() * rhs.length2();
+		if (is_zero(denominator2))
+			return 0;
+		return acos(dot(rhs) / sqrt(denominator2));
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::sum() const
+	{
+		return sum(std::make_index_sequence<N>{});
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::product() const
+	{
+		return product(std::make_index_sequence<N>{});
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::min_component() const
+	{
+		Scalar r = v[0];
+		for (size_t i = 1; i < N; ++i)
+			r = v[i] < r ? v[i] : r;
+		return r;
+	}
+	template <size_t N, typename T>
+	constexpr typename Vector<N, T>::Scalar Vector<N, T>::max_component() const
+	{
+		Scalar r = v[0];
+		for (size_t i = 1; i < N; ++i)
+			r = r < v[i] ? v[i] : r;
+		return r;
+	}
+	template <size_t N, typename T>
+	constexpr void Vector<N, T>::normalize()
+	{
+		*this /= length();
+	}
+	template <size_t N, typename T>
+	constexpr Vector<N, T> Vector<N, T>::unit(size_t i)
+	{
+		Vector<N, T> r;
+		r.v[i] = static_cast<T>(1);
+		return r;
+	}
+
+} // namespace els
+
+#endif